@@ -61,6 +61,24 @@ typedef enum {
  */
 extern AJ_API int AJ_CALL alljoyn_unity_deferred_callbacks_process();
 
+/**
+ * Unity-specific function to process a limited batch of alternate-thread
+ * callbacks on the main thread.  Hosts with a frame budget can call this once
+ * per frame instead of alljoyn_unity_deferred_callbacks_process().
+ *
+ * @param max_callbacks  the maximum number of callbacks to process.  Pass 0 to
+ *                       only report the number of pending callbacks.
+ * @param time_budget_ms stop processing callbacks once this many milliseconds
+ *                       have elapsed, or 0 for no time limit.  At least one
+ *                       callback is processed if any are pending and
+ *                       max_callbacks is not 0.
+ * @param[out] remaining if not NULL, set to the number of callbacks still
+ *                       pending when this function returns
+ *
+ * @return the number of callbacks processed.
+ */
+extern AJ_API int AJ_CALL alljoyn_unity_deferred_callbacks_process_batch(size_t max_callbacks, uint32_t time_budget_ms, size_t* remaining);
+
 /**
  * Enable/disable main thread callback behavior.
  */
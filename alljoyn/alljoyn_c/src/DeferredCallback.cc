@@ -15,17 +15,142 @@
  ******************************************************************************/
 
 #include "DeferredCallback.h"
+#include <new>
 #include <qcc/Debug.h>
+#include <qcc/time.h>
 
 #define QCC_MODULE "ALLJOYN_C"
 
 namespace ajn {
 bool DeferredCallback::initilized = false;
-std::list<DeferredCallback*> DeferredCallback::sPendingCallbacks;
 qcc::Thread* DeferredCallback::sMainThread = NULL;
 bool DeferredCallback::sMainThreadCallbacksOnly = false;
 qcc::Mutex DeferredCallback::sCallbackListLock;
 
+/* Initial size of the pending callbacks ring, grown by doubling if it fills up */
+static const size_t PENDING_RING_SIZE = 64;
+
+std::vector<DeferredCallback*> DeferredCallback::sPendingCallbacks(PENDING_RING_SIZE);
+size_t DeferredCallback::sPendingHead = 0;
+size_t DeferredCallback::sPendingCount = 0;
+std::vector<DeferredCallback*> DeferredCallback::sRunCallbacks;
+
+/*
+ * Size of a callback record.  This is large enough for all the DeferredCallback
+ * instantiations used by the C binding, anything larger comes from the heap.
+ */
+static const size_t CALLBACK_RECORD_SIZE = 128;
+
+/* Maximum number of free callback records kept for reuse */
+static const size_t MAX_FREE_RECORDS = 64;
+
+/* Free callback records, linked through their first word */
+static void* freeRecords = NULL;
+static size_t numFreeRecords = 0;
+static qcc::Mutex recordLock;
+
+void* DeferredCallback::operator new(size_t size)
+{
+    if (size > CALLBACK_RECORD_SIZE) {
+        return ::operator new(size);
+    }
+    recordLock.Lock(MUTEX_CONTEXT);
+    void* record = freeRecords;
+    if (record) {
+        freeRecords = *reinterpret_cast<void**>(record);
+        --numFreeRecords;
+    }
+    recordLock.Unlock(MUTEX_CONTEXT);
+    return record ? record : ::operator new(CALLBACK_RECORD_SIZE);
+}
+
+void DeferredCallback::operator delete(void* p, size_t size)
+{
+    if (!p) {
+        return;
+    }
+    if (size <= CALLBACK_RECORD_SIZE) {
+        recordLock.Lock(MUTEX_CONTEXT);
+        if (numFreeRecords < MAX_FREE_RECORDS) {
+            *reinterpret_cast<void**>(p) = freeRecords;
+            freeRecords = p;
+            ++numFreeRecords;
+            p = NULL;
+        }
+        recordLock.Unlock(MUTEX_CONTEXT);
+    }
+    ::operator delete(p);
+}
+
+void DeferredCallback::Enqueue(DeferredCallback* cb)
+{
+    sCallbackListLock.Lock(MUTEX_CONTEXT);
+    size_t capacity = sPendingCallbacks.size();
+    if (sPendingCount == capacity) {
+        /* Unwrap the ring into a larger one */
+        std::vector<DeferredCallback*> ring(capacity * 2);
+        for (size_t i = 0; i < sPendingCount; ++i) {
+            ring[i] = sPendingCallbacks[(sPendingHead + i) % capacity];
+        }
+        sPendingCallbacks.swap(ring);
+        sPendingHead = 0;
+        capacity *= 2;
+    }
+    sPendingCallbacks[(sPendingHead + sPendingCount) % capacity] = cb;
+    ++sPendingCount;
+    sCallbackListLock.Unlock(MUTEX_CONTEXT);
+}
+
+void DeferredCallback::ReapCallbacks()
+{
+    size_t numRun = 0;
+    for (size_t i = 0; i < sRunCallbacks.size(); ++i) {
+        DeferredCallback* cb = sRunCallbacks[i];
+        if (cb->finished) {
+            delete cb;
+        } else {
+            sRunCallbacks[numRun++] = cb;
+        }
+    }
+    sRunCallbacks.resize(numRun);
+}
+
+int DeferredCallback::TriggerCallbacks(size_t maxCallbacks, uint32_t timeBudget, size_t* remaining)
+{
+    int ret = 0;
+    uint64_t start = timeBudget ? qcc::GetTimestamp64() : 0;
+
+    sCallbackListLock.Lock(MUTEX_CONTEXT);
+    ReapCallbacks();
+    while ((sPendingCount > 0) && (static_cast<size_t>(ret) < maxCallbacks)) {
+        DeferredCallback* cb = sPendingCallbacks[sPendingHead];
+        sPendingHead = (sPendingHead + 1) % sPendingCallbacks.size();
+        --sPendingCount;
+        sCallbackListLock.Unlock(MUTEX_CONTEXT);
+
+        /*
+         * The thread that queued the callback is released by runCallbackNow()
+         * and still has to return from Execute() before the callback can be
+         * deleted.  Rather than waiting for it here the callback is freed by
+         * a later call.
+         */
+        cb->runCallbackNow();
+        ret++;
+
+        sCallbackListLock.Lock(MUTEX_CONTEXT);
+        sRunCallbacks.push_back(cb);
+        if (timeBudget && ((qcc::GetTimestamp64() - start) >= timeBudget)) {
+            break;
+        }
+    }
+    ReapCallbacks();
+    if (remaining) {
+        *remaining = sPendingCount;
+    }
+    sCallbackListLock.Unlock(MUTEX_CONTEXT);
+    return ret;
+}
+
 }
 
 int AJ_CALL alljoyn_unity_deferred_callbacks_process()
@@ -34,6 +159,12 @@ int AJ_CALL alljoyn_unity_deferred_callbacks_process()
     return ajn::DeferredCallback::TriggerCallbacks();
 }
 
+int AJ_CALL alljoyn_unity_deferred_callbacks_process_batch(size_t max_callbacks, uint32_t time_budget_ms, size_t* remaining)
+{
+    QCC_DbgTrace(("%s", __FUNCTION__));
+    return ajn::DeferredCallback::TriggerCallbacks(max_callbacks, time_budget_ms, remaining);
+}
+
 void AJ_CALL alljoyn_unity_set_deferred_callback_mainthread_only(QCC_BOOL mainthread_only)
 {
     QCC_DbgTrace(("%s", __FUNCTION__));
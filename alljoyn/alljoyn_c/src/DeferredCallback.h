@@ -17,7 +17,7 @@
 #define _ALLJOYN_C_DEFERREDCALLBACK_H
 
 #include <alljoyn_c/AjAPI.h>
-#include <list>
+#include <vector>
 #include <signal.h>
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
@@ -45,8 +45,9 @@
  * }
  * @endcode
  *
- * note the dcb pointer is not deleted.  It will be deleted in the
- * TriggerCallbacks method after the callback has been processed.
+ * note the dcb pointer is not deleted.  It will be deleted by a later call to
+ * the TriggerCallbacks method after the callback has been processed and
+ * Execute has returned.
  *
  * Since the dcb pointer is only freed if the TriggerCallbacks is called the
  * DeferredCallback class should only be used if the variable
@@ -63,6 +64,13 @@
  * alljoyn_unity_deferred_callbacks_process()
  * @endcode
  *
+ * Hosts that need to bound the time spent processing callbacks, such as a game
+ * engine main loop, can process a limited batch each frame instead
+ * @code
+ * size_t remaining;
+ * alljoyn_unity_deferred_callbacks_process_batch(32, 2, &remaining)
+ * @endcode
+ *
  * The DeferredCallback class is explicitly designed for usage in a specific
  * situation, the AllJoyn Unity Extension on Android.  The default settings
  * (which do not used the DeferredCallback) should not be changed to used the
@@ -91,25 +99,28 @@ class DeferredCallback {
 
     virtual ~DeferredCallback() { }
 
+    /*
+     * Callbacks are allocated from a pool of fixed size records so that
+     * queuing a callback does not normally go to the heap.
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+
+    /**
+     * Process pending callbacks.
+     *
+     * @param maxCallbacks the maximum number of callbacks to process
+     * @param timeBudget   stop processing callbacks once this many milliseconds
+     *                     have elapsed, 0 for no limit
+     * @param[out] remaining if not NULL, the number of callbacks still pending
+     *
+     * @return the number of callbacks processed
+     */
+    static int TriggerCallbacks(size_t maxCallbacks, uint32_t timeBudget, size_t* remaining);
+
     static int TriggerCallbacks()
     {
-        int ret = 0;
-        while (!sPendingCallbacks.empty()) {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            if (sPendingCallbacks.empty()) {
-                sCallbackListLock.Unlock(MUTEX_CONTEXT);
-                break;
-            }
-            DeferredCallback* cb = sPendingCallbacks.front();
-            sPendingCallbacks.pop_front();
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
-            cb->runCallbackNow();
-            while (!cb->finished)
-                qcc::Sleep(1);
-            delete cb;
-            ret++;
-        }
-        return ret;
+        return TriggerCallbacks(static_cast<size_t>(-1), 0, NULL);
     }
 
     static bool IsMainThread()
@@ -120,6 +131,11 @@ class DeferredCallback {
   protected:
     virtual void runCallbackNow() { };
 
+    /**
+     * Add a callback to the pending callbacks ring.
+     */
+    static void Enqueue(DeferredCallback* cb);
+
     void Wait()
     {
         while (!executeNow)
@@ -139,12 +155,27 @@ class DeferredCallback {
   protected:
     static bool initilized;
     volatile sig_atomic_t finished;
-    static std::list<DeferredCallback*> sPendingCallbacks;
     static qcc::Thread* sMainThread;
     static qcc::Mutex sCallbackListLock;
 
     volatile sig_atomic_t executeNow;
   private:
+    /**
+     * Free the callbacks that have been run once the threads that queued them
+     * have returned from Execute().
+     */
+    static void ReapCallbacks();
+
+    /*
+     * Ring of pending callbacks.  The ring is allocated up front and only
+     * grows if more callbacks are pending than it can hold.
+     */
+    static std::vector<DeferredCallback*> sPendingCallbacks;
+    static size_t sPendingHead;
+    static size_t sPendingCount;
+
+    /* Callbacks that have been run but whose Execute() may not have returned yet */
+    static std::vector<DeferredCallback*> sRunCallbacks;
 };
 
 template <typename R, typename T>
@@ -167,9 +198,7 @@ class DeferredCallback_1 : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -204,9 +233,7 @@ class DeferredCallback_1<void, T> : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -238,9 +265,7 @@ class DeferredCallback_2 : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -276,9 +301,7 @@ class DeferredCallback_2<void, T, U> : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -312,9 +335,7 @@ class DeferredCallback_3 : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -352,9 +373,7 @@ class DeferredCallback_3<void, T, U, V> : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -389,9 +408,7 @@ class DeferredCallback_4 : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -432,9 +449,7 @@ class DeferredCallback_4<void, T, U, V, W> : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -468,9 +483,7 @@ class DeferredCallback_6 : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
@@ -509,9 +522,7 @@ class DeferredCallback_6<void, T, U, V, W, X, Y> : public DeferredCallback {
         if (!sMainThreadCallbacksOnly) {
             runCallbackNow();
         } else {
-            sCallbackListLock.Lock(MUTEX_CONTEXT);
-            sPendingCallbacks.push_back(this);
-            sCallbackListLock.Unlock(MUTEX_CONTEXT);
+            Enqueue(this);
             if (!IsMainThread()) {
                 Wait();
             }
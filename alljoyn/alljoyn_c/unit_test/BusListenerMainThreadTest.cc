@@ -120,6 +120,29 @@ TEST_F(BusListenerMainThreadTest, listner_registered_unregistered) {
     EXPECT_TRUE(listener_unregistered_flag);
 }
 
+TEST_F(BusListenerMainThreadTest, process_batch) {
+    size_t remaining = 0;
+    alljoyn_busattachment_registerbuslistener(bus, buslistener);
+    /* a batch of zero callbacks only reports the backlog */
+    EXPECT_EQ(0, alljoyn_unity_deferred_callbacks_process_batch(0, 0, &remaining));
+    EXPECT_EQ(1U, remaining);
+    EXPECT_FALSE(listener_registered_flag);
+
+    EXPECT_EQ(1, alljoyn_unity_deferred_callbacks_process_batch(1, 10, &remaining));
+    EXPECT_EQ(0U, remaining);
+    EXPECT_TRUE(listener_registered_flag);
+
+    alljoyn_busattachment_unregisterbuslistener(bus, buslistener);
+    for (size_t i = 0; i < 200; ++i) {
+        alljoyn_unity_deferred_callbacks_process_batch(1, 10, NULL);
+        if (listener_unregistered_flag) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_TRUE(listener_unregistered_flag);
+}
+
 //ALLJOYN-1738
 TEST_F(BusListenerMainThreadTest, DISABLED_bus_stopping_disconnected) {
 
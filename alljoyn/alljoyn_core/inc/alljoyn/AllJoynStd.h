@@ -80,6 +80,14 @@ namespace Session {
 extern const char* InterfaceName;                      /**<Interface name */
 }
 }
+
+/** Interface definitions for org.alljoyn.Bus.Debug.* */
+namespace Debug {
+namespace Stats {
+extern const char* ObjectPath;                         /**< Object path */
+extern const char* InterfaceName;                      /**< Interface name */
+}
+}
 }
 
 /** Interface definitions for org.alljoyn.Daemon */
@@ -123,6 +123,17 @@ class AutoPinger {
      */
     QStatus RemoveDestination(const qcc::String& group, const qcc::String& destination, bool removeAll = false);
 
+    /**
+     * Limit the rate at which pings are sent for all groups.  Destinations
+     * that are due while a limit is reached are pinged as soon as the limit
+     * allows it.  By default at most 200 pings are sent per second and at
+     * most 64 pings wait for a reply at any time.
+     *
+     * @param  maxPingsPerSecond Maximum number of pings sent per second, 0 for no limit
+     * @param  maxInFlight Maximum number of pings waiting for a reply, 0 for no limit
+     */
+    void SetRateLimit(uint32_t maxPingsPerSecond, uint32_t maxInFlight);
+
   private:
     AutoPinger(const AutoPinger&);
     void operator=(const AutoPinger&);
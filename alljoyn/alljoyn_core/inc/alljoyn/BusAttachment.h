@@ -160,7 +160,7 @@ class BusAttachment : public MessageReceiver {
      *
      * @return The string representing the connect spec used by the BusAttachment
      */
-    qcc::String GetConnectSpec();
+    const qcc::String& GetConnectSpec();
 
     /**
      * Allow the currently executing method/signal handler to enable concurrent callbacks
@@ -547,7 +547,7 @@ class BusAttachment : public MessageReceiver {
      *
      * @return The unique name of this BusAttachment.
      */
-    const qcc::String GetUniqueName() const;
+    const qcc::String& GetUniqueName() const;
 
     /**
      * Get the unique name of specified alias.
@@ -128,6 +128,63 @@ class BusObject : public MessageReceiver {
      */
     QStatus EmitPropChanged(const char* ifcName, const char** propNames, size_t numProps, SessionId id, uint8_t flags = 0);
 
+    /**
+     * Counters kept for an interface and session that coalesce PropertiesChanged signals
+     */
+    struct PropChangedCounters {
+        uint32_t updates;       /**< Property changes passed to EmitPropChanged */
+        uint32_t signals;       /**< PropertiesChanged signals sent for those changes */
+        uint32_t superseded;    /**< Changes replaced by a later change to the same property before they were sent */
+
+        /** Constructor */
+        PropChangedCounters() : updates(0), signals(0), superseded(0) { }
+    };
+
+    /**
+     * Coalesce the PropertiesChanged signals emitted for an interface and session.
+     *
+     * Once a window is set EmitPropChanged queues property changes instead of sending them. The
+     * changes queued within windowMs of the first one are sent as a single PropertiesChanged
+     * signal that carries the latest value of each property. Changes that are still queued when
+     * this object is destroyed are discarded.
+     *
+     * @param ifcName   The name of the interface.
+     * @param id        ID of the session the signals are emitted on (0 for all).
+     * @param windowMs  Coalescing window in milliseconds. Zero sends any queued changes and
+     *                  stops coalescing.
+     *
+     * @return
+     *      - #ER_OK if successful.
+     *      - #ER_BUS_UNKNOWN_INTERFACE if this object does not implement the interface.
+     */
+    QStatus SetPropChangedWindow(const char* ifcName, SessionId id, uint32_t windowMs);
+
+    /**
+     * Send the queued property changes for an interface and session now rather than at the
+     * end of the coalescing window.
+     *
+     * @param ifcName   The name of the interface.
+     * @param id        ID of the session the signals are emitted on (0 for all).
+     *
+     * @return
+     *      - #ER_OK if there was nothing to send or the signal was sent.
+     *      - An error status from Signal otherwise.
+     */
+    QStatus FlushPropChanged(const char* ifcName, SessionId id);
+
+    /**
+     * Get the counters for an interface and session that coalesce PropertiesChanged signals.
+     *
+     * @param ifcName        The name of the interface.
+     * @param id             ID of the session the signals are emitted on (0 for all).
+     * @param[out] counters  Returns the counters, all zero if no window was ever set.
+     *
+     * @return
+     *      - #ER_OK if successful.
+     *      - #ER_BUS_UNKNOWN_INTERFACE if this object does not implement the interface.
+     */
+    QStatus GetPropChangedCounters(const char* ifcName, SessionId id, PropChangedCounters& counters);
+
     /**
      * Get a reference to the underlying BusAttachment
      *
@@ -604,6 +661,23 @@ class BusObject : public MessageReceiver {
      */
     const char* GetDescription(const char* toLanguage, qcc::String& buffer) const;
 
+    /**
+     * Send a PropertiesChanged signal.
+     *
+     * @param ifcName         The name of the interface.
+     * @param id              ID of the session to send the signal on (0 for all).
+     * @param flags           Flags to be added to the signal.
+     * @param updated         Dictionary entries with the names and values of the changed properties.
+     * @param numUpdated      Number of changed properties.
+     * @param invalidated     Names of the invalidated properties.
+     * @param numInvalidated  Number of invalidated properties.
+     *
+     * @return  The status returned by Signal.
+     */
+    QStatus SendPropChanged(const char* ifcName, SessionId id, uint8_t flags,
+                            const MsgArg* updated, size_t numUpdated,
+                            const char** invalidated, size_t numInvalidated);
+
     struct Components;
     Components* components; /**< Internal components of this object */
 
@@ -38,6 +38,10 @@
 
 namespace ajn {
 
+/// @cond ALLJOYN_DEV
+struct SignatureInfo;
+/// @endcond
+
 /** @name Property Access type */
 // @{
 static const uint8_t PROP_ACCESS_READ  = 1; /**< Read Access type */
@@ -394,6 +398,29 @@ class InterfaceDescription {
      */
     const Property* GetProperty(const char* name) const;
 
+    /**
+     * @internal
+     * Get the argument layout of a member's signatures. The layout is computed
+     * when the interface is activated.
+     *
+     * @param name             Name of the member
+     * @param[out] args        Returns the layout of the member's signature
+     * @param[out] returnArgs  Returns the layout of the member's return signature
+     * @return  true if the interface is activated and the member exists
+     */
+    bool GetMemberSignatureInfo(const char* name, SignatureInfo& args, SignatureInfo& returnArgs) const;
+
+    /**
+     * @internal
+     * Get the layout of a property's signature. The layout is computed when the
+     * interface is activated.
+     *
+     * @param name       Name of the property
+     * @param[out] info  Returns the layout of the property's signature
+     * @return  true if the interface is activated and the property exists
+     */
+    bool GetPropertySignatureInfo(const char* name, SignatureInfo& info) const;
+
     /**
      * Get all the properties.
      *
@@ -511,7 +538,7 @@ class InterfaceDescription {
      * Activate this interface. An interface must be activated before it can be used. Activating an
      * interface locks the interface so that is can no longer be modified.
      */
-    void Activate() { isActivated = true; }
+    void Activate();
 
     /**
      * Indicates if this interface is required to be secure. Secure interfaces require end-to-end
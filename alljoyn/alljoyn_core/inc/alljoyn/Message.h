@@ -156,6 +156,7 @@ class HeaderFields {
  */
 class _Message;
 class _RemoteEndpoint;
+struct SignatureInfo;
 class BusAttachment;
 
 /**
@@ -678,6 +679,23 @@ class _Message {
     QStatus UnmarshalArgs(const qcc::String& expectedSignature,
                           const char* expectedReplySignature = NULL);
 
+    /**
+     * @internal
+     * Unmarshal the message arguments using the precomputed layout of the expected signature.
+     *
+     * @param expectedSignature       The expected signature for this message.
+     * @param expectedReplySignature  The expected reply signature for this message if it is a
+     *                                method call message or NULL otherwise.
+     * @param expectedInfo            The layout of expectedSignature or NULL if it is not known.
+     *
+     * @return
+     *         - #ER_OK if the message was unmarshaled
+     *         - Error status indicating why the unmarshal failed.
+     */
+    QStatus UnmarshalArgs(const qcc::String& expectedSignature,
+                          const char* expectedReplySignature,
+                          const SignatureInfo* expectedInfo);
+
     /**
      * @internal
      * Reads a message from a remote endpoint.
@@ -38,7 +38,6 @@
 #include <qcc/Thread.h>
 #include <qcc/Util.h>
 #include <qcc/SocketStream.h>
-#include <qcc/StreamPump.h>
 #include <qcc/STLContainer.h>
 
 #include <alljoyn/BusAttachment.h>
@@ -111,6 +110,10 @@ AllJoynObj::AllJoynObj(Bus& bus, BusController* busController) :
     exchangeNamesSignal(NULL),
     detachSessionSignal(NULL),
     timer("NameReaper"),
+    joinSessionWorkers("JoinS", true, max(ConfigDB::GetConfigDB()->GetLimit("max_join_session_workers", ALLJOYN_MAX_JOIN_SESSION_WORKERS_DEFAULT), 1U)),
+    rawRelays(ConfigDB::GetConfigDB()->GetLimit("raw_relay_workers", RawRelayService::DEFAULT_NUM_WORKERS)),
+    joinSessionQueue(ConfigDB::GetConfigDB()->GetLimit("max_pending_join_sessions", ALLJOYN_MAX_PENDING_JOIN_SESSIONS_DEFAULT),
+                     ConfigDB::GetConfigDB()->GetLimit("max_join_sessions_per_peer", ALLJOYN_MAX_JOIN_SESSIONS_PER_PEER_DEFAULT)),
     isStopping(false),
     busController(busController)
 {
@@ -264,6 +267,11 @@ QStatus AllJoynObj::Init()
         status = timer.Start();
     }
 
+    /* Start the join session workers */
+    if (ER_OK == status) {
+        status = joinSessionWorkers.Start();
+    }
+
     if (ER_OK == status) {
         status = bus.RegisterBusObject(*this);
     }
@@ -275,28 +283,41 @@ QStatus AllJoynObj::Init()
 
 QStatus AllJoynObj::Stop()
 {
-    /* Stop any outstanding JoinSessionThreads */
+    /* Stop any outstanding join session requests */
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     isStopping = true;
-    vector<JoinSessionThread*>::iterator it = joinSessionThreads.begin();
-    while (it != joinSessionThreads.end()) {
+    set<JoinSessionThread*>::iterator it = attachSessionThreads.begin();
+    while (it != attachSessionThreads.end()) {
         (*it)->Stop();
         ++it;
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    joinSessionWorkers.Stop();
+    rawRelays.Stop();
     return ER_OK;
 }
 
 QStatus AllJoynObj::Join()
 {
-    /* Wait for any outstanding JoinSessionThreads */
+    /* Wait for the workers to exit.  Requests that never ran are expired by the workers on exit. */
+    joinSessionWorkers.Join();
+    rawRelays.Join();
+
+    /* Wait for any outstanding AttachSession threads */
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    while (!joinSessionThreads.empty()) {
+    while (!attachSessionThreads.empty()) {
         joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
         qcc::Sleep(50);
         joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+
+    /* Parked requests and requests queued on workers that were never started are never run */
+    vector<JoinSessionQueue::Request*> outstanding;
+    joinSessionQueue.Clear(outstanding);
+    for (size_t i = 0; i < outstanding.size(); ++i) {
+        delete outstanding[i];
+    }
     return ER_OK;
 }
 
@@ -508,14 +529,39 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
     }
 }
 
+void AllJoynObj::JoinSessionThread::AlarmTriggered(const Alarm& alarm, QStatus reason)
+{
+    /* A reason other than ER_OK means the workers are exiting */
+    if (reason == ER_OK) {
+        ajObj.joinSessionQueue.Started(this);
+        RunJoin();
+    }
+    ajObj.EndJoinSessionRequest(this);
+}
+
 ThreadReturn STDCALL AllJoynObj::JoinSessionThread::Run(void* arg)
 {
-    if (isJoin) {
-        QCC_DbgTrace(("JoinSessionThread::RunJoin()"));
-        return RunJoin();
-    } else {
-        QCC_DbgTrace(("JoinSessionThread::RunAttach()"));
-        return RunAttach();
+    ajObj.joinSessionQueue.Started(this);
+    return RunAttach();
+}
+
+void AllJoynObj::JoinSessionThread::ThreadExit(Thread* thread)
+{
+    ajObj.EndJoinSessionRequest(this);
+}
+
+void AllJoynObj::JoinSessionThread::Reject()
+{
+    MsgArg replyArgs[4];
+    SessionOpts optsOut;
+    replyArgs[0].Set("u", ALLJOYN_JOINSESSION_REPLY_FAILED);
+    replyArgs[1].Set("u", 0);
+    SetSessionOpts(optsOut, replyArgs[2]);
+    /* AttachSession replies also carry the (empty) member list */
+    replyArgs[3].Set("as", 0, NULL);
+    QStatus status = ajObj.MethodReply(msg, replyArgs, isJoin ? 3 : 4);
+    if (ER_OK != status) {
+        QCC_LogError(status, ("Failed to respond to org.alljoyn.%s.%s", isJoin ? "Bus" : "Daemon", isJoin ? "JoinSession" : "AttachSession"));
     }
 }
 
@@ -1229,60 +1275,103 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
     return 0;
 }
 
-void AllJoynObj::JoinSessionThread::ThreadExit(Thread* thread)
+void AllJoynObj::QueueJoinSessionRequest(Message& msg, bool isJoin)
 {
-    ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    vector<JoinSessionThread*>::iterator it = ajObj.joinSessionThreads.begin();
-    JoinSessionThread* deleteMe = NULL;
-    while (it != ajObj.joinSessionThreads.end()) {
-        if (*it == thread) {
-            deleteMe = *it;
-            ajObj.joinSessionThreads.erase(it);
-            break;
-        }
-        ++it;
+    /* Requests are limited per joiner, which for an AttachSession is its src argument rather than the routing node that sent it */
+    String joiner = msg->GetSender();
+    const char* src;
+    if (!isJoin && msg->GetArg(1) && (msg->GetArg(1)->Get("s", &src) == ER_OK)) {
+        joiner = src;
     }
-    ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
-    if (deleteMe) {
-        deleteMe->Join();
-        delete deleteMe;
-    } else {
-        QCC_LogError(ER_FAIL, ("Internal error: JoinSessionThread not found on list"));
+    JoinSessionThread* jst = new JoinSessionThread(*this, msg, isJoin, joiner);
+
+    joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    bool stopping = isStopping;
+    joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    if (stopping) {
+        delete jst;
+        return;
+    }
+
+    switch (joinSessionQueue.Add(jst)) {
+    case JoinSessionQueue::RUN:
+        RunJoinSessionRequest(jst);
+        break;
+
+    case JoinSessionQueue::PARKED:
+        /* Run by EndJoinSessionRequest() when one of the joiner's running requests finishes */
+        break;
+
+    case JoinSessionQueue::REJECTED:
+        /* Fail fast rather than let an unbounded backlog build up */
+        QCC_LogError(ER_THREADPOOL_EXHAUSTED, ("%s from %s rejected: too many requests outstanding",
+                                               isJoin ? "JoinSession" : "AttachSession", joiner.c_str()));
+        jst->Reject();
+        delete jst;
+        break;
     }
 }
 
-void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+void AllJoynObj::RunJoinSessionRequest(JoinSessionThread* jst)
 {
-    /* Handle JoinSession on another thread since JoinThread can block waiting for NameOwnerChanged */
-    joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, true);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
+    while (jst) {
+        QStatus status;
+        bool stopping;
+        if (jst->isJoin) {
+            AlarmListener* listener = jst;
+            uint32_t zero = 0;
+            Alarm alarm(zero, listener);
+            status = joinSessionWorkers.AddAlarmNonBlocking(alarm);
+            joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+            stopping = isStopping;
+            joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
         } else {
-            QCC_LogError(status, ("Join: Failed to start JoinSessionThread"));
-            delete jst;
+            /* Hold the lock until the thread is on the list since ThreadExit() takes it off */
+            joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+            stopping = isStopping;
+            status = stopping ? ER_BUS_STOPPING : jst->Start(NULL, jst);
+            if (status == ER_OK) {
+                attachSessionThreads.insert(jst);
+            }
+            joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+        }
+        if (status == ER_OK) {
+            return;
+        }
+
+        JoinSessionThread* next = static_cast<JoinSessionThread*>(joinSessionQueue.Finished(jst));
+        if (!stopping) {
+            QCC_LogError(status, ("Failed to run %s request from %s", jst->isJoin ? "JoinSession" : "AttachSession", jst->joiner.c_str()));
+            jst->Reject();
         }
+        delete jst;
+        jst = next;
     }
-    joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
 }
 
-void AllJoynObj::AttachSession(const InterfaceDescription::Member* member, Message& msg)
+void AllJoynObj::EndJoinSessionRequest(JoinSessionThread* jst)
 {
-    /* Handle AttachSession on another thread since AttachSession can block when connecting through an intermediate node */
-    joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, false);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
-        } else {
-            QCC_LogError(status, ("Attach: Failed to start JoinSessionThread"));
-            delete jst;
-        }
+    if (!jst->isJoin) {
+        joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+        attachSessionThreads.erase(jst);
+        joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+        jst->Join();
     }
-    joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    JoinSessionThread* next = static_cast<JoinSessionThread*>(joinSessionQueue.Finished(jst));
+    delete jst;
+    RunJoinSessionRequest(next);
+}
+
+void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Handle JoinSession on a worker thread since JoinSession can block waiting for NameOwnerChanged */
+    QueueJoinSessionRequest(msg, true);
+}
+
+void AllJoynObj::AttachSession(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Handle AttachSession on a worker thread since AttachSession can block when connecting through an intermediate node */
+    QueueJoinSessionRequest(msg, false);
 }
 
 
@@ -2008,16 +2097,8 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
             ajObj.AcquireLocks();
             status = (status == ER_OK) ? tStatus : status;
             if (status == ER_OK) {
-                QCC_DbgPrintf(("AllJoynObj::RunAttach(): indirect raw session handling. Create message pump."));
-                SocketStream* ss1 = new SocketStream(srcB2bFd);
-                SocketStream* ss2 = new SocketStream(b2bFd);
-                size_t chunkSize = 4096;
-                String threadNameStr = id;
-                threadNameStr.append("-pump");
-                const char* threadName = threadNameStr.c_str();
-                bool isManaged = true;
-                ManagedObj<StreamPump> pump(ss1, ss2, chunkSize, threadName, isManaged);
-                status = pump->Start();
+                QCC_DbgPrintf(("AllJoynObj::RunAttach(): indirect raw session handling. Create raw relay."));
+                status = ajObj.rawRelays.AddRelay(srcB2bFd, b2bFd, U32ToString(id));
             }
             if (status != ER_OK) {
                 QCC_LogError(status, ("Raw relay creation failed"));
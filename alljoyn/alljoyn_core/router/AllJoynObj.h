@@ -25,6 +25,7 @@
 #include <qcc/platform.h>
 #include <vector>
 #include <map>
+#include <set>
 
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
@@ -41,11 +42,13 @@
 
 #include "Bus.h"
 #include "BusUtil.h"
+#include "JoinSessionQueue.h"
 #include "NameTable.h"
 #include "RemoteEndpoint.h"
 #include "Transport.h"
 #include "VirtualEndpoint.h"
 #include "PermissionMgr.h"
+#include "RawRelay.h"
 #include "ns/IpNameService.h"
 
 namespace ajn {
@@ -122,6 +125,13 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     QStatus Join();
 
+    /**
+     * Get a snapshot of the JoinSession/AttachSession request counters.
+     *
+     * @param[out] stats  Current counter values.
+     */
+    void GetJoinSessionStats(JoinSessionQueue::Stats& stats) { joinSessionQueue.GetStats(stats); }
+
     /**
      * Called when object is successfully registered.
      */
@@ -817,17 +827,34 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
-    /** JoinSessionThread handles a JoinSession request from a local client on a separate thread */
-    class JoinSessionThread : public qcc::Thread, public qcc::ThreadListener {
+    /**
+     * JoinSessionThread handles a JoinSession or AttachSession request.  JoinSession requests run as
+     * alarms on the bounded joinSessionWorkers pool.  AttachSession requests each get their own
+     * thread: an attach that is forwarded to the next routing node blocks until that node replies,
+     * and a bounded pool of such attaches can fill up with requests waiting on one another.  The
+     * number of attach threads is bounded by the admission limit of the JoinSessionQueue instead.
+     */
+    class JoinSessionThread : public qcc::Thread, public qcc::ThreadListener, public qcc::AlarmListener, public JoinSessionQueue::Request {
       public:
-        JoinSessionThread(AllJoynObj& ajObj, const Message& msg, bool isJoin) :
-            qcc::Thread(qcc::String("JoinS-") + qcc::U32ToString(qcc::IncrementAndFetch(&jstCount))),
+        JoinSessionThread(AllJoynObj& ajObj, const Message& msg, bool isJoin, const qcc::String& joiner) :
+            qcc::Thread(qcc::String(isJoin ? "JoinS-" : "AttachS-") + qcc::U32ToString(qcc::IncrementAndFetch(&jstCount))),
+            JoinSessionQueue::Request(joiner, isJoin),
             ajObj(ajObj),
-            msg(msg),
-            isJoin(isJoin) { }
+            msg(msg) { }
+
+        /**
+         * Called by the join session workers when this JoinSession request is due to run (or when
+         * the workers are exiting).
+         */
+        void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
         void ThreadExit(Thread* thread);
 
+        /**
+         * Send a failure reply for a request that was not admitted or could not be run.
+         */
+        void Reject();
+
       protected:
         qcc::ThreadReturn STDCALL Run(void* arg);
 
@@ -838,11 +865,47 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
 
         AllJoynObj& ajObj;
         Message msg;
-        bool isJoin;
     };
 
-    std::vector<JoinSessionThread*> joinSessionThreads;  /**< List of outstanding join session requests */
-    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads */
+    /**
+     * Admit a JoinSession or AttachSession request and run it if its joiner is under its limit.
+     *
+     * @param msg     The JoinSession or AttachSession method call.
+     * @param isJoin  true for JoinSession, false for AttachSession.
+     */
+    void QueueJoinSessionRequest(Message& msg, bool isJoin);
+
+    /**
+     * Run an admitted request, JoinSession requests on the join session workers and AttachSession
+     * requests on their own thread.  If the request cannot be run it is failed and the next parked
+     * request of the same joiner is tried.
+     *
+     * @param jst  The request.
+     */
+    void RunJoinSessionRequest(JoinSessionThread* jst);
+
+    /**
+     * Forget a request that finished running (or was dropped), delete it and run the next parked
+     * request of the same joiner.
+     *
+     * @param jst  The request.
+     */
+    void EndJoinSessionRequest(JoinSessionThread* jst);
+
+    /** Default number of worker threads used to run JoinSession requests */
+    static const uint32_t ALLJOYN_MAX_JOIN_SESSION_WORKERS_DEFAULT = 16;
+
+    /** Default maximum number of outstanding (queued or running) JoinSession/AttachSession requests */
+    static const uint32_t ALLJOYN_MAX_PENDING_JOIN_SESSIONS_DEFAULT = 1024;
+
+    /** Default maximum number of requests of each kind from a single joiner that may run concurrently */
+    static const uint32_t ALLJOYN_MAX_JOIN_SESSIONS_PER_PEER_DEFAULT = 8;
+
+    qcc::Timer joinSessionWorkers;                       /**< Bounded worker pool that runs JoinSession requests */
+    RawRelayService rawRelays;                           /**< Relays the bytes of indirect raw sessions */
+    JoinSessionQueue joinSessionQueue;                   /**< Admission control for JoinSession/AttachSession requests */
+    std::set<JoinSessionThread*> attachSessionThreads;   /**< Running AttachSession threads */
+    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects attachSessionThreads and isStopping */
     bool isStopping;                                     /**< True while waiting for threads to exit */
     BusController* busController;                        /**< BusController that created this BusObject */
 
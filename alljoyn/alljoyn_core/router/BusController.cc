@@ -41,6 +41,7 @@ BusController::BusController(Bus& alljoynBus, AuthListener* authListener) :
     dbusObj(bus, this),
     alljoynObj(bus, this),
     sessionlessObj(bus, this),
+    debugStatsObj(bus, this),
 #ifndef NDEBUG
     alljoynDebugObj(this),
 #endif
@@ -107,6 +108,12 @@ QStatus BusController::Stop()
     }
     status = (status == ER_OK) ? tStatus : status;
 
+    tStatus = debugStatsObj.Stop();
+    if (tStatus != ER_OK) {
+        QCC_LogError(tStatus, ("debugStatsObj::Stop failed"));
+    }
+    status = (status == ER_OK) ? tStatus : status;
+
 #ifndef NDEBUG
     tStatus = alljoynDebugObj.Stop();
     if (tStatus != ER_OK) {
@@ -143,6 +150,12 @@ QStatus BusController::Join()
     }
     status = (status == ER_OK) ? tStatus : status;
 
+    tStatus = debugStatsObj.Join();
+    if (tStatus != ER_OK) {
+        QCC_LogError(tStatus, ("debugStatsObj::Join failed"));
+    }
+    status = (status == ER_OK) ? tStatus : status;
+
 #ifndef NDEBUG
     tStatus = alljoynDebugObj.Join();
     if (tStatus != ER_OK) {
@@ -165,6 +178,8 @@ QStatus BusController::Join()
  *
  * /org/freedesktop/DBus
  * /org/alljoyn/Bus
+ * /org/alljoyn/sl
+ * /org/alljoyn/Bus/Debug/Stats
  * /org/alljoyn/Debug
  *
  * The last one is optional and only registered for debug builds
@@ -188,8 +203,15 @@ void BusController::ObjectRegistered(BusObject* obj)
             QCC_LogError(status, ("sessionlessObj::Init failed"));
         }
     }
-#ifndef NDEBUG
     if (obj == &sessionlessObj) {
+        status = debugStatsObj.Init();
+        if (status != ER_OK) {
+            isDone = true;
+            QCC_LogError(status, ("debugStatsObj::Init failed"));
+        }
+    }
+#ifndef NDEBUG
+    if (obj == &debugStatsObj) {
         status = alljoynDebugObj.Init();
         if (status != ER_OK) {
             isDone = true;
@@ -200,7 +222,7 @@ void BusController::ObjectRegistered(BusObject* obj)
         isDone = true;
     }
 #else
-    if (obj == &sessionlessObj) {
+    if (obj == &debugStatsObj) {
         isDone = true;
     }
 #endif
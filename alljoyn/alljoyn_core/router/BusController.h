@@ -34,6 +34,7 @@
 #include "DBusObj.h"
 #include "AllJoynObj.h"
 #include "AllJoynDebugObj.h"
+#include "DebugStatsObj.h"
 #include "SessionlessObj.h"
 #include "ProtectedAuthListener.h"
 
@@ -173,6 +174,9 @@ class BusController {
     /** Bus object responsible for org.alljoyn.Sessionless */
     SessionlessObj sessionlessObj;
 
+    /** Bus object responsible for org.alljoyn.Bus.Debug.Stats */
+    DebugStatsObj debugStatsObj;
+
 #ifndef NDEBUG
     /** Bus object responsible for org.alljoyn.Debug */
     debug::AllJoynDebugObj alljoynDebugObj;
@@ -62,7 +62,7 @@ DaemonRouter::~DaemonRouter()
 {
 }
 
-static inline QStatus SendThroughEndpoint(Message& msg, BusEndpoint& ep, SessionId sessionId)
+static inline QStatus SendThroughEndpoint(Message& msg, BusEndpoint& ep, SessionId sessionId, RouterStats& stats)
 {
     QCC_DbgTrace(("SendThroughEndpoint(): Routing \"%s\" (%d) through \"%s\"", msg->Description().c_str(), msg->GetCallSerial(), ep->GetUniqueName().c_str()));
     QStatus status;
@@ -74,6 +74,7 @@ static inline QStatus SendThroughEndpoint(Message& msg, BusEndpoint& ep, Session
     // if the bus is stopping or the endpoint is closing we don't expect to be able to send
     if ((status != ER_OK) && (status != ER_BUS_ENDPOINT_CLOSING) && (status != ER_BUS_STOPPING)) {
         QCC_DbgPrintf(("SendThroughEndpoint(dest=%s, ep=%s, id=%u) failed: %s", msg->GetDestination(), ep->GetUniqueName().c_str(), sessionId, QCC_StatusText(status)));
+        stats.Increment(RouterStats::DELIVERY_FAILURES);
     }
     return status;
 }
@@ -88,6 +89,9 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
         return ER_BUS_ENDPOINT_CLOSING;
     }
 
+    RouterStats::ScopedSample sample(stats, RouterStats::ROUTE_LATENCY);
+    stats.Increment(RouterStats::MESSAGES_ROUTED);
+
     QStatus status = ER_OK;
     BusEndpoint sender = origSender;
     bool replyExpected = (msg->GetType() == MESSAGE_METHOD_CALL) && ((msg->GetFlags() & ALLJOYN_FLAG_NO_REPLY_EXPECTED) == 0);
@@ -98,7 +102,9 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
     BusEndpoint destEndpoint;
 
     if (!destinationEmpty) {
+        uint64_t waitStart = stats.StartSample(RouterStats::NAME_TABLE_LOCK_WAIT);
         nameTable.Lock();
+        stats.RecordSince(RouterStats::NAME_TABLE_LOCK_WAIT, waitStart);
         destEndpoint = nameTable.FindEndpoint(destination);
         nameTable.Unlock();
     }
@@ -147,6 +153,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
 
     if (!destinationEmpty) {
         QCC_DbgPrintf(("DaemonRouter::PushMessage(): destinationEmpty=false"));
+        stats.Increment(RouterStats::MESSAGES_UNICAST);
         nameTable.Lock();
         if (destEndpoint->IsValid()) {
             QCC_DbgPrintf(("DaemonRouter::PushMessage(): Valid destEndpoint"));
@@ -183,7 +190,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                 } else {
                     nameTable.Unlock();
                     QCC_DbgPrintf(("DaemonRouter::PushMessage(): SendThroughEndpoint()"));
-                    status = SendThroughEndpoint(msg, destEndpoint, sessionId);
+                    status = SendThroughEndpoint(msg, destEndpoint, sessionId, stats);
                     nameTable.Lock();
                 }
             } else {
@@ -213,6 +220,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                 status = busController->StartService(msg, sender);
             } else {
                 status = ER_BUS_NO_ROUTE;
+                stats.Increment(RouterStats::MESSAGES_NO_ROUTE);
             }
             if (status != ER_OK) {
                 if (replyExpected) {
@@ -247,8 +255,13 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          * regular broadcast message.
          */
         QCC_DbgPrintf(("DaemonRouter::PushMessage(): broadcast messsage"));
+        stats.Increment(RouterStats::MESSAGES_BROADCAST);
+        uint64_t waitStart = stats.StartSample(RouterStats::NAME_TABLE_LOCK_WAIT);
         nameTable.Lock();
+        stats.RecordSince(RouterStats::NAME_TABLE_LOCK_WAIT, waitStart);
+        waitStart = stats.StartSample(RouterStats::RULE_TABLE_LOCK_WAIT);
         ruleTable.Lock();
+        stats.RecordSince(RouterStats::RULE_TABLE_LOCK_WAIT, waitStart);
         RuleIterator it = ruleTable.Begin();
         while (it != ruleTable.End()) {
             if (it->second.IsMatch(msg)) {
@@ -267,7 +280,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                     ruleTable.Unlock();
                     nameTable.Unlock();
                     QCC_DbgPrintf(("DaemonRouter::PushMessage(): SendThroughEndpoint()"));
-                    QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId);
+                    QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId, stats);
                     status = (status == ER_OK) ? tStatus : status;
                     nameTable.Lock();
                     ruleTable.Lock();
@@ -329,7 +342,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
 #endif
                         m_b2bEndpointsLock.Unlock(MUTEX_CONTEXT);
                         QCC_DbgPrintf(("DaemonRouter::PushMessage(): SendThroughEndpoint()"));
-                        QStatus tStatus = SendThroughEndpoint(msg, busEndpoint, sessionId);
+                        QStatus tStatus = SendThroughEndpoint(msg, busEndpoint, sessionId, stats);
                         status = (status == ER_OK) ? tStatus : status;
                         m_b2bEndpointsLock.Lock(MUTEX_CONTEXT);
                         it = m_b2bEndpoints.lower_bound(ep);
@@ -348,7 +361,10 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          * session multicast message.
          */
         QCC_DbgPrintf(("DaemonRouter::PushMessage(): Session multicast message()"));
+        stats.Increment(RouterStats::MESSAGES_SESSIONCAST);
+        uint64_t waitStart = stats.StartSample(RouterStats::SESSION_CAST_LOCK_WAIT);
         sessionCastSetLock.Lock(MUTEX_CONTEXT);
+        stats.RecordSince(RouterStats::SESSION_CAST_LOCK_WAIT, waitStart);
         RemoteEndpoint lastB2b;
         /* We need to obtain the first entry in the sessionCastSet that has the id equal to 'sessionId'
          * and the src equal to 'msg->GetSender()'.
@@ -390,7 +406,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                     SessionCastEntry entry = *sit;
                     sessionCastSetLock.Unlock(MUTEX_CONTEXT);
                     QCC_DbgPrintf(("DaemonRouter::PushMessage(): SendThroughEndpoint(): ep=\"%s\", sessionId=%d", ep->GetUniqueName().c_str(), sessionId));
-                    QStatus tStatus = SendThroughEndpoint(msg, ep, sessionId);
+                    QStatus tStatus = SendThroughEndpoint(msg, ep, sessionId, stats);
                     status = (status == ER_OK) ? tStatus : status;
                     sessionCastSetLock.Lock(MUTEX_CONTEXT);
                     sit = sessionCastSet.lower_bound(entry);
@@ -402,6 +418,9 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
         }
         if (!foundDest) {
             status = okToReceive ? ER_BUS_NO_ROUTE : ER_BUS_POLICY_VIOLATION;
+            if (okToReceive) {
+                stats.Increment(RouterStats::MESSAGES_NO_ROUTE);
+            }
         }
         sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     }
@@ -414,6 +433,50 @@ void DaemonRouter::GetBusNames(vector<qcc::String>& names) const
     nameTable.GetBusNames(names);
 }
 
+void DaemonRouter::GetStatsSnapshot(RouterStats::Snapshot& snapshot)
+{
+    stats.GetSnapshot(snapshot);
+
+    vector<qcc::String> names;
+    nameTable.GetBusNames(names);
+    for (vector<qcc::String>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        const qcc::String& name = *it;
+        if (name[0] == ':') {
+            ++snapshot.gauges[RouterStats::UNIQUE_NAMES];
+        } else {
+            ++snapshot.gauges[RouterStats::ALIAS_NAMES];
+        }
+    }
+    snapshot.gauges[RouterStats::RULES] = static_cast<uint32_t>(ruleTable.GetNumRules());
+
+    m_b2bEndpointsLock.Lock(MUTEX_CONTEXT);
+    snapshot.gauges[RouterStats::B2B_ENDPOINTS] = static_cast<uint32_t>(m_b2bEndpoints.size());
+    m_b2bEndpointsLock.Unlock(MUTEX_CONTEXT);
+
+    sessionCastSetLock.Lock(MUTEX_CONTEXT);
+    snapshot.gauges[RouterStats::SESSION_ROUTES] = static_cast<uint32_t>(sessionCastSet.size());
+    sessionCastSetLock.Unlock(MUTEX_CONTEXT);
+}
+
+void DaemonRouter::GetRemoteEndpoints(vector<RemoteEndpoint>& endpoints)
+{
+    vector<qcc::String> names;
+    nameTable.GetBusNames(names);
+    for (vector<qcc::String>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        const qcc::String& name = *it;
+        if (name[0] == ':') {
+            BusEndpoint ep = nameTable.FindEndpoint(name);
+            if (ep->IsValid() && (ep->GetEndpointType() == ENDPOINT_TYPE_REMOTE)) {
+                endpoints.push_back(RemoteEndpoint::cast(ep));
+            }
+        }
+    }
+
+    m_b2bEndpointsLock.Lock(MUTEX_CONTEXT);
+    endpoints.insert(endpoints.end(), m_b2bEndpoints.begin(), m_b2bEndpoints.end());
+    m_b2bEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
 BusEndpoint DaemonRouter::FindEndpoint(const qcc::String& busName)
 {
     BusEndpoint ep = nameTable.FindEndpoint(busName);
@@ -33,6 +33,7 @@
 #include "LocalTransport.h"
 #include "Router.h"
 #include "NameTable.h"
+#include "RouterStats.h"
 #include "RuleTable.h"
 
 namespace ajn {
@@ -373,11 +374,34 @@ class DaemonRouter : public Router {
      */
     RuleTable& GetRuleTable() { return ruleTable; }
 
+    /**
+     * Return the routing statistics.
+     *
+     * @return the routing statistics.
+     */
+    RouterStats& GetStats() { return stats; }
+
+    /**
+     * Take a snapshot of the routing statistics and the sizes of the routing tables.
+     *
+     * @param[out] snapshot   The statistics.
+     */
+    void GetStatsSnapshot(RouterStats::Snapshot& snapshot);
+
+    /**
+     * Get the remote endpoints, including the bus-to-bus endpoints, that are
+     * connected to this router.
+     *
+     * @param[out] endpoints   The remote endpoints.
+     */
+    void GetRemoteEndpoints(std::vector<RemoteEndpoint>& endpoints);
+
   private:
     LocalEndpoint localEndpoint;    /**< The local endpoint */
     RuleTable ruleTable;            /**< Routing rule table */
     NameTable nameTable;            /**< BusName to transport lookupl table */
     BusController* busController;   /**< The bus controller used with this router */
+    RouterStats stats;              /**< Routing statistics */
 
     std::set<RemoteEndpoint> m_b2bEndpoints; /**< Collection of Bus-to-bus endpoints */
     qcc::Mutex m_b2bEndpointsLock;           /**< Lock that protects m_b2bEndpoints */
@@ -45,7 +45,17 @@ namespace ajn {
 
 
 DaemonTransport::DaemonTransport(BusAttachment& bus)
-    : Thread("DaemonTransport"), bus(bus), stopping(false)
+    : Thread("DaemonTransport"), bus(bus), stopping(false), sharedMemory(false), m_shmRingSize(SHM_RING_SIZE_DEFAULT)
+{
+    /*
+     * We know we are daemon code, so we'd better be running with a daemon
+     * router.  This is assumed elsewhere.
+     */
+    assert(bus.GetInternal().GetRouter().IsDaemon());
+}
+
+DaemonTransport::DaemonTransport(BusAttachment& bus, bool sharedMemory)
+    : Thread("DaemonTransport"), bus(bus), stopping(false), sharedMemory(sharedMemory), m_shmRingSize(SHM_RING_SIZE_DEFAULT)
 {
     /*
      * We know we are daemon code, so we'd better be running with a daemon
@@ -72,6 +82,7 @@ QStatus DaemonTransport::Start()
     m_numHbeatProbes = HEARTBEAT_NUM_PROBES;
     m_maxHbeatProbeTimeout = config->GetLimit("dt_max_probe_timeout", MAX_HEARTBEAT_PROBE_TIMEOUT_DEFAULT);
     m_defaultHbeatProbeTimeout = config->GetLimit("dt_default_probe_timeout", DEFAULT_HEARTBEAT_PROBE_TIMEOUT_DEFAULT);
+    m_shmRingSize = config->GetLimit("shm_ring_size", SHM_RING_SIZE_DEFAULT);
 
     QCC_DbgPrintf(("DaemonTransport: Using m_minHbeatIdleTimeout=%u, m_maxHbeatIdleTimeout=%u, m_numHbeatProbes=%u, m_defaultHbeatProbeTimeout=%u m_maxHbeatProbeTimeout=%u", m_minHbeatIdleTimeout, m_maxHbeatIdleTimeout, m_numHbeatProbes, m_defaultHbeatProbeTimeout, m_maxHbeatProbeTimeout));
 
@@ -174,6 +174,15 @@ class DaemonTransport : public Transport, public _RemoteEndpoint::EndpointListen
     void UntrustedClientExit() { };
 
   protected:
+
+    /**
+     * Create a transport to receive incoming connections from AllJoyn application.
+     *
+     * @param bus           The bus associated with this transport.
+     * @param sharedMemory  True if accepted connections are moved onto shared memory once established.
+     */
+    DaemonTransport(BusAttachment& bus, bool sharedMemory);
+
     std::list<RemoteEndpoint> endpointList;   /**< List of active endpoints */
     qcc::Mutex endpointListLock;              /**< Mutex that protects the endpoint list */
 
@@ -209,6 +218,14 @@ class DaemonTransport : public Transport, public _RemoteEndpoint::EndpointListen
      */
     static const uint32_t HEARTBEAT_NUM_PROBES = 1;
 
+    /**
+     * @brief The default size in bytes of each of the two shared memory rings
+     * used by a connection to the shm transport.
+     *
+     * This corresponds to the configuration item "shm_ring_size"
+     */
+    static const uint32_t SHM_RING_SIZE_DEFAULT = 256 * 1024;
+
     /**
      * Empty private overloaded virtual function for Thread::Start
      * this avoids the overloaded-virtual warning. For the Thread::Start
@@ -218,6 +235,8 @@ class DaemonTransport : public Transport, public _RemoteEndpoint::EndpointListen
 
     BusAttachment& bus;                       /**< The message bus for this transport */
     bool stopping;                            /**< True if Stop() has been called but endpoints still exist */
+    bool sharedMemory;                        /**< True if connections are moved onto shared memory */
+    uint32_t m_shmRingSize;                   /**< Size of each shared memory ring - configurable in router config */
 
     /**
      * @internal
@@ -247,6 +266,36 @@ class DaemonTransport : public Transport, public _RemoteEndpoint::EndpointListen
 
 };
 
+#if defined(QCC_OS_LINUX)
+/**
+ * @brief The daemon end of the shared memory client transport
+ *
+ * Connections are accepted and authenticated on a unix domain socket exactly
+ * as they are by the DaemonTransport.  Once established, message bytes are
+ * exchanged through rings in a memory region shared with the client.  Unix
+ * file descriptors cannot be passed over these connections.
+ */
+class DaemonShmTransport : public DaemonTransport {
+  public:
+    /**
+     * Create a transport to receive incoming connections from AllJoyn application.
+     *
+     * @param bus  The bus associated with this transport.
+     */
+    DaemonShmTransport(BusAttachment& bus) : DaemonTransport(bus, true) { }
+
+    /**
+     * Returns the name of this transport
+     */
+    const char* GetTransportName() const { return TransportName; }
+
+    /**
+     * Name of transport used in transport specs.
+     */
+    static const char* TransportName;
+};
+#endif
+
 } // namespace ajn
 
 #endif // _ALLJOYN_DAEMONTRANSPORT_H
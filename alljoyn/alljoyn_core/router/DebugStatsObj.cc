@@ -0,0 +1,312 @@
+/**
+ * @file
+ * BusObject responsible for implementing the AllJoyn methods (org.alljoyn.Bus.Debug.Stats)
+ * that report routing statistics.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/MutexProfiler.h>
+#include <qcc/String.h>
+#include <qcc/time.h>
+
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/MsgArg.h>
+
+#include "BusController.h"
+#include "ConfigDB.h"
+#include "DebugStatsObj.h"
+#include "JoinSessionQueue.h"
+#include "RemoteEndpoint.h"
+#include "RouterStats.h"
+
+#define QCC_MODULE "ALLJOYN_DAEMON"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+DebugStatsObj::DebugStatsObj(Bus& bus, BusController* busController) :
+    BusObject(org::alljoyn::Bus::Debug::Stats::ObjectPath, false),
+    bus(bus),
+    router(reinterpret_cast<DaemonRouter&>(bus.GetInternal().GetRouter())),
+    busController(busController),
+    timer("statsdump"),
+    dumpIntervalMs(0)
+{
+}
+
+DebugStatsObj::~DebugStatsObj()
+{
+    Stop();
+    Join();
+    bus.UnregisterBusObject(*this);
+}
+
+QStatus DebugStatsObj::Init()
+{
+    QStatus status;
+
+    /* Make this object implement org.alljoyn.Bus.Debug.Stats */
+    const InterfaceDescription* statsIntf = bus.GetInterface(org::alljoyn::Bus::Debug::Stats::InterfaceName);
+    if (!statsIntf) {
+        status = ER_BUS_NO_SUCH_INTERFACE;
+        QCC_LogError(status, ("Failed to get %s interface", org::alljoyn::Bus::Debug::Stats::InterfaceName));
+        return status;
+    }
+
+    status = AddInterface(*statsIntf);
+    if (status == ER_OK) {
+        /* Hook up the methods to their handlers */
+        const MethodEntry methodEntries[] = {
+            { statsIntf->GetMember("GetCounters"),
+              static_cast<MessageReceiver::MethodHandler>(&DebugStatsObj::GetCounters) },
+            { statsIntf->GetMember("GetHistograms"),
+              static_cast<MessageReceiver::MethodHandler>(&DebugStatsObj::GetHistograms) },
+            { statsIntf->GetMember("GetEndpointStats"),
+              static_cast<MessageReceiver::MethodHandler>(&DebugStatsObj::GetEndpointStats) },
+            { statsIntf->GetMember("GetReport"),
+              static_cast<MessageReceiver::MethodHandler>(&DebugStatsObj::GetReport) },
+        };
+        status = AddMethodHandlers(methodEntries, ArraySize(methodEntries));
+    }
+
+    /* Optionally write the statistics out periodically */
+    if (status == ER_OK) {
+        ConfigDB* config = ConfigDB::GetConfigDB();
+        /* Alarm times are 32-bit milliseconds, so clamp long intervals to the longest one */
+        uint64_t intervalMs = static_cast<uint64_t>(config->GetLimit("stats_dump_interval", 0)) * 1000;
+        dumpIntervalMs = static_cast<uint32_t>(min(intervalMs, static_cast<uint64_t>(0xFFFFFFFF)));
+        dumpFile = config->GetProperty("stats_dump_file");
+        uint32_t profileInterval = config->GetLimit("mutex_profile_interval", 0);
+        if (profileInterval > 0) {
+            MutexProfiler::Enable(profileInterval);
+        }
+        if (dumpIntervalMs > 0) {
+            status = timer.Start();
+            if (status == ER_OK) {
+                AlarmListener* listener = this;
+                Alarm alarm(dumpIntervalMs, listener);
+                status = timer.AddAlarm(alarm);
+            }
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Failed to start the statistics dump timer"));
+            }
+        }
+    }
+
+    if (status == ER_OK) {
+        status = bus.RegisterBusObject(*this);
+    }
+    return status;
+}
+
+QStatus DebugStatsObj::Stop()
+{
+    return timer.Stop();
+}
+
+QStatus DebugStatsObj::Join()
+{
+    return timer.Join();
+}
+
+void DebugStatsObj::ObjectRegistered()
+{
+    BusObject::ObjectRegistered();
+    busController->ObjectRegistered(this);
+}
+
+bool DebugStatsObj::IsLocalSender(Message& msg)
+{
+    const qcc::String guid(bus.GetInternal().GetGlobalGUID().ToShortString());
+    qcc::String sender(msg->GetSender());
+    return sender.substr(1, guid.size()) == guid;
+}
+
+qcc::String DebugStatsObj::GetReport()
+{
+    RouterStats::Snapshot snapshot;
+    router.GetStatsSnapshot(snapshot);
+    qcc::String report("# Routing statistics at " + UTCTime() + "\n");
+    report += snapshot.ToString();
+
+    JoinSessionQueue::Stats joinSessionStats;
+    busController->GetAllJoynObj().GetJoinSessionStats(joinSessionStats);
+    report += joinSessionStats.ToString();
+
+    vector<RemoteEndpoint> endpoints;
+    router.GetRemoteEndpoints(endpoints);
+    char line[256];
+    for (vector<RemoteEndpoint>::iterator it = endpoints.begin(); it != endpoints.end(); ++it) {
+        _RemoteEndpoint::TrafficStats stats;
+        (*it)->GetTrafficStats(stats);
+        snprintf(line, sizeof(line), "endpoint %s queued %u max_queued %u tx %llu rx %llu dropped %llu waits %llu\n",
+                 (*it)->GetUniqueName().c_str(), stats.queued, stats.maxQueued,
+                 static_cast<unsigned long long>(stats.txMessages), static_cast<unsigned long long>(stats.rxMessages),
+                 static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.waits));
+        report += line;
+    }
+
+    if (MutexProfiler::IsEnabled()) {
+        report += MutexProfiler::Dump();
+    }
+    return report;
+}
+
+void DebugStatsObj::GetCounters(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Only allow local connections to read the statistics */
+    if (!IsLocalSender(msg)) {
+        MethodReply(msg, "org.alljoyn.Bus.Debug.Stats.NotAllowed", "Statistics can only be read on this device");
+        return;
+    }
+
+    RouterStats::Snapshot snapshot;
+    router.GetStatsSnapshot(snapshot);
+
+    JoinSessionQueue::Stats joinSessionStats;
+    busController->GetAllJoynObj().GetJoinSessionStats(joinSessionStats);
+
+    MsgArg entries[RouterStats::NUM_COUNTERS + RouterStats::NUM_GAUGES + JoinSessionQueue::Stats::NUM_COUNTERS];
+    size_t numEntries = 0;
+    for (uint32_t c = 0; c < RouterStats::NUM_COUNTERS; ++c) {
+        entries[numEntries++].Set("{st}", RouterStats::GetName(static_cast<RouterStats::Counter>(c)), snapshot.counters[c]);
+    }
+    for (uint32_t g = 0; g < RouterStats::NUM_GAUGES; ++g) {
+        uint64_t value = snapshot.gauges[g];
+        entries[numEntries++].Set("{st}", RouterStats::GetName(static_cast<RouterStats::Gauge>(g)), value);
+    }
+    for (uint32_t c = 0; c < JoinSessionQueue::Stats::NUM_COUNTERS; ++c) {
+        uint64_t value = joinSessionStats.counters[c];
+        entries[numEntries++].Set("{st}", JoinSessionQueue::Stats::GetName(static_cast<JoinSessionQueue::Stats::Counter>(c)), value);
+    }
+    MsgArg replyArg;
+    replyArg.Set("a{st}", numEntries, entries);
+    QStatus status = MethodReply(msg, &replyArg, 1);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("DebugStatsObj::GetCounters() failed to send reply"));
+    }
+}
+
+void DebugStatsObj::GetHistograms(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Only allow local connections to read the statistics */
+    if (!IsLocalSender(msg)) {
+        MethodReply(msg, "org.alljoyn.Bus.Debug.Stats.NotAllowed", "Statistics can only be read on this device");
+        return;
+    }
+
+    RouterStats::Snapshot snapshot;
+    router.GetStatsSnapshot(snapshot);
+
+    MsgArg entries[RouterStats::NUM_HISTOGRAMS];
+    for (uint32_t h = 0; h < RouterStats::NUM_HISTOGRAMS; ++h) {
+        RouterStats::Histogram hist = static_cast<RouterStats::Histogram>(h);
+        entries[h].Set("(sttat)", RouterStats::GetName(hist), snapshot.GetCount(hist), snapshot.sums[h],
+                       static_cast<size_t>(RouterStats::NUM_BUCKETS), snapshot.buckets[h]);
+    }
+    MsgArg replyArg;
+    replyArg.Set("a(sttat)", static_cast<size_t>(RouterStats::NUM_HISTOGRAMS), entries);
+    QStatus status = MethodReply(msg, &replyArg, 1);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("DebugStatsObj::GetHistograms() failed to send reply"));
+    }
+}
+
+void DebugStatsObj::GetEndpointStats(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Only allow local connections to read the statistics */
+    if (!IsLocalSender(msg)) {
+        MethodReply(msg, "org.alljoyn.Bus.Debug.Stats.NotAllowed", "Statistics can only be read on this device");
+        return;
+    }
+
+    vector<RemoteEndpoint> endpoints;
+    router.GetRemoteEndpoints(endpoints);
+
+    /* The names and statistics must stay put until the reply has been marshaled */
+    vector<qcc::String> names(endpoints.size());
+    vector<_RemoteEndpoint::TrafficStats> stats(endpoints.size());
+    MsgArg* entries = new MsgArg[endpoints.size()];
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        names[i] = endpoints[i]->GetUniqueName();
+        endpoints[i]->GetTrafficStats(stats[i]);
+        entries[i].Set("(suutttt)", names[i].c_str(), stats[i].queued, stats[i].maxQueued,
+                       stats[i].txMessages, stats[i].rxMessages, stats[i].dropped, stats[i].waits);
+    }
+    MsgArg replyArg;
+    replyArg.Set("a(suutttt)", endpoints.size(), entries);
+    QStatus status = MethodReply(msg, &replyArg, 1);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("DebugStatsObj::GetEndpointStats() failed to send reply"));
+    }
+    delete [] entries;
+}
+
+void DebugStatsObj::GetReport(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Only allow local connections to read the statistics */
+    if (!IsLocalSender(msg)) {
+        MethodReply(msg, "org.alljoyn.Bus.Debug.Stats.NotAllowed", "Statistics can only be read on this device");
+        return;
+    }
+
+    qcc::String report = GetReport();
+    MsgArg replyArg("s", report.c_str());
+    QStatus status = MethodReply(msg, &replyArg, 1);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("DebugStatsObj::GetReport() failed to send reply"));
+    }
+}
+
+void DebugStatsObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
+{
+    if (reason != ER_OK) {
+        return;
+    }
+
+    qcc::String report = GetReport();
+    if (dumpFile.empty()) {
+        printf("%s", report.c_str());
+        fflush(stdout);
+    } else {
+        FILE* file = fopen(dumpFile.c_str(), "a");
+        if (file) {
+            fputs(report.c_str(), file);
+            fclose(file);
+        } else {
+            QCC_LogError(ER_OS_ERROR, ("Failed to open statistics dump file \"%s\"", dumpFile.c_str()));
+        }
+    }
+
+    /* Schedule the next dump */
+    AlarmListener* listener = this;
+    Alarm next(dumpIntervalMs, listener);
+    timer.AddAlarm(next);
+}
+
+}
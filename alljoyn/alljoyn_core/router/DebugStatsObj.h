@@ -0,0 +1,156 @@
+/**
+ * @file
+ * BusObject responsible for implementing the AllJoyn methods (org.alljoyn.Bus.Debug.Stats)
+ * that report routing statistics.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#ifndef _ALLJOYN_DEBUGSTATSOBJ_H
+#define _ALLJOYN_DEBUGSTATSOBJ_H
+
+#include <qcc/platform.h>
+
+#include <qcc/String.h>
+#include <qcc/Timer.h>
+
+#include <alljoyn/BusObject.h>
+#include <alljoyn/Message.h>
+
+#include "Bus.h"
+#include "DaemonRouter.h"
+
+namespace ajn {
+
+class BusController;
+
+/**
+ * BusObject responsible for implementing org.alljoyn.Bus.Debug.Stats.
+ *
+ * Only connections on this device may read the statistics.  If the
+ * stats_dump_interval limit is set in the config the statistics are also
+ * written out every stats_dump_interval seconds, to the file named by the
+ * stats_dump_file property or to stdout if no file is given.  Setting the
+ * mutex_profile_interval limit turns on the mutex contention profiler, with
+ * one in mutex_profile_interval lock acquisitions sampled, and adds the most
+ * contended lock sites to the report.
+ */
+class DebugStatsObj : public BusObject, public qcc::AlarmListener {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param bus              Bus to associate with org.alljoyn.Bus.Debug.Stats interface.
+     * @param busController    Controller that created this object.
+     */
+    DebugStatsObj(Bus& bus, BusController* busController);
+
+    /**
+     * Destructor
+     */
+    ~DebugStatsObj();
+
+    /**
+     * Initialize and register this DebugStatsObj instance.
+     *
+     * @return ER_OK if successful.
+     */
+    QStatus Init();
+
+    /**
+     * Stop DebugStatsObj.
+     *
+     * @return ER_OK if successful.
+     */
+    QStatus Stop();
+
+    /**
+     * Join DebugStatsObj.
+     *
+     * @return ER_OK if successful.
+     */
+    QStatus Join();
+
+    /**
+     * Called when object is successfully registered.
+     */
+    void ObjectRegistered();
+
+    /**
+     * Format the routing statistics, the join session request counters, the
+     * traffic statistics of every remote endpoint and, if it is on, the mutex
+     * contention profile as text.
+     *
+     * @return  The formatted statistics.
+     */
+    qcc::String GetReport();
+
+    /**
+     * Handles the GetCounters method call.
+     *
+     * @param member    Member
+     * @param msg       The incoming message
+     */
+    void GetCounters(const InterfaceDescription::Member* member, Message& msg);
+
+    /**
+     * Handles the GetHistograms method call.
+     *
+     * @param member    Member
+     * @param msg       The incoming message
+     */
+    void GetHistograms(const InterfaceDescription::Member* member, Message& msg);
+
+    /**
+     * Handles the GetEndpointStats method call.
+     *
+     * @param member    Member
+     * @param msg       The incoming message
+     */
+    void GetEndpointStats(const InterfaceDescription::Member* member, Message& msg);
+
+    /**
+     * Handles the GetReport method call.
+     *
+     * @param member    Member
+     * @param msg       The incoming message
+     */
+    void GetReport(const InterfaceDescription::Member* member, Message& msg);
+
+  private:
+
+    /**
+     * Writes out the statistics when the dump alarm goes off.
+     */
+    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+
+    /**
+     * Check that a method call comes from this device.
+     */
+    bool IsLocalSender(Message& msg);
+
+    Bus& bus;                       /**< The bus */
+    DaemonRouter& router;           /**< The router whose statistics are reported */
+    BusController* busController;   /**< BusController that created this object */
+    qcc::Timer timer;               /**< Timer for the periodic dump */
+    uint32_t dumpIntervalMs;        /**< Time between dumps, 0 if the statistics are not dumped */
+    qcc::String dumpFile;           /**< File to append the dumps to, stdout if empty */
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * Admission control for the JoinSession and AttachSession requests handled by the routing node.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <qcc/time.h>
+
+#include "JoinSessionQueue.h"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+static const char* counterNames[JoinSessionQueue::Stats::NUM_COUNTERS] = {
+    "join_sessions_queued",
+    "join_sessions_in_progress",
+    "join_sessions_admitted",
+    "join_sessions_rejected",
+    "join_sessions_deferred",
+    "join_session_max_queue_ms"
+};
+
+JoinSessionQueue::Stats::Stats()
+{
+    memset(counters, 0, sizeof(counters));
+}
+
+const char* JoinSessionQueue::Stats::GetName(Counter c)
+{
+    return (c < NUM_COUNTERS) ? counterNames[c] : "";
+}
+
+qcc::String JoinSessionQueue::Stats::ToString() const
+{
+    qcc::String str;
+    char line[80];
+    for (uint32_t c = 0; c < NUM_COUNTERS; ++c) {
+        snprintf(line, sizeof(line), "%s %u\n", counterNames[c], counters[c]);
+        str += line;
+    }
+    return str;
+}
+
+JoinSessionQueue::JoinSessionQueue(uint32_t maxPending, uint32_t maxPerJoiner) :
+    maxPending(maxPending),
+    maxPerJoiner(max(maxPerJoiner, 1U))
+{
+}
+
+JoinSessionQueue::Admission JoinSessionQueue::Add(Request* request)
+{
+    Admission admission;
+    lock.Lock(MUTEX_CONTEXT);
+    if (requests.size() >= maxPending) {
+        ++stats.counters[Stats::REJECTED];
+        admission = REJECTED;
+    } else {
+        request->queueTime = GetTimestamp64();
+        request->started = false;
+        requests.insert(request);
+        ++stats.counters[Stats::ADMITTED];
+        ++stats.counters[Stats::QUEUED];
+        Joiner& joiner = joiners[make_pair(request->isJoin, request->joiner)];
+        if (joiner.running >= maxPerJoiner) {
+            joiner.parked.push_back(request);
+            ++stats.counters[Stats::DEFERRED];
+            admission = PARKED;
+        } else {
+            ++joiner.running;
+            admission = RUN;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return admission;
+}
+
+void JoinSessionQueue::Started(Request* request)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    if (!request->started && (requests.find(request) != requests.end())) {
+        request->started = true;
+        --stats.counters[Stats::QUEUED];
+        ++stats.counters[Stats::IN_PROGRESS];
+        uint32_t queueTime = static_cast<uint32_t>(GetTimestamp64() - request->queueTime);
+        stats.counters[Stats::MAX_QUEUE_TIME] = max(stats.counters[Stats::MAX_QUEUE_TIME], queueTime);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+JoinSessionQueue::Request* JoinSessionQueue::Finished(Request* request)
+{
+    Request* next = NULL;
+    lock.Lock(MUTEX_CONTEXT);
+    if (requests.erase(request)) {
+        --stats.counters[request->started ? Stats::IN_PROGRESS : Stats::QUEUED];
+        JoinerMap::iterator it = joiners.find(make_pair(request->isJoin, request->joiner));
+        if (it != joiners.end()) {
+            Joiner& joiner = it->second;
+            if (!joiner.parked.empty()) {
+                /* Hand the slot to the oldest parked request of the same joiner */
+                next = joiner.parked.front();
+                joiner.parked.pop_front();
+            } else if (--joiner.running == 0) {
+                joiners.erase(it);
+            }
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return next;
+}
+
+void JoinSessionQueue::Clear(std::vector<Request*>& cleared)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    cleared.assign(requests.begin(), requests.end());
+    requests.clear();
+    joiners.clear();
+    stats.counters[Stats::QUEUED] = 0;
+    stats.counters[Stats::IN_PROGRESS] = 0;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void JoinSessionQueue::GetStats(Stats& snapshot) const
+{
+    lock.Lock(MUTEX_CONTEXT);
+    snapshot = stats;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+}
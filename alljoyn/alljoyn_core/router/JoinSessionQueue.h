@@ -0,0 +1,205 @@
+#ifndef _ALLJOYN_JOINSESSIONQUEUE_H
+#define _ALLJOYN_JOINSESSIONQUEUE_H
+/**
+ * @file
+ * Admission control for the JoinSession and AttachSession requests handled by the routing node.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include JoinSessionQueue.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+
+namespace ajn {
+
+/**
+ * %JoinSessionQueue decides which of the outstanding JoinSession and
+ * AttachSession requests may run.
+ *
+ * A request that would take the number of outstanding requests past
+ * maxPending is rejected.  Otherwise it may run unless its joiner already has
+ * maxPerJoiner requests of the same kind running, in which case it is parked
+ * until one of them finishes.  The joiner is the unique name of the endpoint
+ * that called JoinSession, which for an AttachSession is the src argument
+ * rather than the routing node that forwarded it.  Joins and attaches are
+ * counted separately so that the attaches a join causes are never parked
+ * behind the join itself.
+ *
+ * The queue does not own the requests and does not run them; the caller
+ * runs the requests it is told to and calls Finished() when each is done.
+ */
+class JoinSessionQueue {
+  public:
+
+    /**
+     * A JoinSession or AttachSession request.
+     */
+    class Request {
+      public:
+        /**
+         * Constructor
+         *
+         * @param joiner   Unique name of the endpoint that is joining the session.
+         * @param isJoin   true for JoinSession, false for AttachSession.
+         */
+        Request(const qcc::String& joiner, bool isJoin) : joiner(joiner), isJoin(isJoin), queueTime(0), started(false) { }
+
+        /**
+         * Destructor
+         */
+        virtual ~Request() { }
+
+        const qcc::String joiner;   /**< Unique name of the endpoint that is joining the session */
+        const bool isJoin;          /**< true for JoinSession, false for AttachSession */
+
+      private:
+        friend class JoinSessionQueue;
+
+        uint64_t queueTime;         /**< Time the request was admitted */
+        bool started;               /**< true once Started() has been called */
+    };
+
+    /**
+     * Counters describing the request workload.
+     */
+    struct Stats {
+        /**
+         * The counters.
+         */
+        enum Counter {
+            QUEUED,             /**< Requests admitted but not yet running, including parked ones */
+            IN_PROGRESS,        /**< Requests running */
+            ADMITTED,           /**< Requests admitted */
+            REJECTED,           /**< Requests rejected because too many were outstanding */
+            DEFERRED,           /**< Requests parked because their joiner had too many running */
+            MAX_QUEUE_TIME,     /**< Longest time in milliseconds a request waited before running */
+            NUM_COUNTERS
+        };
+
+        uint32_t counters[NUM_COUNTERS];    /**< Counter values */
+
+        Stats();
+
+        /**
+         * Get the name a counter is reported under.
+         *
+         * @param c   The counter.
+         *
+         * @return  The name.
+         */
+        static const char* GetName(Counter c);
+
+        /**
+         * Format the counters as text, one per line.
+         *
+         * @return  The formatted counters.
+         */
+        qcc::String ToString() const;
+    };
+
+    /**
+     * What to do with a request passed to Add().
+     */
+    enum Admission {
+        RUN,        /**< Run the request now */
+        PARKED,     /**< The request is parked; Finished() hands it back when it may run */
+        REJECTED    /**< Too many requests are outstanding; reply with a failure */
+    };
+
+    /**
+     * Constructor
+     *
+     * @param maxPending     Maximum number of outstanding requests.
+     * @param maxPerJoiner   Maximum number of requests of each kind that may run for one joiner.
+     */
+    JoinSessionQueue(uint32_t maxPending, uint32_t maxPerJoiner);
+
+    /**
+     * Admit a request.
+     *
+     * @param request   The request.
+     *
+     * @return  What to do with the request.  A rejected request is forgotten.
+     */
+    Admission Add(Request* request);
+
+    /**
+     * Record that a request the caller was told to run has started running.
+     *
+     * @param request   The request.
+     */
+    void Started(Request* request);
+
+    /**
+     * Forget a request the caller was told to run, whether or not it started.
+     *
+     * @param request   The request.
+     *
+     * @return  A parked request of the same joiner that may now run, or NULL.
+     */
+    Request* Finished(Request* request);
+
+    /**
+     * Forget all outstanding requests.
+     *
+     * @param[out] cleared   The requests that were outstanding, including parked ones.
+     */
+    void Clear(std::vector<Request*>& cleared);
+
+    /**
+     * Get a snapshot of the counters.
+     *
+     * @param[out] stats   The counters.
+     */
+    void GetStats(Stats& stats) const;
+
+  private:
+
+    /**
+     * The requests of one kind from one joiner.
+     */
+    struct Joiner {
+        uint32_t running;               /**< Requests the caller was told to run */
+        std::deque<Request*> parked;    /**< Requests waiting for one of the running ones to finish */
+        Joiner() : running(0) { }
+    };
+
+    typedef std::map<std::pair<bool, qcc::String>, Joiner> JoinerMap;
+
+    const uint32_t maxPending;          /**< Maximum number of outstanding requests */
+    const uint32_t maxPerJoiner;        /**< Maximum number of running requests of each kind per joiner */
+    mutable qcc::Mutex lock;            /**< Protects the members below */
+    std::set<Request*> requests;        /**< Outstanding requests */
+    JoinerMap joiners;                  /**< Running and parked requests by kind and joiner */
+    Stats stats;                        /**< Counters */
+};
+
+}
+
+#endif
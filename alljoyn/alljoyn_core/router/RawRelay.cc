@@ -0,0 +1,514 @@
+/**
+ * @file
+ *
+ * Service that relays the bytes of indirect raw sessions between two sockets.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+#include <qcc/StreamPump.h>
+#include <qcc/String.h>
+
+#include "RawRelay.h"
+
+#if defined(QCC_OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <qcc/Thread.h>
+#endif
+
+#define QCC_MODULE "ALLJOYN_RAW_RELAY"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/*
+ * Size of the chunks copied by the StreamPump fallback
+ */
+static const size_t PUMP_CHUNK_SIZE = 4096;
+
+/*
+ * Relay bytes between two sockets on a dedicated StreamPump thread.
+ */
+static QStatus StartPump(SocketFd fdA, SocketFd fdB, const String& name)
+{
+    SocketStream* ssA = new SocketStream(fdA);
+    SocketStream* ssB = new SocketStream(fdB);
+    String threadName = name + "-pump";
+    size_t chunkSize = PUMP_CHUNK_SIZE;
+    const char* threadNameStr = threadName.c_str();
+    bool isManaged = true;
+    ManagedObj<StreamPump> pump(ssA, ssB, chunkSize, threadNameStr, isManaged);
+    return pump->Start();
+}
+
+#if defined(QCC_OS_LINUX)
+
+/*
+ * Maximum number of bytes moved by one splice() call.  A pipe holds 64KB by default.
+ */
+static const size_t SPLICE_CHUNK_SIZE = 64 * 1024;
+
+/*
+ * Maximum number of epoll events handled per wakeup
+ */
+static const int MAX_EVENTS = 32;
+
+static uint64_t NowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * splice() is only used between stream sockets the kernel knows how to splice.
+ */
+static bool CanSplice(SocketFd fd)
+{
+    int type = 0;
+    socklen_t len = sizeof(type);
+    if ((getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) != 0) || (type != SOCK_STREAM)) {
+        return false;
+    }
+    struct sockaddr_storage addr;
+    len = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) != 0) {
+        return false;
+    }
+    return (addr.ss_family == AF_INET) || (addr.ss_family == AF_INET6) || (addr.ss_family == AF_UNIX);
+}
+
+/*
+ * A SIGPIPE raised by a splice() into a socket whose peer has gone away is
+ * blocked on the worker threads.  Discard it so it is not left pending.
+ */
+static void DiscardSigPipe()
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    struct timespec zero = { 0, 0 };
+    while (sigtimedwait(&set, NULL, &zero) == SIGPIPE) {
+    }
+}
+
+/*
+ * One relay.  Direction d moves bytes from fds[d] through pipes[d] to fds[1 - d].
+ */
+struct Relay {
+    struct Direction {
+        int pipe[2];            /* Pipe the bytes are spliced through */
+        size_t pending;         /* Bytes currently in the pipe */
+        uint64_t fillUs;        /* When the pipe last went from empty to non-empty */
+        bool eof;               /* Source has closed its end */
+        bool shutdown;          /* Destination has been shutdown for writing */
+
+        Direction() : pending(0), fillUs(0), eof(false), shutdown(false) {
+            pipe[0] = pipe[1] = -1;
+        }
+    };
+
+    uint64_t id;
+    SocketFd fds[2];
+    Direction dir[2];
+    RawRelayStats stats;
+
+    Relay(uint64_t id, SocketFd fdA, SocketFd fdB, const String& name) : id(id) {
+        fds[0] = fdA;
+        fds[1] = fdB;
+        stats.name = name;
+    }
+
+    ~Relay() {
+        for (size_t d = 0; d < 2; ++d) {
+            if (fds[d] >= 0) {
+                qcc::Close(fds[d]);
+            }
+            if (dir[d].pipe[0] >= 0) {
+                close(dir[d].pipe[0]);
+                close(dir[d].pipe[1]);
+            }
+        }
+    }
+
+    /*
+     * Move bytes in one direction until neither the source nor the destination
+     * can make progress.  Returns an error if the relay must be closed.
+     */
+    QStatus Pump(size_t d)
+    {
+        Direction& dr = dir[d];
+        SocketFd src = fds[d];
+        SocketFd dst = fds[1 - d];
+        bool progress;
+        do {
+            progress = false;
+            if (!dr.eof) {
+                ssize_t n = splice(src, NULL, dr.pipe[1], NULL, SPLICE_CHUNK_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n > 0) {
+                    if (dr.pending == 0) {
+                        dr.fillUs = NowUs();
+                    }
+                    dr.pending += n;
+                    progress = true;
+                } else if (n == 0) {
+                    dr.eof = true;
+                } else if ((errno != EAGAIN) && (errno != EINTR)) {
+                    QCC_DbgHLPrintf(("Relay %s: splice from fd %d failed with %d (%s)", stats.name.c_str(), src, errno, strerror(errno)));
+                    return ER_OS_ERROR;
+                }
+            }
+            if (dr.pending > 0) {
+                ssize_t n = splice(dr.pipe[0], NULL, dst, NULL, dr.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n > 0) {
+                    dr.pending -= n;
+                    stats.bytes[d] += n;
+                    if (dr.pending == 0) {
+                        uint64_t latency = NowUs() - dr.fillUs;
+                        ++stats.bursts[d];
+                        stats.totalLatencyUs[d] += latency;
+                        if (latency > stats.maxLatencyUs[d]) {
+                            stats.maxLatencyUs[d] = latency;
+                        }
+                    }
+                    progress = true;
+                } else if ((n < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+                    int err = errno;
+                    if (err == EPIPE) {
+                        DiscardSigPipe();
+                    }
+                    QCC_DbgHLPrintf(("Relay %s: splice to fd %d failed with %d (%s)", stats.name.c_str(), dst, err, strerror(err)));
+                    return ER_OS_ERROR;
+                }
+            }
+        } while (progress);
+
+        /* Pass the end of stream on once everything before it has been delivered */
+        if (dr.eof && (dr.pending == 0) && !dr.shutdown) {
+            ::shutdown(dst, SHUT_WR);
+            dr.shutdown = true;
+        }
+        return ER_OK;
+    }
+
+    bool IsDone() const { return dir[0].shutdown && dir[1].shutdown; }
+};
+
+/*
+ * Worker thread that runs all the relays registered in its epoll set.
+ */
+class RawRelayService::Worker : public Thread {
+  public:
+
+    Worker(const char* name) : Thread(name), epollFd(-1), wakeFd(-1), nextId(1) { }
+
+    ~Worker()
+    {
+        for (map<uint64_t, Relay*>::iterator it = relays.begin(); it != relays.end(); ++it) {
+            delete it->second;
+        }
+        if (wakeFd >= 0) {
+            close(wakeFd);
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+    }
+
+    QStatus Init()
+    {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            QCC_LogError(ER_OS_ERROR, ("epoll_create1 failed with %d (%s)", errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            QCC_LogError(ER_OS_ERROR, ("eventfd failed with %d (%s)", errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = 0;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0) {
+            QCC_LogError(ER_OS_ERROR, ("epoll_ctl add failed with %d (%s)", errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        return ER_OK;
+    }
+
+    QStatus Add(SocketFd fdA, SocketFd fdB, const String& name)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        Relay* relay = new Relay(nextId++, fdA, fdB, name);
+        QStatus status = ER_OK;
+        for (size_t d = 0; (status == ER_OK) && (d < 2); ++d) {
+            if ((pipe2(relay->dir[d].pipe, O_NONBLOCK | O_CLOEXEC) != 0) || (qcc::SetBlocking(relay->fds[d], false) != ER_OK)) {
+                status = ER_OS_ERROR;
+                QCC_LogError(status, ("Relay %s: setup failed with %d (%s)", name.c_str(), errno, strerror(errno)));
+            }
+        }
+        if (status == ER_OK) {
+            relays[relay->id] = relay;
+            /*
+             * Edge triggered so each readiness change is reported once.  The
+             * epoll data identifies the relay and which of its sockets is ready.
+             */
+            for (size_t d = 0; (status == ER_OK) && (d < 2); ++d) {
+                struct epoll_event ev;
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                ev.data.u64 = (relay->id << 1) | d;
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, relay->fds[d], &ev) != 0) {
+                    status = ER_OS_ERROR;
+                    QCC_LogError(status, ("Relay %s: epoll_ctl add failed with %d (%s)", name.c_str(), errno, strerror(errno)));
+                }
+            }
+            if (status != ER_OK) {
+                relays.erase(relay->id);
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, relay->fds[0], NULL);
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, relay->fds[1], NULL);
+            }
+        }
+        if (status != ER_OK) {
+            /* Don't close the sockets, the caller still owns them */
+            relay->fds[0] = relay->fds[1] = -1;
+            delete relay;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+
+    size_t GetNumRelays()
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        size_t num = relays.size();
+        lock.Unlock(MUTEX_CONTEXT);
+        return num;
+    }
+
+    void GetStats(vector<RawRelayStats>& stats)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        for (map<uint64_t, Relay*>::iterator it = relays.begin(); it != relays.end(); ++it) {
+            stats.push_back(it->second->stats);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    QStatus Stop()
+    {
+        QStatus status = Thread::Stop();
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            QCC_LogError(ER_OS_ERROR, ("Failed to wake relay worker %d (%s)", errno, strerror(errno)));
+        }
+        return status;
+    }
+
+  protected:
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+        struct epoll_event events[MAX_EVENTS];
+        while (!IsStopping()) {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                QCC_LogError(ER_OS_ERROR, ("epoll_wait failed with %d (%s)", errno, strerror(errno)));
+                break;
+            }
+            lock.Lock(MUTEX_CONTEXT);
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.u64 == 0) {
+                    uint64_t count;
+                    if (read(wakeFd, &count, sizeof(count)) < 0) {
+                        QCC_DbgPrintf(("Relay worker wake read failed %d", errno));
+                    }
+                    continue;
+                }
+                /* An earlier event in this batch may have closed the relay */
+                map<uint64_t, Relay*>::iterator it = relays.find(events[i].data.u64 >> 1);
+                if (it == relays.end()) {
+                    continue;
+                }
+                Relay* relay = it->second;
+                QStatus status = relay->Pump(0);
+                if (status == ER_OK) {
+                    status = relay->Pump(1);
+                }
+                if ((status != ER_OK) || relay->IsDone()) {
+                    QCC_DbgPrintf(("Relay %s closed after %llu/%llu bytes", relay->stats.name.c_str(),
+                                   (unsigned long long)relay->stats.bytes[0], (unsigned long long)relay->stats.bytes[1]));
+                    relays.erase(it);
+                    delete relay;
+                }
+            }
+            lock.Unlock(MUTEX_CONTEXT);
+        }
+        return 0;
+    }
+
+  private:
+
+    Mutex lock;                         /* Protects relays */
+    map<uint64_t, Relay*> relays;       /* Relays keyed by id */
+    int epollFd;                        /* Epoll set with both sockets of every relay */
+    int wakeFd;                         /* eventfd used to wake the thread when it is stopped */
+    uint64_t nextId;                    /* Next relay id, 0 is reserved for wakeFd */
+};
+
+#else
+
+/*
+ * The worker threads are only used where splice() is available.
+ */
+class RawRelayService::Worker {
+  public:
+    size_t GetNumRelays() { return 0; }
+    void GetStats(vector<RawRelayStats>& stats) { }
+    QStatus Stop() { return ER_OK; }
+    QStatus Join() { return ER_OK; }
+};
+
+#endif
+
+RawRelayService::RawRelayService(uint32_t numWorkers) : numWorkers(numWorkers), isStopping(false)
+{
+}
+
+RawRelayService::~RawRelayService()
+{
+    Stop();
+    Join();
+}
+
+QStatus RawRelayService::AddRelay(SocketFd fdA, SocketFd fdB, const String& name)
+{
+#if defined(QCC_OS_LINUX)
+    if ((numWorkers > 0) && CanSplice(fdA) && CanSplice(fdB)) {
+        lock.Lock(MUTEX_CONTEXT);
+        if (isStopping) {
+            lock.Unlock(MUTEX_CONTEXT);
+            return ER_BUS_STOPPING;
+        }
+        QStatus status = ER_OK;
+        if (workers.empty()) {
+            for (uint32_t i = 0; (status == ER_OK) && (i < numWorkers); ++i) {
+                Worker* worker = new Worker("rawrelay");
+                status = worker->Init();
+                if (status == ER_OK) {
+                    status = worker->Start();
+                }
+                if (status == ER_OK) {
+                    workers.push_back(worker);
+                } else {
+                    delete worker;
+                }
+            }
+        }
+        /* Give the relay to the least loaded worker */
+        Worker* worker = NULL;
+        size_t least = 0;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            size_t num = workers[i]->GetNumRelays();
+            if (!worker || (num < least)) {
+                worker = workers[i];
+                least = num;
+            }
+        }
+        status = worker ? worker->Add(fdA, fdB, name) : ER_OS_ERROR;
+        lock.Unlock(MUTEX_CONTEXT);
+        if (status == ER_OK) {
+            return status;
+        }
+        QCC_LogError(status, ("Relay %s: falling back to a stream pump", name.c_str()));
+    }
+#endif
+    return StartPump(fdA, fdB, name);
+}
+
+void RawRelayService::GetStats(vector<RawRelayStats>& stats)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->GetStats(stats);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+size_t RawRelayService::GetNumRelays()
+{
+    size_t num = 0;
+    lock.Lock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        num += workers[i]->GetNumRelays();
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return num;
+}
+
+QStatus RawRelayService::Stop()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    isStopping = true;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Stop();
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return ER_OK;
+}
+
+QStatus RawRelayService::Join()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    vector<Worker*> stopped;
+    stopped.swap(workers);
+    lock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < stopped.size(); ++i) {
+        stopped[i]->Join();
+        delete stopped[i];
+    }
+    return ER_OK;
+}
+
+}
@@ -0,0 +1,148 @@
+/**
+ * @file
+ *
+ * Service that relays the bytes of indirect raw sessions between two sockets.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#ifndef _ALLJOYN_RAWRELAY_H
+#define _ALLJOYN_RAWRELAY_H
+
+#ifndef __cplusplus
+#error Only include RawRelay.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/Mutex.h>
+#include <qcc/SocketTypes.h>
+#include <qcc/String.h>
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * Counters kept for each relay.  Index 0 of each array is for bytes moving
+ * from the first socket to the second, index 1 for the opposite direction.
+ */
+struct RawRelayStats {
+    qcc::String name;               /**< Name the relay was created with */
+    uint64_t bytes[2];              /**< Bytes relayed */
+    uint64_t bursts[2];             /**< Number of times the relay buffer went from empty to drained */
+    uint64_t totalLatencyUs[2];     /**< Sum of the time bytes waited in the relay buffer */
+    uint64_t maxLatencyUs[2];       /**< Longest time bytes waited in the relay buffer */
+
+    RawRelayStats() {
+        for (size_t i = 0; i < 2; ++i) {
+            bytes[i] = bursts[i] = totalLatencyUs[i] = maxLatencyUs[i] = 0;
+        }
+    }
+};
+
+/**
+ * Relays the bytes of indirect raw sessions between pairs of sockets.
+ *
+ * On Linux all relays are multiplexed on a small number of worker threads that
+ * wait on an epoll set and move bytes with splice() through a pipe so that the
+ * data never has to be copied into user space.  Where splice() cannot be used
+ * each relay falls back to its own StreamPump thread.
+ */
+class RawRelayService {
+  public:
+
+    /**
+     * Default number of worker threads.
+     */
+    static const uint32_t DEFAULT_NUM_WORKERS = 2;
+
+    /**
+     * Constructor
+     *
+     * @param numWorkers  Number of worker threads.  The threads are only started
+     *                    once the first relay has been added.
+     */
+    RawRelayService(uint32_t numWorkers = DEFAULT_NUM_WORKERS);
+
+    /**
+     * Destructor.  Stops the workers and closes any relays that are still open.
+     */
+    ~RawRelayService();
+
+    /**
+     * Start relaying bytes between two connected stream sockets.  The service
+     * takes ownership of both sockets and closes them once either side has
+     * closed its connection and the relay has drained.
+     *
+     * @param fdA   First socket.
+     * @param fdB   Second socket.
+     * @param name  Name used for logging and in the relay counters.
+     *
+     * @return ER_OK if the relay was started.
+     */
+    QStatus AddRelay(qcc::SocketFd fdA, qcc::SocketFd fdB, const qcc::String& name);
+
+    /**
+     * Get the counters for the relays that are currently open.  Relays that
+     * fell back to a StreamPump are not included.
+     *
+     * @param[out] stats  Receives one entry per open relay.
+     */
+    void GetStats(std::vector<RawRelayStats>& stats);
+
+    /**
+     * Get the number of relays currently multiplexed on the worker threads.
+     *
+     * @return The number of open relays.
+     */
+    size_t GetNumRelays();
+
+    /**
+     * Stop the worker threads.  No more relays can be added.
+     *
+     * @return ER_OK
+     */
+    QStatus Stop();
+
+    /**
+     * Wait for the worker threads to exit and close any relays that are still open.
+     *
+     * @return ER_OK
+     */
+    QStatus Join();
+
+  private:
+
+    class Worker;
+
+    /**
+     * Private copy constructor and assignment operator.
+     */
+    RawRelayService(const RawRelayService& other);
+    RawRelayService& operator=(const RawRelayService& other);
+
+    qcc::Mutex lock;                /**< Protects workers and isStopping */
+    std::vector<Worker*> workers;   /**< Worker threads, created on first use */
+    uint32_t numWorkers;            /**< Number of worker threads to create */
+    bool isStopping;                /**< True once Stop() has been called */
+};
+
+}
+
+#endif
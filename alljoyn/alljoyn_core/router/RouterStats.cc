@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Low overhead counters and latency histograms for the routing node.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <list>
+
+#if defined(QCC_OS_GROUP_WINDOWS)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include "RouterStats.h"
+
+#define QCC_MODULE "ROUTER"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+static const char* counterNames[RouterStats::NUM_COUNTERS] = {
+    "messages_routed",
+    "messages_unicast",
+    "messages_broadcast",
+    "messages_sessioncast",
+    "messages_no_route",
+    "delivery_failures"
+};
+
+static const char* histogramNames[RouterStats::NUM_HISTOGRAMS] = {
+    "route_latency_us",
+    "name_table_lock_wait_us",
+    "rule_table_lock_wait_us",
+    "session_cast_lock_wait_us"
+};
+
+static const char* gaugeNames[RouterStats::NUM_GAUGES] = {
+    "rules",
+    "unique_names",
+    "alias_names",
+    "b2b_endpoints",
+    "session_routes"
+};
+
+/*
+ * The statistics recorded by one thread.  Only the owning thread writes to
+ * a block, other threads only read it when they take a snapshot.
+ */
+struct RouterStats::ThreadStats {
+    RouterStats::Internal* owner;
+    uint32_t sampleCounts[NUM_HISTOGRAMS];
+    volatile uint64_t counters[NUM_COUNTERS];
+    volatile uint64_t buckets[NUM_HISTOGRAMS][NUM_BUCKETS];
+    volatile uint64_t sums[NUM_HISTOGRAMS];
+
+    ThreadStats(RouterStats::Internal* owner) : owner(owner)
+    {
+        for (uint32_t c = 0; c < NUM_COUNTERS; ++c) {
+            counters[c] = 0;
+        }
+        for (uint32_t h = 0; h < NUM_HISTOGRAMS; ++h) {
+            for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+                buckets[h][b] = 0;
+            }
+            sums[h] = 0;
+            sampleCounts[h] = 0;
+        }
+    }
+
+    void AddTo(Snapshot& snapshot) const
+    {
+        for (uint32_t c = 0; c < NUM_COUNTERS; ++c) {
+            snapshot.counters[c] += counters[c];
+        }
+        for (uint32_t h = 0; h < NUM_HISTOGRAMS; ++h) {
+            for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+                snapshot.buckets[h][b] += buckets[h][b];
+            }
+            snapshot.sums[h] += sums[h];
+        }
+    }
+};
+
+/*
+ * Keeps track of the per-thread blocks.  A block is found through a thread
+ * local storage slot and is folded into the retired totals when its thread
+ * exits so that short lived threads do not leak blocks.
+ */
+class RouterStats::Internal {
+  public:
+    Internal()
+    {
+#if defined(QCC_OS_GROUP_WINDOWS)
+        key = FlsAlloc(&Internal::ThreadExit);
+        assert((key != FLS_OUT_OF_INDEXES) && "RouterStats::Internal(): Out of fiber local storage");
+#else
+        int ret = pthread_key_create(&key, &Internal::ThreadExit);
+        assert((ret == 0) && "RouterStats::Internal(): Out of thread local storage");
+        QCC_UNUSED(ret);
+#endif
+    }
+
+    ~Internal()
+    {
+        /* Threads that exit from here on no longer retire their blocks */
+#if defined(QCC_OS_GROUP_WINDOWS)
+        FlsFree(key);
+#else
+        pthread_key_delete(key);
+#endif
+        lock.Lock(MUTEX_CONTEXT);
+        for (list<ThreadStats*>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            delete *it;
+        }
+        blocks.clear();
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    ThreadStats* Get()
+    {
+#if defined(QCC_OS_GROUP_WINDOWS)
+        return reinterpret_cast<ThreadStats*>(FlsGetValue(key));
+#else
+        return reinterpret_cast<ThreadStats*>(pthread_getspecific(key));
+#endif
+    }
+
+    ThreadStats* Add()
+    {
+        ThreadStats* ts = new ThreadStats(this);
+        lock.Lock(MUTEX_CONTEXT);
+        blocks.push_back(ts);
+        lock.Unlock(MUTEX_CONTEXT);
+#if defined(QCC_OS_GROUP_WINDOWS)
+        FlsSetValue(key, ts);
+#else
+        pthread_setspecific(key, ts);
+#endif
+        return ts;
+    }
+
+    void Retire(ThreadStats* ts)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        blocks.remove(ts);
+        ts->AddTo(retired);
+        lock.Unlock(MUTEX_CONTEXT);
+        delete ts;
+    }
+
+    void GetSnapshot(Snapshot& snapshot)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        snapshot = retired;
+        for (list<ThreadStats*>::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            (*it)->AddTo(snapshot);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+  private:
+
+#if defined(QCC_OS_GROUP_WINDOWS)
+    static void NTAPI ThreadExit(void* arg)
+#else
+    static void ThreadExit(void* arg)
+#endif
+    {
+        ThreadStats* ts = reinterpret_cast<ThreadStats*>(arg);
+        if (ts) {
+            ts->owner->Retire(ts);
+        }
+    }
+
+#if defined(QCC_OS_GROUP_WINDOWS)
+    DWORD key;
+#else
+    pthread_key_t key;
+#endif
+    Mutex lock;                 /* Protects blocks and retired */
+    list<ThreadStats*> blocks;  /* Blocks of the threads that have recorded statistics */
+    Snapshot retired;           /* Totals of the threads that have exited */
+};
+
+RouterStats::Snapshot::Snapshot()
+{
+    memset(counters, 0, sizeof(counters));
+    memset(buckets, 0, sizeof(buckets));
+    memset(sums, 0, sizeof(sums));
+    memset(gauges, 0, sizeof(gauges));
+}
+
+uint64_t RouterStats::Snapshot::GetCount(Histogram h) const
+{
+    uint64_t count = 0;
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+        count += buckets[h][b];
+    }
+    return count;
+}
+
+uint64_t RouterStats::Snapshot::GetPercentile(Histogram h, uint32_t percent) const
+{
+    uint64_t count = GetCount(h);
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+        seen += buckets[h][b];
+        if ((seen >= rank) && (seen > 0)) {
+            return GetBucketLimit(b);
+        }
+    }
+    return GetBucketLimit(NUM_BUCKETS - 1);
+}
+
+qcc::String RouterStats::Snapshot::ToString() const
+{
+    qcc::String str;
+    char line[160];
+    for (uint32_t c = 0; c < NUM_COUNTERS; ++c) {
+        snprintf(line, sizeof(line), "%s %llu\n", counterNames[c], static_cast<unsigned long long>(counters[c]));
+        str += line;
+    }
+    for (uint32_t g = 0; g < NUM_GAUGES; ++g) {
+        snprintf(line, sizeof(line), "%s %u\n", gaugeNames[g], gauges[g]);
+        str += line;
+    }
+    for (uint32_t h = 0; h < NUM_HISTOGRAMS; ++h) {
+        Histogram hist = static_cast<Histogram>(h);
+        uint64_t count = GetCount(hist);
+        snprintf(line, sizeof(line), "%s count %llu mean %llu p50 %llu p90 %llu p99 %llu max %llu\n", histogramNames[h],
+                 static_cast<unsigned long long>(count),
+                 static_cast<unsigned long long>(count ? sums[h] / count : 0),
+                 static_cast<unsigned long long>(GetPercentile(hist, 50)),
+                 static_cast<unsigned long long>(GetPercentile(hist, 90)),
+                 static_cast<unsigned long long>(GetPercentile(hist, 99)),
+                 static_cast<unsigned long long>(GetPercentile(hist, 100)));
+        str += line;
+    }
+    return str;
+}
+
+const char* RouterStats::GetName(Counter c)
+{
+    return (c < NUM_COUNTERS) ? counterNames[c] : "";
+}
+
+const char* RouterStats::GetName(Histogram h)
+{
+    return (h < NUM_HISTOGRAMS) ? histogramNames[h] : "";
+}
+
+const char* RouterStats::GetName(Gauge g)
+{
+    return (g < NUM_GAUGES) ? gaugeNames[g] : "";
+}
+
+RouterStats::RouterStats() : internal(new Internal())
+{
+}
+
+RouterStats::~RouterStats()
+{
+    delete internal;
+}
+
+RouterStats::ThreadStats* RouterStats::GetThreadStats()
+{
+    ThreadStats* ts = internal->Get();
+    return ts ? ts : internal->Add();
+}
+
+void RouterStats::Increment(Counter c, uint32_t n)
+{
+    ThreadStats* ts = GetThreadStats();
+    ts->counters[c] = ts->counters[c] + n;
+}
+
+uint64_t RouterStats::StartSample(Histogram h)
+{
+    ThreadStats* ts = GetThreadStats();
+    if (++ts->sampleCounts[h] < SAMPLE_INTERVAL) {
+        return 0;
+    }
+    ts->sampleCounts[h] = 0;
+    return GetTimestampMicros();
+}
+
+void RouterStats::Record(Histogram h, uint64_t value)
+{
+    ThreadStats* ts = GetThreadStats();
+    uint32_t bucket = 0;
+    for (uint64_t v = value; v && (bucket < (NUM_BUCKETS - 1)); v >>= 1) {
+        ++bucket;
+    }
+    ts->buckets[h][bucket] = ts->buckets[h][bucket] + 1;
+    ts->sums[h] = ts->sums[h] + value;
+}
+
+void RouterStats::GetSnapshot(Snapshot& snapshot)
+{
+    internal->GetSnapshot(snapshot);
+}
+
+}
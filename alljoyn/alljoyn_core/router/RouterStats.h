@@ -0,0 +1,248 @@
+#ifndef _ALLJOYN_ROUTERSTATS_H
+#define _ALLJOYN_ROUTERSTATS_H
+/**
+ * @file
+ * Low overhead counters and latency histograms for the routing node.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include RouterStats.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <qcc/String.h>
+#include <qcc/time.h>
+
+namespace ajn {
+
+/**
+ * %RouterStats collects counters and latency histograms on the routing path.
+ *
+ * Every thread that records a statistic gets its own block of counters, so
+ * recording never takes a lock or touches a cache line that another thread
+ * writes.  The blocks are added up when a snapshot is taken.  Latencies are
+ * only measured for one in SAMPLE_INTERVAL events of each histogram on each
+ * thread to keep the cost of reading the clock off the routing path.
+ */
+class RouterStats {
+  public:
+
+    /**
+     * Event counters.
+     */
+    enum Counter {
+        MESSAGES_ROUTED,        /**< Messages pushed through the router */
+        MESSAGES_UNICAST,       /**< Messages routed to a destination bus name */
+        MESSAGES_BROADCAST,     /**< Broadcast messages matched against the rule table */
+        MESSAGES_SESSIONCAST,   /**< Messages multicast to the members of a session */
+        MESSAGES_NO_ROUTE,      /**< Messages that had no route to their destination */
+        DELIVERY_FAILURES,      /**< Deliveries to an endpoint that failed */
+        NUM_COUNTERS
+    };
+
+    /**
+     * Latency histograms, all in microseconds.
+     */
+    enum Histogram {
+        ROUTE_LATENCY,          /**< Time taken to route a message */
+        NAME_TABLE_LOCK_WAIT,   /**< Time spent waiting for the name table lock */
+        RULE_TABLE_LOCK_WAIT,   /**< Time spent waiting for the rule table lock */
+        SESSION_CAST_LOCK_WAIT, /**< Time spent waiting for the session cast set lock */
+        NUM_HISTOGRAMS
+    };
+
+    /**
+     * Sizes of the routing tables, sampled when a snapshot is taken.
+     */
+    enum Gauge {
+        RULES,                  /**< Rules in the rule table */
+        UNIQUE_NAMES,           /**< Unique names in the name table */
+        ALIAS_NAMES,            /**< Well-known names in the name table */
+        B2B_ENDPOINTS,          /**< Bus-to-bus endpoints */
+        SESSION_ROUTES,         /**< Entries in the session cast set */
+        NUM_GAUGES
+    };
+
+    /**
+     * Number of histogram buckets.  Bucket 0 counts values of 0, bucket n
+     * counts values from 2^(n-1) to 2^n - 1 and the last bucket counts
+     * everything from 2^(NUM_BUCKETS-2) up.
+     */
+    static const uint32_t NUM_BUCKETS = 24;
+
+    /**
+     * One event in this many is timed for each histogram on each thread.
+     */
+    static const uint32_t SAMPLE_INTERVAL = 8;
+
+    /**
+     * Totals of all threads at one point in time.
+     */
+    struct Snapshot {
+        uint64_t counters[NUM_COUNTERS];                    /**< Counter values */
+        uint64_t buckets[NUM_HISTOGRAMS][NUM_BUCKETS];      /**< Histogram bucket counts */
+        uint64_t sums[NUM_HISTOGRAMS];                      /**< Sum of the values recorded in each histogram */
+        uint32_t gauges[NUM_GAUGES];                        /**< Gauge values */
+
+        Snapshot();
+
+        /**
+         * Get the number of values recorded in a histogram.
+         *
+         * @param h   The histogram.
+         *
+         * @return  The number of values.
+         */
+        uint64_t GetCount(Histogram h) const;
+
+        /**
+         * Get an upper bound for a percentile of a histogram.
+         *
+         * @param h         The histogram.
+         * @param percent   The percentile, 0 to 100.
+         *
+         * @return  The upper bound of the bucket that holds the percentile, or 0 if the histogram is empty.
+         */
+        uint64_t GetPercentile(Histogram h, uint32_t percent) const;
+
+        /**
+         * Format the snapshot as text with one statistic per line.
+         *
+         * @return  The formatted snapshot.
+         */
+        qcc::String ToString() const;
+    };
+
+    /**
+     * Get the name of a counter.
+     */
+    static const char* GetName(Counter c);
+
+    /**
+     * Get the name of a histogram.
+     */
+    static const char* GetName(Histogram h);
+
+    /**
+     * Get the name of a gauge.
+     */
+    static const char* GetName(Gauge g);
+
+    /**
+     * Get the upper bound of a histogram bucket.
+     *
+     * @param bucket   The bucket.
+     *
+     * @return  The smallest value that is counted in a higher bucket.
+     */
+    static uint64_t GetBucketLimit(uint32_t bucket) { return static_cast<uint64_t>(1) << bucket; }
+
+    /**
+     * Constructor
+     */
+    RouterStats();
+
+    /**
+     * Destructor
+     */
+    ~RouterStats();
+
+    /**
+     * Add to a counter.
+     *
+     * @param c   The counter.
+     * @param n   The amount to add.
+     */
+    void Increment(Counter c, uint32_t n = 1);
+
+    /**
+     * Decide whether the calling thread should time the current event.  Each
+     * histogram keeps its own count, so timing one event for one histogram
+     * does not change which events are timed for another.
+     *
+     * @param h   The histogram the event will be recorded in.
+     *
+     * @return  A start timestamp to pass to RecordSince() if the event is to
+     *          be timed, 0 otherwise.
+     */
+    uint64_t StartSample(Histogram h);
+
+    /**
+     * Record the time since a sample was started.
+     *
+     * @param h       The histogram.
+     * @param start   The value returned by StartSample(), nothing is recorded if this is 0.
+     */
+    void RecordSince(Histogram h, uint64_t start)
+    {
+        if (start) {
+            Record(h, qcc::GetTimestampMicros() - start);
+        }
+    }
+
+    /**
+     * Record a value in a histogram.
+     *
+     * @param h       The histogram.
+     * @param value   The value in microseconds.
+     */
+    void Record(Histogram h, uint64_t value);
+
+    /**
+     * Add up the counters and histograms of all threads.  The gauges are
+     * left for the owner of the routing tables to fill in.
+     *
+     * @param[out] snapshot   The totals.
+     */
+    void GetSnapshot(Snapshot& snapshot);
+
+    /**
+     * Times an event from construction to destruction if it is sampled.
+     */
+    class ScopedSample {
+      public:
+        ScopedSample(RouterStats& stats, Histogram h) : stats(stats), h(h), start(stats.StartSample(h)) { }
+        ~ScopedSample() { stats.RecordSince(h, start); }
+
+      private:
+        ScopedSample(const ScopedSample& other);
+        ScopedSample& operator=(const ScopedSample& other);
+
+        RouterStats& stats;
+        Histogram h;
+        uint64_t start;
+    };
+
+  private:
+
+    RouterStats(const RouterStats& other);
+    RouterStats& operator=(const RouterStats& other);
+
+    struct ThreadStats;
+    class Internal;
+
+    ThreadStats* GetThreadStats();
+
+    Internal* internal;
+};
+
+}
+
+#endif
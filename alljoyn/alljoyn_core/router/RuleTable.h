@@ -130,6 +130,18 @@ class RuleTable {
         return ret;
     }
 
+    /**
+     * Get the number of rules in the rule table.
+     *
+     * @return  The number of rules.
+     */
+    size_t GetNumRules() {
+        lock.Lock(MUTEX_CONTEXT);
+        size_t num = rules.size();
+        lock.Unlock(MUTEX_CONTEXT);
+        return num;
+    }
+
   private:
     qcc::Mutex lock;                            /**< Lock protecting rule table */
     std::multimap<BusEndpoint, Rule> rules;    /**< Rule table */
@@ -396,6 +396,12 @@ QStatus SessionlessObj::PushMessage(Message& msg)
     } else {
         it->second = val;
     }
+    /* Keep the expansion of a compressed message for as long as it is queued here */
+    if (msg->GetCompressionToken()) {
+        uint32_t tillExpire;
+        msg->IsExpired(&tillExpire);
+        bus.GetInternal().GetCompressionRules()->Pin(key, msg->GetCompressionToken(), tillExpire);
+    }
 
     lock.Unlock();
     router.UnlockNameTable();
@@ -531,6 +537,7 @@ QStatus SessionlessObj::CancelMessage(const qcc::String& sender, uint32_t serial
             if (!it->second.second->IsExpired()) {
                 status = ER_OK;
             }
+            bus.GetInternal().GetCompressionRules()->Unpin(it->first);
             localCache.erase(it);
             messageErased = true;
             break;
@@ -574,6 +581,7 @@ void SessionlessObj::NameOwnerChanged(const String& name,
         SessionlessMessageKey key(oldOwner->c_str(), "", "", "");
         LocalCache::iterator mit = localCache.lower_bound(key);
         while ((mit != localCache.end()) && (::strcmp(oldOwner->c_str(), mit->second.second->GetSender()) == 0)) {
+            bus.GetInternal().GetCompressionRules()->Unpin(mit->first);
             localCache.erase(mit++);
         }
         /* Alert the advertiser worker if the local cache is empty */
@@ -807,6 +815,7 @@ void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sid,
             SessionlessMessageKey key = it->first;
             if (it->second.second->IsExpired()) {
                 /* Remove expired message without sending */
+                bus.GetInternal().GetCompressionRules()->Unpin(it->first);
                 localCache.erase(it++);
                 messageErased = true;
             } else if (sid != 0) {
@@ -893,6 +902,7 @@ void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
         LocalCache::iterator it = localCache.begin();
         while (it != localCache.end()) {
             if (it->second.second->IsExpired(&expire)) {
+                bus.GetInternal().GetCompressionRules()->Unpin(it->first);
                 localCache.erase(it++);
             } else {
                 ++it;
@@ -366,7 +366,7 @@ IpNameServiceImpl::IpNameServiceImpl()
     m_wakeEvent(), m_forceLazyUpdate(false), m_refreshAdvertisements(false),
     m_enabled(false), m_doEnable(false), m_doDisable(false),
     m_ipv4QuietSockFd(qcc::INVALID_SOCKET_FD), m_ipv6QuietSockFd(qcc::INVALID_SOCKET_FD),
-    m_ipv4UnicastSockFd(qcc::INVALID_SOCKET_FD), m_unicastEvent(NULL),
+    m_ipv4UnicastSockFd(qcc::INVALID_SOCKET_FD), m_unicastEvent(NULL), m_mdnsPacketTrackerBucket(0),
     m_protectListeners(false), m_packetScheduler(*this),
     m_networkChangeScheduleCount(m_retries + 1)
 {
@@ -1967,13 +1967,10 @@ QStatus IpNameServiceImpl::RefreshCache(TransportMask transportMask, const qcc::
         it = m_peerInfoMap.find(guid);
         longGuid = guid;
     } else {
-        for (std::unordered_map<qcc::String, std::set<PeerInfo>, Hash, Equal>::iterator i = m_peerInfoMap.begin();
-             i != m_peerInfoMap.end(); ++i) {
-            if (qcc::GUID128(i->first).ToShortString() == guid) {
-                it = i;
-                longGuid = it->first;
-                break;
-            }
+        std::unordered_map<qcc::String, qcc::String, Hash, Equal>::iterator sit = m_peerShortGuids.find(guid);
+        if (sit != m_peerShortGuids.end()) {
+            longGuid = sit->second;
+            it = m_peerInfoMap.find(longGuid);
         }
     }
     // the guid was not found in the m_peerInfoMap the name is unknown.
@@ -3276,7 +3273,11 @@ void IpNameServiceImpl::SendProtocolMessage(
         return;
     }
 
-    uint8_t* buffer = new uint8_t[size];
+    //
+    // Every datagram fits in NS_MESSAGE_MAX, so serialize into a buffer on the
+    // stack instead of allocating one per send.
+    //
+    uint8_t buffer[NS_MESSAGE_MAX];
     size = packet->Serialize(buffer);
 
     size_t sent;
@@ -3340,7 +3341,6 @@ void IpNameServiceImpl::SendProtocolMessage(
             QCC_LogError(status, ("IpNameServiceImpl::SendProtocolMessage(): Error quietly sending to \"%s\"", destination.ToString().c_str()));
         }
 
-        delete [] buffer;
         return;
     }
 
@@ -3485,8 +3485,6 @@ void IpNameServiceImpl::SendProtocolMessage(
             }
         }
     }
-
-    delete [] buffer;
 }
 
 bool IpNameServiceImpl::InterfaceRequested(uint32_t transportIndex, uint32_t liveIndex)
@@ -6698,6 +6696,32 @@ void IpNameServiceImpl::DoPeriodicMaintenance(void)
     m_mutex.Unlock();
 }
 
+//
+// Determine whether any of the names in an advertised name set matches a name,
+// possibly containing wildcards, from a who-has or search request.  The set is
+// sorted, so only the range of names that share the literal prefix of the
+// pattern (everything up to the first wildcard) needs to be run through
+// WildcardMatch().  Patterns without wildcards are a plain lookup.
+//
+static bool MatchAdvertisedName(const set<qcc::String>& advertised, const qcc::String& pattern)
+{
+    size_t wildcard = pattern.find_first_of("*?");
+    if (wildcard == qcc::String::npos) {
+        return advertised.find(pattern) != advertised.end();
+    }
+
+    qcc::String prefix = pattern.substr(0, wildcard);
+    for (set<qcc::String>::const_iterator it = advertised.lower_bound(prefix); it != advertised.end(); ++it) {
+        if (it->compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        if (WildcardMatch(*it, pattern) == false) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void IpNameServiceImpl::HandleProtocolQuestion(WhoHas whoHas, const qcc::IPEndpoint& endpoint, int32_t interfaceIndex, const qcc::IPAddress& localAddress)
 {
     QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolQuestion(%s)", endpoint.ToString().c_str()));
@@ -6786,40 +6810,24 @@ void IpNameServiceImpl::HandleProtocolQuestion(WhoHas whoHas, const qcc::IPEndpo
             // from V1 to support legacy thin core leaf nodes looking for router
             // nodes.
             //
-            for (set<qcc::String>::iterator j = m_advertised[index].begin(); m_enableV1 && (j != m_advertised[index].end()); ++j) {
-
-                //
-                // The requested name comes in from the WhoHas message and we
-                // allow wildcards there.
-                //
-                if (WildcardMatch((*j), wkn)) {
-                    QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolQuestion(): request for %s does not match my %s",
-                                   wkn.c_str(), (*j).c_str()));
-                    continue;
-                } else {
-                    respond = true;
-                    break;
-                }
+            //
+            // The requested name comes in from the WhoHas message and we
+            // allow wildcards there.
+            //
+            if (m_enableV1 && MatchAdvertisedName(m_advertised[index], wkn)) {
+                respond = true;
             }
 
             //
             // Check to see if this name on the list of names we quietly advertise.
             //
-            for (set<qcc::String>::iterator j = m_advertised_quietly[index].begin(); j != m_advertised_quietly[index].end(); ++j) {
-
-                //
-                // The requested name comes in from the WhoHas message and we
-                // allow wildcards there.
-                //
-                if (WildcardMatch((*j), wkn)) {
-                    QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolQuestion(): request for %s does not match my %s",
-                                   wkn.c_str(), (*j).c_str()));
-                    continue;
-                } else {
-                    respond = true;
-                    respondQuietly = true;
-                    break;
-                }
+            //
+            // The requested name comes in from the WhoHas message and we
+            // allow wildcards there.
+            //
+            if (MatchAdvertisedName(m_advertised_quietly[index], wkn)) {
+                respond = true;
+                respondQuietly = true;
             }
         }
 
@@ -7218,6 +7226,20 @@ void IpNameServiceImpl::HandleProtocolAnswer(IsAt isAt, uint32_t timer, const qc
 }
 
 
+//
+// FNV-1a over a received datagram.  Used only to recognize exact repeats of a
+// multicast burst; zero is reserved to mean "no digest".
+//
+static uint64_t DigestProtocolMessage(uint8_t const* buffer, uint32_t nbytes)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < nbytes; ++i) {
+        hash ^= buffer[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
 void IpNameServiceImpl::HandleProtocolMessage(uint8_t const* buffer, uint32_t nbytes, const qcc::IPEndpoint& endpoint, const uint16_t recvPort, int32_t interfaceIndex, const qcc::IPAddress& localAddress)
 {
     QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolMessage(0x%x, %d, %s)", buffer, nbytes, endpoint.ToString().c_str()));
@@ -7292,6 +7314,23 @@ void IpNameServiceImpl::HandleProtocolMessage(uint8_t const* buffer, uint32_t nb
         }
     } else {
         // Messages not received on port 9956 are version two messages.
+        //
+        // Senders repeat each multicast burst several times and every copy of
+        // a given burst is byte-for-byte identical.  Once one copy has been
+        // accepted by the MDNSPacketTracker the rest can be dropped here
+        // without paying for Deserialize().
+        //
+        uint64_t digest = DigestProtocolMessage(buffer, nbytes);
+        if (recvPort == MULTICAST_MDNS_PORT) {
+            m_mutex.Lock();
+            bool duplicate = IsDuplicateMDNSPacket(digest);
+            m_mutex.Unlock();
+            if (duplicate) {
+                QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolMessage(): Ignoring repeated datagram"));
+                return;
+            }
+        }
+
         MDNSPacket mdnsPacket;
         size_t bytesRead = mdnsPacket->Deserialize(buffer, nbytes);
         if (bytesRead != nbytes) {
@@ -7300,9 +7339,9 @@ void IpNameServiceImpl::HandleProtocolMessage(uint8_t const* buffer, uint32_t nb
         }
 
         if (mdnsPacket->GetHeader().GetQRType() == MDNSHeader::MDNS_QUERY) {
-            HandleProtocolQuery(mdnsPacket, endpoint, recvPort);
+            HandleProtocolQuery(mdnsPacket, endpoint, recvPort, digest);
         } else {
-            HandleProtocolResponse(mdnsPacket, endpoint, recvPort, interfaceIndex);
+            HandleProtocolResponse(mdnsPacket, endpoint, recvPort, interfaceIndex, digest);
         }
     }
 }
@@ -7352,6 +7391,7 @@ bool IpNameServiceImpl::AddToPeerInfoMap(const qcc::String& guid, const qcc::IPE
         std::set<PeerInfo> peerInfoList;
         peerInfoList.insert(peerInfo);
         m_peerInfoMap.insert(std::pair<qcc::String, std::set<PeerInfo> >(guid, peerInfoList));
+        m_peerShortGuids[GUID128(guid).ToShortString()] = guid;
         QCC_DbgHLPrintf(("Add to peer info map: %s", peerInfo.ToString(guid).c_str()));
     }
     m_mutex.Unlock();
@@ -7368,13 +7408,13 @@ bool IpNameServiceImpl::RemoveFromPeerInfoMap(const qcc::String& guid)
         }
         QCC_DbgHLPrintf(("Erase from peer info map: guid=%s", guid.c_str()));
         m_peerInfoMap.erase(guid);
-        unordered_map<pair<String, IPEndpoint>, uint16_t, HashPacketTracker, EqualPacketTracker>::iterator it1 = m_mdnsPacketTracker.begin();
-        while (it1 != m_mdnsPacketTracker.end()) {
-            if (it1->first.first == guid) {
-                m_mdnsPacketTracker.erase(it1++);
-            } else {
-                it1++;
+        m_peerShortGuids.erase(GUID128(guid).ToShortString());
+        std::unordered_map<qcc::String, std::vector<PacketTrackerEntry>, Hash, Equal>::iterator it1 = m_mdnsPacketTracker.find(guid);
+        if (it1 != m_mdnsPacketTracker.end()) {
+            for (std::vector<PacketTrackerEntry>::iterator eit = it1->second.begin(); eit != it1->second.end(); ++eit) {
+                ForgetMDNSPacketDigest(eit->digest);
             }
+            m_mdnsPacketTracker.erase(it1);
         }
         m_mutex.Unlock();
         return true;
@@ -7383,41 +7423,103 @@ bool IpNameServiceImpl::RemoveFromPeerInfoMap(const qcc::String& guid)
     return false;
 }
 
-bool IpNameServiceImpl::UpdateMDNSPacketTracker(qcc::String guid, IPEndpoint endpoint, uint16_t burstId)
+//
+// Burst ids are tracked in buckets of PACKET_TRACKER_BUCKET_MS.  Entries that
+// have not been refreshed for PACKET_TRACKER_TTL_BUCKETS buckets belong to
+// peers that have gone quiet and are swept out so the tracker stays bounded.
+//
+const uint32_t PACKET_TRACKER_BUCKET_MS = 120 * 1000;
+const uint32_t PACKET_TRACKER_TTL_BUCKETS = 3;
+
+void IpNameServiceImpl::ForgetMDNSPacketDigest(uint64_t digest)
+{
+    if (digest) {
+        std::unordered_multiset<uint64_t>::iterator it = m_mdnsPacketDigests.find(digest);
+        if (it != m_mdnsPacketDigests.end()) {
+            m_mdnsPacketDigests.erase(it);
+        }
+    }
+}
+
+bool IpNameServiceImpl::IsDuplicateMDNSPacket(uint64_t digest)
+{
+    return digest && (m_mdnsPacketDigests.find(digest) != m_mdnsPacketDigests.end());
+}
+
+void IpNameServiceImpl::PurgeMDNSPacketTracker(uint32_t bucket)
+{
+    std::unordered_map<qcc::String, std::vector<PacketTrackerEntry>, Hash, Equal>::iterator it = m_mdnsPacketTracker.begin();
+    while (it != m_mdnsPacketTracker.end()) {
+        std::vector<PacketTrackerEntry>& entries = it->second;
+        for (size_t i = 0; i < entries.size();) {
+            if ((bucket - entries[i].bucket) >= PACKET_TRACKER_TTL_BUCKETS) {
+                ForgetMDNSPacketDigest(entries[i].digest);
+                entries[i] = entries.back();
+                entries.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        if (entries.empty()) {
+            m_mdnsPacketTracker.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+    m_mdnsPacketTrackerBucket = bucket;
+}
+
+bool IpNameServiceImpl::UpdateMDNSPacketTracker(qcc::String guid, IPEndpoint endpoint, uint16_t burstId, uint64_t digest)
 {
     //QCC_DbgPrintf(("IpNameServiceImpl::UpdateMDNSPacketTracker(%s, %s,%d)", guid.c_str(), endpoint.ToString().c_str(), burstId));
 
+    uint32_t bucket = static_cast<uint32_t>(GetTimestamp64() / PACKET_TRACKER_BUCKET_MS);
+    if (bucket != m_mdnsPacketTrackerBucket) {
+        PurgeMDNSPacketTracker(bucket);
+    }
+
     //
     // We check for the entry in MDNSPacketTracker
     // If we find it we return false since that implies that we have seen a packet from this burst
     // If we do not find it we return true that implies that we have not seen a packet from this burst.
     //     We add/update the guid with this burst id
     //
-    pair<String, IPEndpoint> key(guid, endpoint);
-    unordered_map<pair<String, IPEndpoint>, uint16_t, HashPacketTracker, EqualPacketTracker>::iterator it = m_mdnsPacketTracker.find(key);
-    // Check if the GUID is present in the Map
-    // If Yes check if the incoming burst id is same or lower
-    if (it != m_mdnsPacketTracker.end()) {
-        // Drop the packet if burst id is lower or same
-        if (it->second >= burstId) {
-            return false;
-        }
-        // Update the last seen burst id from this guid
-        else {
-            it->second = burstId;
+    std::vector<PacketTrackerEntry>& entries = m_mdnsPacketTracker[guid];
+    for (std::vector<PacketTrackerEntry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        if (it->endpoint == endpoint) {
+            // Drop the packet if burst id is lower or same
+            if (it->burstId >= burstId) {
+                return false;
+            }
+            // Update the last seen burst id from this guid
+            it->burstId = burstId;
+            it->bucket = bucket;
+            if (it->digest != digest) {
+                ForgetMDNSPacketDigest(it->digest);
+                it->digest = digest;
+                if (digest) {
+                    m_mdnsPacketDigests.insert(digest);
+                }
+            }
             return true;
         }
     }
+
     // GUID is not present in the Map so we add the entry
-    else {
-        m_mdnsPacketTracker[key] = burstId;
-        return true;
+    PacketTrackerEntry entry;
+    entry.endpoint = endpoint;
+    entry.burstId = burstId;
+    entry.digest = digest;
+    entry.bucket = bucket;
+    entries.push_back(entry);
+    if (digest) {
+        m_mdnsPacketDigests.insert(digest);
     }
     return true;
 }
 
 
-void IpNameServiceImpl::HandleProtocolResponse(MDNSPacket mdnsPacket, IPEndpoint endpoint, uint16_t recvPort, int32_t interfaceIndex)
+void IpNameServiceImpl::HandleProtocolResponse(MDNSPacket mdnsPacket, IPEndpoint endpoint, uint16_t recvPort, int32_t interfaceIndex, uint64_t digest)
 {
     // Get IPv4 address of interface for this message (message may have been
     // received on the IPv6 address).  This will be used as a sanity check later
@@ -7585,7 +7687,7 @@ void IpNameServiceImpl::HandleProtocolResponse(MDNSPacket mdnsPacket, IPEndpoint
     //
     if (recvPort == MULTICAST_MDNS_PORT) {
         // We need to check if this packet is from a burst which we have seen before in which case we will ignore it
-        if (!UpdateMDNSPacketTracker(guid, ns4, refRData->GetSearchID())) {
+        if (!UpdateMDNSPacketTracker(guid, ns4, refRData->GetSearchID(), digest)) {
             QCC_DbgPrintf(("Ignoring response with duplicate burst ID"));
             m_mutex.Unlock();
             return;
@@ -7761,7 +7863,7 @@ bool IpNameServiceImpl::HandleAdvertiseResponse(MDNSPacket mdnsPacket, uint16_t
     return true;
 }
 
-void IpNameServiceImpl::HandleProtocolQuery(MDNSPacket mdnsPacket, IPEndpoint endpoint, uint16_t recvPort)
+void IpNameServiceImpl::HandleProtocolQuery(MDNSPacket mdnsPacket, IPEndpoint endpoint, uint16_t recvPort, uint64_t digest)
 {
     bool isAllJoynQuery = true;
     // Check if someone is asking about an alljoyn service.
@@ -7809,7 +7911,7 @@ void IpNameServiceImpl::HandleProtocolQuery(MDNSPacket mdnsPacket, IPEndpoint en
     //
     if (recvPort == MULTICAST_MDNS_PORT) {
         // We need to check if this packet is from a burst which we have seen before in which case we will ignore it
-        if (!UpdateMDNSPacketTracker(guid, ns4, refRData->GetSearchID())) {
+        if (!UpdateMDNSPacketTracker(guid, ns4, refRData->GetSearchID(), digest)) {
             QCC_DbgPrintf(("Ignoring query with duplicate burst ID"));
             m_mutex.Unlock();
             return;
@@ -7899,40 +8001,24 @@ bool IpNameServiceImpl::HandleSearchQuery(TransportMask completeTransportMask, M
             //
             // Check to see if this name on the list of names we actively advertise.
             //
-            for (set<String>::iterator j = m_advertised[index].begin(); j != m_advertised[index].end(); ++j) {
-
-                //
-                // The requested name comes in from the WhoHas message and we
-                // allow wildcards there.
-                //
-                if (WildcardMatch((*j), wkn)) {
-                    QCC_DbgPrintf(("IpNameServiceImpl::HandleSearchQuery(): request for %s does not match my %s",
-                                   wkn.c_str(), (*j).c_str()));
-                    continue;
-                } else {
-                    respond = true;
-                    break;
-                }
+            //
+            // The requested name comes in from the search message and we
+            // allow wildcards there.
+            //
+            if (MatchAdvertisedName(m_advertised[index], wkn)) {
+                respond = true;
             }
 
             //
             // Check to see if this name on the list of names we quietly advertise.
             //
-            for (set<String>::iterator j = m_advertised_quietly[index].begin(); j != m_advertised_quietly[index].end(); ++j) {
-
-                //
-                // The requested name comes in from the WhoHas message and we
-                // allow wildcards there.
-                //
-                if (WildcardMatch((*j), wkn)) {
-                    QCC_DbgPrintf(("IpNameServiceImpl::HandleSearchQuery(): request for %s does not match my %s",
-                                   wkn.c_str(), (*j).c_str()));
-                    continue;
-                } else {
-                    respond = true;
-                    respondQuietly = true;
-                    break;
-                }
+            //
+            // The requested name comes in from the search message and we
+            // allow wildcards there.
+            //
+            if (MatchAdvertisedName(m_advertised_quietly[index], wkn)) {
+                respond = true;
+                respondQuietly = true;
             }
         }
         //
@@ -1188,20 +1188,20 @@ class IpNameServiceImpl : public qcc::Thread {
      * @internal
      * @brief Do something with a received MDNS protocol query.
      */
-    void HandleProtocolQuery(MDNSPacket packet, qcc::IPEndpoint endpoint, uint16_t recvPort);
+    void HandleProtocolQuery(MDNSPacket packet, qcc::IPEndpoint endpoint, uint16_t recvPort, uint64_t digest);
 
     /**
      * @internal
      * @brief Do something with a received MDNS protocol response.
      */
-    void HandleProtocolResponse(MDNSPacket mdnsPacket, qcc::IPEndpoint endpoint, uint16_t recvPort, int32_t interfaceIndex);
+    void HandleProtocolResponse(MDNSPacket mdnsPacket, qcc::IPEndpoint endpoint, uint16_t recvPort, int32_t interfaceIndex, uint64_t digest);
 
     /**
      * @internal
      * @brief Update the MDNSPacketTracker which is useful for keep track of burst and
      *        not responding to each packet of a burst
      */
-    bool UpdateMDNSPacketTracker(qcc::String guid, qcc::IPEndpoint endpoint, uint16_t burstId);
+    bool UpdateMDNSPacketTracker(qcc::String guid, qcc::IPEndpoint endpoint, uint16_t burstId, uint64_t digest = 0);
 
     /**
      * One possible callback for each of the corresponding transport masks in a
@@ -1566,21 +1566,51 @@ class IpNameServiceImpl : public qcc::Thread {
     };
 
     /**
-     * Hash functor for PacketTracker Key
+     * Burst tracking state for one (guid, ns4) pair.  The digest of the datagram that carried the
+     * most recent burst lets HandleProtocolMessage() drop exact repeats of it before parsing.
      */
-    struct HashPacketTracker {
-        inline size_t operator()(const std::pair<qcc::String, qcc::IPEndpoint>& s) const {
-            qcc::String str = s.first + s.second.ToString();
-            return qcc::hash_string(str.c_str());
-        }
+    struct PacketTrackerEntry {
+        qcc::IPEndpoint endpoint;   /**< The sender's IPv4 name service endpoint */
+        uint16_t burstId;           /**< Most recent burst id seen */
+        uint64_t digest;            /**< Digest of the datagram that carried burstId (0 if unknown) */
+        uint32_t bucket;            /**< TTL bucket in which the entry was last updated */
     };
 
-    struct EqualPacketTracker {
-        inline bool operator()(const std::pair<qcc::String, qcc::IPEndpoint>& s1, const std::pair<qcc::String, qcc::IPEndpoint>& s2) const {
-            return (s1.first == s2.first) && (s1.second == s2.second);
-        }
-    };
-    std::unordered_map<std::pair<qcc::String, qcc::IPEndpoint>, uint16_t, HashPacketTracker, EqualPacketTracker> m_mdnsPacketTracker;
+    /**
+     * Tracker entries keyed by guid so that all state for a peer can be found (and purged) with
+     * one hashed lookup.
+     */
+    std::unordered_map<qcc::String, std::vector<PacketTrackerEntry>, Hash, Equal> m_mdnsPacketTracker;
+
+    /**
+     * Digests of the datagrams recorded in m_mdnsPacketTracker.
+     */
+    std::unordered_multiset<uint64_t> m_mdnsPacketDigests;
+
+    /**
+     * The TTL bucket of the last m_mdnsPacketTracker sweep.
+     */
+    uint32_t m_mdnsPacketTrackerBucket;
+
+    /**
+     * @internal
+     * @brief Remove m_mdnsPacketTracker entries that have not been updated for
+     *        PACKET_TRACKER_TTL_BUCKETS buckets.
+     */
+    void PurgeMDNSPacketTracker(uint32_t bucket);
+
+    /**
+     * @internal
+     * @brief Check whether a received datagram is an exact copy of one that already
+     *        updated the MDNSPacketTracker and can therefore be dropped unparsed.
+     */
+    bool IsDuplicateMDNSPacket(uint64_t digest);
+
+    /**
+     * @internal
+     * @brief Drop one reference to a datagram digest from m_mdnsPacketDigests.
+     */
+    void ForgetMDNSPacketDigest(uint64_t digest);
 
     /*
      * PeerInfo holds the information about a peer for which we know the unicast address
@@ -1596,14 +1626,28 @@ class IpNameServiceImpl : public qcc::Thread {
         { }
         qcc::String ToString(const qcc::String& guid) const;
         bool operator<(const PeerInfo& other) const {
-            return unicastInfo.ToString() < other.unicastInfo.ToString();
+            const qcc::IPAddress& addr = unicastInfo.addr;
+            const qcc::IPAddress& otherAddr = other.unicastInfo.addr;
+            if (addr.Size() != otherAddr.Size()) {
+                return addr.Size() < otherAddr.Size();
+            }
+            int cmp = memcmp(addr.GetIPReference(), otherAddr.GetIPReference(), addr.Size());
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+            return unicastInfo.port < other.unicastInfo.port;
         }
         bool operator==(const PeerInfo& other) const {
-            return unicastInfo.ToString() == other.unicastInfo.ToString();
+            return unicastInfo == other.unicastInfo;
         }
     };
 
     std::unordered_map<qcc::String, std::set<PeerInfo>, Hash, Equal> m_peerInfoMap;
+
+    /**
+     * Short (GUID128::ToShortString()) to long guid index for the guids in m_peerInfoMap.
+     */
+    std::unordered_map<qcc::String, qcc::String, Hash, Equal> m_peerShortGuids;
     void PrintPeerInfoMap();
 
     class BurstExpiryHandler;
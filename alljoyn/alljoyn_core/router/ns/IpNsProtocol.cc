@@ -1619,130 +1619,161 @@ size_t _NSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     return size;
 }
 
-//MDNSDomainName
-void MDNSDomainName::SetName(String name)
-{
-    m_name = name;
-}
-
-String MDNSDomainName::GetName() const
-{
-    return m_name;
-}
-
-MDNSDomainName::MDNSDomainName()
-{
-}
-
-MDNSDomainName::~MDNSDomainName()
-{
-}
-
-size_t MDNSDomainName::GetSerializedSize(std::map<qcc::String, uint32_t>& offsets) const
+//
+// Domain names are encoded as a sequence of length-prefixed labels, ending
+// either in a zero length label or in a two octet pointer to the remainder of
+// the name somewhere earlier in the datagram.  The helpers below are shared by
+// MDNSDomainName and MDNSPtrRData.
+//
+static size_t GetSerializedNameSize(const String& name, std::map<qcc::String, uint32_t>& offsets)
 {
     size_t size = 0;
-    String name = m_name;
+    size_t pos = 0;
     while (true) {
-        if (name.empty()) {
+        if (pos >= name.size()) {
             size++;
             break;
-        } else if (offsets.find(name) != offsets.end()) {
-            size++;
-            size++;
+        }
+        String suffix = name.substr(pos);
+        if (offsets.find(suffix) != offsets.end()) {
+            size += 2;
             break;
-        } else {
-            offsets[name] = 0; /* 0 is used as a placeholder so that the serialized size is computed correctly */
-            size_t newPos = name.find_first_of('.');
-            String temp = name.substr(0, newPos);
-            size++;
-            size += temp.length();
-            size_t pos = (newPos == String::npos) ? String::npos : (newPos + 1);
-            name = name.substr(pos);
         }
+        offsets[suffix] = 0; /* 0 is used as a placeholder so that the serialized size is computed correctly */
+        size_t newPos = name.find_first_of('.', pos);
+        size_t len = ((newPos == String::npos) ? name.size() : newPos) - pos;
+        size += 1 + len;
+        pos = (newPos == String::npos) ? name.size() : (newPos + 1);
     }
     return size;
 }
 
-size_t MDNSDomainName::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>& offsets, uint32_t headerOffset) const
+static size_t SerializeName(const String& name, uint8_t* buffer, std::map<qcc::String, uint32_t>& offsets, uint32_t headerOffset)
 {
     size_t size = 0;
-    String name = m_name;
+    size_t pos = 0;
     while (true) {
-        if (name.empty()) {
+        if (pos >= name.size()) {
             buffer[size++] = 0;
             break;
-        } else if (offsets.find(name) != offsets.end()) {
-            buffer[size++] = 0xc0 | ((offsets[name] & 0xFF00) >> 8);
-            buffer[size++] = (offsets[name] & 0xFF);
+        }
+        String suffix = name.substr(pos);
+        std::map<qcc::String, uint32_t>::iterator it = offsets.find(suffix);
+        if (it != offsets.end()) {
+            buffer[size++] = 0xc0 | ((it->second & 0xFF00) >> 8);
+            buffer[size++] = (it->second & 0xFF);
             break;
-        } else {
-            offsets[name] = size + headerOffset;
-            size_t newPos = name.find_first_of('.');
-            String temp = name.substr(0, newPos);
-            buffer[size++] = temp.length();
-            memcpy(reinterpret_cast<void*>(&buffer[size]), const_cast<void*>(reinterpret_cast<const void*>(temp.c_str())), temp.size());
-            size += temp.length();
-            size_t pos = (newPos == String::npos) ? String::npos : (newPos + 1);
-            name = name.substr(pos);
         }
+        offsets[suffix] = size + headerOffset;
+        size_t newPos = name.find_first_of('.', pos);
+        size_t len = ((newPos == String::npos) ? name.size() : newPos) - pos;
+        buffer[size++] = len;
+        memcpy(&buffer[size], name.c_str() + pos, len);
+        size += len;
+        pos = (newPos == String::npos) ? name.size() : (newPos + 1);
     }
     return size;
 }
 
-size_t MDNSDomainName::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+//
+// Decode the name starting at offset in the datagram, following compression
+// pointers in place.  Labels must lie below end, and each pointer must point
+// strictly before the position it was read from, which both keeps reads in
+// bounds and guarantees termination on malformed packets.  Returns the number
+// of octets the name occupies at offset, or zero and an empty name on error.
+//
+static size_t DeserializeName(uint8_t const* packet, uint32_t offset, uint32_t end, String& name)
 {
-    m_name.clear();
+    name.clear();
     size_t size = 0;
-    if (bufsize < 1) {
-        QCC_DbgPrintf(("MDNSDomainName::Deserialize(): Insufficient bufsize %d", bufsize));
-        return 0;
-    }
-    vector<uint32_t> offsets;
-
-    while (bufsize > 0) {
-        if (((buffer[size] & 0xc0) >> 6) == 3 && bufsize > 1) {
-            uint32_t pointer = ((buffer[size] << 8 | buffer[size + 1]) & 0x3FFF);
-            if (compressedOffsets.find(pointer) != compressedOffsets.end()) {
-                if (m_name.length() > 0) {
-                    m_name.append('.');
-                }
-                m_name.append(compressedOffsets[pointer]);
-                size += 2;
-                break;
-            } else {
+    uint32_t pos = offset;
+    while (true) {
+        if (pos >= end) {
+            name.clear();
+            return 0;
+        }
+        uint8_t len = packet[pos];
+        if ((len & 0xc0) == 0xc0) {
+            if (pos + 1 >= end) {
+                name.clear();
                 return 0;
             }
+            uint32_t pointer = ((len << 8) | packet[pos + 1]) & 0x3FFF;
+            if (pointer >= pos) {
+                QCC_DbgPrintf(("DeserializeName(): Invalid compression pointer %d at %d", pointer, pos));
+                name.clear();
+                return 0;
+            }
+            if (size == 0) {
+                size = pos + 2 - offset;
+            }
+            end = pos;
+            pos = pointer;
+            continue;
         }
-        size_t temp_size = buffer[size++];
-        bufsize--;
-        //
-        // If there's not enough data in the buffer then bail.
-        //
-        if (bufsize < temp_size) {
-            QCC_DbgPrintf(("MDNSDomainName::Deserialize(): Insufficient bufsize %d", bufsize));
-            return 0;
+        ++pos;
+        if (len == 0) {
+            if (!name.empty()) {
+                name.append('.');
+            }
+            break;
         }
-        if (m_name.length() > 0) {
-            m_name.append('.');
+        if (pos + len > end) {
+            QCC_DbgPrintf(("DeserializeName(): Insufficient bufsize %d", end - pos));
+            name.clear();
+            return 0;
         }
-        if (temp_size > 0) {
-            offsets.push_back(headerOffset + size - 1);
-            m_name.append(reinterpret_cast<const char*>(buffer + size), temp_size);
-            bufsize -= temp_size;
-            size += temp_size;
-        } else {
-            break;
+        if (!name.empty()) {
+            name.append('.');
         }
-
+        name.append(reinterpret_cast<const char*>(packet + pos), len);
+        pos += len;
     }
-
-    for (uint32_t i = 0; i < offsets.size(); ++i) {
-        compressedOffsets[offsets[i]] = m_name.substr(offsets[i] - headerOffset);
+    if (size == 0) {
+        size = pos - offset;
     }
-
     return size;
 }
 
+//MDNSDomainName
+void MDNSDomainName::SetName(String name)
+{
+    m_name = name;
+}
+
+String MDNSDomainName::GetName() const
+{
+    return m_name;
+}
+
+MDNSDomainName::MDNSDomainName()
+{
+}
+
+MDNSDomainName::~MDNSDomainName()
+{
+}
+
+size_t MDNSDomainName::GetSerializedSize(std::map<qcc::String, uint32_t>& offsets) const
+{
+    return GetSerializedNameSize(m_name, offsets);
+}
+
+size_t MDNSDomainName::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>& offsets, uint32_t headerOffset) const
+{
+    return SerializeName(m_name, buffer, offsets, headerOffset);
+}
+
+size_t MDNSDomainName::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
+{
+    if (bufsize < 1) {
+        QCC_DbgPrintf(("MDNSDomainName::Deserialize(): Insufficient bufsize %d", bufsize));
+        m_name.clear();
+        return 0;
+    }
+    return DeserializeName(buffer - headerOffset, headerOffset, headerOffset + bufsize, m_name);
+}
+
 //MDNSQuestion
 MDNSQuestion::MDNSQuestion(qcc::String qName, uint16_t qType, uint16_t qClass) :
     m_qType(qType),
@@ -1802,10 +1833,10 @@ size_t MDNSQuestion::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>&
     return size + 4;
 }
 
-size_t MDNSQuestion::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSQuestion::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     // Deserialize the QNAME first
-    size_t size = m_qName.Deserialize(buffer, bufsize, compressedOffsets, headerOffset);
+    size_t size = m_qName.Deserialize(buffer, bufsize, headerOffset);
     if (size >= bufsize) {
         return 0;
     }
@@ -1917,7 +1948,7 @@ size_t MDNSResourceRecord::Serialize(uint8_t* buffer, std::map<qcc::String, uint
     return size;
 }
 
-size_t MDNSResourceRecord::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSResourceRecord::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     if (m_rdata) {
         delete m_rdata;
@@ -1926,7 +1957,7 @@ size_t MDNSResourceRecord::Deserialize(uint8_t const* buffer, uint32_t bufsize,
     //
     // Deserialize the NAME first
     //
-    size_t size = m_rrDomainName.Deserialize(buffer, bufsize, compressedOffsets, headerOffset);
+    size_t size = m_rrDomainName.Deserialize(buffer, bufsize, headerOffset);
     if (size == 0 || bufsize < 8) {
         //error
         QCC_DbgPrintf((" MDNSResourceRecord::Deserialize() Error occured while deserializing domain name or insufficient buffer"));
@@ -1989,7 +2020,7 @@ size_t MDNSResourceRecord::Deserialize(uint8_t const* buffer, uint32_t bufsize,
     size += 8;
     headerOffset += size;
     uint8_t const* p = &buffer[size];
-    size_t processed = m_rdata->Deserialize(p, bufsize, compressedOffsets, headerOffset);
+    size_t processed = m_rdata->Deserialize(p, bufsize, headerOffset);
     if (!processed) {
         QCC_DbgPrintf(("MDNSResourceRecord::Deserialize() Error occured while deserializing resource data"));
         return 0;
@@ -2063,7 +2094,7 @@ size_t MDNSDefaultRData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32
     return 0;
 }
 
-size_t MDNSDefaultRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSDefaultRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     //
     // If there's not enough data in the buffer to even get the string size out
@@ -2255,7 +2286,7 @@ size_t MDNSTextRData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>
     return rdlen + 2;
 }
 
-size_t MDNSTextRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSTextRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     //
     // If there's not enough data in the buffer to even get the string size out
@@ -2280,18 +2311,24 @@ size_t MDNSTextRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::
     uint8_t const* p = &buffer[2];
     while (rdlen > 0 && bufsize > 0) {
         uint8_t sz = *p++;
-        String str;
         bufsize--;
         if (bufsize < sz) {
             QCC_DbgPrintf(("MDNSTextRecord::Deserialize(): Insufficient bufsize %d", bufsize));
             return 0;
         }
-        str.assign(reinterpret_cast<const char*>(p), sz);
-        size_t eqPos = str.find_first_of('=', 0);
-        if (eqPos != String::npos) {
-            m_fields[str.substr(0, eqPos)] = str.substr(eqPos + 1);
+        //
+        // Split the key=value pair in place rather than going through an
+        // intermediate string.
+        //
+        const char* str = reinterpret_cast<const char*>(p);
+        const char* eq = static_cast<const char*>(memchr(str, '=', sz));
+        size_t keyLen = eq ? (eq - str) : sz;
+        size_t valueLen = eq ? (sz - keyLen - 1) : 0;
+        String& value = m_fields[keyLen ? String(str, keyLen) : String()];
+        if (valueLen) {
+            value.assign(eq + 1, valueLen);
         } else {
-            m_fields[str.substr(0, eqPos)] = String();
+            value.clear();
         }
         p += sz;
         rdlen -= sz + 1;
@@ -2336,7 +2373,7 @@ size_t MDNSARData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>& o
     return 6;
 }
 
-size_t MDNSARData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSARData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
 
     if (bufsize < 6) {
@@ -2380,7 +2417,7 @@ size_t MDNSAAAARData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>
     return 18;
 }
 
-size_t MDNSAAAARData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSAAAARData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     if (bufsize < 18) {
         QCC_DbgPrintf(("MDNSTextRecord::Deserialize(): Insufficient bufsize %d", bufsize));
@@ -2409,58 +2446,18 @@ qcc::String MDNSPtrRData::GetPtrDName() const
 
 size_t MDNSPtrRData::GetSerializedSize(std::map<qcc::String, uint32_t>& offsets) const
 {
-    size_t size = 2;
-    String name = m_rdataStr;
-    while (true) {
-        if (name.empty()) {
-            size++;
-            break;
-        } else if (offsets.find(name) != offsets.end()) {
-            size++;
-            size++;
-            break;
-        } else {
-            offsets[name] = 0; /* 0 is used as a placeholder so that the serialized size is computed correctly */
-            size_t newPos = name.find_first_of('.');
-            String temp = name.substr(0, newPos);
-            size++;
-            size += temp.length();
-            size_t pos = (newPos == String::npos) ? String::npos : (newPos + 1);
-            name = name.substr(pos);
-        }
-    }
-    return size;
+    return 2 + GetSerializedNameSize(m_rdataStr, offsets);
 }
 
 size_t MDNSPtrRData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>& offsets, uint32_t headerOffset) const
 {
-    size_t size = 2;
-    String name = m_rdataStr;
-    while (true) {
-        if (name.empty()) {
-            buffer[size++] = 0;
-            break;
-        } else if (offsets.find(name) != offsets.end()) {
-            buffer[size++] = 0xc0 | ((offsets[name] & 0xFF00) >> 8);
-            buffer[size++] = (offsets[name] & 0xFF);
-            break;
-        } else {
-            offsets[name] = size + headerOffset;
-            size_t newPos = name.find_first_of('.');
-            String temp = name.substr(0, newPos);
-            buffer[size++] = temp.length();
-            memcpy(reinterpret_cast<void*>(&buffer[size]), const_cast<void*>(reinterpret_cast<const void*>(temp.c_str())), temp.size());
-            size += temp.length();
-            size_t pos = (newPos == String::npos) ? String::npos : (newPos + 1);
-            name = name.substr(pos);
-        }
-    }
+    size_t size = 2 + SerializeName(m_rdataStr, &buffer[2], offsets, headerOffset + 2);
     buffer[0] = ((size - 2) & 0xFF00) >> 8;
     buffer[1] = ((size - 2) & 0xFF);
     return size;
 }
 
-size_t MDNSPtrRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSPtrRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
     m_rdataStr.clear();
     //
@@ -2475,10 +2472,7 @@ size_t MDNSPtrRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::m
     uint16_t szStr = buffer[0] << 8 | buffer[1];
     bufsize -= 2;
 
-    size_t size = 2;
-
-    vector<uint32_t> offsets;
-
+    //
     // If there's not enough data in the buffer then bail.
     //
     if (bufsize < szStr) {
@@ -2486,47 +2480,11 @@ size_t MDNSPtrRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::m
         return 0;
     }
 
-    while (bufsize > 0) {
-        if (((buffer[size] & 0xc0) >> 6) == 3 && bufsize > 1) {
-            uint32_t pointer = ((buffer[size] << 8 | buffer[size + 1]) & 0x3FFF);
-            if (compressedOffsets.find(pointer) != compressedOffsets.end()) {
-                if (m_rdataStr.length() > 0) {
-                    m_rdataStr.append('.');
-                }
-                m_rdataStr.append(compressedOffsets[pointer]);
-                size += 2;
-                break;
-            } else {
-                return 0;
-            }
-        }
-        size_t temp_size = buffer[size++];
-        bufsize--;
-        //
-        // If there's not enough data in the buffer then bail.
-        //
-        if (bufsize < temp_size) {
-            QCC_DbgPrintf(("MDNSPtrRecord::Deserialize(): Insufficient bufsize %d", bufsize));
-            return 0;
-        }
-        if (m_rdataStr.length() > 0) {
-            m_rdataStr.append('.');
-        }
-        if (temp_size > 0) {
-            offsets.push_back(headerOffset + size - 1);
-            m_rdataStr.append(reinterpret_cast<const char*>(buffer + size), temp_size);
-            bufsize -= temp_size;
-            size += temp_size;
-        } else {
-            break;
-        }
-    }
-
-    for (uint32_t i = 0; i < offsets.size(); ++i) {
-        compressedOffsets[offsets[i]] = m_rdataStr.substr(offsets[i] - 2 - headerOffset);
+    size_t size = DeserializeName(buffer - headerOffset, headerOffset + 2, headerOffset + 2 + bufsize, m_rdataStr);
+    if (size == 0) {
+        return 0;
     }
-
-    return size;
+    return size + 2;
 }
 
 //MDNSSrvRData
@@ -2611,7 +2569,7 @@ size_t MDNSSrvRData::Serialize(uint8_t* buffer, std::map<qcc::String, uint32_t>&
     return size;
 }
 
-size_t MDNSSrvRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset)
+size_t MDNSSrvRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset)
 {
 
 //
@@ -2642,7 +2600,7 @@ size_t MDNSSrvRData::Deserialize(uint8_t const* buffer, uint32_t bufsize, std::m
     size_t size = 8;
     headerOffset += 8;
     uint8_t const* p = &buffer[size];
-    size += m_target.Deserialize(p, bufsize, compressedOffsets, headerOffset);
+    size += m_target.Deserialize(p, bufsize, headerOffset);
 
     return size;
 }
@@ -3570,7 +3528,6 @@ size_t _MDNSPacket::Serialize(uint8_t* buffer) const
 size_t _MDNSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
 {
     Clear();
-    std::map<uint32_t, qcc::String> compressedOffsets;
     size_t size = m_header.Deserialize(buffer, bufsize);
     size_t ret;
     if (size == 0) {
@@ -3589,7 +3546,7 @@ size_t _MDNSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     size_t headerOffset = size;
     for (int i = 0; i < m_header.GetQDCount(); i++) {
         MDNSQuestion q;
-        ret = q.Deserialize(p, bufsize, compressedOffsets, headerOffset);
+        ret = q.Deserialize(p, bufsize, headerOffset);
         if (ret == 0 || ret > bufsize) {
             QCC_DbgPrintf(("Error while deserializing question"));
             return 0;
@@ -3604,7 +3561,7 @@ size_t _MDNSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     }
     for (int i = 0; i < m_header.GetANCount(); i++) {
         MDNSResourceRecord r;
-        ret = r.Deserialize(p, bufsize, compressedOffsets, headerOffset);
+        ret = r.Deserialize(p, bufsize, headerOffset);
         if (ret == 0 || ret > bufsize) {
             QCC_DbgPrintf(("Error while deserializing answer"));
             return 0;
@@ -3618,7 +3575,7 @@ size_t _MDNSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     }
     for (int i = 0; i < m_header.GetNSCount(); i++) {
         MDNSResourceRecord r;
-        ret = r.Deserialize(p, bufsize, compressedOffsets, headerOffset);
+        ret = r.Deserialize(p, bufsize, headerOffset);
         if (ret == 0 || ret > bufsize) {
             QCC_DbgPrintf(("Error while deserializing NS"));
             return 0;
@@ -3632,7 +3589,7 @@ size_t _MDNSPacket::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     }
     for (int i = 0; i < m_header.GetARCount(); i++) {
         MDNSResourceRecord r;
-        ret = r.Deserialize(p, bufsize, compressedOffsets, headerOffset);
+        ret = r.Deserialize(p, bufsize, headerOffset);
 
         if (ret == 0 || ret > bufsize) {
             QCC_DbgPrintf(("Error while deserializing additional"));
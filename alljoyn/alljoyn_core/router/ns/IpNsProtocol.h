@@ -2093,7 +2093,7 @@ class MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset) = 0;
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset) = 0;
 
     /**
      * @internal
@@ -2165,7 +2165,7 @@ class MDNSDefaultRData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
 };
 /**
  * @internal
@@ -2334,7 +2334,7 @@ class MDNSTextRData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
 
   private:
     uint16_t version;
@@ -2454,7 +2454,7 @@ class MDNSARData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     qcc::String m_ipv4Addr;
 };
@@ -2538,7 +2538,7 @@ class MDNSAAAARData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     qcc::String m_ipv6Addr;
 };
@@ -2622,7 +2622,7 @@ class MDNSPtrRData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     qcc::String m_rdataStr;
 };
@@ -2696,15 +2696,20 @@ class MDNSDomainName {
      * @brief Deserialize a header wire-representation and all of its children
      * questinos and answers from the provided buffer with support for compression.
      *
+     * Compression pointers are resolved directly against the received datagram
+     * (which starts headerOffset bytes before buffer) rather than through a
+     * table of previously decoded names.
+     *
      * @see ProtocolElement::Deserialize()
      *
      * @param buffer The buffer to read the bytes from.
      * @param bufsize The number of bytes available in the buffer.
+     * @param headerOffset The offset of buffer from the start of the datagram.
      *
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     qcc::String m_name;
 };
@@ -2840,7 +2845,7 @@ class MDNSSrvRData : public MDNSRData {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    virtual size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     uint16_t m_priority;
     uint16_t m_weight;
@@ -3470,7 +3475,7 @@ class MDNSResourceRecord {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     MDNSDomainName m_rrDomainName;
     RRType m_rrType;
@@ -3597,7 +3602,7 @@ class MDNSQuestion {
      * @return The number of octets read from the buffer, or zero if an error
      * occurred.
      */
-    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, std::map<uint32_t, qcc::String>& compressedOffsets, uint32_t headerOffset);
+    size_t Deserialize(uint8_t const* buffer, uint32_t bufsize, uint32_t headerOffset);
   private:
     MDNSDomainName m_qName;
     uint16_t m_qType;
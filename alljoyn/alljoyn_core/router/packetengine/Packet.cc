@@ -75,6 +75,7 @@ Packet::Packet(size_t _mtu) :
     sendTs(0),
     sendAttempts(0),
     fastRetransmit(false),
+    next(NULL),
     mtu(_mtu),
     crc16(0),
     version(0)
@@ -93,6 +94,7 @@ Packet::Packet(const Packet& other) :
     sendTs(other.sendTs),
     sendAttempts(other.sendAttempts),
     fastRetransmit(other.fastRetransmit),
+    next(NULL),
     mtu(other.mtu),
     crc16(other.crc16),
     version(other.version)
@@ -232,6 +234,7 @@ void Packet::Clean()
     sendTs = 0;
     sendAttempts = 0;
     fastRetransmit = false;
+    next = NULL;
     crc16 = 0;
     version = 0;
 }
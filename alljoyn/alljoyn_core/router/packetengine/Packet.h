@@ -80,6 +80,7 @@ class Packet {
     uint64_t sendTs;       /* Timestampe when packet was last sent */
     uint16_t sendAttempts; /* Number of times this packet has been sent */
     bool fastRetransmit;   /* true iff packet has been fast retransmitted */
+    Packet* next;          /* Link used while the packet is in a PacketPool or PacketQueue */
 
     /** Constructor */
     Packet(size_t mtu);
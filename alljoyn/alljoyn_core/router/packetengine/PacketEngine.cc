@@ -347,9 +347,7 @@ QStatus PacketEngine::DeliverControlMsg(PacketEngine::ChannelInfo& ci, const voi
     p->seqNum = seqNum;
     p->flags = PACKET_FLAG_CONTROL;
     p->expireTs = static_cast<uint64_t>(-1);
-    ci.txLock.Lock();
-    ci.txControlQueue.push_back(p);
-    ci.txLock.Unlock();
+    ci.txControlQueue.Push(p);
     QStatus status = txPacketThread.Alert();
     return status;
 }
@@ -720,9 +718,9 @@ PacketEngine::ChannelInfo::~ChannelInfo()
     }
 
     txLock.Lock();
-    while (!txControlQueue.empty()) {
-        engine.pool.ReturnPacket(txControlQueue.front());
-        txControlQueue.pop_front();
+    Packet* p;
+    while ((p = txControlQueue.Pop()) != NULL) {
+        engine.pool.ReturnPacket(p);
     }
     txLock.Unlock();
 
@@ -902,6 +900,7 @@ PacketEngine::RxPacketThread::RxPacketThread(const qcc::String& engineName) : Th
 qcc::ThreadReturn STDCALL PacketEngine::RxPacketThread::Run(void* arg)
 {
     engine = reinterpret_cast<PacketEngine*>(arg);
+    PacketPool::Cache cache(engine->pool);
     vector<Event*> checkEvents, sigEvents;
     QStatus status = ER_OK;
     Event& stopEvent = GetStopEvent();
@@ -925,7 +924,7 @@ qcc::ThreadReturn STDCALL PacketEngine::RxPacketThread::Run(void* arg)
                 if (it != engine->packetStreams.end()) {
                     PacketStream& stream = *(it->second.first);
                     PacketEngineListener& listener = *(it->second.second);
-                    Packet* p = engine->pool.GetPacket();
+                    Packet* p = engine->pool.GetPacket(cache);
                     status = p->Unmarshal(stream);
                     engine->channelInfoLock.Unlock();
                     if (status == ER_OK) {
@@ -1553,9 +1552,8 @@ qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
             while ((ci = engine->AcquireNextChannelInfo(ci)) != NULL) {
                 ci->txLock.Lock();
                 /* Send all control messages */
-                while (!ci->txControlQueue.empty()) {
-                    Packet* p = ci->txControlQueue.front();
-                    ci->txControlQueue.pop_front();
+                Packet* p;
+                while ((p = ci->txControlQueue.Pop()) != NULL) {
                     p->Marshal();
                     status = ci->packetStream.PushPacketBytes(p->buffer, p->payloadLen + Packet::payloadOffset, ci->dest);
                     /* Closedown if control message was a disconnectRsp */
@@ -23,7 +23,6 @@
 
 #include <qcc/platform.h>
 #include <map>
-#include <deque>
 
 #include <qcc/Stream.h>
 #include <qcc/SocketStream.h>
@@ -148,7 +147,7 @@ class PacketEngine : public qcc::AlarmListener {
         uint16_t txFill, txDrain;
         uint16_t remoteRxDrain;
         uint16_t xOffSeqNum;
-        std::deque<Packet*> txControlQueue;
+        PacketQueue txControlQueue;
         int32_t txRttMean;
         int32_t txRttMeanVar;
         bool txRttInit;
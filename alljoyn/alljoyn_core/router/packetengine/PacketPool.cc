@@ -20,7 +20,7 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 #include <qcc/Mutex.h>
-
+#include <qcc/atomic.h>
 #include "PacketPool.h"
 
 using namespace std;
@@ -30,7 +30,64 @@ using namespace qcc;
 
 namespace ajn {
 
-PacketPool::PacketPool() : mtu(0), usedCount(0)
+/* Lock-free push of the chain first..last onto a list */
+static void PushChain(Packet* volatile* list, Packet* first, Packet* last)
+{
+    Packet* head;
+    do {
+        head = *list;
+        last->next = head;
+    } while (!CompareAndExchangePointer(reinterpret_cast<void* volatile*>(list), head, first));
+}
+
+/* Lock-free removal of all packets on a list */
+static Packet* TakeAll(Packet* volatile* list)
+{
+    Packet* head;
+    do {
+        head = *list;
+    } while (head && !CompareAndExchangePointer(reinterpret_cast<void* volatile*>(list), head, NULL));
+    return head;
+}
+
+void PacketQueue::Push(Packet* p)
+{
+    PushChain(&head, p, p);
+}
+
+Packet* PacketQueue::Pop()
+{
+    if (!pending) {
+        /* Reverse the pushed packets so the oldest is returned first */
+        Packet* p = TakeAll(&head);
+        while (p) {
+            Packet* next = p->next;
+            p->next = pending;
+            pending = p;
+            p = next;
+        }
+    }
+    Packet* p = pending;
+    if (p) {
+        pending = p->next;
+        p->next = NULL;
+    }
+    return p;
+}
+
+PacketPool::Cache::~Cache()
+{
+    if (head) {
+        Packet* last = head;
+        while (last->next) {
+            last = last->next;
+        }
+        PushChain(&pool.freeList, head, last);
+        head = NULL;
+    }
+}
+
+PacketPool::PacketPool() : mtu(0), sharedCache(*this), freeList(NULL), freeCount(0), usedCount(0)
 {
 }
 
@@ -48,47 +105,81 @@ QStatus PacketPool::Stop()
 PacketPool::~PacketPool()
 {
     lock.Lock();
-    std::vector<Packet*>::iterator it = freeList.begin();
-    for (; it != freeList.end(); ++it) {
-        Packet* p = *it;
+    Packet* p = sharedCache.head;
+    sharedCache.head = NULL;
+    lock.Unlock();
+    while (p) {
+        Packet* next = p->next;
+        delete p;
+        p = next;
+    }
+    p = TakeAll(&freeList);
+    while (p) {
+        Packet* next = p->next;
         delete p;
+        p = next;
+    }
+}
+
+void PacketPool::Refill(Cache& cache)
+{
+    Packet* p = TakeAll(&freeList);
+    if (p) {
+        Packet* last = p;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = cache.head;
+        cache.head = p;
     }
-    freeList.clear();
+}
+
+Packet* PacketPool::GetPacket()
+{
+#ifdef PACKET_LEAK_DEBUG
+    return new Packet(mtu);
+#else
+    lock.Lock();
+    Packet* p = GetPacket(sharedCache);
     lock.Unlock();
+    return p;
+#endif
 }
 
-Packet* PacketPool::GetPacket() {
+Packet* PacketPool::GetPacket(Cache& cache)
+{
     Packet* p = NULL;
 #ifdef PACKET_LEAK_DEBUG
     p = new Packet(mtu);
 #else
-    lock.Lock();
-    usedCount++;
-    if (freeList.size() > 0) {
-        p = freeList.back();
-        freeList.pop_back();
-        lock.Unlock();
+    IncrementAndFetch(&usedCount);
+    if (!cache.head) {
+        Refill(cache);
+    }
+    if (cache.head) {
+        p = cache.head;
+        cache.head = p->next;
+        p->next = NULL;
+        DecrementAndFetch(&freeCount);
     } else {
-        lock.Unlock();
         p = new Packet(mtu);
     }
 #endif
     return p;
 }
 
-void PacketPool::ReturnPacket(Packet* p) {
+void PacketPool::ReturnPacket(Packet* p)
+{
 #ifdef PACKET_LEAK_DEBUG
     delete p;
 #else
-    lock.Lock();
-    --usedCount;
-    if ((freeList.size() * 2) > usedCount) {
-        lock.Unlock();
+    int32_t used = DecrementAndFetch(&usedCount);
+    if ((freeCount * 2) > used) {
         delete p;
     } else {
         p->Clean();
-        freeList.push_back(p);
-        lock.Unlock();
+        PushChain(&freeList, p, p);
+        IncrementAndFetch(&freeCount);
     }
 #endif
 }
@@ -22,15 +22,61 @@
 #define _ALLJOYN_PACKETPOOL_H
 
 #include <qcc/platform.h>
-
-#include <vector>
+#include <qcc/Mutex.h>
 
 #include "Packet.h"
 
 namespace ajn {
 
+/**
+ * Multiple producer, single consumer queue of packets.
+ * Push() is lock-free and may be called from any thread. Pop() and IsEmpty() may only be called
+ * by one thread at a time.
+ */
+class PacketQueue {
+  public:
+    PacketQueue() : head(NULL), pending(NULL) { }
+
+    /* Add a packet to the end of the queue */
+    void Push(Packet* p);
+
+    /* Remove the packet at the front of the queue or return NULL if the queue is empty */
+    Packet* Pop();
+
+    bool IsEmpty() const { return !pending && !head; }
+
+  private:
+    /* Packets pushed since the last Pop() (newest first) */
+    Packet* volatile head;
+
+    /* Packets taken from head in FIFO order. Only touched by the consumer. */
+    Packet* pending;
+
+    PacketQueue(const PacketQueue& other);
+    PacketQueue& operator=(const PacketQueue& other);
+};
+
 class PacketPool {
   public:
+    /**
+     * Packets cached for use by a single thread. A thread that allocates packets frequently
+     * keeps a Cache so that GetPacket() does not need to take the pool lock.
+     */
+    class Cache {
+        friend class PacketPool;
+      public:
+        Cache(PacketPool& pool) : pool(pool), head(NULL) { }
+
+        ~Cache();
+
+      private:
+        PacketPool& pool;
+        Packet* head;
+
+        Cache(const Cache& other);
+        Cache& operator=(const Cache& other);
+    };
+
     PacketPool();
 
     QStatus Start(size_t mtu);
@@ -39,8 +85,13 @@ class PacketPool {
 
     ~PacketPool();
 
+    /* Get a packet using the pool's shared cache */
     Packet* GetPacket();
 
+    /* Get a packet using a cache owned by the calling thread */
+    Packet* GetPacket(Cache& cache);
+
+    /* Return a packet. This is lock-free and may be called from any thread */
     void ReturnPacket(Packet* p);
 
     uint32_t GetMTU() const { return mtu; }
@@ -48,8 +99,13 @@ class PacketPool {
   private:
     size_t mtu;
     qcc::Mutex lock;
-    std::vector<Packet*> freeList;
-    size_t usedCount;
+    Cache sharedCache;
+    Packet* volatile freeList;
+    volatile int32_t freeCount;
+    volatile int32_t usedCount;
+
+    /* Move all returned packets into a cache */
+    void Refill(Cache& cache);
 };
 
 }
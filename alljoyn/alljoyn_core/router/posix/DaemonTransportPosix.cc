@@ -36,6 +36,9 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "DaemonTransport.h"
+#if defined(QCC_OS_LINUX)
+#include "ShmStream.h"
+#endif
 #ifdef ENABLE_POLICYDB
 #include "PolicyDB.h"
 #endif
@@ -48,6 +51,17 @@ using namespace qcc;
 namespace ajn {
 
 const char* DaemonTransport::TransportName = "unix";
+#if defined(QCC_OS_LINUX)
+const char* DaemonShmTransport::TransportName = "shm";
+
+/*
+ * On Linux the endpoint stream can be moved onto shared memory, it behaves as
+ * a plain SocketStream until it is.
+ */
+typedef ShmStream DaemonStream;
+#else
+typedef SocketStream DaemonStream;
+#endif
 
 class _DaemonEndpoint;
 typedef qcc::ManagedObj<_DaemonEndpoint> DaemonEndpoint;
@@ -61,7 +75,7 @@ class _DaemonEndpoint : public _RemoteEndpoint {
   public:
 
     _DaemonEndpoint(DaemonTransport* transport, BusAttachment& bus, bool incoming, const qcc::String connectSpec, SocketFd sock) :
-        _RemoteEndpoint(bus, incoming, connectSpec, &stream, DaemonTransport::TransportName),
+        _RemoteEndpoint(bus, incoming, connectSpec, &stream, transport->GetTransportName()),
         m_transport(transport),
         processId(-1),
         stream(sock)
@@ -120,10 +134,19 @@ class _DaemonEndpoint : public _RemoteEndpoint {
         return _RemoteEndpoint::SetIdleTimeouts(reqIdleTimeout, reqProbeTimeout, maxIdleProbes);
     }
 
+#if defined(QCC_OS_LINUX)
+    /**
+     * Move the established connection onto shared memory.
+     *
+     * @param ringSize  Size in bytes of each shared memory ring.
+     */
+    QStatus OfferSharedMemory(uint32_t ringSize) { return stream.Offer(ringSize); }
+#endif
+
   private:
     DaemonTransport* m_transport;        /**< The DaemonTransport holding the connection */
     uint32_t processId;
-    SocketStream stream;
+    DaemonStream stream;
 };
 
 static const int CRED_TIMEOUT = 5000;  /**< Times out credentials exchange to avoid denial of service attack */
@@ -242,7 +265,8 @@ void* DaemonTransport::Run(void* arg)
             qcc::String redirection;
             static const bool truthiness = true;
             DaemonTransport* trans = this;
-            DaemonEndpoint conn = DaemonEndpoint(trans, bus, truthiness, DaemonTransport::TransportName, newSock);
+            const char* transportName = GetTransportName();
+            DaemonEndpoint conn = DaemonEndpoint(trans, bus, truthiness, transportName, newSock);
 
             conn->SetUserId(uid);
             conn->SetGroupId(gid);
@@ -251,12 +275,18 @@ void* DaemonTransport::Run(void* arg)
             /* Initialized the features for this endpoint */
             conn->GetFeatures().isBusToBus = false;
             conn->GetFeatures().allowRemote = false;
-            conn->GetFeatures().handlePassing = true;
+            /* Unix file descriptors cannot be passed through shared memory */
+            conn->GetFeatures().handlePassing = !sharedMemory;
 
             endpointListLock.Lock(MUTEX_CONTEXT);
             endpointList.push_back(RemoteEndpoint::cast(conn));
             endpointListLock.Unlock(MUTEX_CONTEXT);
             status = conn->Establish("EXTERNAL", authName, redirection);
+#if defined(QCC_OS_LINUX)
+            if ((status == ER_OK) && sharedMemory) {
+                status = conn->OfferSharedMemory(m_shmRingSize);
+            }
+#endif
             if (status == ER_OK) {
                 conn->SetListener(this);
                 status = conn->Start(m_defaultHbeatIdleTimeout, m_defaultHbeatProbeTimeout, m_numHbeatProbes, m_maxHbeatProbeTimeout);
@@ -288,11 +318,11 @@ void* DaemonTransport::Run(void* arg)
 
 QStatus DaemonTransport::NormalizeTransportSpec(const char* inSpec, qcc::String& outSpec, map<qcc::String, qcc::String>& argMap) const
 {
-    QStatus status = ParseArguments(DaemonTransport::TransportName, inSpec, argMap);
+    QStatus status = ParseArguments(GetTransportName(), inSpec, argMap);
     qcc::String path = Trim(argMap["path"]);
     qcc::String abstract = Trim(argMap["abstract"]);
     if (status == ER_OK) {
-        outSpec = "unix:";
+        outSpec = qcc::String(GetTransportName()) + ":";
         if (!path.empty()) {
             outSpec.append("path=");
             outSpec.append(path);
@@ -118,6 +118,9 @@ static const char internalConfig[] =
     "<busconfig>"
     "  <type>alljoyn</type>"
     "  <listen>unix:abstract=alljoyn</listen>"
+#if defined(QCC_OS_LINUX)
+    "  <listen>shm:abstract=alljoyn-shm</listen>"
+#endif
 #if defined(QCC_OS_DARWIN)
     "  <listen>launchd:env=DBUS_LAUNCHD_SESSION_BUS_SOCKET</listen>"
 #endif
@@ -177,7 +180,7 @@ class OptParse {
 
     ParseResultCode ParseResult();
 
-    String GetConfigFile() const {
+    const String& GetConfigFile() const {
         return configFile;
     }
     bool GetFork() const {
@@ -540,6 +543,10 @@ int daemon(OptParse& opts) {
 #endif
         } else if (addrStr.compare(0, sizeof("slap:") - 1, "slap:") == 0) {
             skip = opts.GetNoSLAP();
+#if defined(QCC_OS_LINUX)
+        } else if (addrStr.compare(0, sizeof("shm:") - 1, "shm:") == 0) {
+            // Shared memory connections are local only, same as unix.
+#endif
 
         } else {
             Log(LOG_ERR, "Unsupported listen address: %s (ignoring)\n", addrStr.c_str());
@@ -571,6 +578,7 @@ int daemon(OptParse& opts) {
     cntr.Add(new TransportFactory<UDPTransport>(UDPTransport::TransportName, false));
 #if defined(QCC_OS_LINUX)
     cntr.Add(new TransportFactory<DaemonSLAPTransport>(DaemonSLAPTransport::TransportName, false));
+    cntr.Add(new TransportFactory<DaemonShmTransport>(DaemonShmTransport::TransportName, false));
 #endif
 #if defined(QCC_OS_ANDROID)
 //    cntr.Add(new TransportFactory<WFDTransport>(WFDTransport::TransportName, false));
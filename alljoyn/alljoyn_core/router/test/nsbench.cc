@@ -0,0 +1,221 @@
+/**
+ * @file
+ * Name service datagram decode benchmark
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <alljoyn/version.h>
+
+#include "ns/IpNameServiceImpl.h"
+#include "ns/IpNsProtocol.h"
+
+#define QCC_MODULE "NSBENCH"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+typedef vector<uint8_t> Datagram;
+
+static void Append(vector<Datagram>& datagrams, MDNSPacket& packet)
+{
+    Datagram datagram(packet->GetSerializedSize());
+    packet->Serialize(&datagram[0]);
+    datagrams.push_back(datagram);
+}
+
+/*
+ * Build the datagrams a busy network sends: each peer queries for the
+ * AllJoyn services and answers with PTR, SRV and TXT records for TCP and UDP,
+ * its advertised names and its sender-info, all sharing name suffixes.
+ */
+static void Synthesize(vector<Datagram>& datagrams, uint32_t peers, uint32_t names)
+{
+    for (uint32_t p = 0; p < peers; ++p) {
+        String guid = BytesToHexString(reinterpret_cast<const uint8_t*>(&p), sizeof(p)) + "0123456789abcdef01234567";
+
+        MDNSPacket query;
+        query->SetHeader(MDNSHeader(static_cast<uint16_t>(p), MDNSHeader::MDNS_QUERY));
+        query->AddQuestion(MDNSQuestion("_alljoyn._tcp.local.", MDNSResourceRecord::PTR, MDNSResourceRecord::INTERNET));
+        query->AddQuestion(MDNSQuestion("_alljoyn._udp.local.", MDNSResourceRecord::PTR, MDNSResourceRecord::INTERNET));
+        MDNSSearchRData searchRData;
+        searchRData.SetValue("name", "org.alljoyn.nsbench.*");
+        query->AddAdditionalRecord(MDNSResourceRecord("search." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &searchRData));
+        MDNSSenderRData senderRData;
+        senderRData.SetSearchID(static_cast<uint16_t>(p));
+        query->AddAdditionalRecord(MDNSResourceRecord("sender-info." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &senderRData));
+        Append(datagrams, query);
+
+        MDNSPacket response;
+        response->SetHeader(MDNSHeader(static_cast<uint16_t>(p), MDNSHeader::MDNS_RESPONSE));
+        const char* protocols[] = { "_tcp", "_udp" };
+        for (size_t i = 0; i < ArraySize(protocols); ++i) {
+            String service = String("_alljoyn.") + protocols[i] + ".local.";
+            MDNSPtrRData ptrRData;
+            ptrRData.SetPtrDName(guid + "." + service);
+            response->AddAnswer(MDNSResourceRecord(service, MDNSResourceRecord::PTR, MDNSResourceRecord::INTERNET, 120, &ptrRData));
+            MDNSSrvRData srvRData(1, 1, static_cast<uint16_t>(9955 + i), guid + ".local.");
+            response->AddAnswer(MDNSResourceRecord(guid + "." + service, MDNSResourceRecord::SRV, MDNSResourceRecord::INTERNET, 120, &srvRData));
+            MDNSTextRData txtRData;
+            txtRData.SetValue(i ? "u6port" : "r6port", U32ToString(9955 + i));
+            response->AddAnswer(MDNSResourceRecord(guid + "." + service, MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &txtRData));
+        }
+        MDNSAdvertiseRData advRData;
+        advRData.SetTransport(TRANSPORT_TCP | TRANSPORT_UDP);
+        for (uint32_t n = 0; n < names; ++n) {
+            advRData.SetValue("name", "org.alljoyn.nsbench.peer" + U32ToString(p) + ".name" + U32ToString(n));
+        }
+        response->AddAdditionalRecord(MDNSResourceRecord("advertise." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &advRData));
+        response->AddAdditionalRecord(MDNSResourceRecord("sender-info." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &senderRData));
+        Append(datagrams, response);
+    }
+}
+
+/*
+ * Load captured datagrams, one per line as hex digits, for example the UDP
+ * payloads of the name service packets in a capture taken on port 5353.
+ */
+static bool Load(vector<Datagram>& datagrams, const char* fileName)
+{
+    FILE* file = fopen(fileName, "r");
+    if (!file) {
+        printf("Cannot open %s\n", fileName);
+        return false;
+    }
+    char line[2 * IpNameServiceImpl::NS_MESSAGE_MAX + 4];
+    while (fgets(line, sizeof(line), file)) {
+        String hex = Trim(line);
+        if (hex.empty() || (hex[0] == '#')) {
+            continue;
+        }
+        Datagram datagram(hex.size() / 2);
+        if (datagram.empty() || (HexStringToBytes(hex, &datagram[0], datagram.size()) != datagram.size())) {
+            printf("Skipping line that is not a hex datagram\n");
+            continue;
+        }
+        datagrams.push_back(datagram);
+    }
+    fclose(file);
+    return true;
+}
+
+static void usage(void)
+{
+    printf("Usage: nsbench [-h] [-n <count>] [-p <peers>] [-a <names>] [-f <file>]\n\n");
+    printf("Options:\n");
+    printf("   -h            - Print this help message\n");
+    printf("   -n <count>    - Number of times to replay the datagrams (default 1000)\n");
+    printf("   -p <peers>    - Number of peers to synthesize datagrams for (default 64)\n");
+    printf("   -a <names>    - Number of names each synthesized peer advertises (default 8)\n");
+    printf("   -f <file>     - Replay the hex datagrams in file, one per line, instead\n");
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = 1000;
+    uint32_t peers = 64;
+    uint32_t names = 8;
+    const char* fileName = NULL;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    /* Parse command line args */
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            count = StringToU32(argv[++i], 10, count);
+        } else if ((::strcmp("-p", argv[i]) == 0) && (i + 1 < argc)) {
+            peers = StringToU32(argv[++i], 10, peers);
+        } else if ((::strcmp("-a", argv[i]) == 0) && (i + 1 < argc)) {
+            names = StringToU32(argv[++i], 10, names);
+        } else if ((::strcmp("-f", argv[i]) == 0) && (i + 1 < argc)) {
+            fileName = argv[++i];
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    vector<Datagram> datagrams;
+    if (fileName) {
+        if (!Load(datagrams, fileName)) {
+            return 1;
+        }
+    } else {
+        Synthesize(datagrams, peers, names);
+    }
+    if (datagrams.empty()) {
+        printf("No datagrams to replay\n");
+        return 1;
+    }
+
+    uint64_t bytes = 0;
+    size_t largest = 0;
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        bytes += datagrams[i].size();
+        largest = max(largest, datagrams[i].size());
+    }
+    if (largest > IpNameServiceImpl::NS_MESSAGE_MAX) {
+        printf("Warning: largest datagram is %u bytes, more than NS_MESSAGE_MAX\n", static_cast<uint32_t>(largest));
+    }
+
+    /* Decode each datagram into a fresh packet the way HandleProtocolMessage() does */
+    uint64_t decoded = 0;
+    uint64_t rejected = 0;
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; n < count; ++n) {
+        for (size_t i = 0; i < datagrams.size(); ++i) {
+            MDNSPacket packet;
+            if (packet->Deserialize(&datagrams[i][0], static_cast<uint32_t>(datagrams[i].size()))) {
+                ++decoded;
+            } else {
+                ++rejected;
+            }
+        }
+    }
+    uint64_t elapsedMs = max(GetTimestamp64() - start, static_cast<uint64_t>(1));
+    uint64_t total = decoded + rejected;
+
+    printf("datagrams:     %u (%llu bytes, largest %u)\n", static_cast<uint32_t>(datagrams.size()),
+           static_cast<unsigned long long>(bytes), static_cast<uint32_t>(largest));
+    printf("replays:       %u\n", count);
+    printf("decoded:       %llu\n", static_cast<unsigned long long>(decoded));
+    printf("rejected:      %llu\n", static_cast<unsigned long long>(rejected));
+    printf("elapsed:       %.3f s\n", elapsedMs / 1000.0);
+    printf("packets/sec:   %.0f\n", total * 1000.0 / elapsedMs);
+    printf("us/packet:     %.2f\n", elapsedMs * 1000.0 / total);
+    printf("MB/sec:        %.2f\n", bytes * count / (elapsedMs * 1000.0));
+    return 0;
+}
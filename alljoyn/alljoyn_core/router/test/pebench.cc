@@ -0,0 +1,335 @@
+/**
+ * @file
+ * PacketEngine loopback stream benchmark
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <time.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <alljoyn/version.h>
+
+#include "PacketEngine.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static const size_t LOOPBACK_MTU = 1472;
+
+/* Microsecond monotonic timestamp */
+static uint64_t NowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * In-memory PacketStream. Packets pushed to one stream are delivered to its peer.
+ */
+class LoopbackPacketStream : public PacketStream {
+  public:
+    LoopbackPacketStream(uint16_t port) : local(GetPacketDest("127.0.0.1", port)), peer(NULL)
+    {
+        sinkEvent.SetEvent();
+    }
+
+    void SetPeer(LoopbackPacketStream& other) { peer = &other; }
+
+    const PacketDest& GetDest() const { return local; }
+
+    QStatus Start() { return ER_OK; }
+
+    QStatus Stop() { return ER_OK; }
+
+    QStatus PullPacketBytes(void* buf, size_t reqBytes, size_t& actualBytes, PacketDest& sender, uint32_t timeout)
+    {
+        actualBytes = 0;
+        lock.Lock();
+        if (packets.empty()) {
+            lock.Unlock();
+            return ER_TIMEOUT;
+        }
+        vector<uint8_t>& packet = packets.front();
+        actualBytes = ::min(reqBytes, packet.size());
+        ::memcpy(buf, &packet[0], actualBytes);
+        packets.pop_front();
+        if (packets.empty()) {
+            sourceEvent.ResetEvent();
+        }
+        lock.Unlock();
+        sender = peer->GetDest();
+        return ER_OK;
+    }
+
+    Event& GetSourceEvent() { return sourceEvent; }
+
+    size_t GetSourceMTU() { return LOOPBACK_MTU; }
+
+    QStatus PushPacketBytes(const void* buf, size_t numBytes, PacketDest& dest)
+    {
+        peer->Deliver(buf, numBytes);
+        return ER_OK;
+    }
+
+    Event& GetSinkEvent() { return sinkEvent; }
+
+    size_t GetSinkMTU() { return LOOPBACK_MTU; }
+
+    String ToString(const PacketDest& dest) const { return "loopback:" + U32ToString(dest.port); }
+
+  private:
+    void Deliver(const void* buf, size_t numBytes)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(buf);
+        lock.Lock();
+        packets.push_back(vector<uint8_t>(p, p + numBytes));
+        sourceEvent.SetEvent();
+        lock.Unlock();
+    }
+
+    PacketDest local;
+    LoopbackPacketStream* peer;
+    Mutex lock;
+    deque<vector<uint8_t> > packets;
+    Event sourceEvent;
+    Event sinkEvent;
+};
+
+/**
+ * One end of the loopback connection.
+ */
+class BenchEndpoint : public PacketEngineListener {
+  public:
+    BenchEndpoint(const char* name, uint16_t port, uint32_t window) : packetStream(port), engine(name, window) { }
+
+    QStatus Start()
+    {
+        QStatus status = engine.AddPacketStream(packetStream, *this);
+        if (status == ER_OK) {
+            status = engine.Start(LOOPBACK_MTU);
+        }
+        return status;
+    }
+
+    void Stop()
+    {
+        engine.Stop();
+        engine.Join();
+    }
+
+    QStatus Connect(BenchEndpoint& other)
+    {
+        return engine.Connect(other.packetStream.GetDest(), packetStream, *this, NULL);
+    }
+
+    void PacketEngineConnectCB(PacketEngine& engine, QStatus status, const PacketEngineStream* stream, const PacketDest& dest, void* context)
+    {
+        if (status == ER_OK) {
+            this->stream = *stream;
+        } else {
+            QCC_LogError(status, ("Connect failed"));
+        }
+        connected.SetEvent();
+    }
+
+    bool PacketEngineAcceptCB(PacketEngine& engine, const PacketEngineStream& stream, const PacketDest& dest)
+    {
+        this->stream = stream;
+        connected.SetEvent();
+        return true;
+    }
+
+    void PacketEngineDisconnectCB(PacketEngine& engine, const PacketEngineStream& stream, const PacketDest& dest) { }
+
+    LoopbackPacketStream packetStream;
+    PacketEngine engine;
+    PacketEngineStream stream;
+    Event connected;
+};
+
+/**
+ * Reads fixed size messages and records the one-way latency of each.
+ */
+class ReceiverThread : public Thread {
+  public:
+    ReceiverThread(PacketEngineStream& stream, size_t msgSize, uint32_t count) :
+        Thread("pebench-rx"), stream(stream), msgSize(msgSize), count(count), endUs(0)
+    {
+        latencies.reserve(count);
+    }
+
+    vector<uint32_t> latencies;
+
+    uint64_t GetEndUs() const { return endUs; }
+
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        vector<uint8_t> buf(msgSize);
+        while (!IsStopping() && (latencies.size() < count)) {
+            size_t offset = 0;
+            while (offset < msgSize) {
+                size_t actual = 0;
+                QStatus status = stream.PullBytes(&buf[offset], msgSize - offset, actual, 1000);
+                if (status == ER_OK) {
+                    offset += actual;
+                } else if ((status != ER_TIMEOUT) || IsStopping()) {
+                    QCC_LogError(status, ("PullBytes failed"));
+                    return (ThreadReturn) 0;
+                }
+            }
+            uint64_t sentUs;
+            ::memcpy(&sentUs, &buf[0], sizeof(sentUs));
+            latencies.push_back(static_cast<uint32_t>(NowUs() - sentUs));
+        }
+        endUs = NowUs();
+        return (ThreadReturn) 0;
+    }
+
+  private:
+    PacketEngineStream& stream;
+    size_t msgSize;
+    uint32_t count;
+    uint64_t endUs;
+};
+
+static uint32_t Percentile(const vector<uint32_t>& sorted, double pct)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(pct * (sorted.size() - 1) / 100.0);
+    return sorted[idx];
+}
+
+static void usage(void)
+{
+    printf("Usage: pebench [-h] [-n <count>] [-s <size>] [-w <window>]\n\n");
+    printf("Options:\n");
+    printf("   -h            - Print this help message\n");
+    printf("   -n <count>    - Number of messages to send (default 100000)\n");
+    printf("   -s <size>     - Message size in bytes (default 512)\n");
+    printf("   -w <window>   - PacketEngine window size (default 128)\n");
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t count = 100000;
+    size_t msgSize = 512;
+    uint32_t window = 128;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    /* Parse command line args */
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            count = StringToU32(argv[++i], 10, count);
+        } else if ((::strcmp("-s", argv[i]) == 0) && (i + 1 < argc)) {
+            msgSize = StringToU32(argv[++i], 10, static_cast<uint32_t>(msgSize));
+        } else if ((::strcmp("-w", argv[i]) == 0) && (i + 1 < argc)) {
+            window = StringToU32(argv[++i], 10, window);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    msgSize = ::max(msgSize, sizeof(uint64_t));
+
+    BenchEndpoint server("pe-server", 9911, window);
+    BenchEndpoint client("pe-client", 9912, window);
+    server.packetStream.SetPeer(client.packetStream);
+    client.packetStream.SetPeer(server.packetStream);
+
+    status = server.Start();
+    if (status == ER_OK) {
+        status = client.Start();
+    }
+    if (status == ER_OK) {
+        status = client.Connect(server);
+    }
+    if (status == ER_OK) {
+        status = Event::Wait(client.connected, 5000);
+    }
+    if (status == ER_OK) {
+        status = Event::Wait(server.connected, 5000);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up loopback connection"));
+        return 1;
+    }
+
+    ReceiverThread receiver(server.stream, msgSize, count);
+    receiver.Start();
+
+    vector<uint8_t> msg(msgSize, 0x5a);
+    uint64_t startUs = NowUs();
+    for (uint32_t i = 0; (i < count) && (status == ER_OK); ++i) {
+        uint64_t nowUs = NowUs();
+        ::memcpy(&msg[0], &nowUs, sizeof(nowUs));
+        size_t offset = 0;
+        while ((offset < msgSize) && (status == ER_OK)) {
+            size_t sent = 0;
+            status = client.stream.PushBytes(&msg[offset], msgSize - offset, sent);
+            offset += sent;
+        }
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("PushBytes failed"));
+        receiver.Stop();
+    }
+    receiver.Join();
+
+    vector<uint32_t>& latencies = receiver.latencies;
+    uint64_t elapsedUs = ::max(receiver.GetEndUs(), startUs + 1) - startUs;
+    size_t payload = LOOPBACK_MTU - Packet::payloadOffset;
+    uint64_t packets = static_cast<uint64_t>(latencies.size()) * ((msgSize + payload - 1) / payload);
+    sort(latencies.begin(), latencies.end());
+
+    printf("messages:      %u of %u (%u bytes each)\n", static_cast<uint32_t>(latencies.size()), count, static_cast<uint32_t>(msgSize));
+    printf("elapsed:       %.3f s\n", elapsedUs / 1000000.0);
+    printf("packets/sec:   %.0f\n", packets * 1000000.0 / elapsedUs);
+    printf("MB/sec:        %.2f\n", latencies.size() * msgSize / static_cast<double>(elapsedUs));
+    printf("latency (us):  p50=%u p90=%u p99=%u p99.9=%u max=%u\n",
+           Percentile(latencies, 50), Percentile(latencies, 90), Percentile(latencies, 99),
+           Percentile(latencies, 99.9), latencies.empty() ? 0 : latencies.back());
+
+    client.Stop();
+    server.Stop();
+    return (latencies.size() == count) ? 0 : 1;
+}
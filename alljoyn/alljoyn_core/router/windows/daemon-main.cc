@@ -112,7 +112,7 @@ class OptParse {
 
     ParseResultCode ParseResult();
 
-    qcc::String GetConfigFile() const { return configFile; }
+    const qcc::String& GetConfigFile() const { return configFile; }
     bool UseInternalConfig() const { return useInternalConfig; }
     bool PrintAddress() const { return printAddress; }
     int GetVerbosity() const { return verbosity; }
@@ -82,13 +82,42 @@ static qcc::String ConcatenateCompressedFields(uint8_t* hdr, size_t hdrLen, cons
     return result;
 }
 
-QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+static QStatus EncryptCCM(const _Message& message, Crypto_AES& aes, const KeyBlob& nonce, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+{
+    uint8_t* body = msgBuf + hdrLen;
+    if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
+        /*
+         * To prevent an attack where the attacker sends a bogus expansion rule we
+         * authenticate the compressed headers even though we won't be sending them.
+         */
+        qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
+        return aes.Encrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), Crypto::MACLength);
+    } else {
+        return aes.Encrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, Crypto::MACLength);
+    }
+}
+
+static QStatus DecryptCCM(const _Message& message, Crypto_AES& aes, const KeyBlob& nonce, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+{
+    uint8_t* body = msgBuf + hdrLen;
+    if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
+        /*
+         * To prevent an attack where the attacker sends a bogus expansion rule we
+         * authenticate the compressed headers even though we won't be sending them.
+         */
+        qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
+        return aes.Decrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), Crypto::MACLength);
+    } else {
+        return aes.Decrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, Crypto::MACLength);
+    }
+}
+
+QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen, Crypto_AES* cipher)
 {
     QStatus status;
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
         {
-            uint8_t* body = msgBuf + hdrLen;
             uint8_t nd[5];
             uint32_t serial = message.GetCallSerial();
 
@@ -102,16 +131,11 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
             QCC_DbgHLPrintf(("Encrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
             QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-            Crypto_AES aes(keyBlob, Crypto_AES::CCM);
-            if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
-                /*
-                 * To prevent an attack where the attacker sends a bogus expansion rule we
-                 * authenticate the compressed headers even though we won't be sending them.
-                 */
-                qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-                status = aes.Encrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            if (cipher) {
+                status = EncryptCCM(message, *cipher, nonce, msgBuf, hdrLen, bodyLen);
             } else {
-                status = aes.Encrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+                Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+                status = EncryptCCM(message, aes, nonce, msgBuf, hdrLen, bodyLen);
             }
         }
         break;
@@ -124,13 +148,12 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
     return status;
 }
 
-QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen, Crypto_AES* cipher)
 {
     QStatus status;
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
         {
-            uint8_t* body = msgBuf + hdrLen;
             uint8_t nd[5];
             uint32_t serial = message.GetCallSerial();
 
@@ -144,16 +167,11 @@ QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
             QCC_DbgHLPrintf(("Decrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
             QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-            Crypto_AES aes(keyBlob, Crypto_AES::CCM);
-            if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
-                /*
-                 * To prevent an attack where the attacker sends a bogus expansion rule we
-                 * authenticate the compressed headers even though we won't be sending them.
-                 */
-                qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-                status = aes.Decrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            if (cipher) {
+                status = DecryptCCM(message, *cipher, nonce, msgBuf, hdrLen, bodyLen);
             } else {
-                status = aes.Decrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+                Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+                status = DecryptCCM(message, aes, nonce, msgBuf, hdrLen, bodyLen);
             }
         }
         break;
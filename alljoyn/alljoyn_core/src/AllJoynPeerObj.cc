@@ -279,7 +279,6 @@ void AllJoynPeerObj::GetExpansion(const InterfaceDescription::Member* member, Me
 
 QStatus AllJoynPeerObj::RequestHeaderExpansion(Message& msg, RemoteEndpoint& sender)
 {
-    bool expansionPending = false;
     uint32_t token = msg->GetCompressionToken();
 
     assert(bus);
@@ -287,15 +286,11 @@ QStatus AllJoynPeerObj::RequestHeaderExpansion(Message& msg, RemoteEndpoint& sen
 
     lock.Lock(MUTEX_CONTEXT);
     /*
-     * First check if there are any other messages waiting for the same expansion rule.
+     * Check if there are any other messages waiting for the same expansion rule.
      */
-    for (std::deque<Message>::iterator iter = msgsPendingExpansion.begin(); iter != msgsPendingExpansion.end(); ++iter) {
-        if ((*iter)->GetCompressionToken() == token) {
-            expansionPending = true;
-            break;
-        }
-    }
-    msgsPendingExpansion.push_back(msg);
+    std::deque<Message>& pending = msgsPendingExpansion[token];
+    bool expansionPending = !pending.empty();
+    pending.push_back(msg);
     lock.Unlock(MUTEX_CONTEXT);
     /*
      * If there is already an expansion request for this message we don't need another one.
@@ -312,19 +307,15 @@ QStatus AllJoynPeerObj::RequestAuthentication(Message& msg)
     return DispatchRequest(msg, AUTHENTICATE_PEER);
 }
 
-bool AllJoynPeerObj::RemoveCompressedMessage(Message& msg, uint32_t token)
+void AllJoynPeerObj::RemoveCompressedMessages(uint32_t token, std::deque<Message>& msgs)
 {
     lock.Lock(MUTEX_CONTEXT);
-    for (std::deque<Message>::iterator iter = msgsPendingExpansion.begin(); iter != msgsPendingExpansion.end(); ++iter) {
-        if ((*iter)->GetCompressionToken() == token) {
-            msg = *iter;
-            msgsPendingExpansion.erase(iter);
-            lock.Unlock(MUTEX_CONTEXT);
-            return true;
-        }
+    std::map<uint32_t, std::deque<Message> >::iterator iter = msgsPendingExpansion.find(token);
+    if (iter != msgsPendingExpansion.end()) {
+        msgs.swap(iter->second);
+        msgsPendingExpansion.erase(iter);
     }
     lock.Unlock(MUTEX_CONTEXT);
-    return false;
 }
 
 /**
@@ -339,13 +330,13 @@ void AllJoynPeerObj::ExpandHeader(Message& msg, const qcc::String& receivedFrom)
     assert(bus);
     QStatus status = ER_OK;
     uint32_t token = msg->GetCompressionToken();
+    CompressionRules& rules = bus->GetInternal().GetCompressionRules();
 
-    const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-    if (!expFields) {
-        Message replyMsg(*bus);
+    if (!rules->HasExpansion(token)) {
         MsgArg arg("u", token);
         /*
-         * The endpoint the message was received on knows the expansion rule for the token we just received.
+         * The endpoint the message was received on knows the expansion rule for the token we just
+         * received. The messages stay queued until the reply arrives or the request times out.
          */
         ProxyBusObject remotePeerObj(*bus, receivedFrom.c_str(), org::alljoyn::Bus::Peer::ObjectPath, 0);
         const InterfaceDescription* ifc = bus->GetInterface(org::alljoyn::Bus::Peer::HeaderCompression::InterfaceName);
@@ -356,57 +347,90 @@ void AllJoynPeerObj::ExpandHeader(Message& msg, const qcc::String& receivedFrom)
             remotePeerObj.AddInterface(*ifc);
             const InterfaceDescription::Member* getExpansionMember = ifc->GetMember("GetExpansion");
             assert(getExpansionMember);
-            status = remotePeerObj.MethodCall(*getExpansionMember, &arg, 1, replyMsg, EXPANSION_TIMEOUT);
-        }
-        if (status == ER_OK) {
-            status = replyMsg->AddExpansionRule(token, replyMsg->GetArg(0));
+            status = remotePeerObj.MethodCallAsync(*getExpansionMember, this,
+                                                   static_cast<MessageReceiver::ReplyHandler>(&AllJoynPeerObj::ExpansionReply),
+                                                   &arg, 1, reinterpret_cast<void*>(static_cast<uintptr_t>(token)), EXPANSION_TIMEOUT);
             if (status == ER_OK) {
-                expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-                if (!expFields) {
-                    status = ER_BUS_HDR_EXPANSION_INVALID;
-                }
+                return;
             }
         }
     }
+    std::deque<Message> msgs;
+    RemoveCompressedMessages(token, msgs);
     /*
      * Clean up if we can't expand the messages.
      */
     if (status != ER_OK) {
-        while (RemoveCompressedMessage(msg, token)) {
-            QCC_LogError(status, ("Failed to expand message %s", msg->Description().c_str()));
+        for (std::deque<Message>::iterator iter = msgs.begin(); iter != msgs.end(); ++iter) {
+            QCC_LogError(status, ("Failed to expand message %s", (*iter)->Description().c_str()));
         }
         return;
     }
-    /*
-     * Calling RemoveCompressedMessage() in a loop may look innefficient but it is highly unlikely
-     * we will be expanding different headers at the same time so we are really just removing the
-     * front message from the list.
-     */
-    while (RemoveCompressedMessage(msg, token)) {
-        Router& router = bus->GetInternal().GetRouter();
-        BusEndpoint sender = router.FindEndpoint(msg->GetRcvEndpointName());
+    Router& router = bus->GetInternal().GetRouter();
+    for (std::deque<Message>::iterator iter = msgs.begin(); iter != msgs.end(); ++iter) {
+        Message& expMsg = *iter;
+        BusEndpoint sender = router.FindEndpoint(expMsg->GetRcvEndpointName());
         if (sender->IsValid()) {
             /*
              * Expand the compressed fields. Don't overwrite headers we received.
              */
-            for (size_t id = 0; id < ArraySize(msg->hdrFields.field); id++) {
-                if (HeaderFields::Compressible[id] && (msg->hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
-                    msg->hdrFields.field[id] = expFields->field[id];
-                }
+            if (!rules->Expand(token, expMsg->hdrFields)) {
+                QCC_LogError(ER_BUS_CANNOT_EXPAND_MESSAGE, ("Failed to expand message %s", expMsg->Description().c_str()));
+                continue;
             }
             /*
              * Initialize ttl from the message header.
              */
-            if (msg->hdrFields.field[ALLJOYN_HDR_FIELD_TIME_TO_LIVE].typeId != ALLJOYN_INVALID) {
-                msg->ttl = msg->hdrFields.field[ALLJOYN_HDR_FIELD_TIME_TO_LIVE].v_uint16;
+            if (expMsg->hdrFields.field[ALLJOYN_HDR_FIELD_TIME_TO_LIVE].typeId != ALLJOYN_INVALID) {
+                expMsg->ttl = expMsg->hdrFields.field[ALLJOYN_HDR_FIELD_TIME_TO_LIVE].v_uint16;
             } else {
-                msg->ttl = 0;
+                expMsg->ttl = 0;
             }
-            msg->hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].Clear();
+            expMsg->hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].Clear();
             /*
              * we have succesfully expanded the message so now it can be routed.
              */
-            router.PushMessage(msg, sender);
+            router.PushMessage(expMsg, sender);
+        }
+    }
+}
+
+void AllJoynPeerObj::ExpansionReply(Message& reply, void* context)
+{
+    assert(bus);
+    QStatus status = ER_OK;
+    uint32_t token = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(context));
+
+    if (reply->GetType() == MESSAGE_METHOD_RET) {
+        status = reply->AddExpansionRule(token, reply->GetArg(0));
+        if ((status == ER_OK) && !bus->GetInternal().GetCompressionRules()->HasExpansion(token)) {
+            status = ER_BUS_HDR_EXPANSION_INVALID;
+        }
+    } else {
+        status = ER_BUS_CANNOT_EXPAND_MESSAGE;
+    }
+    /*
+     * The waiting messages are expanded and routed on the dispatcher rather than on the thread that
+     * delivered the reply.
+     */
+    if (status == ER_OK) {
+        Message msg(*bus);
+        lock.Lock(MUTEX_CONTEXT);
+        std::map<uint32_t, std::deque<Message> >::iterator iter = msgsPendingExpansion.find(token);
+        bool pending = (iter != msgsPendingExpansion.end()) && !iter->second.empty();
+        if (pending) {
+            msg = iter->second.front();
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        if (pending) {
+            status = DispatchRequest(msg, EXPAND_HEADER, reply->GetSender());
+        }
+    }
+    if (status != ER_OK) {
+        std::deque<Message> msgs;
+        RemoveCompressedMessages(token, msgs);
+        for (std::deque<Message>::iterator iter = msgs.begin(); iter != msgs.end(); ++iter) {
+            QCC_LogError(status, ("Failed to expand message %s", (*iter)->Description().c_str()));
         }
     }
 }
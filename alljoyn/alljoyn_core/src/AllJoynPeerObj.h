@@ -340,12 +340,23 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
     void DoKeyAuthentication(Message& msg);
 
     /**
-     * Process a message to advance an authentication conversation.
+     * Request the expansion rule for a compressed message or, if the rule is already known, expand
+     * and route all messages waiting on the same compression token. The request to the remote peer
+     * is asynchronous so the dispatcher is not blocked waiting for the reply.
      *
-     * @param msg  The auth challenge message
+     * @param msg              A compressed message waiting for expansion
+     * @param sendingEndpoint  The endpoint the message was received on
      */
     void ExpandHeader(Message& msg, const qcc::String& sendingEndpoint);
 
+    /**
+     * Reply handler for the GetExpansion method call issued by ExpandHeader().
+     *
+     * @param reply    The reply message
+     * @param context  The compression token that was requested
+     */
+    void ExpansionReply(Message& reply, void* context);
+
     /**
      * Session key generation algorithm.
      *
@@ -401,15 +412,13 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
     QStatus DispatchRequest(Message& msg, AllJoynPeerObj::RequestType reqType, const qcc::String data = "");
 
     /**
-     * Get the next compressed message from the msgsPendingExpansion queue that has the specified
-     * compression token. The message is removed from the list.
+     * Remove all compressed messages waiting for the expansion rule for the specified compression
+     * token.
      *
-     * @param msg       Message that was removed.
      * @param token     The compression token
-     *
-     * @return  Returns true if a message was removed and returned.
+     * @param msgs      Returns the messages that were removed in the order they were received.
      */
-    bool RemoveCompressedMessage(Message& msg, uint32_t token);
+    void RemoveCompressedMessages(uint32_t token, std::deque<Message>& msgs);
 
     /**
      * Record the master secret.
@@ -470,8 +479,8 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
     /** Queue of encrypted messages waiting for an authentication to complete */
     std::deque<Message> msgsPendingAuth;
 
-    /** Queue of compressed messages waiting for an expansion rule to be supplied */
-    std::deque<Message> msgsPendingExpansion;
+    /** Queues of compressed messages waiting for an expansion rule to be supplied indexed by compression token */
+    std::map<uint32_t, std::deque<Message> > msgsPendingExpansion;
 
     uint16_t supportedAuthSuitesCount;
     uint32_t* supportedAuthSuites;
@@ -66,6 +66,10 @@ const char* org::alljoyn::Bus::Peer::HeaderCompression::InterfaceName = "org.all
 const char* org::alljoyn::Bus::Peer::Authentication::InterfaceName = "org.alljoyn.Bus.Peer.Authentication";
 const char* org::alljoyn::Bus::Peer::Session::InterfaceName = "org.alljoyn.Bus.Peer.Session";
 
+/** org.alljoyn.Bus.Debug.Stats interface definitions */
+const char* org::alljoyn::Bus::Debug::Stats::ObjectPath = "/org/alljoyn/Bus/Debug/Stats";
+const char* org::alljoyn::Bus::Debug::Stats::InterfaceName = "org.alljoyn.Bus.Debug.Stats";
+
 /** org.allseen.Introsoectable interface definitions */
 const char* org::allseen::Introspectable::InterfaceName = "org.allseen.Introspectable";
 const char* org::allseen::Introspectable::IntrospectDocType =
@@ -187,6 +191,21 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         ifc->AddMethod("SetDebugLevel",  "su", NULL, "module,level", 0);
         ifc->Activate();
     }
+    {
+        /* Create the org.alljoyn.Bus.Debug.Stats interface */
+        InterfaceDescription* ifc = NULL;
+        status = bus.CreateInterface(org::alljoyn::Bus::Debug::Stats::InterfaceName, ifc);
+
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to create interface \"%s\"", org::alljoyn::Bus::Debug::Stats::InterfaceName));
+            return status;
+        }
+        ifc->AddMethod("GetCounters",      NULL, "a{st}",      "counters",   0);
+        ifc->AddMethod("GetHistograms",    NULL, "a(sttat)",   "histograms", 0);
+        ifc->AddMethod("GetEndpointStats", NULL, "a(suutttt)", "endpoints",  0);
+        ifc->AddMethod("GetReport",        NULL, "s",          "report",     0);
+        ifc->Activate();
+    }
     {
         /* Create the org.alljoyn.Bus.Peer.HeaderCompression interface */
         InterfaceDescription* ifc = NULL;
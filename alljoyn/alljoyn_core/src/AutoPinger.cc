@@ -88,4 +88,9 @@ QStatus AutoPinger::RemoveDestination(const qcc::String& group, const qcc::Strin
     return internal->RemoveDestination(group, destination, removeAll);
 }
 
+void AutoPinger::SetRateLimit(uint32_t maxPingsPerSecond, uint32_t maxInFlight)
+{
+    internal->SetRateLimit(maxPingsPerSecond, maxInFlight);
+}
+
 }
@@ -13,10 +13,10 @@
  *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
  *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  ******************************************************************************/
-
 #include "AutoPingerInternal.h"
 #include <alljoyn/BusAttachment.h>
 #include <qcc/time.h>
+#include <qcc/Util.h>
 #include <algorithm>
 #include <memory>
 #include <set>
@@ -28,45 +28,28 @@
 
 namespace ajn {
 
-// Destination data
-struct Destination {
-    Destination(const qcc::String& _destination, const AutoPingerInternal::PingState _oldState) :
-        destination(_destination), oldState(_oldState) { }
-    qcc::String destination;
-
-    /* mutable so we can modify this even while iterating;
-     * see UpdatePingStateOfDestination()
-     */
-    mutable AutoPingerInternal::PingState oldState;
-
-    bool operator==(const Destination& dest) const {
-        return (destination == dest.destination);
-    }
-
-    bool operator<(const Destination& dest) const {
-        return (destination < dest.destination);
-    }
-};
-
 // Group data
 struct PingGroup {
-    PingGroup(uint32_t pingInterval,      /* milliseconds */
-              qcc::AlarmListener* alarmListener,
-              void* context,
-              PingListener& _pingListener) :
-        alarm(pingInterval, alarmListener, context, pingInterval), pingListener(_pingListener) { }
-
-    ~PingGroup() {
-        qcc::String* ctx = static_cast<qcc::String*>(alarm->GetContext());
-        alarm->SetContext(NULL);
-        if (NULL != ctx) {
-            delete ctx;
-        }
-    }
+    PingGroup(const qcc::String& _name, uint32_t _pingInterval, PingListener& _pingListener) :
+        name(_name), pingInterval(_pingInterval), pingListener(_pingListener) { }
 
-    qcc::Alarm alarm;
+    qcc::String name;
+    uint32_t pingInterval;      /* milliseconds */
     PingListener& pingListener;
-    std::map<Destination, unsigned int> destinations;
+    std::map<qcc::String, PingEntry*> destinations;
+};
+
+// Destination data, one per destination per group
+struct PingEntry {
+    PingEntry(PingGroup* _group, const qcc::String& _destination) :
+        group(_group), destination(_destination), refCount(1), oldState(AutoPingerInternal::UNKNOWN), dueTick(0), isReady(false) { }
+
+    PingGroup* group;
+    qcc::String destination;
+    unsigned int refCount;
+    AutoPingerInternal::PingState oldState;
+    uint64_t dueTick;           /* tick at which the destination is pinged next */
+    bool isReady;               /* true when on the ready queue rather than on the wheel */
 };
 
 // Context used to pass additional info in callbacks
@@ -99,6 +82,9 @@ class AutoPingAsyncCB : public BusAttachment::PingAsyncCB {
         std::set<PingAsyncContext*>::iterator it = ctxs->find(ctx);
 
         if (it != ctxs->end()) {
+            // free up a slot in the in-flight window
+            ctx->pinger->PingDone();
+
             if ((ctx->pinger->IsRunning()) && (false == ctx->pinger->pausing)) {
                 if (ER_OK != status) {
                     if (ER_ALLJOYN_PING_REPLY_IN_PROGRESS != status) {
@@ -138,6 +124,22 @@ class AutoPingAsyncCB : public BusAttachment::PingAsyncCB {
 
 static AutoPingAsyncCB* pingCallback = NULL;
 
+/*
+ * Tick at which a destination pinged at nowMs is pinged next.  The interval is
+ * shortened by up to 10% at random so that destinations do not stay in lock
+ * step, and rounded down to a tick so it is never longer than configured.
+ */
+static uint64_t NextPingTick(uint64_t nowMs, uint32_t pingInterval, uint32_t tickMs)
+{
+    uint64_t dueMs = nowMs + pingInterval - (qcc::Rand32() % (pingInterval / 10 + 1));
+    return std::max(dueMs / tickMs, nowMs / tickMs + 1);
+}
+
+static uint64_t CurrentTick(uint32_t tickMs)
+{
+    return qcc::GetTimestamp64() / tickMs;
+}
+
 void AutoPingerInternal::Init()
 {
     ctxs = new std::set<PingAsyncContext*>();
@@ -156,7 +158,8 @@ void AutoPingerInternal::Cleanup()
 }
 
 AutoPingerInternal::AutoPingerInternal(ajn::BusAttachment& _busAttachment) :
-    timer("autopinger"), busAttachment(_busAttachment), pausing(false)
+    timer("autopinger"), busAttachment(_busAttachment), numEntries(0), lastTick(CurrentTick(TICK_MS)), lastTickMs(qcc::GetTimestamp64()),
+    tickArmed(false), maxPingsPerSecond(DEFAULT_MAX_PINGS_PER_SECOND), maxInFlight(DEFAULT_MAX_IN_FLIGHT), inFlight(0), credit(0), pausing(false)
 {
     QCC_DbgPrintf(("AutoPingerInternal constructed"));
     timer.Start();
@@ -189,6 +192,10 @@ AutoPingerInternal::~AutoPingerInternal()
     // Cleanup all groups
     pingerMutex.Lock();
     for (std::map<qcc::String, PingGroup*>::iterator pair = pingGroups.begin(); pair != pingGroups.end(); ++pair) {
+        std::map<qcc::String, PingEntry*>::iterator dit = pair->second->destinations.begin();
+        for (; dit != pair->second->destinations.end(); ++dit) {
+            delete dit->second;
+        }
         delete pair->second;
     }
     pingerMutex.Unlock();
@@ -198,40 +205,156 @@ AutoPingerInternal::~AutoPingerInternal()
 
 void AutoPingerInternal::AlarmTriggered(const qcc::Alarm& alarm, QStatus reason)
 {
-    qcc::String* groupName(reinterpret_cast<qcc::String*>(alarm->GetContext()));
+    if (ER_OK != reason) {
+        return;
+    }
 
-    if ((false == pausing) && (NULL != groupName)) {
-        // Ping all destination of the group
-        PingGroupDestinations(*groupName);
+    ctxMutex->Lock();
+    pingerMutex.Lock();
+    tickArmed = false;
+    if ((false == pausing) && (numEntries > 0)) {
+        AdvanceWheel();
     }
+    UpdateTickAlarm();
+    pingerMutex.Unlock();
+    ctxMutex->Unlock();
 }
 
-void AutoPingerInternal::PingGroupDestinations(const qcc::String& group)
+void AutoPingerInternal::AdvanceWheel()
 {
-    QCC_DbgPrintf(("AutoPingerInternal: start pinging destination in group: '%s'", group.c_str()));
-    ctxMutex->Lock();
-    pingerMutex.Lock();
-    std::map<qcc::String, PingGroup*>::const_iterator it = pingGroups.find(group);
-    if (it != pingGroups.end()) {
-        std::map<Destination, unsigned int>::iterator mapIt = (*it).second->destinations.begin();
-        for (; mapIt != (*it).second->destinations.end(); ++mapIt) {
-            PingAsyncContext* context = new PingAsyncContext(this, group, mapIt->first.destination, mapIt->first.oldState, (*it).second->pingListener);
-            std::pair<std::set<PingAsyncContext*>::iterator, bool> pair = ctxs->insert(context);
-            if (ER_OK != busAttachment.PingAsync(mapIt->first.destination.c_str(), PING_TIMEOUT, pingCallback, context)) {
-                ctxs->erase(pair.first);
-                delete context;
+    uint64_t nowMs = qcc::GetTimestamp64();
+    uint64_t tick = nowMs / TICK_MS;
+
+    // Only visit the slots of the ticks that passed, at most one turn of the wheel
+    uint64_t first = lastTick + 1;
+    if (tick >= NUM_SLOTS) {
+        first = std::max(first, tick - NUM_SLOTS + 1);
+    }
+    for (uint64_t t = first; t <= tick; ++t) {
+        std::vector<PingEntry*>& slot = wheel[t % NUM_SLOTS];
+        for (size_t i = 0; i < slot.size();) {
+            PingEntry* entry = slot[i];
+            if (entry->dueTick <= tick) {
+                slot[i] = slot.back();
+                slot.pop_back();
+                entry->isReady = true;
+                ready.push_back(entry);
+            } else {
+                ++i;
             }
         }
     }
+
+    // Refill the rate limit, allowing at most one tick worth of pings to accumulate
+    if (maxPingsPerSecond > 0) {
+        uint64_t maxCredit = std::max(static_cast<uint64_t>(maxPingsPerSecond) * TICK_MS, static_cast<uint64_t>(1000));
+        credit = std::min(credit + (nowMs - lastTickMs) * maxPingsPerSecond, maxCredit);
+    }
+    lastTick = tick;
+    lastTickMs = nowMs;
+
+    while (!ready.empty()) {
+        if ((maxInFlight > 0) && (inFlight >= maxInFlight)) {
+            break;
+        }
+        if ((maxPingsPerSecond > 0) && (credit < 1000)) {
+            break;
+        }
+        PingEntry* entry = ready.front();
+        ready.pop_front();
+        Schedule(entry, NextPingTick(nowMs, entry->group->pingInterval, TICK_MS));
+        Ping(entry);
+        if (maxPingsPerSecond > 0) {
+            credit -= 1000;
+        }
+    }
+    if (!ready.empty()) {
+        QCC_DbgPrintf(("AutoPingerInternal: %u destinations deferred to next tick", static_cast<uint32_t>(ready.size())));
+    }
+}
+
+void AutoPingerInternal::Ping(PingEntry* entry)
+{
+    PingAsyncContext* context = new PingAsyncContext(this, entry->group->name, entry->destination, entry->oldState, entry->group->pingListener);
+    std::pair<std::set<PingAsyncContext*>::iterator, bool> pair = ctxs->insert(context);
+    if (ER_OK != busAttachment.PingAsync(entry->destination.c_str(), PING_TIMEOUT, pingCallback, context)) {
+        ctxs->erase(pair.first);
+        delete context;
+    } else {
+        ++inFlight;
+    }
+}
+
+void AutoPingerInternal::PingDone()
+{
+    pingerMutex.Lock();
+    if (inFlight > 0) {
+        --inFlight;
+    }
     pingerMutex.Unlock();
-    ctxMutex->Unlock();
+}
+
+void AutoPingerInternal::Schedule(PingEntry* entry, uint64_t dueTick)
+{
+    entry->dueTick = dueTick;
+    if (dueTick <= lastTick) {
+        entry->isReady = true;
+        ready.push_back(entry);
+    } else {
+        entry->isReady = false;
+        wheel[dueTick % NUM_SLOTS].push_back(entry);
+    }
+}
+
+void AutoPingerInternal::Unschedule(PingEntry* entry)
+{
+    if (entry->isReady) {
+        std::deque<PingEntry*>::iterator it = std::find(ready.begin(), ready.end(), entry);
+        if (it != ready.end()) {
+            ready.erase(it);
+        }
+    } else {
+        std::vector<PingEntry*>& slot = wheel[entry->dueTick % NUM_SLOTS];
+        std::vector<PingEntry*>::iterator it = std::find(slot.begin(), slot.end(), entry);
+        if (it != slot.end()) {
+            *it = slot.back();
+            slot.pop_back();
+        }
+    }
+}
+
+void AutoPingerInternal::RemoveEntry(PingEntry* entry)
+{
+    Unschedule(entry);
+    delete entry;
+    --numEntries;
+}
+
+/*
+ * The tick is a one-shot alarm that is re-armed from AlarmTriggered() for as
+ * long as there are destinations, so an idle pinger does not wake up at all.
+ */
+void AutoPingerInternal::UpdateTickAlarm()
+{
+    if ((numEntries > 0) && (false == pausing) && !tickArmed) {
+        qcc::AlarmListener* alarmListener = this;
+        void* context = NULL;
+        // Fire on the next tick boundary so a tick never runs late by more than the timer does
+        uint32_t delay = TICK_MS - static_cast<uint32_t>(qcc::GetTimestamp64() % TICK_MS);
+        tickAlarm = qcc::Alarm(delay, alarmListener, context);
+        tickArmed = (ER_OK == timer.AddAlarmNonBlocking(tickAlarm));
+    }
 }
 
 void AutoPingerInternal::Pause()
 {
-    // Stop all pending alarms
+    // Stop the pending tick
     pausing = true;
-    timer.RemoveAlarmsWithListener(*this);
+    pingerMutex.Lock();
+    if (tickArmed && timer.RemoveAlarm(tickAlarm, false)) {
+        tickArmed = false;
+    }
+    pingerMutex.Unlock();
 
     QCC_DbgPrintf(("AutoPingerInternal paused"));
 }
@@ -241,49 +364,34 @@ void AutoPingerInternal::Resume()
     assert(timer.IsRunning());
     if (true == pausing) {
         pingerMutex.Lock();
-        // re-add all Alarm objects
-        std::map<qcc::String, PingGroup*>::const_iterator it = pingGroups.begin();
-        for (; it != pingGroups.end(); ++it) {
-            timer.AddAlarmNonBlocking((*it).second->alarm);
-        }
+        pausing = false;
+        UpdateTickAlarm();
         pingerMutex.Unlock();
 
-        pausing = false;
         QCC_DbgPrintf(("AutoPingerInternal resumed"));
     }
 }
 
+void AutoPingerInternal::SetRateLimit(uint32_t maxPingsPerSecond, uint32_t maxInFlight)
+{
+    pingerMutex.Lock();
+    this->maxPingsPerSecond = maxPingsPerSecond;
+    this->maxInFlight = maxInFlight;
+    pingerMutex.Unlock();
+}
+
 void AutoPingerInternal::AddPingGroup(const qcc::String& group, PingListener& listener, uint32_t pingInterval)
 {
     pingerMutex.Lock();
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
-    uint32_t intervalMillisec = pingInterval * 1000;
     if (it != pingGroups.end()) {
         // Group already exists => just update its ping time
         QCC_DbgPrintf(("AutoPingerInternal: updating existing group: '%s' with new ping time: %u", group.c_str(), pingInterval));
-
-        if (timer.RemoveAlarm((*it).second->alarm, false)) {
-            // Cleanup old alarm
-            void* context = (*it).second->alarm->GetContext();
-            (*it).second->alarm->SetContext(NULL);
-            if (NULL == context) {
-                // There was no context, create one
-                context = (void*)(new qcc::String(group));
-            }
-
-            // Alarm is a managed object (auto cleanup when overwritten)
-            qcc::AlarmListener* alarmListener = (qcc::AlarmListener*)this;
-            (*it).second->alarm = qcc::Alarm(intervalMillisec, alarmListener, context, intervalMillisec);
-            timer.AddAlarmNonBlocking((*it).second->alarm);
-        }
+        SetPingInterval(group, pingInterval);
     } else {
         // Create a new group element
         QCC_DbgPrintf(("AutoPingerInternal: adding new group: '%s' with ping time: %u", group.c_str(), pingInterval));
-
-        void* context = (void*)(new qcc::String(group));
-        PingGroup* pingGroup = new PingGroup(intervalMillisec, this, context, listener);
-        pingGroups.insert(std::pair<qcc::String, PingGroup*>(group, pingGroup));
-        timer.AddAlarmNonBlocking(pingGroup->alarm);
+        pingGroups.insert(std::pair<qcc::String, PingGroup*>(group, new PingGroup(group, pingInterval * 1000, listener)));
     }
     pingerMutex.Unlock();
 }
@@ -294,8 +402,10 @@ void AutoPingerInternal::RemovePingGroup(const qcc::String& group)
     pingerMutex.Lock();
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
     if (it != pingGroups.end()) {
-        // destructor of PingGroup cleans-up context
-        timer.RemoveAlarm((*it).second->alarm, false);
+        std::map<qcc::String, PingEntry*>::iterator dit = it->second->destinations.begin();
+        for (; dit != it->second->destinations.end(); ++dit) {
+            RemoveEntry(dit->second);
+        }
         delete it->second;
         pingGroups.erase(it);
     }
@@ -309,23 +419,21 @@ QStatus AutoPingerInternal::SetPingInterval(const qcc::String& group, uint32_t p
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
     if (it != pingGroups.end()) {
         QCC_DbgPrintf(("AutoPingerInternal: updating group: '%s' with ping time: %u", group.c_str(), pingInterval));
-
-        if (timer.RemoveAlarm((*it).second->alarm, false)) {
-            // Cleanup old alarm
-            void* context = (*it).second->alarm->GetContext();
-            (*it).second->alarm->SetContext(NULL);
-            if (NULL == context) {
-                context = (void*)(new qcc::String(group));
+        PingGroup* pingGroup = it->second;
+        pingGroup->pingInterval = pingInterval * 1000;
+
+        // Destinations that would now wait longer than the new interval are moved forward
+        uint64_t nowMs = qcc::GetTimestamp64();
+        uint64_t latest = (nowMs + pingGroup->pingInterval) / TICK_MS;
+        std::map<qcc::String, PingEntry*>::iterator dit = pingGroup->destinations.begin();
+        for (; dit != pingGroup->destinations.end(); ++dit) {
+            PingEntry* entry = dit->second;
+            if (!entry->isReady && (entry->dueTick > latest)) {
+                Unschedule(entry);
+                Schedule(entry, NextPingTick(nowMs, pingGroup->pingInterval, TICK_MS));
             }
-
-            // Alarm is a managed object (auto cleanup when overwritten)
-            uint32_t intervalMillisec = pingInterval * 1000;
-            qcc::AlarmListener* alarmListener = (qcc::AlarmListener*)this;
-            (*it).second->alarm = qcc::Alarm(intervalMillisec, alarmListener, context, intervalMillisec);
-            timer.AddAlarmNonBlocking((*it).second->alarm);
-
-            status = ER_OK;
         }
+        status = ER_OK;
     } else {
         status = ER_BUS_PING_GROUP_NOT_FOUND;
         QCC_LogError(status, ("AutoPingerInternal: cannot update ping time for non-existing group: '%s'", group.c_str()));
@@ -341,18 +449,24 @@ QStatus AutoPingerInternal::AddDestination(const qcc::String& group, const qcc::
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
     if (it != pingGroups.end()) {
         status = ER_OK;
-        Destination dummy(destination, AutoPingerInternal::UNKNOWN);
-        std::map<Destination, unsigned int>::iterator dit;
-        if ((dit = it->second->destinations.find(dummy)) == it->second->destinations.end()) {
+        std::map<qcc::String, PingEntry*>::iterator dit = it->second->destinations.find(destination);
+        if (dit == it->second->destinations.end()) {
             QCC_DbgPrintf(("AutoPingerInternal: adding destination: '%s' to group: %s", destination.c_str(), group.c_str()));
-            (*it).second->destinations[(Destination(destination, AutoPingerInternal::UNKNOWN))] = 1;
+            PingEntry* entry = new PingEntry(it->second, destination);
+            it->second->destinations[destination] = entry;
+            ++numEntries;
+            UpdateTickAlarm();
+
+            // First ping at a random point within the interval to spread out destinations added together
+            uint64_t ticks = std::max(it->second->pingInterval / TICK_MS, static_cast<uint32_t>(1));
+            Schedule(entry, CurrentTick(TICK_MS) + (qcc::Rand32() % ticks));
         } else {
-            dit->second++;
-            QCC_DbgPrintf(("AutoPingerInternal: destination: '%s' already present in group: %u; increasing refcount", destination.c_str(), group.c_str()));
+            dit->second->refCount++;
+            QCC_DbgPrintf(("AutoPingerInternal: destination: '%s' already present in group: %s; increasing refcount", destination.c_str(), group.c_str()));
         }
     } else {
         status = ER_BUS_PING_GROUP_NOT_FOUND;
-        QCC_LogError(status, ("AutoPingerInternal: cannot add destination: '%s' to non-existing group: %u", destination.c_str(), group.c_str()));
+        QCC_LogError(status, ("AutoPingerInternal: cannot add destination: '%s' to non-existing group: %s", destination.c_str(), group.c_str()));
     }
     pingerMutex.Unlock();
 
@@ -367,16 +481,16 @@ QStatus AutoPingerInternal::RemoveDestination(const qcc::String& group, const qc
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
     if (it != pingGroups.end()) {
         status = ER_OK;
-        Destination dummy(destination, AutoPingerInternal::UNKNOWN);
-        std::map<Destination, unsigned int>::iterator dit = it->second->destinations.find(dummy);
+        std::map<qcc::String, PingEntry*>::iterator dit = it->second->destinations.find(destination);
         if (dit != it->second->destinations.end()) {
             if (removeAll == true) {
-                dit->second = 0;
+                dit->second->refCount = 0;
             } else {
-                --dit->second;
+                --dit->second->refCount;
             }
 
-            if (dit->second == 0) {
+            if (dit->second->refCount == 0) {
+                RemoveEntry(dit->second);
                 it->second->destinations.erase(dit);
             }
         }
@@ -395,15 +509,12 @@ bool AutoPingerInternal::UpdatePingStateOfDestination(const qcc::String& group,
     pingerMutex.Lock();
     std::map<qcc::String, PingGroup*>::iterator it = pingGroups.find(group);
     if (it != pingGroups.end()) {
-        Destination dummy(destination, AutoPingerInternal::UNKNOWN);
-        std::map<Destination, unsigned int>::iterator dit = it->second->destinations.find(dummy);
+        std::map<qcc::String, PingEntry*>::iterator dit = it->second->destinations.find(destination);
 
         // Update state
-        if (dit != (*it).second->destinations.end()) {
-            if (state != dit->first.oldState) {
-                /* this only works because oldState is mutable.
-                   Alternatively, you have to add it again to the map (and erase the old one) */
-                dit->first.oldState = state;
+        if (dit != it->second->destinations.end()) {
+            if (state != dit->second->oldState) {
+                dit->second->oldState = state;
                 result = true; /* state gets updated */
             }
         }
@@ -27,7 +27,9 @@
 #error Only include AutoPingerInternal.h in C++ code.
 #endif
 
+#include <deque>
 #include <map>
+#include <vector>
 #include <qcc/Timer.h>
 #include <qcc/String.h>
 #include <qcc/Mutex.h>
@@ -39,11 +41,20 @@ namespace ajn {
 /// @cond ALLJOYN_DEV
 /** @internal Forward references */
 struct PingGroup;
+struct PingEntry;
 class BusAttachment;
 /// @endcond
 
 /**
  * AutoPingerInternal class
+ *
+ * All destinations of all groups are kept on a hashed timer wheel that is
+ * advanced by a single tick alarm, so a tick only visits the slots
+ * that became due since the previous one.  Due destinations are moved to a
+ * ready queue and pinged from there subject to a rate limit and a bound on
+ * the number of pings in flight; whatever cannot be sent waits for the next
+ * tick.  Ping times are jittered so destinations added together spread out
+ * over the interval instead of being pinged in bursts.
  */
 class AutoPingerInternal : public qcc::AlarmListener {
   public:
@@ -123,9 +134,23 @@ class AutoPingerInternal : public qcc::AlarmListener {
      */
     QStatus RemoveDestination(const qcc::String& group, const qcc::String& destination, bool removeAll = false);
 
+    /**
+     * Limit the rate at which pings are sent
+     *
+     * @param  maxPingsPerSecond Maximum number of pings sent per second, 0 for no limit
+     * @param  maxInFlight Maximum number of pings waiting for a reply, 0 for no limit
+     */
+    void SetRateLimit(uint32_t maxPingsPerSecond, uint32_t maxInFlight);
+
+    /** Default maximum number of pings sent per second */
+    static const uint32_t DEFAULT_MAX_PINGS_PER_SECOND = 200;
+
+    /** Default maximum number of pings waiting for a reply */
+    static const uint32_t DEFAULT_MAX_IN_FLIGHT = 64;
+
   private:
     friend class AutoPingAsyncCB;
-    friend struct Destination;
+    friend struct PingEntry;
     friend class PingAsyncContext;
 
     enum PingState {
@@ -137,8 +162,20 @@ class AutoPingerInternal : public qcc::AlarmListener {
     AutoPingerInternal(const AutoPingerInternal&);
     void operator=(const AutoPingerInternal&);
 
+    /** Length of a timer wheel tick in milliseconds */
+    static const uint32_t TICK_MS = 100;
+
+    /** Number of slots on the timer wheel */
+    static const uint32_t NUM_SLOTS = 256;
+
     bool UpdatePingStateOfDestination(const qcc::String& group, const qcc::String& destination, const AutoPingerInternal::PingState state);
-    void PingGroupDestinations(const qcc::String& group);
+    void PingDone();
+    void AdvanceWheel();
+    void Ping(PingEntry* entry);
+    void Schedule(PingEntry* entry, uint64_t dueTick);
+    void Unschedule(PingEntry* entry);
+    void RemoveEntry(PingEntry* entry);
+    void UpdateTickAlarm();
     bool IsRunning();
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
@@ -147,6 +184,19 @@ class AutoPingerInternal : public qcc::AlarmListener {
     qcc::Mutex pingerMutex;
     std::map<qcc::String, PingGroup*> pingGroups;
 
+    std::vector<PingEntry*> wheel[NUM_SLOTS];   /**< Destinations waiting for their next ping, by due tick */
+    std::deque<PingEntry*> ready;               /**< Destinations that are due but have not been pinged yet */
+    size_t numEntries;                          /**< Number of destinations in all groups */
+    uint64_t lastTick;                          /**< Last tick processed */
+    uint64_t lastTickMs;                        /**< Time the last tick was processed */
+    qcc::Alarm tickAlarm;                       /**< Alarm that advances the wheel */
+    bool tickArmed;                             /**< True while tickAlarm is on the timer */
+
+    uint32_t maxPingsPerSecond;
+    uint32_t maxInFlight;
+    uint32_t inFlight;                          /**< Pings waiting for a reply */
+    uint64_t credit;                            /**< Pings that may be sent now, in thousandths */
+
     bool pausing;
 };
 }
@@ -200,6 +200,11 @@ static class ClientTransportFactoryContainer : public TransportFactoryContainer
             if (ClientTransport::IsAvailable()) {
                 Add(new TransportFactory<ClientTransport>(ClientTransport::TransportName, true));
             }
+#if defined(QCC_OS_LINUX)
+            if (ShmClientTransport::IsAvailable()) {
+                Add(new TransportFactory<ShmClientTransport>(ShmClientTransport::TransportName, true));
+            }
+#endif
             if (NullTransport::IsAvailable()) {
                 Add(new TransportFactory<NullTransport>(NullTransport::TransportName, true));
             }
@@ -335,7 +340,7 @@ uint32_t BusAttachment::GetConcurrency()
     return concurrency;
 }
 
-qcc::String BusAttachment::GetConnectSpec()
+const qcc::String& BusAttachment::GetConnectSpec()
 {
     return connectSpec;
 }
@@ -794,13 +799,13 @@ void BusAttachment::ClearKeyStore()
     busInternal->keyStore.Clear();
 }
 
-const qcc::String BusAttachment::GetUniqueName() const
+const qcc::String& BusAttachment::GetUniqueName() const
 {
     /*
      * Cannot have a valid unique name if not connected to the bus.
      */
     if (!IsConnected()) {
-        return "";
+        return qcc::String::Empty;
     }
     return busInternal->localEndpoint->GetUniqueName();
 }
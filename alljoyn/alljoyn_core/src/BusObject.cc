@@ -32,6 +32,7 @@
 #include <qcc/Util.h>
 #include <qcc/String.h>
 #include <qcc/Mutex.h>
+#include <qcc/Timer.h>
 #include <qcc/XmlElement.h>
 #include <alljoyn/DBusStd.h>
 #include <alljoyn/AllJoynStd.h>
@@ -60,6 +61,10 @@ typedef struct {
 } MethodContext;
 
 struct BusObject::Components {
+    class PropChangedQueue;
+
+    Components() : inUseCounter(0), propChanged(NULL) { }
+
     /** The interfaces this object implements */
     vector<pair<const InterfaceDescription*, bool> > ifaces;
     /** The method handlers for this object */
@@ -72,6 +77,195 @@ struct BusObject::Components {
 
     /** counter to prevent this BusObject being deleted if it is being used by another thread. */
     int32_t inUseCounter;
+
+    /** Queued PropertiesChanged signals, created when a coalescing window is first set */
+    PropChangedQueue* volatile propChanged;
+};
+
+/*
+ * Queues the property changes for the interface and session pairs that have a coalescing window
+ * and sends them from a timer once the window has passed.
+ */
+class BusObject::Components::PropChangedQueue : public AlarmListener {
+  public:
+
+    PropChangedQueue(BusObject& obj) : obj(obj), timer("PropChanged") {
+        timer.Start();
+    }
+
+    ~PropChangedQueue() {
+        timer.Stop();
+        timer.Join();
+        for (QueueMap::iterator it = queues.begin(); it != queues.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    /*
+     * Set the coalescing window for an interface and session.
+     */
+    QStatus SetWindow(const char* ifcName, SessionId id, uint32_t windowMs) {
+        lock.Lock(MUTEX_CONTEXT);
+        Queue*& queue = queues[QueueKey(ifcName, id)];
+        if (!queue) {
+            queue = new Queue(ifcName, id);
+        }
+        queue->windowMs = windowMs;
+        lock.Unlock(MUTEX_CONTEXT);
+        return windowMs ? ER_OK : Flush(ifcName, id);
+    }
+
+    /*
+     * Queue changed and invalidated properties. Returns false if the interface and session
+     * are not being coalesced and the caller must send the signal itself.
+     */
+    bool Add(const char* ifcName, SessionId id, uint8_t flags,
+             const char** updatedNames, const MsgArg* updatedValues, size_t numUpdated,
+             const char** invalidatedNames, size_t numInvalidated) {
+        Batch batch;
+        lock.Lock(MUTEX_CONTEXT);
+        QueueMap::iterator it = queues.find(QueueKey(ifcName, id));
+        if ((it == queues.end()) || (it->second->windowMs == 0)) {
+            lock.Unlock(MUTEX_CONTEXT);
+            return false;
+        }
+        Queue* queue = it->second;
+        if (queue->armed && (queue->flags != flags)) {
+            /* Changes sent with different flags cannot share a signal */
+            Take(*queue, batch);
+        }
+        queue->flags = flags;
+        for (size_t i = 0; i < numUpdated; ++i) {
+            std::map<qcc::String, MsgArg>::iterator vit = queue->values.find(updatedNames[i]);
+            if (vit != queue->values.end()) {
+                vit->second = updatedValues[i];
+                ++queue->counters.superseded;
+            } else {
+                queue->values[updatedNames[i]] = updatedValues[i];
+                queue->counters.superseded += queue->invalidated.erase(updatedNames[i]);
+            }
+        }
+        for (size_t i = 0; i < numInvalidated; ++i) {
+            if (!queue->invalidated.insert(invalidatedNames[i]).second) {
+                ++queue->counters.superseded;
+            } else {
+                queue->counters.superseded += queue->values.erase(invalidatedNames[i]);
+            }
+        }
+        queue->counters.updates += numUpdated + numInvalidated;
+        if (!queue->armed && (numUpdated + numInvalidated)) {
+            AlarmListener* listener = this;
+            void* context = queue;
+            queue->alarm = Alarm(queue->windowMs, listener, context);
+            queue->armed = (timer.AddAlarm(queue->alarm) == ER_OK);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        Send(batch);
+        return true;
+    }
+
+    /*
+     * Send the queued changes for an interface and session now.
+     */
+    QStatus Flush(const char* ifcName, SessionId id) {
+        Batch batch;
+        lock.Lock(MUTEX_CONTEXT);
+        QueueMap::iterator it = queues.find(QueueKey(ifcName, id));
+        if ((it != queues.end()) && it->second->armed) {
+            Take(*it->second, batch);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        return Send(batch);
+    }
+
+    void GetCounters(const char* ifcName, SessionId id, PropChangedCounters& counters) {
+        lock.Lock(MUTEX_CONTEXT);
+        QueueMap::const_iterator it = queues.find(QueueKey(ifcName, id));
+        counters = (it != queues.end()) ? it->second->counters : PropChangedCounters();
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    void AlarmTriggered(const Alarm& alarm, QStatus reason) {
+        Batch batch;
+        lock.Lock(MUTEX_CONTEXT);
+        Queue* queue = static_cast<Queue*>(alarm->GetContext());
+        if (queue->armed && (reason == ER_OK)) {
+            Take(*queue, batch);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        Send(batch);
+    }
+
+  private:
+
+    typedef std::pair<qcc::String, SessionId> QueueKey;
+
+    /* The changes queued for one interface and session */
+    struct Queue {
+        qcc::String ifcName;
+        SessionId id;
+        uint32_t windowMs;
+        uint8_t flags;
+        bool armed;                             /* True while changes are queued and the alarm is set */
+        Alarm alarm;
+        std::map<qcc::String, MsgArg> values;   /* Latest values of the changed properties */
+        std::set<qcc::String> invalidated;      /* Invalidated properties */
+        PropChangedCounters counters;
+
+        Queue(const char* ifcName, SessionId id) : ifcName(ifcName), id(id), windowMs(0), flags(0), armed(false) { }
+    };
+
+    /* Changes taken off a queue to be sent as one signal */
+    struct Batch {
+        Queue* queue;
+        uint8_t flags;
+        std::map<qcc::String, MsgArg> values;
+        std::set<qcc::String> invalidated;
+
+        Batch() : queue(NULL), flags(0) { }
+    };
+
+    typedef std::map<QueueKey, Queue*> QueueMap;
+
+    /* Move the changes from a queue to a batch, called with the lock held */
+    void Take(Queue& queue, Batch& batch) {
+        timer.RemoveAlarm(queue.alarm, false);
+        batch.queue = &queue;
+        batch.flags = queue.flags;
+        batch.values.swap(queue.values);
+        batch.invalidated.swap(queue.invalidated);
+        queue.armed = false;
+    }
+
+    QStatus Send(Batch& batch) {
+        if (!batch.queue) {
+            return ER_OK;
+        }
+        std::vector<MsgArg> updated(batch.values.size());
+        std::vector<const char*> invalidated;
+        invalidated.reserve(batch.invalidated.size());
+        size_t i = 0;
+        for (std::map<qcc::String, MsgArg>::iterator it = batch.values.begin(); it != batch.values.end(); ++it) {
+            updated[i++].Set("{sv}", it->first.c_str(), &it->second);
+        }
+        for (std::set<qcc::String>::const_iterator it = batch.invalidated.begin(); it != batch.invalidated.end(); ++it) {
+            invalidated.push_back(it->c_str());
+        }
+        QStatus status = obj.SendPropChanged(batch.queue->ifcName.c_str(), batch.queue->id, batch.flags,
+                                             updated.empty() ? NULL : &updated[0], updated.size(),
+                                             invalidated.empty() ? NULL : &invalidated[0], invalidated.size());
+        if (status == ER_OK) {
+            lock.Lock(MUTEX_CONTEXT);
+            ++batch.queue->counters.signals;
+            lock.Unlock(MUTEX_CONTEXT);
+        }
+        return status;
+    }
+
+    BusObject& obj;
+    qcc::Mutex lock;        /* Protects the queues */
+    qcc::Timer timer;       /* Sends the queued changes at the end of each window */
+    QueueMap queues;        /* Queues are never removed so alarms can refer to them */
 };
 
 
@@ -239,29 +433,15 @@ void BusObject::EmitPropChanged(const char* ifcName, const char* propName, MsgAr
     qcc::String emitsChanged;
     if (ifc && ifc->GetPropertyAnnotation(propName, org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged)) {
         QCC_DbgPrintf(("emitsChanged = %s", emitsChanged.c_str()));
+        Components::PropChangedQueue* propChanged = components->propChanged;
         if (emitsChanged == "true") {
-            const InterfaceDescription* bus_ifc = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
-            const InterfaceDescription::Member* propChanged = (bus_ifc ? bus_ifc->GetMember("PropertiesChanged") : NULL);
-
-            QCC_DbgPrintf(("propChanged = %s", propChanged ? propChanged->name.c_str() : NULL));
-            if (propChanged != NULL) {
-                MsgArg args[3];
-                args[0].Set("s", ifcName);
-                MsgArg str("{sv}", propName, &val);
-                args[1].Set("a{sv}", 1, &str);
-                args[2].Set("as", 0, NULL);
-                Signal(NULL, id, *propChanged, args, ArraySize(args), 0, flags);
+            MsgArg str("{sv}", propName, &val);
+            if (!propChanged || !propChanged->Add(ifcName, id, flags, &propName, &val, 1, NULL, 0)) {
+                SendPropChanged(ifcName, id, flags, &str, 1, NULL, 0);
             }
         } else if (emitsChanged == "invalidates") {
-            const InterfaceDescription* bus_ifc = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
-            const InterfaceDescription::Member* propChanged = (bus_ifc ? bus_ifc->GetMember("PropertiesChanged") : NULL);
-            if (NULL != propChanged) {
-                // EMPTY array, followed by array of strings
-                MsgArg args[3];
-                args[0].Set("s", ifcName);
-                args[1].Set("a{sv}", 0, NULL);
-                args[2].Set("as", 1, &propName);
-                Signal(NULL, id, *propChanged, args, ArraySize(args), 0, flags);
+            if (!propChanged || !propChanged->Add(ifcName, id, flags, NULL, NULL, 0, &propName, 1)) {
+                SendPropChanged(ifcName, id, flags, NULL, 0, &propName, 1);
             }
         }
     }
@@ -277,10 +457,10 @@ QStatus BusObject::EmitPropChanged(const char* ifcName, const char** propNames,
     if (!ifc) {
         status = ER_BUS_UNKNOWN_INTERFACE;
     } else {
-        MsgArg* updatedProp = new MsgArg[numProps];
-        const char** invalidatedProp = new const char*[numProps];
-        size_t updatedPropNum = 0;
-        size_t invalidatedPropNum = 0;
+        vector<const char*> updatedNames;
+        vector<MsgArg> updatedValues(numProps);
+        vector<const char*> invalidatedProp;
+        updatedNames.reserve(numProps);
 
         for (size_t i = 0; i < numProps; ++i) {
             const char* propName = propNames[i];
@@ -295,43 +475,90 @@ QStatus BusObject::EmitPropChanged(const char* ifcName, const char** propNames,
                 /* property has emitschanged annotation and is readable */
                 if (emitsChanged == "true") {
                     /* also emit the value */
-                    MsgArg* val = new MsgArg();
-                    status = Get(ifcName, propName, *val);
+                    status = Get(ifcName, propName, updatedValues[updatedNames.size()]);
                     if (status != ER_OK) {
-                        delete val;
                         status = ER_BUS_NO_SUCH_PROPERTY;
                         break;
                     }
-                    updatedProp[updatedPropNum].Set("{sv}", propName, val);
-                    updatedProp[updatedPropNum].SetOwnershipFlags(MsgArg::OwnsArgs, true /*deep*/);
-                    updatedPropNum++;
+                    updatedNames.push_back(propName);
                 } else if (emitsChanged == "invalidates") {
                     /* only emit that it's invalidated */
-                    invalidatedProp[invalidatedPropNum] = propName;
-                    invalidatedPropNum++;
+                    invalidatedProp.push_back(propName);
                 }
             }
         }
         if (status == ER_OK) {
-            const InterfaceDescription* bus_ifc = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
-            assert(bus_ifc);
-            const InterfaceDescription::Member* propChanged = bus_ifc->GetMember("PropertiesChanged");
-            assert(propChanged);
-
-            MsgArg args[3];
-            args[0].Set("s", ifcName);
-            args[1].Set("a{sv}", updatedPropNum, updatedProp);
-            args[2].Set("as", invalidatedPropNum, invalidatedProp);
-            /* send the signal */
-            status = Signal(NULL, id, *propChanged, args, ArraySize(args), 0, flags);
+            const char** invalidated = invalidatedProp.empty() ? NULL : &invalidatedProp[0];
+            Components::PropChangedQueue* propChanged = components->propChanged;
+            if (!propChanged || !propChanged->Add(ifcName, id, flags, updatedNames.empty() ? NULL : &updatedNames[0],
+                                                  updatedValues.empty() ? NULL : &updatedValues[0], updatedNames.size(),
+                                                  invalidated, invalidatedProp.size())) {
+                vector<MsgArg> updatedProp(updatedNames.size());
+                for (size_t i = 0; i < updatedNames.size(); ++i) {
+                    updatedProp[i].Set("{sv}", updatedNames[i], &updatedValues[i]);
+                }
+                status = SendPropChanged(ifcName, id, flags, updatedProp.empty() ? NULL : &updatedProp[0], updatedProp.size(),
+                                         invalidated, invalidatedProp.size());
+            }
         }
-
-        delete[] updatedProp;
-        delete[] invalidatedProp;
     }
     return status;
 }
 
+QStatus BusObject::SendPropChanged(const char* ifcName, SessionId id, uint8_t flags,
+                                   const MsgArg* updated, size_t numUpdated,
+                                   const char** invalidated, size_t numInvalidated)
+{
+    const InterfaceDescription* bus_ifc = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    const InterfaceDescription::Member* propChanged = (bus_ifc ? bus_ifc->GetMember("PropertiesChanged") : NULL);
+    QCC_DbgPrintf(("propChanged = %s", propChanged ? propChanged->name.c_str() : NULL));
+    if (propChanged == NULL) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+    MsgArg args[3];
+    args[0].Set("s", ifcName);
+    args[1].Set("a{sv}", numUpdated, updated);
+    args[2].Set("as", numInvalidated, invalidated);
+    return Signal(NULL, id, *propChanged, args, ArraySize(args), 0, flags);
+}
+
+QStatus BusObject::SetPropChangedWindow(const char* ifcName, SessionId id, uint32_t windowMs)
+{
+    if (!LookupInterface(components->ifaces, ifcName)) {
+        return ER_BUS_UNKNOWN_INTERFACE;
+    }
+    if (!components->propChanged) {
+        if (windowMs == 0) {
+            return ER_OK;
+        }
+        components->counterLock.Lock(MUTEX_CONTEXT);
+        if (!components->propChanged) {
+            components->propChanged = new Components::PropChangedQueue(*this);
+        }
+        components->counterLock.Unlock(MUTEX_CONTEXT);
+    }
+    return components->propChanged->SetWindow(ifcName, id, windowMs);
+}
+
+QStatus BusObject::FlushPropChanged(const char* ifcName, SessionId id)
+{
+    Components::PropChangedQueue* propChanged = components->propChanged;
+    return propChanged ? propChanged->Flush(ifcName, id) : ER_OK;
+}
+
+QStatus BusObject::GetPropChangedCounters(const char* ifcName, SessionId id, PropChangedCounters& counters)
+{
+    if (!LookupInterface(components->ifaces, ifcName)) {
+        return ER_BUS_UNKNOWN_INTERFACE;
+    }
+    Components::PropChangedQueue* propChanged = components->propChanged;
+    if (propChanged) {
+        propChanged->GetCounters(ifcName, id, counters);
+    } else {
+        counters = PropChangedCounters();
+    }
+    return ER_OK;
+}
 
 void BusObject::SetProp(const InterfaceDescription::Member* member, Message& msg)
 {
@@ -835,7 +1062,6 @@ BusObject::BusObject(BusAttachment& bus, const char* path, bool isPlaceholder) :
     description(),
     translator(NULL)
 {
-    components->inUseCounter = 0;
 }
 
 BusObject::BusObject(const char* path, bool isPlaceholder) :
@@ -850,11 +1076,14 @@ BusObject::BusObject(const char* path, bool isPlaceholder) :
     description(),
     translator(NULL)
 {
-    components->inUseCounter = 0;
 }
 
 BusObject::~BusObject()
 {
+    /* Stop sending queued property changes before anything else is torn down */
+    delete components->propChanged;
+    components->propChanged = NULL;
+
     components->counterLock.Lock(MUTEX_CONTEXT);
     while (components->inUseCounter != 0) {
         components->counterLock.Unlock(MUTEX_CONTEXT);
@@ -188,13 +188,59 @@ class ClientTransport : public Transport, public _RemoteEndpoint::EndpointListen
      */
     void EndpointExit(RemoteEndpoint& endpoint);
 
+  protected:
+
+    /**
+     * Create a client transport.
+     *
+     * @param bus           The bus associated with this transport.
+     * @param sharedMemory  True if the connection is moved onto shared memory once established.
+     */
+    ClientTransport(BusAttachment& bus, bool sharedMemory);
+
   private:
     BusAttachment& m_bus;           /**< The message bus for this transport */
+    bool m_sharedMemory;            /**< True if the connection is moved onto shared memory */
     bool m_running;                 /**< True after Start() has been called, before Stop() */
     TransportListener* m_listener;  /**< Registered TransportListener */
     RemoteEndpoint m_endpoint;      /**< The active endpoint */
 };
 
+#if defined(QCC_OS_LINUX)
+/**
+ * @brief A client transport that exchanges messages with a local daemon through shared memory.
+ *
+ * The connection is made and authenticated on a unix domain socket exactly as
+ * it is by the ClientTransport, the daemon then hands over a shared memory
+ * region that carries the message bytes.  Unix file descriptors cannot be
+ * passed over this transport.
+ */
+class ShmClientTransport : public ClientTransport {
+  public:
+    /**
+     * Create a shared memory client transport.
+     *
+     * @param bus  The bus associated with this transport.
+     */
+    ShmClientTransport(BusAttachment& bus) : ClientTransport(bus, true) { }
+
+    /**
+     * Returns the name of this transport
+     */
+    const char* GetTransportName() const { return TransportName; }
+
+    /**
+     * Name of transport used in transport specs.
+     */
+    static const char* TransportName;
+
+    /**
+     * Returns true if the shared memory client transport is available on this platform.
+     */
+    static bool IsAvailable() { return true; }
+};
+#endif
+
 } // namespace ajn
 
 #endif // _ALLJOYN_CLIENTTRANSPORT_H
@@ -43,7 +43,11 @@ using namespace qcc;
 
 namespace ajn {
 
-ClientTransport::ClientTransport(BusAttachment& bus) : m_bus(bus), m_listener(0)
+ClientTransport::ClientTransport(BusAttachment& bus) : m_bus(bus), m_sharedMemory(false), m_listener(0)
+{
+}
+
+ClientTransport::ClientTransport(BusAttachment& bus, bool sharedMemory) : m_bus(bus), m_sharedMemory(sharedMemory), m_listener(0)
 {
 }
 
@@ -21,49 +21,110 @@
 
 #include <qcc/platform.h>
 
+#include <limits>
+
 #include <qcc/Util.h>
 #include <qcc/Mutex.h>
 #include <qcc/Debug.h>
+#include <qcc/time.h>
 #include <alljoyn/Status.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/Message.h>
 
-#include "Adler32.h"
+#include "SignatureUtils.h"
 #include "CompressionRules.h"
 
 #define QCC_MODULE "ALLJOYN"
 
+#define ROUNDUP8(n)  (((n) + 7) & ~7)
+
 using namespace qcc;
 using namespace std;
 
 namespace ajn {
 
-void _CompressionRules::Add(const HeaderFields& hdrFields, uint32_t token)
+_CompressionRules::_CompressionRules(size_t maxRules) : maxRules(maxRules ? maxRules : 1)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+_CompressionRules::Rule* _CompressionRules::Add(const HeaderFields& hdrFields, uint32_t token, size_t fingerprint)
 {
-    HeaderFields* expFields = new HeaderFields;
+    if ((tokenMap.size() >= maxRules) && !pins.empty()) {
+        ReleaseExpired();
+    }
     /*
-     * Copy compressible fields.
+     * Make room by evicting the least recently used rule. Pinned rules are not in the LRU list so
+     * the table only grows past maxRules while queued sessionless messages need the rules.
      */
-    for (size_t i = 0; i < ArraySize(expFields->field); i++) {
+    while ((tokenMap.size() >= maxRules) && !lru.empty()) {
+        QCC_DbgPrintf(("Evicting compression rule %u", lru.back()->token));
+        Remove(lru.back());
+        ++stats.evictions;
+    }
+    Rule* rule = new Rule;
+    rule->token = token;
+    rule->fingerprint = fingerprint;
+    rule->pins = 0;
+    /*
+     * Copy compressible fields. The savings are the space these fields would have used on the wire
+     * less the space used by the compression token.
+     */
+    size_t fieldsLen = 0;
+    for (size_t i = 0; i < ArraySize(rule->fields.field); i++) {
         if (HeaderFields::Compressible[i]) {
-            expFields->field[i] = hdrFields.field[i];
+            rule->fields.field[i] = hdrFields.field[i];
+            if (rule->fields.field[i].typeId != ALLJOYN_INVALID) {
+                fieldsLen += ROUNDUP8(SignatureUtils::GetSize(&rule->fields.field[i], 1, 4));
+            }
         }
     }
+    MsgArg tokenField("u", token);
+    const size_t tokenLen = ROUNDUP8(SignatureUtils::GetSize(&tokenField, 1, 4));
+    rule->savings = (fieldsLen > tokenLen) ? (fieldsLen - tokenLen) : 0;
     /*
      * Add forward and reverse mapping.
      */
-    tokenMap[token] = expFields;
-    fieldMap[expFields] = token;
-    QCC_DbgHLPrintf(("Added compression/expansion rule %u <-->\n%s", token, expFields->ToString().c_str()));
+    lru.push_front(rule);
+    rule->lruPos = lru.begin();
+    tokenMap[token] = rule;
+    fieldMap.insert(std::pair<const size_t, Rule*>(fingerprint, rule));
+    QCC_DbgHLPrintf(("Added compression/expansion rule %u <-->\n%s", token, rule->fields.ToString().c_str()));
+    return rule;
+}
+
+void _CompressionRules::Remove(Rule* rule)
+{
+    pair<unordered_multimap<size_t, Rule*>::iterator, unordered_multimap<size_t, Rule*>::iterator> range = fieldMap.equal_range(rule->fingerprint);
+    for (unordered_multimap<size_t, Rule*>::iterator iter = range.first; iter != range.second; ++iter) {
+        if (iter->second == rule) {
+            fieldMap.erase(iter);
+            break;
+        }
+    }
+    tokenMap.erase(rule->token);
+    lru.erase(rule->lruPos);
+    delete rule;
+}
+
+_CompressionRules::Rule* _CompressionRules::Find(const HeaderFields& hdrFields, size_t fingerprint)
+{
+    pair<unordered_multimap<size_t, Rule*>::iterator, unordered_multimap<size_t, Rule*>::iterator> range = fieldMap.equal_range(fingerprint);
+    for (unordered_multimap<size_t, Rule*>::iterator iter = range.first; iter != range.second; ++iter) {
+        if (FieldsEqual(iter->second->fields, hdrFields)) {
+            return iter->second;
+        }
+    }
+    return NULL;
 }
 
 void _CompressionRules::AddExpansion(const HeaderFields& hdrFields, uint32_t token)
 {
     if (token) {
         lock.Lock(MUTEX_CONTEXT);
-        if (fieldMap.count(&hdrFields) == 0) {
-            Add(hdrFields, token);
+        if (tokenMap.count(token) == 0) {
+            Add(hdrFields, token, Fingerprint(hdrFields));
         }
         lock.Unlock(MUTEX_CONTEXT);
     }
@@ -72,46 +133,156 @@ void _CompressionRules::AddExpansion(const HeaderFields& hdrFields, uint32_t tok
 uint32_t _CompressionRules::GetToken(const HeaderFields& hdrFields)
 {
     uint32_t token;
+    const size_t fingerprint = Fingerprint(hdrFields);
     lock.Lock(MUTEX_CONTEXT);
-    unordered_map<const HeaderFields*, uint32_t, HdrFieldHash, HdrFieldsEq>::iterator iter = fieldMap.find(&hdrFields);
-    if (iter != fieldMap.end()) {
-        token = iter->second;
+    Rule* rule = Find(hdrFields, fingerprint);
+    if (rule) {
+        Touch(rule);
+        ++stats.hits;
     } else {
         /*
          * Allocate a random token (check it isn't zero and not in use)
          */
-        do { token = Rand32(); } while (token && GetExpansion(token));
-        Add(hdrFields, token);
+        do { token = Rand32(); } while (!token || tokenMap.count(token));
+        rule = Add(hdrFields, token, fingerprint);
     }
+    token = rule->token;
+    ++stats.compressed;
+    stats.bytesSaved += rule->savings;
     lock.Unlock(MUTEX_CONTEXT);
     return token;
 }
 
-const HeaderFields* _CompressionRules::GetExpansion(uint32_t token)
+bool _CompressionRules::Expand(uint32_t token, HeaderFields& hdrFields)
 {
-    const HeaderFields* expansion = NULL;
+    bool expanded = false;
     if (token) {
         lock.Lock(MUTEX_CONTEXT);
-        map<uint32_t, const HeaderFields*>::iterator iter = tokenMap.find(token);
-        expansion = (iter != tokenMap.end()) ? iter->second : NULL;
+        unordered_map<uint32_t, Rule*>::iterator iter = tokenMap.find(token);
+        if (iter != tokenMap.end()) {
+            Rule* rule = iter->second;
+            for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
+                if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
+                    hdrFields.field[id] = rule->fields.field[id];
+                }
+            }
+            Touch(rule);
+            ++stats.expanded;
+            expanded = true;
+        } else {
+            ++stats.misses;
+        }
         lock.Unlock(MUTEX_CONTEXT);
     }
-    return expansion;
+    return expanded;
+}
+
+void _CompressionRules::Release(Rule* rule)
+{
+    if (--rule->pins == 0) {
+        lru.push_back(rule);
+        rule->lruPos = --lru.end();
+    }
+}
+
+void _CompressionRules::ReleaseExpired()
+{
+    const uint64_t now = GetTimestamp64();
+    map<String, PinnedRule>::iterator iter = pins.begin();
+    while (iter != pins.end()) {
+        if (iter->second.expires && (iter->second.expires <= now)) {
+            Release(iter->second.rule);
+            pins.erase(iter++);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void _CompressionRules::Pin(const qcc::String& key, uint32_t token, uint32_t tillExpireMS)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    unordered_map<uint32_t, Rule*>::iterator iter = tokenMap.find(token);
+    Rule* rule = (iter != tokenMap.end()) ? iter->second : NULL;
+    map<String, PinnedRule>::iterator pit = pins.find(key);
+    /*
+     * The message replaces one queued with the same key so that message no longer needs its rule.
+     */
+    if ((pit != pins.end()) && (pit->second.rule != rule)) {
+        Release(pit->second.rule);
+        pins.erase(pit);
+        pit = pins.end();
+    }
+    if (rule) {
+        if (pit == pins.end()) {
+            if (rule->pins++ == 0) {
+                lru.erase(rule->lruPos);
+            }
+            pit = pins.insert(pair<const String, PinnedRule>(key, PinnedRule())).first;
+            pit->second.rule = rule;
+        }
+        if (tillExpireMS == (numeric_limits<uint32_t>::max)()) {
+            pit->second.expires = 0;
+        } else {
+            pit->second.expires = GetTimestamp64() + tillExpireMS;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void _CompressionRules::Unpin(const qcc::String& key)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    map<String, PinnedRule>::iterator pit = pins.find(key);
+    if (pit != pins.end()) {
+        Release(pit->second.rule);
+        pins.erase(pit);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+bool _CompressionRules::HasExpansion(uint32_t token)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    bool found = tokenMap.count(token) != 0;
+    lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
+void _CompressionRules::GetStatistics(Statistics& statistics)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    statistics = stats;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+size_t _CompressionRules::GetNumRules()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    size_t numRules = tokenMap.size();
+    lock.Unlock(MUTEX_CONTEXT);
+    return numRules;
+}
+
+size_t _CompressionRules::GetNumPinned()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    size_t numPinned = pins.size();
+    lock.Unlock(MUTEX_CONTEXT);
+    return numPinned;
 }
 
 _CompressionRules::~_CompressionRules()
 {
-    map<uint32_t, const ajn::HeaderFields*>::iterator iter = tokenMap.begin();
-    while (iter != tokenMap.end()) {
+    for (unordered_map<uint32_t, Rule*>::iterator iter = tokenMap.begin(); iter != tokenMap.end(); ++iter) {
         delete iter->second;
-        iter++;
     }
 }
 
-bool _CompressionRules::HdrFieldsEq::operator()(const HeaderFields* k1, const HeaderFields* k2) const
+bool _CompressionRules::FieldsEqual(const HeaderFields& k1, const HeaderFields& k2)
 {
-    const MsgArg* f1 = k1->field;
-    const MsgArg* f2 = k2->field;
+    const MsgArg* f1 = k1.field;
+    const MsgArg* f2 = k2.field;
     for (int i = 0; i < ALLJOYN_HDR_FIELD_UNKNOWN; i++, f1++, f2++) {
         if (HeaderFields::Compressible[i]) {
             if (f1->typeId != f2->typeId) {
@@ -154,18 +325,51 @@ bool _CompressionRules::HdrFieldsEq::operator()(const HeaderFields* k1, const He
     return true;
 }
 
-size_t _CompressionRules::HdrFieldHash::operator()(const HeaderFields* k) const
+/*
+ * FNV-1a over the type and value of each compressible field.
+ */
+static inline size_t FnvUpdate(size_t hash, const void* data, size_t len)
 {
-    Adler32 adler;
-    size_t hash = 0;
-    if (k->field[ALLJOYN_HDR_FIELD_MEMBER].typeId == ALLJOYN_STRING) {
-        hash = adler.Update((uint8_t*)k->field[ALLJOYN_HDR_FIELD_MEMBER].v_string.str, k->field[ALLJOYN_HDR_FIELD_MEMBER].v_string.len);
-    }
-    if (k->field[ALLJOYN_HDR_FIELD_INTERFACE].typeId == ALLJOYN_STRING) {
-        hash = adler.Update((uint8_t*)k->field[ALLJOYN_HDR_FIELD_INTERFACE].v_string.str, k->field[ALLJOYN_HDR_FIELD_INTERFACE].v_string.len);
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (len--) {
+        hash = (hash ^ *p++) * 16777619;
     }
     return hash;
+}
+
+size_t _CompressionRules::Fingerprint(const HeaderFields& hdrFields)
+{
+    size_t hash = 2166136261U;
+    for (int i = 0; i < ALLJOYN_HDR_FIELD_UNKNOWN; i++) {
+        if (!HeaderFields::Compressible[i]) {
+            continue;
+        }
+        const MsgArg* f = &hdrFields.field[i];
+        uint8_t typeId = static_cast<uint8_t>(f->typeId);
+        hash = FnvUpdate(hash, &typeId, 1);
+        switch (f->typeId) {
+        case ALLJOYN_STRING:
+        case ALLJOYN_OBJECT_PATH:
+            hash = FnvUpdate(hash, f->v_string.str, f->v_string.len);
+            break;
+
+        case ALLJOYN_SIGNATURE:
+            hash = FnvUpdate(hash, f->v_signature.sig, f->v_signature.len);
+            break;
 
+        case ALLJOYN_UINT16:
+            hash = FnvUpdate(hash, &f->v_uint16, sizeof(f->v_uint16));
+            break;
+
+        case ALLJOYN_UINT32:
+            hash = FnvUpdate(hash, &f->v_uint32, sizeof(f->v_uint32));
+            break;
+
+        default:
+            break;
+        }
+    }
+    return hash;
 }
 
 }
@@ -35,6 +35,7 @@
 #include <alljoyn/Status.h>
 
 #include <qcc/STLContainer.h>
+#include <list>
 #include <map>
 
 namespace ajn {
@@ -59,14 +60,37 @@ class _CompressionRules {
 
   public:
 
+    /**
+     * Default upper bound on the number of compression/expansion rules kept in the table.
+     */
+    static const size_t DEFAULT_MAX_RULES = 1024;
+
+    /**
+     * Counters describing how well header compression is working.
+     */
+    struct Statistics {
+        uint32_t compressed;     ///< Number of headers compressed
+        uint32_t hits;           ///< Compressed headers that reused an existing token
+        uint32_t expanded;       ///< Number of headers expanded
+        uint32_t misses;         ///< Expansions that failed because the token was unknown
+        uint32_t evictions;      ///< Rules evicted to keep the table within bounds
+        uint64_t bytesSaved;     ///< Approximate header bytes omitted from the wire by compression
+    };
+
+    /**
+     * Constructor
+     *
+     * @param maxRules  The maximum number of rules to keep. The least recently used rule is
+     *                  evicted when a new rule would exceed this bound.
+     */
+    _CompressionRules(size_t maxRules = DEFAULT_MAX_RULES);
+
     /**
      * Add a new expansion rule to the expansion table. This is an expansion that was received from
      * a remote peer. Note that 0 is an invalid token value.
      *
      * @param hdrFields  The header fields to add.
      * @param token      The compression token for the header fields.
-     *
-     * @return ER_OK if the expansion rule was added.
      */
     void AddExpansion(const HeaderFields& hdrFields, uint32_t token);
 
@@ -80,14 +104,64 @@ class _CompressionRules {
     uint32_t GetToken(const HeaderFields& hdrFields);
 
     /**
-     * Perform the lookup of the expansion given a compression token. Note that token must
-     * be non-zero.
+     * Expand a compressed header. Compressible fields that are already present in hdrFields are
+     * not overwritten. Note that token must be non-zero.
+     *
+     * The expansion is copied while the rules are locked so the result stays valid even if the
+     * rule is later evicted.
+     *
+     * @param token      The compression token to lookup.
+     * @param hdrFields  The header fields to expand.
+     *
+     * @return  true if the token was known and the header was expanded.
+     */
+    bool Expand(uint32_t token, HeaderFields& hdrFields);
+
+    /**
+     * Check if there is an expansion rule for a compression token.
      *
      * @param token  The compression token to lookup.
      *
-     * @return  The expansion for the compression token or NULL if there is no such expansion.
+     * @return  true if there is an expansion for the compression token.
+     */
+    bool HasExpansion(uint32_t token);
+
+    /**
+     * Keep the rule for a compression token while a queued sessionless message uses it. Remote
+     * peers ask for the expansion of a sessionless message long after it was sent, so a pinned
+     * rule is never evicted. A key pins at most one rule: pinning the key again releases the rule
+     * it pinned before, just as a newer sessionless message replaces the queued one.
+     *
+     * @param key           Identifies the queued message as "sender:interface:member:path".
+     * @param token         The compression token of the queued message.
+     * @param tillExpireMS  Time until the queued message expires as returned by
+     *                      Message::IsExpired().
+     */
+    void Pin(const qcc::String& key, uint32_t token, uint32_t tillExpireMS);
+
+    /**
+     * Release the rule pinned by a key once its sessionless message is no longer queued.
+     *
+     * @param key  The key the rule was pinned with.
+     */
+    void Unpin(const qcc::String& key);
+
+    /**
+     * Get a snapshot of the compression counters.
+     *
+     * @param stats  Returns the current counters.
      */
-    const HeaderFields* GetExpansion(uint32_t token);
+    void GetStatistics(Statistics& stats);
+
+    /**
+     * Get the number of rules currently in the table.
+     */
+    size_t GetNumRules();
+
+    /**
+     * Get the number of keys currently pinning a rule.
+     */
+    size_t GetNumPinned();
 
     /**
      * Destructor
@@ -97,39 +171,111 @@ class _CompressionRules {
   private:
 
     /**
-     * Add a compression/expansion rule.
+     * A single compression/expansion rule.
      */
-    void Add(const HeaderFields& hdrFields, uint32_t token);
+    struct Rule {
+        HeaderFields fields;                  ///< The compressible header fields
+        uint32_t token;                       ///< The compression token
+        size_t fingerprint;                   ///< Hash of the compressible fields, computed once
+        size_t savings;                       ///< Approximate bytes saved each time the rule is used
+        uint32_t pins;                        ///< Number of keys pinning the rule
+        std::list<Rule*>::iterator lruPos;    ///< Position in the LRU list, unused while pinned
+    };
 
     /**
-     * Mutex to protect compression rules maps
+     * A rule pinned by a queued sessionless message.
      */
-    qcc::Mutex lock;
+    struct PinnedRule {
+        Rule* rule;                           ///< The pinned rule
+        uint64_t expires;                     ///< When the message expires, 0 if it does not
+    };
 
     /**
-     * Hash funcion for header compression. Hash value is computed over member and interface only.
-     * on the reasonable assumption that there will only be one compression for a specific message.
+     * Assignment and copy are not allowed
      */
-    struct HdrFieldHash {
-        size_t operator()(const HeaderFields* k) const;
-    };
+    _CompressionRules(const _CompressionRules& other);
+    _CompressionRules& operator=(const _CompressionRules& other);
+
+    /**
+     * Add a compression/expansion rule evicting the least recently used rule if necessary.
+     */
+    Rule* Add(const HeaderFields& hdrFields, uint32_t token, size_t fingerprint);
+
+    /**
+     * Find a rule with the same compressible header fields.
+     */
+    Rule* Find(const HeaderFields& hdrFields, size_t fingerprint);
+
+    /**
+     * Move a rule to the most recently used end of the LRU list.
+     */
+    void Touch(Rule* rule) {
+        if (!rule->pins) {
+            lru.splice(lru.begin(), lru, rule->lruPos);
+        }
+    }
+
+    /**
+     * Drop a pin on a rule. A rule that is no longer pinned goes back to the least recently used
+     * end of the LRU list since no queued message needs it.
+     */
+    void Release(Rule* rule);
+
+    /**
+     * Release the pins of sessionless messages that have expired.
+     */
+    void ReleaseExpired();
+
+    /**
+     * Remove a rule from all of the maps and free it.
+     */
+    void Remove(Rule* rule);
+
+    /**
+     * Hash funcion for header compression. Hash value is computed over all of the compressible
+     * header fields.
+     */
+    static size_t Fingerprint(const HeaderFields& hdrFields);
 
     /**
      * Function for testing compressible message header fields for equality.
      */
-    struct HdrFieldsEq {
-        bool operator()(const HeaderFields* k1, const HeaderFields* k2) const;
-    };
+    static bool FieldsEqual(const HeaderFields& k1, const HeaderFields& k2);
+
+    /**
+     * Mutex to protect compression rules maps
+     */
+    qcc::Mutex lock;
+
+    /**
+     * Upper bound on the number of rules
+     */
+    const size_t maxRules;
 
     /**
-     * The header compression mapping from header fields to compression token
+     * The header compression mapping from the header fields fingerprint to compression rules
      */
-    std::unordered_map<const ajn::HeaderFields*, uint32_t, HdrFieldHash, HdrFieldsEq> fieldMap;
+    std::unordered_multimap<size_t, Rule*> fieldMap;
 
     /*
-     * The header expansion mapping from compression token to header fields
+     * The header expansion mapping from compression token to compression rules
+     */
+    std::unordered_map<uint32_t, Rule*> tokenMap;
+
+    /**
+     * Unpinned rules ordered from most to least recently used
+     */
+    std::list<Rule*> lru;
+
+    /**
+     * Pinned rules keyed by the sessionless message that uses them
+     */
+    std::map<qcc::String, PinnedRule> pins;
+
+    /**
+     * Compression counters
      */
-    std::map<uint32_t, const ajn::HeaderFields*> tokenMap;
+    Statistics stats;
 
 };
 
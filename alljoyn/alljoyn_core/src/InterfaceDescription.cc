@@ -25,6 +25,7 @@
 #include <qcc/StringMapKey.h>
 #include <qcc/XmlElement.h>
 #include <map>
+#include <vector>
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/Status.h>
 
@@ -268,6 +269,25 @@ struct InterfaceDescription::Definitions {
     typedef std::map<qcc::StringMapKey, Member> MemberMap;
     typedef std::map<qcc::StringMapKey, Property> PropertyMap;
 
+    /** Member index entry */
+    struct MemberSlot {
+        const char* name;               /**< Member name or NULL for an empty slot */
+        uint32_t hash;                  /**< Hash of the name */
+        const Member* member;           /**< The member */
+        SignatureInfo args;             /**< Layout of the member's signature */
+        SignatureInfo returnArgs;       /**< Layout of the member's return signature */
+        MemberSlot() : name(NULL), hash(0), member(NULL) { }
+    };
+
+    /** Property index entry */
+    struct PropertySlot {
+        const char* name;               /**< Property name or NULL for an empty slot */
+        uint32_t hash;                  /**< Hash of the name */
+        const Property* property;       /**< The property */
+        SignatureInfo info;             /**< Layout of the property's signature */
+        PropertySlot() : name(NULL), hash(0), property(NULL) { }
+    };
+
     MemberMap members;              /**< Interface members */
     PropertyMap properties;         /**< Interface properties */
     AnnotationsMap annotations;     /**< Interface Annotations */
@@ -276,16 +296,124 @@ struct InterfaceDescription::Definitions {
     Translator* translator;
     bool hasDescription;
 
+    /*
+     * The members and properties can no longer change once the interface has been activated so
+     * they are indexed in open addressed tables that are sized and seeded so that names rarely,
+     * if ever, share a slot. The tables are empty until the interface is activated.
+     */
+    std::vector<MemberSlot> memberIndex;        /**< Member lookup table */
+    std::vector<PropertySlot> propertyIndex;    /**< Property lookup table */
+    uint32_t memberSeed;                        /**< Hash seed for the member table */
+    uint32_t propertySeed;                      /**< Hash seed for the property table */
+    bool indexed;                               /**< True once the tables have been built */
 
     Definitions() :
-        translator(NULL), hasDescription(false)
+        translator(NULL), hasDescription(false), memberSeed(0), propertySeed(0), indexed(false)
     { }
 
     Definitions(const MemberMap& m, const PropertyMap& p, const AnnotationsMap& a,
                 const qcc::String& langTag, const qcc::String& desc, Translator* dt, bool hd) :
         members(m), properties(p), annotations(a),
-        languageTag(langTag), description(desc), translator(dt), hasDescription(hd)
+        languageTag(langTag), description(desc), translator(dt), hasDescription(hd),
+        memberSeed(0), propertySeed(0), indexed(false)
     { }
+
+    /** FNV-1a hash of a name */
+    static uint32_t Hash(const char* name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261U ^ seed;
+        while (*name) {
+            hash = (hash ^ static_cast<uint8_t>(*name++)) * 16777619U;
+        }
+        return hash;
+    }
+
+    /**
+     * Place slots in a table with at least twice as many entries, trying a few seeds to find one
+     * where no two names share a slot. Names that do collide are placed by linear probing.
+     */
+    template <typename Slot>
+    static void Build(std::vector<Slot>& index, uint32_t& seed, std::vector<Slot>& slots)
+    {
+        size_t size = 4;
+        while (size < 2 * slots.size()) {
+            size <<= 1;
+        }
+        for (seed = 0; seed < MAX_SEEDS; ++seed) {
+            std::vector<bool> used(size, false);
+            bool perfect = true;
+            for (size_t i = 0; perfect && (i < slots.size()); ++i) {
+                slots[i].hash = Hash(slots[i].name, seed);
+                size_t pos = slots[i].hash & (size - 1);
+                perfect = !used[pos];
+                used[pos] = true;
+            }
+            if (perfect) {
+                break;
+            }
+        }
+        if (seed == MAX_SEEDS) {
+            seed = MAX_SEEDS - 1;
+        }
+        index.assign(size, Slot());
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i].hash = Hash(slots[i].name, seed);
+            size_t pos = slots[i].hash & (size - 1);
+            while (index[pos].name) {
+                pos = (pos + 1) & (size - 1);
+            }
+            index[pos] = slots[i];
+        }
+    }
+
+    /** Look up a name in a table built by Build() */
+    template <typename Slot>
+    static const Slot* Find(const std::vector<Slot>& index, uint32_t seed, const char* name)
+    {
+        size_t mask = index.size() - 1;
+        uint32_t hash = Hash(name, seed);
+        for (size_t pos = hash & mask; index[pos].name; pos = (pos + 1) & mask) {
+            if ((index[pos].hash == hash) && (strcmp(index[pos].name, name) == 0)) {
+                return &index[pos];
+            }
+        }
+        return NULL;
+    }
+
+    /** Build the member and property tables */
+    void BuildIndex()
+    {
+        std::vector<MemberSlot> memberSlots(members.size());
+        MemberMap::const_iterator mit = members.begin();
+        for (size_t i = 0; mit != members.end(); ++i, ++mit) {
+            memberSlots[i].name = mit->second.name.c_str();
+            memberSlots[i].member = &mit->second;
+            SignatureUtils::GetSignatureInfo(mit->second.signature.c_str(), memberSlots[i].args);
+            SignatureUtils::GetSignatureInfo(mit->second.returnSignature.c_str(), memberSlots[i].returnArgs);
+        }
+        Build(memberIndex, memberSeed, memberSlots);
+
+        std::vector<PropertySlot> propertySlots(properties.size());
+        PropertyMap::const_iterator pit = properties.begin();
+        for (size_t i = 0; pit != properties.end(); ++i, ++pit) {
+            propertySlots[i].name = pit->second.name.c_str();
+            propertySlots[i].property = &pit->second;
+            SignatureUtils::GetSignatureInfo(pit->second.signature.c_str(), propertySlots[i].info);
+        }
+        Build(propertyIndex, propertySeed, propertySlots);
+        indexed = true;
+    }
+
+    /** Discard the member and property tables */
+    void ClearIndex()
+    {
+        indexed = false;
+        memberIndex.clear();
+        propertyIndex.clear();
+    }
+
+    /** Number of hash seeds tried when building a table */
+    static const uint32_t MAX_SEEDS = 16;
 };
 
 bool InterfaceDescription::Member::GetAnnotation(const qcc::String& name, qcc::String& value) const
@@ -349,6 +477,7 @@ InterfaceDescription& InterfaceDescription::operator=(const InterfaceDescription
         defs->languageTag = other.defs->languageTag;
         defs->description = other.defs->description;
         defs->translator = other.defs->translator;
+        defs->ClearIndex();
 
         /* Update the iface pointer in each member */
         Definitions::MemberMap::iterator mit = defs->members.begin();
@@ -611,6 +740,10 @@ size_t InterfaceDescription::GetProperties(const Property** props, size_t numPro
 
 const InterfaceDescription::Property* InterfaceDescription::GetProperty(const char* name) const
 {
+    if (defs->indexed) {
+        const Definitions::PropertySlot* slot = Definitions::Find(defs->propertyIndex, defs->propertySeed, name);
+        return slot ? slot->property : NULL;
+    }
     Definitions::PropertyMap::const_iterator pit = defs->properties.find(qcc::StringMapKey(name));
     return (pit == defs->properties.end()) ? NULL : &(pit->second);
 }
@@ -630,10 +763,41 @@ size_t InterfaceDescription::GetMembers(const Member** members, size_t numMember
 
 const InterfaceDescription::Member* InterfaceDescription::GetMember(const char* name) const
 {
+    if (defs->indexed) {
+        const Definitions::MemberSlot* slot = Definitions::Find(defs->memberIndex, defs->memberSeed, name);
+        return slot ? slot->member : NULL;
+    }
     Definitions::MemberMap::const_iterator mit = defs->members.find(qcc::StringMapKey(name));
     return (mit == defs->members.end()) ? NULL : &(mit->second);
 }
 
+bool InterfaceDescription::GetMemberSignatureInfo(const char* name, SignatureInfo& args, SignatureInfo& returnArgs) const
+{
+    const Definitions::MemberSlot* slot = defs->indexed ? Definitions::Find(defs->memberIndex, defs->memberSeed, name) : NULL;
+    if (slot) {
+        args = slot->args;
+        returnArgs = slot->returnArgs;
+    }
+    return slot != NULL;
+}
+
+bool InterfaceDescription::GetPropertySignatureInfo(const char* name, SignatureInfo& info) const
+{
+    const Definitions::PropertySlot* slot = defs->indexed ? Definitions::Find(defs->propertyIndex, defs->propertySeed, name) : NULL;
+    if (slot) {
+        info = slot->info;
+    }
+    return slot != NULL;
+}
+
+void InterfaceDescription::Activate()
+{
+    if (!isActivated) {
+        defs->BuildIndex();
+        isActivated = true;
+    }
+}
+
 bool InterfaceDescription::HasMember(const char* name, const char* inSig, const char* outSig)
 {
     const Member* member = GetMember(name);
@@ -54,10 +54,186 @@ namespace ajn {
  */
 static const uint16_t LowStoreVersion = 0x0102;
 
+/*
+ * First version that stores each key as a separately encrypted record
+ */
+static const uint16_t RecordStoreVersion = 0x0104;
+
 /*
  * Current key store version we will write
  */
-static const uint16_t KeyStoreVersion = 0x0103;
+static const uint16_t KeyStoreVersion = 0x0104;
+
+/*
+ * Key record operations
+ */
+static const uint8_t RecordPutKey = 1;
+static const uint8_t RecordDelKey = 2;
+static const uint8_t RecordEnd = 3;
+
+/*
+ * A key record header is the length of the encrypted record, the revision and sequence number
+ * used for the nonce, the operation, the key GUID, the revision the key was added in and the
+ * key expiration.
+ */
+static const size_t RecordHeaderSize = 4 * sizeof(uint32_t) + sizeof(uint8_t) + qcc::GUID128::SIZE + sizeof(uint64_t) + sizeof(uint16_t);
+
+/*
+ * Length of the authentication field appended to each key record
+ */
+static const uint8_t RecordAuthLen = 16;
+
+/*
+ * Sanity check on the length of a key record
+ */
+static const uint32_t MaxRecordLen = 64000;
+
+/*
+ * A journal starts with the key store version and the revision of the key store the journal
+ * records apply to.
+ */
+static const size_t JournalHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+
+/*
+ * The journal is not compacted until it is at least this big
+ */
+static const size_t JournalMinCompactionSize = 16 * 1024;
+
+/*
+ * Nonce for a key record. All records are encrypted with the same key so every record must be
+ * written with a revision and sequence number pair that has never been used before.
+ */
+static KeyBlob RecordNonce(uint32_t revision, uint32_t seq)
+{
+    uint8_t nonce[2 * sizeof(uint32_t)];
+    memcpy(nonce, &revision, sizeof(revision));
+    memcpy(nonce + sizeof(revision), &seq, sizeof(seq));
+    return KeyBlob(nonce, sizeof(nonce), KeyBlob::GENERIC);
+}
+
+/*
+ * The header of a key record. The header is not encrypted so that the key store can be loaded
+ * without decrypting the keys but it is authenticated along with the encrypted key.
+ */
+struct RecordHeader {
+    uint32_t len;
+    uint32_t rev;
+    uint32_t seq;
+    uint8_t op;
+    qcc::GUID128 guid;
+    uint32_t keyRevision;
+    Timespec expiration;
+
+    RecordHeader() : len(0), rev(0), seq(0), op(0), guid(0), keyRevision(0) { }
+
+    void Pack(uint8_t* buf) const
+    {
+        memcpy(buf, &len, sizeof(len));
+        buf += sizeof(len);
+        memcpy(buf, &rev, sizeof(rev));
+        buf += sizeof(rev);
+        memcpy(buf, &seq, sizeof(seq));
+        buf += sizeof(seq);
+        *buf++ = op;
+        memcpy(buf, guid.GetBytes(), qcc::GUID128::SIZE);
+        buf += qcc::GUID128::SIZE;
+        memcpy(buf, &keyRevision, sizeof(keyRevision));
+        buf += sizeof(keyRevision);
+        memcpy(buf, &expiration.seconds, sizeof(expiration.seconds));
+        buf += sizeof(expiration.seconds);
+        memcpy(buf, &expiration.mseconds, sizeof(expiration.mseconds));
+    }
+
+    void Unpack(const uint8_t* buf)
+    {
+        memcpy(&len, buf, sizeof(len));
+        buf += sizeof(len);
+        memcpy(&rev, buf, sizeof(rev));
+        buf += sizeof(rev);
+        memcpy(&seq, buf, sizeof(seq));
+        buf += sizeof(seq);
+        op = *buf++;
+        guid.SetBytes(buf);
+        buf += qcc::GUID128::SIZE;
+        memcpy(&keyRevision, buf, sizeof(keyRevision));
+        buf += sizeof(keyRevision);
+        memcpy(&expiration.seconds, buf, sizeof(expiration.seconds));
+        buf += sizeof(expiration.seconds);
+        memcpy(&expiration.mseconds, buf, sizeof(expiration.mseconds));
+    }
+};
+
+/*
+ * Pull a sealed key record, that is the record header followed by the encrypted record.
+ * Returns ER_EOF if there are no more records.
+ */
+static QStatus PullRecord(Source& source, RecordHeader& hdr, qcc::String& sealed)
+{
+    uint8_t hdrBuf[RecordHeaderSize];
+    size_t pulled;
+    QStatus status = source.PullBytes(hdrBuf, sizeof(hdrBuf), pulled);
+    if (status != ER_OK) {
+        return status;
+    }
+    if (pulled != sizeof(hdrBuf)) {
+        return ER_BUS_CORRUPT_KEYSTORE;
+    }
+    hdr.Unpack(hdrBuf);
+    /* Sanity check on the length */
+    if ((hdr.len < RecordAuthLen) || (hdr.len > MaxRecordLen)) {
+        return ER_BUS_CORRUPT_KEYSTORE;
+    }
+    uint8_t* data = new uint8_t[hdr.len];
+    status = source.PullBytes(data, hdr.len, pulled);
+    if ((status == ER_EOF) || ((status == ER_OK) && (pulled != hdr.len))) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
+    }
+    if (status == ER_OK) {
+        sealed.assign((const char*)hdrBuf, sizeof(hdrBuf));
+        sealed.append((const char*)data, hdr.len);
+    }
+    delete [] data;
+    return status;
+}
+
+/*
+ * Encrypt a key record, the length in the header is set from the length of the payload.
+ */
+static QStatus SealRecord(const KeyBlob& key, RecordHeader& hdr, const qcc::String& payload, qcc::String& sealed)
+{
+    size_t len = payload.size();
+    hdr.len = static_cast<uint32_t>(len + RecordAuthLen);
+    uint8_t* data = new uint8_t[RecordHeaderSize + hdr.len];
+    hdr.Pack(data);
+    Crypto_AES aes(key, Crypto_AES::CCM);
+    QStatus status = aes.Encrypt_CCM(payload.data(), data + RecordHeaderSize, len, RecordNonce(hdr.rev, hdr.seq), data, RecordHeaderSize, RecordAuthLen);
+    if (status == ER_OK) {
+        sealed.assign((const char*)data, RecordHeaderSize + len);
+    }
+    delete [] data;
+    return status;
+}
+
+/*
+ * Authenticate and decrypt a sealed key record.
+ */
+static QStatus OpenRecord(const KeyBlob& key, const qcc::String& sealed, RecordHeader& hdr, qcc::String& payload)
+{
+    if (sealed.size() < (RecordHeaderSize + RecordAuthLen)) {
+        return ER_BUS_CORRUPT_KEYSTORE;
+    }
+    hdr.Unpack((const uint8_t*)sealed.data());
+    size_t len = sealed.size() - RecordHeaderSize;
+    uint8_t* data = new uint8_t[len];
+    Crypto_AES aes(key, Crypto_AES::CCM);
+    QStatus status = aes.Decrypt_CCM(sealed.data() + RecordHeaderSize, data, len, RecordNonce(hdr.rev, hdr.seq), sealed.data(), RecordHeaderSize, RecordAuthLen);
+    payload.clear();
+    if ((status == ER_OK) && (len > 0)) {
+        payload.append((const char*)data, len);
+    }
+    delete [] data;
+    return status;
+}
 
 
 QStatus KeyStoreListener::PutKeys(KeyStore& keyStore, const qcc::String& source, const qcc::String& password)
@@ -76,6 +252,50 @@ QStatus KeyStoreListener::GetKeys(KeyStore& keyStore, qcc::String& sink)
     return status;
 }
 
+
+/*
+ * Lock on the key store files that is held while the key store or its journal is read or
+ * written. The lock is taken on a separate lock file so that the key store and journal files
+ * can be replaced while the lock is held.
+ */
+class KeyStoreFileLock {
+
+  public:
+
+    KeyStoreFileLock(const qcc::String& fileName) : source(NULL), locked(false) {
+        /* Create the lock file if it does not exist yet */
+        {
+            FileSink sink(fileName, FileSink::PRIVATE, true);
+        }
+        source = new FileSource(fileName);
+        if (source->IsValid()) {
+            locked = source->Lock(true);
+        }
+        if (!locked) {
+            QCC_LogError(ER_OS_ERROR, ("Cannot lock %s", fileName.c_str()));
+        }
+    }
+
+    ~KeyStoreFileLock() {
+        if (locked) {
+            source->Unlock();
+        }
+        delete source;
+    }
+
+    bool IsLocked() const { return locked; }
+
+  private:
+
+    /* Private copy constructor and assign operator to prevent copying */
+    KeyStoreFileLock(const KeyStoreFileLock& other);
+    KeyStoreFileLock& operator=(const KeyStoreFileLock& other);
+
+    FileSource* source;
+
+    bool locked;
+};
+
 class DefaultKeyStoreListener : public KeyStoreListener {
 
   public:
@@ -86,20 +306,27 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         } else {
             fileName = GetHomeDir() + "/.alljoyn_keystore/" + application;
         }
+        journalFileName = fileName + ".journal";
+        lockFileName = fileName + ".lock";
     }
 
     QStatus LoadRequest(KeyStore& keyStore) {
         QStatus status;
+        KeyStoreFileLock fileLock(lockFileName);
+        if (!fileLock.IsLocked()) {
+            status = ER_BUS_READ_ERROR;
+            QCC_LogError(status, ("Cannot read key store from %s", fileName.c_str()));
+            return status;
+        }
         /* Try to load the keystore */
         {
             FileSource source(fileName);
             if (source.IsValid()) {
-                source.Lock(true);
                 status = keyStore.Pull(source, fileName);
                 if (status == ER_OK) {
                     QCC_DbgHLPrintf(("Read key store from %s", fileName.c_str()));
+                    status = LoadJournal(keyStore);
                 }
-                source.Unlock();
                 return status;
             }
         }
@@ -116,14 +343,12 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         {
             FileSource source(fileName);
             if (source.IsValid()) {
-                source.Lock(true);
                 status = keyStore.Pull(source, fileName);
                 if (status == ER_OK) {
                     QCC_DbgHLPrintf(("Initialized key store %s", fileName.c_str()));
                 } else {
                     QCC_LogError(status, ("Failed to initialize key store %s", fileName.c_str()));
                 }
-                source.Unlock();
             } else {
                 status = ER_BUS_READ_ERROR;
             }
@@ -132,15 +357,90 @@ class DefaultKeyStoreListener : public KeyStoreListener {
     }
 
     QStatus StoreRequest(KeyStore& keyStore) {
+        QStatus status;
+        KeyStoreFileLock fileLock(lockFileName);
+        if (!fileLock.IsLocked()) {
+            status = ER_BUS_WRITE_ERROR;
+            QCC_LogError(status, ("Cannot write key store to %s", fileName.c_str()));
+            return status;
+        }
+        if (keyStore.IsShared()) {
+            SyncJournal(keyStore);
+        }
+        /*
+         * Unless there is no usable journal only the changed keys are appended to the journal
+         */
+        if (keyStore.IsJournalValid()) {
+            FileSink journal(journalFileName, FileSink::PRIVATE, true);
+            if (journal.IsValid()) {
+                status = keyStore.PushJournal(journal);
+                if (status == ER_OK) {
+                    QCC_DbgHLPrintf(("Appended key store changes to %s", journalFileName.c_str()));
+                    return status;
+                }
+            }
+            QCC_DbgHLPrintf(("Cannot append to %s, rewriting key store", journalFileName.c_str()));
+        }
+        return WriteKeyStore(keyStore);
+    }
+
+    QStatus CompactRequest(KeyStore& keyStore) {
+        KeyStoreFileLock fileLock(lockFileName);
+        if (!fileLock.IsLocked()) {
+            return ER_BUS_WRITE_ERROR;
+        }
+        if (keyStore.IsShared()) {
+            SyncJournal(keyStore);
+        }
+        /* Another application may have compacted the journal already */
+        if (!keyStore.IsCompactionDue()) {
+            return ER_OK;
+        }
+        return WriteKeyStore(keyStore);
+    }
+
+  private:
+
+    QStatus LoadJournal(KeyStore& keyStore) {
+        QStatus status = ER_OK;
+        FileSource journal(journalFileName);
+        if (journal.IsValid()) {
+            status = keyStore.PullJournal(journal);
+            if (status == ER_OK) {
+                QCC_DbgHLPrintf(("Read key store journal from %s", journalFileName.c_str()));
+            }
+        }
+        return status;
+    }
+
+    QStatus SyncJournal(KeyStore& keyStore) {
+        FileSource source(fileName);
+        FileSource journal(journalFileName);
+        if (journal.IsValid()) {
+            return keyStore.SyncJournal(source, journal);
+        } else {
+            StringSource noJournal("");
+            return keyStore.SyncJournal(source, noJournal);
+        }
+    }
+
+    QStatus WriteKeyStore(KeyStore& keyStore) {
         QStatus status;
         FileSink sink(fileName, FileSink::PRIVATE);
         if (sink.IsValid()) {
-            sink.Lock(true);
             status = keyStore.Push(sink);
             if (status == ER_OK) {
                 QCC_DbgHLPrintf(("Wrote key store to %s", fileName.c_str()));
+                /*
+                 * The old journal was merged into the key store so start a new one
+                 */
+                FileSink journal(journalFileName, FileSink::PRIVATE);
+                if (journal.IsValid()) {
+                    keyStore.PushJournal(journal);
+                } else {
+                    DeleteFile(journalFileName);
+                }
             }
-            sink.Unlock();
         } else {
             status = ER_BUS_WRITE_ERROR;
             QCC_LogError(status, ("Cannot write key store to %s", fileName.c_str()));
@@ -148,23 +448,55 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         return status;
     }
 
-  private:
-
     qcc::String fileName;
 
+    qcc::String journalFileName;
+
+    qcc::String lockFileName;
+
+};
+
+/*
+ * Rewrites the key store when the journal has grown too big so that the thread storing the
+ * keys does not have to wait for it.
+ */
+class KeyStoreCompactor : public qcc::Thread {
+
+  public:
+
+    KeyStoreCompactor(KeyStore& keyStore) : Thread("KeyStoreCompactor"), keyStore(keyStore) { }
+
+    ThreadReturn STDCALL Run(void* arg) {
+        QStatus status = keyStore.Compact();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to compact key store journal"));
+        }
+        return 0;
+    }
+
+  private:
+
+    KeyStore& keyStore;
 };
 
 KeyStore::KeyStore(const qcc::String& application) :
     application(application),
     storeState(UNAVAILABLE),
     keys(new KeyMap),
+    snapshotRevision(0),
+    snapshotSize(0),
+    journalSize(0),
+    journalRevision(0),
+    journalValid(false),
     defaultListener(NULL),
     listener(NULL),
     thisGuid(),
     keyStoreKey(NULL),
+    revision(0),
     shared(false),
     stored(NULL),
     loaded(NULL),
+    compactor(NULL),
     keyEventListener(NULL)
 {
 }
@@ -191,6 +523,8 @@ KeyStore::~KeyStore()
         lock.Lock(MUTEX_CONTEXT);
     }
     lock.Unlock(MUTEX_CONTEXT);
+    StopCompaction();
+    delete compactor;
     delete defaultListener;
     delete listener;
     delete keyStoreKey;
@@ -227,6 +561,7 @@ QStatus KeyStore::Reset()
 {
     if (storeState != UNAVAILABLE) {
         QStatus status = Clear();
+        StopCompaction();
         storeState = UNAVAILABLE;
         delete listener;
         listener = NULL;
@@ -264,6 +599,7 @@ QStatus KeyStore::Store()
     /* Don't store if not modified */
     if (storeState == MODIFIED) {
 
+        persistLock.Lock(MUTEX_CONTEXT);
         lock.Lock(MUTEX_CONTEXT);
         EraseExpiredKeys();
 
@@ -287,6 +623,12 @@ QStatus KeyStore::Store()
             deletions.clear();
         }
         lock.Unlock(MUTEX_CONTEXT);
+        persistLock.Unlock(MUTEX_CONTEXT);
+
+        /* Rewriting the key store can take a while so it is not done on this thread */
+        if ((status == ER_OK) && defaultListener && IsCompactionDue()) {
+            StartCompaction();
+        }
     }
     return status;
 }
@@ -314,17 +656,26 @@ size_t KeyStore::EraseExpiredKeys()
 {
     size_t count = 0;
     bool dirty = true;
+    Timespec now;
+    GetTimeNow(&now);
     while (dirty) {
         dirty = false;
         KeyMap::iterator it = keys->begin();
         while (it != keys->end()) {
             KeyMap::iterator current = it++;
-            if (current->second.key.HasExpired()) {
+            bool expired;
+            if (current->second.loaded) {
+                expired = current->second.key.HasExpired();
+            } else {
+                expired = (current->second.expiration.seconds != 0) && (current->second.expiration <= now);
+            }
+            if (expired) {
                 QCC_DbgPrintf(("Deleting expired key for GUID %s", current->first.ToString().c_str()));
                 bool affected = false;
                 if (keyEventListener) {
                     affected = keyEventListener->NotifyAutoDelete(this, current->first);
                 }
+                changes.insert(current->first);
                 keys->erase(current);
                 ++count;
                 dirty = true;
@@ -353,7 +704,14 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
     uint8_t guidBuf[qcc::GUID128::SIZE];
     size_t pulled;
     size_t len = 0;
-    uint16_t version;
+    uint16_t version = KeyStoreVersion;
+
+    /* Any journal belongs to the key store being pulled and is not usable until it has been checked */
+    snapshotRevision = 0;
+    snapshotSize = 0;
+    journalSize = 0;
+    journalRevision = 0;
+    journalValid = false;
 
     /* Pull and check the key store version */
     QStatus status = source.PullBytes(&version, sizeof(version), pulled);
@@ -371,11 +729,15 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         thisGuid.SetBytes(guidBuf);
     }
 
-    /* This is the only chance to generate the key store key */
+    /*
+     * This is the only chance to generate the key store key. The key store GUID goes into the
+     * key so that a key store that is deleted and created again does not reuse the nonces of
+     * the old one.
+     */
     if (!keyStoreKey) {
         keyStoreKey = new KeyBlob;
     }
-    keyStoreKey->Derive(password + GetGuid(), Crypto_AES::AES128_SIZE, KeyBlob::AES);
+    keyStoreKey->Derive(password + thisGuid.ToString(), Crypto_AES::AES128_SIZE, KeyBlob::AES);
 
     /* Allow for an uninitialized (empty) key store */
     if (status == ER_EOF) {
@@ -394,12 +756,13 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
     if (status != ER_OK) {
         goto ExitPull;
     }
-    /* Sanity check on the length */
-    if (len > 64000) {
+    if (version >= RecordStoreVersion) {
+        /* The keys are not decrypted until they are used */
+        status = PullRecords(source, len);
+    } else if (len > 64000) {
+        /* Sanity check on the length */
         status = ER_BUS_CORRUPT_KEYSTORE;
-        goto ExitPull;
-    }
-    if (len > 0) {
+    } else if (len > 0) {
         uint8_t* data = NULL;
         /*
          * Pull the encrypted keys.
@@ -411,10 +774,13 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         }
         if (status == ER_OK) {
             /*
-             * Decrypt the key store.
+             * Decrypt the key store. Older versions encrypted all keys at once with a key
+             * derived from the password only.
              */
+            KeyBlob legacyKey;
+            legacyKey.Derive(password, Crypto_AES::AES128_SIZE, KeyBlob::AES);
             KeyBlob nonce((uint8_t*)&revision, sizeof(revision), KeyBlob::GENERIC);
-            Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+            Crypto_AES aes(legacyKey, Crypto_AES::CCM);
             status = aes.Decrypt_CCM(data, data, len, nonce, NULL, 0, 16);
             /*
              * Unpack the guid/key pairs from an intermediate string source.
@@ -456,7 +822,12 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
     if (status != ER_OK) {
         goto ExitPull;
     }
-    if (EraseExpiredKeys()) {
+    snapshotRevision = revision;
+    snapshotSize = sizeof(version) + sizeof(revision) + qcc::GUID128::SIZE + sizeof(len) + len;
+    journalRevision = revision;
+    /* A key store in an older format is written again in full with the next store */
+    journalValid = (version >= RecordStoreVersion);
+    if (EraseExpiredKeys() || !journalValid) {
         storeState = MODIFIED;
     } else {
         storeState = LOADED;
@@ -475,18 +846,78 @@ ExitPull:
     return status;
 }
 
+QStatus KeyStore::PullRecords(Source& source, size_t len)
+{
+    QStatus status = ER_OK;
+    size_t total = 0;
+    uint32_t count = 0;
+    /*
+     * The records end with a record that holds the number of key records and a digest of their
+     * headers so that records cannot be dropped from or added to the key store.
+     */
+    Crypto_SHA256 hash;
+    hash.Init();
+    while (status == ER_OK) {
+        RecordHeader hdr;
+        qcc::String sealed;
+        status = PullRecord(source, hdr, sealed);
+        if (status == ER_EOF) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+        if (status != ER_OK) {
+            break;
+        }
+        total += sealed.size();
+        if ((total > len) || (hdr.rev > revision)) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+            break;
+        }
+        if (hdr.op == RecordEnd) {
+            qcc::String payload;
+            uint8_t digest[Crypto_SHA256::DIGEST_SIZE];
+            uint32_t n = 0;
+            status = OpenRecord(*keyStoreKey, sealed, hdr, payload);
+            hash.GetDigest(digest);
+            if ((status == ER_OK) && (payload.size() == (sizeof(n) + sizeof(digest)))) {
+                memcpy(&n, payload.data(), sizeof(n));
+            }
+            if ((status != ER_OK) || (total != len) || (hdr.rev != revision) || (n != count) ||
+                (payload.size() != (sizeof(n) + sizeof(digest))) || (memcmp(payload.data() + sizeof(n), digest, sizeof(digest)) != 0)) {
+                status = ER_BUS_CORRUPT_KEYSTORE;
+            }
+            break;
+        }
+        if (hdr.op != RecordPutKey) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+            break;
+        }
+        hash.Update((const uint8_t*)sealed.data(), RecordHeaderSize);
+        SetSealed((*keys)[hdr.guid], sealed);
+        ++count;
+        QCC_DbgPrintf(("KeyStore::Pull rev:%d GUID %s", hdr.keyRevision, hdr.guid.ToString().c_str()));
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Key store is corrupt after %u records", count));
+    }
+    return status;
+}
+
 QStatus KeyStore::Clear()
 {
     if (storeState == UNAVAILABLE) {
         return ER_BUS_KEYSTORE_NOT_LOADED;
     }
+    persistLock.Lock(MUTEX_CONTEXT);
     lock.Lock(MUTEX_CONTEXT);
     keys->clear();
     storeState = MODIFIED;
-    revision = 0;
+    /* The revision is not reset so that the records written next do not reuse a nonce */
     deletions.clear();
+    changes.clear();
+    journalValid = false;
     lock.Unlock(MUTEX_CONTEXT);
     listener->StoreRequest(*this);
+    persistLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 
@@ -507,6 +938,7 @@ QStatus KeyStore::Reload()
         return ER_OK;
     }
 
+    persistLock.Lock(MUTEX_CONTEXT);
     lock.Lock(MUTEX_CONTEXT);
     QStatus status;
     uint32_t currentRevision = revision;
@@ -567,6 +999,7 @@ QStatus KeyStore::Reload()
     }
 
     lock.Unlock(MUTEX_CONTEXT);
+    persistLock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -575,37 +1008,62 @@ QStatus KeyStore::Push(Sink& sink)
     size_t pushed;
     QStatus status = ER_OK;
 
-    QCC_DbgHLPrintf(("KeyStore::Push (revision %d)", revision + 1));
     lock.Lock(MUTEX_CONTEXT);
 
     /*
-     * Pack the keys into an intermediate string sink.
+     * The revision number is incremented each time the key store is stored. Keys that have
+     * not changed since they were last written are copied as they are, the others are
+     * encrypted with the new revision number.
      */
+    ++revision;
+    QCC_DbgHLPrintf(("KeyStore::Push (revision %d)", revision));
     StringSink strSink;
+    Crypto_SHA256 hash;
+    hash.Init();
+    uint32_t seq = 0;
     KeyMap::iterator it;
-    for (it = keys->begin(); it != keys->end(); ++it) {
-        strSink.PushBytes(&it->second.revision, sizeof(revision), pushed);
-        strSink.PushBytes(it->first.GetBytes(), qcc::GUID128::SIZE, pushed);
-        it->second.key.Store(strSink);
-        strSink.PushBytes(&it->second.accessRights, sizeof(it->second.accessRights), pushed);
-        QCC_DbgPrintf(("KeyStore::Push rev:%d GUID %s", it->second.revision, it->first.ToString().c_str()));
+    for (it = keys->begin(); (status == ER_OK) && (it != keys->end()); ++it) {
+        KeyRecord& keyRec = it->second;
+        if (keyRec.sealed.empty()) {
+            status = SealKey(it->first, keyRec, revision, ++seq);
+        }
+        if (status == ER_OK) {
+            strSink.PushBytes(keyRec.sealed.data(), keyRec.sealed.size(), pushed);
+            hash.Update((const uint8_t*)keyRec.sealed.data(), RecordHeaderSize);
+        }
+        QCC_DbgPrintf(("KeyStore::Push rev:%d GUID %s", keyRec.revision, it->first.ToString().c_str()));
+    }
+    /*
+     * The last record holds the number of keys and a digest of the headers of the key records
+     */
+    if (status == ER_OK) {
+        uint32_t count = static_cast<uint32_t>(keys->size());
+        uint8_t digest[Crypto_SHA256::DIGEST_SIZE];
+        hash.GetDigest(digest);
+        qcc::String payload((const char*)&count, sizeof(count));
+        payload.append((const char*)digest, sizeof(digest));
+        RecordHeader hdr;
+        hdr.rev = revision;
+        hdr.seq = ++seq;
+        hdr.op = RecordEnd;
+        qcc::String sealed;
+        status = SealRecord(*keyStoreKey, hdr, payload, sealed);
+        if (status == ER_OK) {
+            strSink.PushBytes(sealed.data(), sealed.size(), pushed);
+        }
     }
     size_t keysLen = strSink.GetString().size();
     /*
      * First two bytes are the version number.
      */
-    status = sink.PushBytes(&KeyStoreVersion, sizeof(KeyStoreVersion), pushed);
-    if (status != ER_OK) {
-        goto ExitPush;
+    if (status == ER_OK) {
+        status = sink.PushBytes(&KeyStoreVersion, sizeof(KeyStoreVersion), pushed);
     }
     /*
-     * Second two bytes are the key store revision number. The revision number is incremented each
-     * time the key store is stored.
+     * Followed by the key store revision number
      */
-    ++revision;
-    status = sink.PushBytes(&revision, sizeof(revision), pushed);
-    if (status != ER_OK) {
-        goto ExitPush;
+    if (status == ER_OK) {
+        status = sink.PushBytes(&revision, sizeof(revision), pushed);
     }
     /*
      * Store the GUID
@@ -613,35 +1071,289 @@ QStatus KeyStore::Push(Sink& sink)
     if (status == ER_OK) {
         status = sink.PushBytes(thisGuid.GetBytes(), qcc::GUID128::SIZE, pushed);
     }
-    if (status != ER_OK) {
-        goto ExitPush;
+    /* Store the length of the key records and the records */
+    if (status == ER_OK) {
+        status = sink.PushBytes(&keysLen, sizeof(keysLen), pushed);
     }
-    if (keysLen > 0) {
-        /*
-         * Encrypt keys.
-         */
-        KeyBlob nonce((uint8_t*)&revision, sizeof(revision), KeyBlob::GENERIC);
-        uint8_t* keysData = new uint8_t[keysLen + 16];
-        Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
-        status = aes.Encrypt_CCM(strSink.GetString().data(), keysData, keysLen, nonce, NULL, 0, 16);
-        /* Store the length of the encrypted keys */
+    if (status == ER_OK) {
+        status = sink.PushBytes(strSink.GetString().data(), keysLen, pushed);
+    }
+    if (status == ER_OK) {
+        storeState = LOADED;
+        snapshotRevision = revision;
+        snapshotSize = sizeof(KeyStoreVersion) + sizeof(revision) + qcc::GUID128::SIZE + sizeof(keysLen) + keysLen;
+        journalRevision = revision;
+        journalSize = 0;
+        journalValid = true;
+        changes.clear();
+    }
+
+    if (stored) {
+        stored->SetEvent();
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus KeyStore::PullJournal(Source& source)
+{
+    size_t pulled;
+    uint16_t version;
+    uint32_t fileRevision;
+    size_t records = 0;
+
+    QCC_DbgPrintf(("KeyStore::PullJournal"));
+    lock.Lock(MUTEX_CONTEXT);
+
+    /*
+     * The journal header is the key store version and the revision of the key store the journal
+     * records apply to.
+     */
+    QStatus status = source.PullBytes(&version, sizeof(version), pulled);
+    if (status == ER_EOF) {
+        /* An empty journal */
+        lock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
+    if ((status == ER_OK) && (pulled != sizeof(version))) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
+    }
+    if (status == ER_OK) {
+        status = source.PullBytes(&fileRevision, sizeof(fileRevision), pulled);
+        if ((status == ER_EOF) || ((status == ER_OK) && (pulled != sizeof(fileRevision)))) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+    }
+    if ((status == ER_OK) && (!journalValid || (version != KeyStoreVersion) || (fileRevision != snapshotRevision))) {
+        QCC_DbgHLPrintf(("KeyStore::PullJournal ignoring journal for revision %d", fileRevision));
+        journalValid = false;
+        storeState = MODIFIED;
+        lock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
+    if (status == ER_OK) {
+        journalSize = JournalHeaderSize;
+        journalRevision = fileRevision;
+    }
+    while (status == ER_OK) {
+        RecordHeader hdr;
+        qcc::String sealed;
+        status = PullRecord(source, hdr, sealed);
+        if (status != ER_OK) {
+            break;
+        }
+        if (hdr.rev <= snapshotRevision) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+            break;
+        }
+        status = ApplyRecord(sealed, false);
+        QCC_DbgPrintf(("KeyStore::PullJournal rev:%d op:%d GUID %s %s", hdr.rev, hdr.op, QCC_StatusText(status), hdr.guid.ToString().c_str()));
         if (status == ER_OK) {
-            status = sink.PushBytes(&keysLen, sizeof(keysLen), pushed);
+            journalSize += sealed.size();
+            if (hdr.rev > revision) {
+                revision = hdr.rev;
+            }
+            ++records;
         }
-        /* Store the encrypted keys */
+    }
+    if (status == ER_EOF) {
+        status = ER_OK;
+    } else if (status != ER_OK) {
+        /*
+         * Keep the intact records but don't append after a damaged one, the next store will
+         * rewrite the key store and start a new journal.
+         */
+        QCC_LogError(status, ("Key store journal is damaged after %u records", records));
+        journalValid = false;
+        storeState = MODIFIED;
+        status = ER_OK;
+    }
+    if (EraseExpiredKeys()) {
+        storeState = MODIFIED;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus KeyStore::ApplyRecord(const qcc::String& sealed, bool keepChanges)
+{
+    RecordHeader hdr;
+    hdr.Unpack((const uint8_t*)sealed.data());
+    if (keepChanges && (changes.count(hdr.guid) != 0)) {
+        return ER_OK;
+    }
+    if (hdr.op == RecordPutKey) {
+        /* The key is not decrypted until it is used */
+        SetSealed((*keys)[hdr.guid], sealed);
+        return ER_OK;
+    } else if (hdr.op == RecordDelKey) {
+        qcc::String payload;
+        QStatus status = OpenRecord(*keyStoreKey, sealed, hdr, payload);
         if (status == ER_OK) {
-            status = sink.PushBytes(keysData, keysLen, pushed);
+            keys->erase(hdr.guid);
         }
-        delete [] keysData;
+        return status;
     } else {
-        status = sink.PushBytes(&keysLen, sizeof(keysLen), pushed);
+        return ER_BUS_CORRUPT_KEYSTORE;
+    }
+}
+
+QStatus KeyStore::SyncJournal(Source& keyStoreSource, Source& journalSource)
+{
+    size_t pulled;
+    uint16_t version = 0;
+    uint32_t storeRevision = 0;
+    uint32_t fileRevision = 0;
+
+    lock.Lock(MUTEX_CONTEXT);
+
+    /*
+     * The key store may have been written by another application since it was loaded
+     */
+    QStatus status = keyStoreSource.PullBytes(&version, sizeof(version), pulled);
+    if ((status == ER_OK) && (pulled == sizeof(version))) {
+        status = keyStoreSource.PullBytes(&storeRevision, sizeof(storeRevision), pulled);
+    }
+    if ((status == ER_OK) && (pulled != sizeof(storeRevision))) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
     }
     if (status != ER_OK) {
-        goto ExitPush;
+        journalValid = false;
+        lock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+    if (storeRevision > revision) {
+        revision = storeRevision;
+    }
+    if (version < RecordStoreVersion) {
+        /* The key store needs to be written in the current format before the journal can be used */
+        journalValid = false;
     }
-    storeState = LOADED;
 
-ExitPush:
+    /*
+     * Check the journal belongs to the key store as it is now
+     */
+    status = journalSource.PullBytes(&version, sizeof(version), pulled);
+    if (status == ER_EOF) {
+        /* No journal, the next journal record starts a new one */
+        journalRevision = storeRevision;
+        journalSize = 0;
+        lock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
+    if ((status == ER_OK) && (pulled == sizeof(version))) {
+        status = journalSource.PullBytes(&fileRevision, sizeof(fileRevision), pulled);
+    }
+    if ((status == ER_OK) && ((pulled != sizeof(fileRevision)) || (version != KeyStoreVersion) || (fileRevision != storeRevision))) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
+    }
+    /*
+     * Skip the records already seen, unless the journal was started again by another
+     * application none of the records have been seen.
+     */
+    size_t size = JournalHeaderSize;
+    if ((status == ER_OK) && (fileRevision == journalRevision) && (journalSize > JournalHeaderSize)) {
+        while ((status == ER_OK) && (size < journalSize)) {
+            uint8_t buf[256];
+            status = journalSource.PullBytes(buf, min(sizeof(buf), journalSize - size), pulled);
+            size += pulled;
+        }
+        if (status == ER_EOF) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+    }
+    /*
+     * Merge the records appended by other applications, local changes that have not been
+     * stored yet take precedence.
+     */
+    while (status == ER_OK) {
+        RecordHeader hdr;
+        qcc::String sealed;
+        status = PullRecord(journalSource, hdr, sealed);
+        if (status == ER_OK) {
+            status = ApplyRecord(sealed, true);
+        }
+        if (status == ER_OK) {
+            QCC_DbgPrintf(("KeyStore::SyncJournal rev:%d op:%d GUID %s", hdr.rev, hdr.op, hdr.guid.ToString().c_str()));
+            size += sealed.size();
+            if (hdr.rev > revision) {
+                revision = hdr.rev;
+            }
+        }
+    }
+    if (status == ER_EOF) {
+        journalRevision = fileRevision;
+        journalSize = size;
+        status = ER_OK;
+    } else {
+        QCC_LogError(status, ("Key store journal is damaged"));
+        journalValid = false;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus KeyStore::PushJournal(Sink& sink)
+{
+    size_t pushed;
+    QStatus status = ER_OK;
+
+    lock.Lock(MUTEX_CONTEXT);
+
+    /*
+     * A new journal starts with the key store version and the revision the records apply to.
+     */
+    if (journalSize == 0) {
+        status = sink.PushBytes(&KeyStoreVersion, sizeof(KeyStoreVersion), pushed);
+        if (status == ER_OK) {
+            status = sink.PushBytes(&journalRevision, sizeof(journalRevision), pushed);
+        }
+        if (status == ER_OK) {
+            journalSize = JournalHeaderSize;
+        }
+    }
+    if ((status == ER_OK) && !changes.empty()) {
+        QCC_DbgHLPrintf(("KeyStore::PushJournal (revision %d) %u changes", revision + 1, changes.size()));
+        /*
+         * The revision number is incremented each time changes are appended, all records in this
+         * batch share the revision and have different sequence numbers.
+         */
+        ++revision;
+        uint32_t seq = 0;
+        std::set<qcc::GUID128>::iterator it;
+        for (it = changes.begin(); (status == ER_OK) && (it != changes.end()); ++it) {
+            qcc::String sealed;
+            KeyMap::iterator kit = keys->find(*it);
+            if (kit == keys->end()) {
+                RecordHeader hdr;
+                hdr.rev = revision;
+                hdr.seq = ++seq;
+                hdr.op = RecordDelKey;
+                hdr.guid = *it;
+                status = SealRecord(*keyStoreKey, hdr, qcc::String(), sealed);
+            } else if (kit->second.loaded) {
+                status = SealKey(*it, kit->second, revision, ++seq);
+                sealed = kit->second.sealed;
+            } else {
+                /* The key was replaced by one that has already been stored */
+                continue;
+            }
+            if (status == ER_OK) {
+                status = sink.PushBytes(sealed.data(), sealed.size(), pushed);
+            }
+            if (status == ER_OK) {
+                journalSize += sealed.size();
+            }
+            QCC_DbgPrintf(("KeyStore::PushJournal GUID %s", it->ToString().c_str()));
+        }
+    }
+    if (status == ER_OK) {
+        changes.clear();
+        storeState = LOADED;
+    } else {
+        /* A partially written journal cannot be appended to */
+        journalValid = false;
+    }
 
     if (stored) {
         stored->SetEvent();
@@ -650,6 +1362,124 @@ ExitPush:
     return status;
 }
 
+bool KeyStore::IsJournalValid()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    bool valid = journalValid && (snapshotRevision != 0);
+    lock.Unlock(MUTEX_CONTEXT);
+    return valid;
+}
+
+bool KeyStore::IsCompactionDue()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    /*
+     * If another application has rewritten the key store since it was loaded the keys held
+     * here may be out of date so it is left to that application to compact the journal.
+     */
+    bool due = journalValid && (snapshotRevision != 0) && (journalRevision == snapshotRevision) &&
+               (journalSize > max(snapshotSize, JournalMinCompactionSize));
+    lock.Unlock(MUTEX_CONTEXT);
+    return due;
+}
+
+QStatus KeyStore::Compact()
+{
+    QStatus status = ER_OK;
+    persistLock.Lock(MUTEX_CONTEXT);
+    if ((storeState != UNAVAILABLE) && defaultListener && IsCompactionDue()) {
+        QCC_DbgHLPrintf(("KeyStore::Compact"));
+        status = defaultListener->CompactRequest(*this);
+    }
+    persistLock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+void KeyStore::StartCompaction()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    if (!compactor) {
+        compactor = new KeyStoreCompactor(*this);
+    }
+    if (!compactor->IsRunning()) {
+        compactor->Join();
+        QStatus status = compactor->Start();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to start key store compaction"));
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void KeyStore::StopCompaction()
+{
+    if (compactor) {
+        compactor->Join();
+    }
+}
+
+void KeyStore::SetSealed(KeyRecord& keyRec, const qcc::String& sealed)
+{
+    RecordHeader hdr;
+    hdr.Unpack((const uint8_t*)sealed.data());
+    keyRec.revision = hdr.keyRevision;
+    keyRec.key.Erase();
+    memset(keyRec.accessRights, 0, sizeof(keyRec.accessRights));
+    keyRec.expiration = hdr.expiration;
+    keyRec.sealed = sealed;
+    keyRec.loaded = false;
+}
+
+QStatus KeyStore::SealKey(const qcc::GUID128& guid, KeyRecord& keyRec, uint32_t rev, uint32_t seq)
+{
+    size_t pushed;
+    StringSink strSink;
+    keyRec.key.Store(strSink);
+    strSink.PushBytes(&keyRec.accessRights, sizeof(keyRec.accessRights), pushed);
+    RecordHeader hdr;
+    hdr.rev = rev;
+    hdr.seq = seq;
+    hdr.op = RecordPutKey;
+    hdr.guid = guid;
+    hdr.keyRevision = keyRec.revision;
+    keyRec.key.GetExpiration(hdr.expiration);
+    return SealRecord(*keyStoreKey, hdr, strSink.GetString(), keyRec.sealed);
+}
+
+QStatus KeyStore::UnsealKey(KeyMap::iterator it)
+{
+    KeyRecord& keyRec = it->second;
+    if (keyRec.loaded) {
+        return ER_OK;
+    }
+    RecordHeader hdr;
+    qcc::String payload;
+    QStatus status = OpenRecord(*keyStoreKey, keyRec.sealed, hdr, payload);
+    if (status == ER_OK) {
+        size_t pulled;
+        StringSource strSource(payload);
+        status = keyRec.key.Load(strSource);
+        if (status == ER_OK) {
+            status = strSource.PullBytes(&keyRec.accessRights, sizeof(keyRec.accessRights), pulled);
+        }
+        if ((status == ER_OK) && (pulled != sizeof(keyRec.accessRights))) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+    }
+    if (status == ER_OK) {
+        keyRec.loaded = true;
+    } else {
+        /* Drop the key so that it is negotiated again */
+        status = ER_BUS_CORRUPT_KEYSTORE;
+        QCC_LogError(status, ("Failed to load key for GUID %s", it->first.ToString().c_str()));
+        deletions.insert(it->first);
+        changes.insert(it->first);
+        keys->erase(it);
+        storeState = MODIFIED;
+    }
+    return status;
+}
+
 QStatus KeyStore::GetKey(const qcc::GUID128& guid, KeyBlob& key, uint8_t accessRights[4])
 {
     if (storeState == UNAVAILABLE) {
@@ -658,8 +1488,9 @@ QStatus KeyStore::GetKey(const qcc::GUID128& guid, KeyBlob& key, uint8_t accessR
     QStatus status;
     lock.Lock(MUTEX_CONTEXT);
     QCC_DbgPrintf(("KeyStore::GetKey %s", guid.ToString().c_str()));
-    if (keys->find(guid) != keys->end()) {
-        KeyRecord& keyRec = (*keys)[guid];
+    KeyMap::iterator it = keys->find(guid);
+    if ((it != keys->end()) && (UnsealKey(it) == ER_OK)) {
+        KeyRecord& keyRec = it->second;
         key = keyRec.key;
         memcpy(accessRights, &keyRec.accessRights, sizeof(uint8_t) * 4);
         QCC_DbgPrintf(("AccessRights %1x%1x%1x%1x", accessRights[0], accessRights[1], accessRights[2], accessRights[3]));
@@ -695,8 +1526,11 @@ QStatus KeyStore::AddKey(const qcc::GUID128& guid, const KeyBlob& key, const uin
     keyRec.key = key;
     QCC_DbgPrintf(("AccessRights %1x%1x%1x%1x", accessRights[0], accessRights[1], accessRights[2], accessRights[3]));
     memcpy(&keyRec.accessRights, accessRights, sizeof(uint8_t) * 4);
+    keyRec.sealed.clear();
+    keyRec.loaded = true;
     storeState = MODIFIED;
     deletions.erase(guid);
+    changes.insert(guid);
     lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
@@ -706,13 +1540,16 @@ QStatus KeyStore::DelKey(const qcc::GUID128& guid)
     if (storeState == UNAVAILABLE) {
         return ER_BUS_KEYSTORE_NOT_LOADED;
     }
+    persistLock.Lock(MUTEX_CONTEXT);
     lock.Lock(MUTEX_CONTEXT);
     QCC_DbgPrintf(("KeyStore::DelKey %s", guid.ToString().c_str()));
     keys->erase(guid);
     storeState = MODIFIED;
     deletions.insert(guid);
+    changes.insert(guid);
     lock.Unlock(MUTEX_CONTEXT);
     listener->StoreRequest(*this);
+    persistLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 
@@ -722,11 +1559,15 @@ QStatus KeyStore::SetKeyExpiration(const qcc::GUID128& guid, const Timespec& exp
         return ER_BUS_KEYSTORE_NOT_LOADED;
     }
     QStatus status = ER_OK;
+    persistLock.Lock(MUTEX_CONTEXT);
     lock.Lock(MUTEX_CONTEXT);
     QCC_DbgPrintf(("KeyStore::SetExpiration %s", guid.ToString().c_str()));
-    if (keys->count(guid) != 0) {
-        (*keys)[guid].key.SetExpiration(expiration);
+    KeyMap::iterator it = keys->find(guid);
+    if ((it != keys->end()) && (UnsealKey(it) == ER_OK)) {
+        it->second.key.SetExpiration(expiration);
+        it->second.sealed.clear();
         storeState = MODIFIED;
+        changes.insert(guid);
     } else {
         status = ER_BUS_KEY_UNAVAILABLE;
     }
@@ -734,6 +1575,7 @@ QStatus KeyStore::SetKeyExpiration(const qcc::GUID128& guid, const Timespec& exp
     if (status == ER_OK) {
         listener->StoreRequest(*this);
     }
+    persistLock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -749,10 +1591,14 @@ QStatus KeyStore::GetKeyExpiration(const qcc::GUID128& guid, Timespec& expiratio
     if (status == ER_OK) {
         lock.Lock(MUTEX_CONTEXT);
         QCC_DbgPrintf(("KeyStore::GetExpiration %s", guid.ToString().c_str()));
-        if (keys->count(guid) != 0) {
-            (*keys)[guid].key.GetExpiration(expiration);
-        } else {
+        KeyMap::iterator it = keys->find(guid);
+        if (it == keys->end()) {
             status = ER_BUS_KEY_UNAVAILABLE;
+        } else if (it->second.loaded) {
+            it->second.key.GetExpiration(expiration);
+        } else {
+            /* The expiration is known without loading the key */
+            expiration = it->second.expiration;
         }
         lock.Unlock(MUTEX_CONTEXT);
     }
@@ -762,6 +1608,10 @@ QStatus KeyStore::GetKeyExpiration(const qcc::GUID128& guid, Timespec& expiratio
 QStatus KeyStore::SearchAssociatedKeys(const qcc::GUID128& guid, qcc::GUID128** list, size_t* numItems) {
     size_t count = 0;
     lock.Lock(MUTEX_CONTEXT);
+    /* The associations are only known once the keys are loaded */
+    for (KeyMap::iterator it = keys->begin(); it != keys->end();) {
+        UnsealKey(it++);
+    }
     for (KeyMap::iterator it = keys->begin(); it != keys->end(); ++it) {
         if ((it->second.key.GetAssociationMode() != KeyBlob::ASSOCIATE_MEMBER)
             && (it->second.key.GetAssociationMode() != KeyBlob::ASSOCIATE_BOTH)) {
@@ -36,6 +36,7 @@
 #include <qcc/Mutex.h>
 #include <qcc/Stream.h>
 #include <qcc/Event.h>
+#include <qcc/Thread.h>
 #include <qcc/time.h>
 
 #include <alljoyn/KeyStoreListener.h>
@@ -48,12 +49,20 @@ namespace ajn {
 
 /* forward decl */
 class KeyStoreKeyEventListener;
+class DefaultKeyStoreListener;
+class KeyStoreCompactor;
 
 /**
  * The %KeyStore class manages the storing and loading of key blobs from
  * external storage.
+ *
+ * Each key is stored as a separately encrypted record. Loading the key store only reads the
+ * record headers, a key is decrypted the first time it is used.
  */
 class KeyStore {
+
+    friend class KeyStoreCompactor;
+
   public:
 
     /**
@@ -266,6 +275,67 @@ class KeyStore {
      */
     QStatus Push(qcc::Sink& sink);
 
+    /**
+     * Pull the key changes recorded in a journal into the key store. This must be called
+     * after the keys have been pulled with Pull(). A journal that does not belong to the
+     * keys that were pulled is ignored, a truncated or corrupt journal is applied up to the
+     * last intact record. Like the keys pulled with Pull() the keys in the journal are not
+     * decrypted until they are used.
+     *
+     * @param source    The source to read the journal from.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PullJournal(qcc::Source& source);
+
+    /**
+     * Append the keys that have been added, changed or deleted since the last Push or
+     * PushJournal to a journal. Each key is written as a separately encrypted and
+     * authenticated record.
+     *
+     * @param sink The sink to append the journal records to.
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PushJournal(qcc::Sink& sink);
+
+    /**
+     * Catch up with the revisions that other applications sharing the key store may have
+     * written. This must be called with the key store files locked, before the key store is
+     * pushed or changes are appended to the journal, so that the revision the records are
+     * encrypted with is newer than any revision already written. The keys the other
+     * applications appended to the journal are merged into the key store unless they have
+     * also been changed locally since the last store.
+     *
+     * @param keyStoreSource    The source to read the key store from, only the header is read.
+     * @param journalSource     The source to read the journal from.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise, changes must then not be appended to the journal
+     */
+    QStatus SyncJournal(qcc::Source& keyStoreSource, qcc::Source& journalSource);
+
+    /**
+     * Indicates if changes can be appended to the journal with PushJournal(). If not the key
+     * store must be written in full with Push().
+     *
+     * @return  Returns true if there is a usable journal.
+     */
+    bool IsJournalValid();
+
+    /**
+     * Indicates if the journal has grown larger than the key store itself so that the key
+     * store should be rewritten in full. The default key store listener does this on a
+     * background thread.
+     *
+     * @return  Returns true if the journal should be compacted.
+     */
+    bool IsCompactionDue();
+
     /**
      * Indicates if this is a shared key store.
      *
@@ -311,6 +381,33 @@ class KeyStore {
      */
     QStatus Load();
 
+    /**
+     * Rewrite the key store in full if the journal has grown too big. Called on the
+     * compaction thread.
+     */
+    QStatus Compact();
+
+    /**
+     * Start the compaction thread unless it is already running.
+     */
+    void StartCompaction();
+
+    /**
+     * Wait for the compaction thread to exit.
+     */
+    void StopCompaction();
+
+    /**
+     * Pull the key records of a key store written with RecordStoreVersion or later.
+     */
+    QStatus PullRecords(qcc::Source& source, size_t len);
+
+    /**
+     * Apply a journal record to the key store, records for keys that have been changed since
+     * the last store are skipped if keepChanges is true.
+     */
+    QStatus ApplyRecord(const qcc::String& sealed, bool keepChanges);
+
     /**
      * The application that owns this key store. If the key store is shared this will be the name
      * of a suite of applications.
@@ -331,10 +428,13 @@ class KeyStore {
      */
     class KeyRecord {
       public:
-        KeyRecord() : revision(0) { }
+        KeyRecord() : revision(0), loaded(true) { }
         uint32_t revision;       ///< Revision number when this key was added
-        qcc::KeyBlob key;        ///< The key blob for the key
+        qcc::KeyBlob key;        ///< The key blob for the key, empty until the key is loaded
         uint8_t accessRights[4]; ///< Access rights associated with this record (see PeerState)
+        qcc::Timespec expiration; ///< Expiration of the key until the key is loaded
+        qcc::String sealed;      ///< The encrypted record last read or written for this key, empty if the key has changed since
+        bool loaded;             ///< Indicates if the key and access rights have been decrypted from the sealed record
     };
 
     /**
@@ -342,6 +442,23 @@ class KeyStore {
      */
     typedef std::map<qcc::GUID128, KeyRecord> KeyMap;
 
+    /**
+     * Encrypt a key record with the given revision and sequence number, this replaces the
+     * record's sealed form.
+     */
+    QStatus SealKey(const qcc::GUID128& guid, KeyRecord& keyRec, uint32_t rev, uint32_t seq);
+
+    /**
+     * Decrypt a key record that has not been loaded yet. A record that cannot be decrypted is
+     * removed from the key store.
+     */
+    QStatus UnsealKey(KeyMap::iterator it);
+
+    /**
+     * Set a key record from a record that has not been decrypted yet.
+     */
+    static void SetSealed(KeyRecord& keyRec, const qcc::String& sealed);
+
     /**
      * In memory copy of the key store
      */
@@ -352,10 +469,43 @@ class KeyStore {
      */
     std::set<qcc::GUID128> deletions;
 
+    /**
+     * GUID for keys that have been added, changed or deleted since the key store was last
+     * pushed
+     */
+    std::set<qcc::GUID128> changes;
+
+    /**
+     * Revision of the key store that was last pulled or pushed in full
+     */
+    uint32_t snapshotRevision;
+
+    /**
+     * Size of the key store that was last pulled or pushed in full
+     */
+    size_t snapshotSize;
+
+    /**
+     * Size of the journal, zero if no journal records have been written since the last push
+     */
+    size_t journalSize;
+
+    /**
+     * Revision of the key store that the journal records apply to. This is different from
+     * snapshotRevision if another application sharing the key store has rewritten it since
+     * it was loaded.
+     */
+    uint32_t journalRevision;
+
+    /**
+     * Indicates if records can be appended to the journal
+     */
+    bool journalValid;
+
     /**
      * Default listener for handling load/store requests
      */
-    KeyStoreListener* defaultListener;
+    DefaultKeyStoreListener* defaultListener;
 
     /**
      * Listener for handling load/store requests
@@ -372,6 +522,13 @@ class KeyStore {
      */
     qcc::Mutex lock;
 
+    /**
+     * Mutex held while the key store is being reloaded or written so that a background
+     * compaction never sees a key store that is half reloaded. Must not be taken while
+     * holding lock.
+     */
+    qcc::Mutex persistLock;
+
     /**
      * Key for encrypting/decrypting the key store.
      */
@@ -397,6 +554,11 @@ class KeyStore {
      */
     qcc::Event* loaded;
 
+    /**
+     * Thread that compacts the journal in the background
+     */
+    KeyStoreCompactor* compactor;
+
     /* the key event listener */
     KeyStoreKeyEventListener* keyEventListener;
 
@@ -22,7 +22,7 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 
-#include <list>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/GUID.h>
@@ -935,10 +935,9 @@ QStatus _LocalEndpoint::HandleMethodCall(Message& message)
     QStatus status = ER_OK;
 
     /* Look up the member */
-    MethodTable::SafeEntry* safeEntry = methodTable.Find(message->GetObjectPath(),
-                                                         message->GetInterface(),
-                                                         message->GetMemberName());
-    const MethodTable::Entry* entry = safeEntry ? safeEntry->entry : NULL;
+    MethodTable::SafeEntry safeEntry;
+    methodTable.Find(message->GetObjectPath(), message->GetInterface(), message->GetMemberName(), safeEntry);
+    const MethodTable::Entry* entry = safeEntry.entry;
 
     if (entry == NULL) {
         if (strcmp(message->GetInterface(), org::freedesktop::DBus::Peer::InterfaceName) == 0) {
@@ -965,7 +964,7 @@ QStatus _LocalEndpoint::HandleMethodCall(Message& message)
             }
         }
         if (status == ER_OK) {
-            status = message->UnmarshalArgs(entry->member->signature, entry->member->returnSignature.c_str());
+            status = message->UnmarshalArgs(entry->member->signature, entry->member->returnSignature.c_str(), &entry->args);
         }
     }
     if (status == ER_OK) {
@@ -1018,8 +1017,6 @@ QStatus _LocalEndpoint::HandleMethodCall(Message& message)
         status = ER_OK;
     }
 
-    // safeEntry might be null here
-    delete safeEntry;
     return status;
 }
 
@@ -1027,33 +1024,19 @@ QStatus _LocalEndpoint::HandleSignal(Message& message)
 {
     QStatus status = ER_OK;
 
-    signalTable.Lock();
-
-    /* Look up the signal */
-    pair<SignalTable::const_iterator, SignalTable::const_iterator> range =
-        signalTable.Find(message->GetInterface(), message->GetMemberName());
+    /*
+     * Look up the signal and build a list of all signal handlers whose rules match it
+     */
+    vector<SignalTable::Handler> callList;
+    SignatureInfo args;
+    const InterfaceDescription::Member* signal = signalTable.Find(message, callList, args);
 
     /*
      * Quick exit if there are no handlers for this signal
      */
-    if (range.first == range.second) {
-        signalTable.Unlock();
+    if (!signal) {
         return ER_OK;
     }
-    /*
-     * Build a list of all signal handlers for this signal
-     */
-    list<SignalTable::Entry> callList;
-    const InterfaceDescription::Member* signal = range.first->second.member;
-    do {
-        if (range.first->second.rule.IsMatch(message)) {
-            callList.push_back(range.first->second);
-        }
-    } while (++range.first != range.second);
-    /*
-     * We have our callback list so we can unlock the signal table.
-     */
-    signalTable.Unlock();
     /*
      * Validate and unmarshal the signal
      */
@@ -1061,7 +1044,7 @@ QStatus _LocalEndpoint::HandleSignal(Message& message)
         status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
         QCC_LogError(status, ("Signal from secure interface was not encrypted"));
     } else {
-        status = message->UnmarshalArgs(signal->signature);
+        status = message->UnmarshalArgs(signal->signature, NULL, &args);
     }
     if (status != ER_OK) {
         if ((status == ER_BUS_MESSAGE_DECRYPTION_FAILED) || (status == ER_BUS_MESSAGE_NOT_ENCRYPTED) || (status == ER_BUS_NOT_AUTHORIZED)) {
@@ -1069,7 +1052,7 @@ QStatus _LocalEndpoint::HandleSignal(Message& message)
             status = ER_OK;
         }
     } else {
-        list<SignalTable::Entry>::const_iterator callit;
+        vector<SignalTable::Handler>::const_iterator callit;
         for (callit = callList.begin(); callit != callList.end(); ++callit) {
             (callit->object->*callit->handler)(callit->member, message->GetObjectPath(), message);
         }
@@ -749,8 +749,9 @@ size_t _Message::ComputeHeaderLen()
 QStatus _Message::EncryptMessage()
 {
     KeyBlob key;
+    PeerCipher cipher;
     PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(GetDestination());
-    QStatus status = peerState->GetKey(key, PEER_SESSION_KEY);
+    QStatus status = peerState->GetKey(key, PEER_SESSION_KEY, cipher);
 
     if (status == ER_OK) {
         /*
@@ -764,7 +765,7 @@ QStatus _Message::EncryptMessage()
     if (status == ER_OK) {
         size_t argsLen = msgHeader.bodyLen - ajn::Crypto::MACLength;
         size_t hdrLen = ROUNDUP8(sizeof(msgHeader) + msgHeader.headerLen);
-        status = ajn::Crypto::Encrypt(*this, key, (uint8_t*)msgBuf, hdrLen, argsLen);
+        status = ajn::Crypto::Encrypt(*this, key, (uint8_t*)msgBuf, hdrLen, argsLen, cipher->Get());
         if (status == ER_OK) {
             QCC_DbgHLPrintf(("EncryptMessage: %s", Description().c_str()));
             /*
@@ -910,8 +911,19 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      */
     hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].Clear();
     if ((msgHeader.flags & ALLJOYN_FLAG_COMPRESSED)) {
-        hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32 = bus->GetInternal().GetCompressionRules()->GetToken(hdrFields);
+        CompressionRules& rules = bus->GetInternal().GetCompressionRules();
+        uint32_t token = rules->GetToken(hdrFields);
+        hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32 = token;
         hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_UINT32;
+        /*
+         * Receivers ask for the expansion of a sessionless message for as long as the router
+         * queues it, so the rule must outlive the message rather than fall out of the LRU.
+         */
+        if (msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) {
+            uint32_t tillExpire;
+            IsExpired(&tillExpire);
+            rules->Pin(String(GetSender()) + ":" + GetInterface() + ":" + GetMemberName() + ":" + GetObjectPath(), token, tillExpire);
+        }
     }
     /*
      * Calculate space required for the header fields
@@ -1383,8 +1395,9 @@ void _Message::ErrorMsg(QStatus status,
 QStatus _Message::GetExpansion(uint32_t token, MsgArg& replyArg)
 {
     QStatus status = ER_OK;
-    const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-    if (expFields) {
+    HeaderFields expansion;
+    const HeaderFields* expFields = &expansion;
+    if (bus->GetInternal().GetCompressionRules()->Expand(token, expansion)) {
         MsgArg* hdrArray = new MsgArg[ALLJOYN_HDR_FIELD_UNKNOWN];
         size_t numElements = 0;
         /*
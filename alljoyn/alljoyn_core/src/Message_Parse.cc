@@ -556,6 +556,11 @@ QStatus _Message::ParseValue(MsgArg* arg, const char*& sigPtr, bool arrayElem)
 static const char* WildCardSignature = "*";
 
 QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char* expectedReplySignature)
+{
+    return UnmarshalArgs(expectedSignature, expectedReplySignature, NULL);
+}
+
+QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char* expectedReplySignature, const SignatureInfo* expectedInfo)
 {
     const char* sig = GetSignature();
     QStatus status = ER_OK;
@@ -591,7 +596,8 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
         size_t hdrLen = bodyPtr - (uint8_t*)msgBuf;
         PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(GetSender());
         KeyBlob key;
-        status = peerState->GetKey(key, broadcast ? PEER_GROUP_KEY : PEER_SESSION_KEY);
+        PeerCipher cipher;
+        status = peerState->GetKey(key, broadcast ? PEER_GROUP_KEY : PEER_SESSION_KEY, cipher);
         if (status != ER_OK) {
             QCC_LogError(status, ("Unable to decrypt message"));
             /*
@@ -613,7 +619,7 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
          * algorithm adds appends a MAC block to the end of the encrypted data.
          */
         size_t bodyLen = msgHeader.bodyLen;
-        status = ajn::Crypto::Decrypt(*this, key, (uint8_t*)msgBuf, hdrLen, bodyLen);
+        status = ajn::Crypto::Decrypt(*this, key, (uint8_t*)msgBuf, hdrLen, bodyLen, cipher->Get());
         if (status != ER_OK) {
             goto ExitUnmarshalArgs;
         }
@@ -621,9 +627,19 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
         authMechanism = key.GetTag();
     }
     /*
-     * Calculate how many arguments there are
+     * Calculate how many arguments there are. If the layout of the expected signature is known a
+     * body of the wrong size for a fixed size signature is rejected before anything is parsed.
      */
-    _numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
+    if (expectedInfo && (expectedSignature != WildCardSignature)) {
+        if (expectedInfo->fixedSize && (msgHeader.bodyLen != expectedInfo->fixedSize)) {
+            status = ER_BUS_BAD_BODY_LEN;
+            QCC_LogError(status, ("Expected a message body of %u bytes got %u", expectedInfo->fixedSize, msgHeader.bodyLen));
+            goto ExitUnmarshalArgs;
+        }
+        _numMsgArgs = expectedInfo->numArgs;
+    } else {
+        _numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
+    }
     _msgArgs = new MsgArg[_numMsgArgs];
 
     /*
@@ -1163,19 +1179,13 @@ QStatus _Message::Unmarshal(qcc::String& endpointName, bool handlePassing, bool
             status = ER_BUS_MISSING_COMPRESSION_TOKEN;
             goto ExitUnmarshal;
         }
-        const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-        if (!expFields) {
-            QCC_DbgPrintf(("No expansion for token %u", token));
-            status = ER_BUS_CANNOT_EXPAND_MESSAGE;
-            goto ExitUnmarshal;
-        }
         /*
          * Expand the compressed fields. Don't overwrite headers we received in the message.
          */
-        for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
-            if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
-                hdrFields.field[id] = expFields->field[id];
-            }
+        if (!bus->GetInternal().GetCompressionRules()->Expand(token, hdrFields)) {
+            QCC_DbgPrintf(("No expansion for token %u", token));
+            status = ER_BUS_CANNOT_EXPAND_MESSAGE;
+            goto ExitUnmarshal;
         }
         hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_INVALID;
     }
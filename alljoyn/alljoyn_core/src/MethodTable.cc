@@ -23,6 +23,8 @@
 
 #include <qcc/platform.h>
 
+#include <vector>
+
 #include "MethodTable.h"
 
 /** @internal */
@@ -33,80 +35,145 @@ using namespace std;
 
 namespace ajn {
 
+MethodTable::MethodTable() : hashTable(new MapType()), pending(NULL), pendingObject(NULL), pendingMethods(NULL)
+{
+}
+
 MethodTable::~MethodTable()
 {
     lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.begin();
-    while (iter != hashTable.end()) {
+    const MapType& table = hashTable.Get();
+    for (MapType::const_iterator iter = table.begin(); iter != table.end(); ++iter) {
+        for (ObjectMethods::const_iterator mit = iter->second->begin(); mit != iter->second->end(); ++mit) {
+            delete mit->second;
+        }
         delete iter->second;
-        ++iter;
     }
-
-    hashTable.clear();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
-void MethodTable::Add(BusObject* object,
-                      MessageReceiver::MethodHandler func,
-                      const InterfaceDescription::Member* member,
-                      void* context)
+MethodTable::ObjectMethods* MethodTable::CopyMethods(MapType& table, BusObject* object, vector<ObjectMethods*>& retired)
 {
-    Entry* entry = new Entry(object, func, member, context);
-    lock.Lock(MUTEX_CONTEXT);
-    hashTable[Key(object->GetPath(), entry->ifaceStr.empty() ? NULL : entry->ifaceStr.c_str(), member->name.c_str())] = entry;
+    ObjectMethods*& methods = table[object->GetPath()];
+    if (methods) {
+        retired.push_back(methods);
+        methods = new ObjectMethods(*methods);
+    } else {
+        methods = new ObjectMethods();
+    }
+    return methods;
+}
+
+void MethodTable::Insert(ObjectMethods& methods, Entry* entry, vector<Entry*>& retired)
+{
+    Key key(entry->ifaceStr.c_str(), entry->methodStr.c_str());
+    ObjectMethods::iterator iter = methods.find(key);
+    if (iter != methods.end()) {
+        retired.push_back(iter->second);
+        methods.erase(iter);
+    }
+    methods.insert(pair<const Key, Entry*>(key, entry));
 
     /* Method calls don't require an interface so we need to add an entry with a NULL interface */
     if (!entry->ifaceStr.empty()) {
         // specification states "if there are multiple properties on an object
         // with the same name, the results are undefined." We choose to only
         // use the first member that was added.
-        if (hashTable.find(Key(object->GetPath(), NULL, member->name.c_str())) == hashTable.end()) {
-            hashTable[Key(object->GetPath(), NULL, member->name.c_str())] = new Entry(*entry);
+        if (methods.find(Key(NULL, entry->methodStr.c_str())) == methods.end()) {
+            Entry* anyIface = new Entry(*entry);
+            methods.insert(pair<const Key, Entry*>(Key(NULL, anyIface->methodStr.c_str()), anyIface));
         }
     }
-    lock.Unlock(MUTEX_CONTEXT);
 }
 
-MethodTable::SafeEntry* MethodTable::Find(const char* objectPath,
-                                          const char* iface,
-                                          const char* methodName)
+void MethodTable::Publish(MapType* next, vector<ObjectMethods*>& retiredMethods, vector<Entry*>& retiredEntries)
 {
-    SafeEntry* entry = NULL;
-    Key key(objectPath, iface, methodName);
+    hashTable.Publish(next);
+    for (size_t i = 0; i < retiredMethods.size(); ++i) {
+        delete retiredMethods[i];
+    }
+    /* Entries wait for any caller that is still using them */
+    for (size_t i = 0; i < retiredEntries.size(); ++i) {
+        delete retiredEntries[i];
+    }
+}
+
+void MethodTable::Add(BusObject* object,
+                      MessageReceiver::MethodHandler func,
+                      const InterfaceDescription::Member* member,
+                      void* context)
+{
+    Entry* entry = new Entry(object, func, member, context);
     lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.find(key);
-    if (iter != hashTable.end()) {
-        entry = new SafeEntry();
-        entry->Set(iter->second);
+    if (pending && (object == pendingObject)) {
+        /* Called from AddAll(), the new table is published once all methods have been added */
+        Insert(*pendingMethods, entry, pendingRetired);
+    } else {
+        vector<ObjectMethods*> retiredMethods;
+        vector<Entry*> retiredEntries;
+        MapType* next = new MapType(hashTable.Get());
+        Insert(*CopyMethods(*next, object, retiredMethods), entry, retiredEntries);
+        Publish(next, retiredMethods, retiredEntries);
     }
     lock.Unlock(MUTEX_CONTEXT);
-    return entry;
+}
+
+bool MethodTable::Find(const char* objectPath,
+                       const char* iface,
+                       const char* methodName,
+                       SafeEntry& entry)
+{
+    SnapshotPtr<MapType>::Reader table(hashTable);
+    MapType::const_iterator iter = table->find(objectPath);
+    if (iter != table->end()) {
+        ObjectMethods::const_iterator mit = iter->second->find(Key(iface, methodName));
+        if (mit != iter->second->end()) {
+            entry.Set(mit->second);
+            return true;
+        }
+    }
+    return false;
 }
 
 void MethodTable::RemoveAll(BusObject* object)
 {
-    MapType::iterator iter;
     /*
-     * Iterate over all entries deleting all entries that reference the object
+     * An object path is only registered by one object at a time so all of
+     * the entries for the object are found under its path.
      */
     lock.Lock(MUTEX_CONTEXT);
-    iter = hashTable.begin();
-    while (iter != hashTable.end()) {
-        if (iter->second->object == object) {
-            Entry* deleteMe = iter->second;
-            hashTable.erase(iter);
-            delete deleteMe;
-            iter = hashTable.begin();
-        } else {
-            ++iter;
+    const MapType& table = hashTable.Get();
+    MapType::const_iterator iter = table.find(object->GetPath());
+    if (iter != table.end()) {
+        vector<ObjectMethods*> retiredMethods(1, iter->second);
+        vector<Entry*> retiredEntries;
+        for (ObjectMethods::const_iterator mit = iter->second->begin(); mit != iter->second->end(); ++mit) {
+            retiredEntries.push_back(mit->second);
         }
+        MapType* next = new MapType(table);
+        next->erase(object->GetPath());
+        Publish(next, retiredMethods, retiredEntries);
     }
     lock.Unlock(MUTEX_CONTEXT);
 }
 
 void MethodTable::AddAll(BusObject* object)
 {
+    /* Collect all of the object's methods into a single new version of the table */
+    lock.Lock(MUTEX_CONTEXT);
+    vector<ObjectMethods*> retiredMethods;
+    vector<Entry*> retiredEntries;
+    pending = new MapType(hashTable.Get());
+    pendingObject = object;
+    pendingMethods = CopyMethods(*pending, object, retiredMethods);
     object->InstallMethods(*this);
+    MapType* next = pending;
+    pending = NULL;
+    pendingObject = NULL;
+    pendingMethods = NULL;
+    retiredEntries.swap(pendingRetired);
+    Publish(next, retiredMethods, retiredEntries);
+    lock.Unlock(MUTEX_CONTEXT);
 }
 
 }
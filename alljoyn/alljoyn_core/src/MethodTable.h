@@ -26,6 +26,7 @@
 #include <vector>
 
 #include <qcc/String.h>
+#include <qcc/StringMapKey.h>
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
 #include <qcc/atomic.h>
@@ -38,10 +39,17 @@
 
 #include <qcc/STLContainer.h>
 
+#include "SignatureUtils.h"
+#include "SnapshotPtr.h"
+
 namespace ajn {
 
 /**
  * %MethodTable is a hash table that maps object paths to BusObject instances.
+ *
+ * The table is published as an immutable snapshot so that method calls can be
+ * dispatched from any number of threads without taking a lock.  Adding or
+ * removing handlers builds a new snapshot under a lock and swaps it in.
  */
 class MethodTable {
 
@@ -59,7 +67,13 @@ class MethodTable {
               const InterfaceDescription::Member* member,
               void* context)
             : object(object), handler(handler), member(member), context(context), ifaceStr(member->iface->GetName()), methodStr(member->name),
-            refCount(0) { }
+            refCount(0)
+        {
+            SignatureInfo returnArgs;
+            if (!member->iface->GetMemberSignatureInfo(member->name.c_str(), args, returnArgs)) {
+                SignatureUtils::GetSignatureInfo(member->signature.c_str(), args);
+            }
+        }
 
         ~Entry()
         {
@@ -79,6 +93,7 @@ class MethodTable {
         void* context;                                 /**<  Optional context provided when handler was registered */
         qcc::String ifaceStr;                          /**<  Interface string */
         qcc::String methodStr;                         /**<  Method string */
+        SignatureInfo args;                            /**<  Layout of the method's arguments */
         mutable volatile int32_t refCount;
     };
 
@@ -101,6 +116,11 @@ class MethodTable {
         const Entry* entry;
     };
 
+    /**
+     * Constructor
+     */
+    MethodTable();
+
     /**
      * Destructor
      */
@@ -124,11 +144,11 @@ class MethodTable {
      * @param objectPath   The object path.
      * @param iface        The interface.
      * @param methodName   The method name.
-     * @return
-     *      - Entry that matches objectPath, interface and method
-     *      - NULL if not found
+     * @param[out] entry   Set to the entry that matches objectPath, interface and method.
+     *
+     * @return  true if a matching entry was found.
      */
-    SafeEntry* Find(const char* objectPath, const char* iface, const char* methodName);
+    bool Find(const char* objectPath, const char* iface, const char* methodName, SafeEntry& entry);
 
     /**
      * Remove all hash entries related to the specified object.
@@ -146,38 +166,35 @@ class MethodTable {
 
   private:
 
-    qcc::Mutex lock; /**< Lock protecting the method table */
+    qcc::Mutex lock; /**< Lock serializing changes to the method table */
 
     /**
-     * Type definition for method hash table key
+     * Type definition for the key of the methods of a single object
      */
     class Key {
       public:
-        const char* objPath;
         const char* iface;
         const char* methodName;
-        Key(const char* obj, const char* ifc, const char* method) : objPath(obj), iface((ifc && *ifc) ? ifc : NULL), methodName(method) { }
+        size_t hash;
+        Key(const char* ifc, const char* method) : iface((ifc && *ifc) ? ifc : NULL), methodName(method), hash(37) {
+            for (const char* p = methodName; *p; ++p) {
+                hash = *p + hash * 11;
+            }
+            if (iface) {
+                for (const char* p = iface; *p; ++p) {
+                    hash += *p * 7;
+                }
+            }
+        }
     };
 
     /**
      * Hash functor
      */
     struct Hash {
-        /** Calculate hash for Key k  */
+        /** Return the hash computed when Key k was constructed */
         size_t operator()(const Key& k) const {
-            size_t hash = 37;
-            for (const char* p = k.methodName; *p; ++p) {
-                hash = *p + hash * 11;
-            }
-            for (const char* p = k.objPath; *p; ++p) {
-                hash = *p + hash * 5;
-            }
-            if (k.iface) {
-                for (const char* p = k.iface; *p; ++p) {
-                    hash += *p * 7;
-                }
-            }
-            return hash;
+            return k.hash;
         }
     };
 
@@ -190,16 +207,54 @@ class MethodTable {
          */
         bool operator()(const Key& k1, const Key& k2) const {
             if ((k1.iface == NULL) || (k2.iface == NULL)) {
-                return (k1.iface == k2.iface) && (strcmp(k1.methodName, k2.methodName) == 0) && (strcmp(k1.objPath, k2.objPath) == 0);
+                return (k1.iface == k2.iface) && (strcmp(k1.methodName, k2.methodName) == 0);
             } else {
-                return (strcmp(k1.methodName, k2.methodName) == 0) && (strcmp(k1.iface, k2.iface) == 0) && (strcmp(k1.objPath, k2.objPath) == 0);
+                return (strcmp(k1.methodName, k2.methodName) == 0) && (strcmp(k1.iface, k2.iface) == 0);
             }
         }
     };
 
-    /** The hash table */
-    typedef std::unordered_map<Key, Entry*, Hash, Equal> MapType;
-    MapType hashTable;
+    /** The methods of a single object, never modified once published */
+    typedef std::unordered_map<Key, Entry*, Hash, Equal> ObjectMethods;
+
+    /** The hash table, maps object paths to the methods of the object */
+    typedef std::unordered_map<qcc::StringMapKey, ObjectMethods*> MapType;
+
+    /**
+     * Replace the methods of an object in a table with a copy that can be modified.
+     *
+     * @param table    The table to modify.
+     * @param object   The object.
+     * @param retired  Receives the replaced methods if the object already had methods in the table.
+     *
+     * @return  The copy of the object's methods.
+     */
+    ObjectMethods* CopyMethods(MapType& table, BusObject* object, std::vector<ObjectMethods*>& retired);
+
+    /**
+     * Insert an entry into the methods of an object.
+     *
+     * @param methods  The methods to modify.
+     * @param entry    The entry to insert.
+     * @param retired  Receives any entry that was replaced.
+     */
+    void Insert(ObjectMethods& methods, Entry* entry, std::vector<Entry*>& retired);
+
+    /**
+     * Publish a new version of the table and delete what it no longer uses.
+     * Must be called with the lock held.
+     *
+     * @param next            The new version of the table.
+     * @param retiredMethods  Methods that are no longer in the table.
+     * @param retiredEntries  Entries that are no longer in the table.
+     */
+    void Publish(MapType* next, std::vector<ObjectMethods*>& retiredMethods, std::vector<Entry*>& retiredEntries);
+
+    SnapshotPtr<MapType> hashTable;     /**< The published table */
+    MapType* pending;                   /**< Table being built by AddAll() */
+    BusObject* pendingObject;           /**< The object AddAll() is adding */
+    ObjectMethods* pendingMethods;      /**< The methods of pendingObject in pending */
+    std::vector<Entry*> pendingRetired; /**< Entries replaced while building pending */
 };
 
 }
@@ -123,16 +123,22 @@ PeerStateTable::PeerStateTable()
 
 PeerState PeerStateTable::GetPeerState(const qcc::String& busName, bool createIfUnknown)
 {
-    lock.Lock(MUTEX_CONTEXT);
-    std::map<const qcc::String, PeerState>::iterator iter = peerMap.find(busName);
-    QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() %s state for %s", (iter == peerMap.end()) ? "no" : "got", busName.c_str()));
-    if (iter != peerMap.end() || createIfUnknown) {
-        PeerState result = peerMap[busName];
-        lock.Unlock(MUTEX_CONTEXT);
+    Shard& shard = GetShard(busName);
+    shard.lock.Lock(MUTEX_CONTEXT);
+    PeerMap::iterator iter = shard.peerMap.find(busName);
+    QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() %s state for %s", (iter == shard.peerMap.end()) ? "no" : "got", busName.c_str()));
+    if (iter != shard.peerMap.end()) {
+        PeerState result = iter->second;
+        shard.lock.Unlock(MUTEX_CONTEXT);
+        return result;
+    }
+    if (createIfUnknown) {
+        PeerState result = shard.peerMap[busName];
+        shard.lock.Unlock(MUTEX_CONTEXT);
         return result;
     }
 
-    lock.Unlock(MUTEX_CONTEXT);
+    shard.lock.Unlock(MUTEX_CONTEXT);
     return PeerState();
 }
 
@@ -140,27 +146,41 @@ PeerState PeerStateTable::GetPeerState(const qcc::String& uniqueName, const qcc:
 {
     assert(uniqueName[0] == ':');
     PeerState result;
-    lock.Lock(MUTEX_CONTEXT);
-    std::map<const qcc::String, PeerState>::iterator iter = peerMap.find(uniqueName);
-    if (iter == peerMap.end()) {
+    Shard& uniqueShard = GetShard(uniqueName);
+    Shard& aliasShard = GetShard(aliasName);
+    /*
+     * The two names may be in different shards, always lock the shards in the same order.
+     */
+    Shard* first = (&uniqueShard < &aliasShard) ? &uniqueShard : &aliasShard;
+    Shard* second = (&uniqueShard < &aliasShard) ? &aliasShard : &uniqueShard;
+    first->lock.Lock(MUTEX_CONTEXT);
+    if (second != first) {
+        second->lock.Lock(MUTEX_CONTEXT);
+    }
+    PeerMap::iterator iter = uniqueShard.peerMap.find(uniqueName);
+    if (iter == uniqueShard.peerMap.end()) {
         QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() no state stored for %s aka %s", uniqueName.c_str(), aliasName.c_str()));
-        result = peerMap[aliasName];
-        peerMap[uniqueName] = result;
+        result = aliasShard.peerMap[aliasName];
+        uniqueShard.peerMap[uniqueName] = result;
     } else {
         QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() got state for %s aka %s", uniqueName.c_str(), aliasName.c_str()));
         result = iter->second;
-        peerMap[aliasName] = result;
+        aliasShard.peerMap[aliasName] = result;
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    if (second != first) {
+        second->lock.Unlock(MUTEX_CONTEXT);
+    }
+    first->lock.Unlock(MUTEX_CONTEXT);
     return result;
 }
 
 void PeerStateTable::DelPeerState(const qcc::String& busName)
 {
-    lock.Lock(MUTEX_CONTEXT);
-    QCC_DbgHLPrintf(("PeerStateTable::DelPeerState() %s for %s", peerMap.count(busName) ? "remove state" : "no state to remove", busName.c_str()));
-    peerMap.erase(busName);
-    lock.Unlock(MUTEX_CONTEXT);
+    Shard& shard = GetShard(busName);
+    shard.lock.Lock(MUTEX_CONTEXT);
+    QCC_DbgHLPrintf(("PeerStateTable::DelPeerState() %s for %s", shard.peerMap.count(busName) ? "remove state" : "no state to remove", busName.c_str()));
+    shard.peerMap.erase(busName);
+    shard.lock.Unlock(MUTEX_CONTEXT);
 }
 
 void PeerStateTable::GetGroupKey(qcc::KeyBlob& key)
@@ -179,22 +199,30 @@ void PeerStateTable::GetGroupKey(qcc::KeyBlob& key)
 void PeerStateTable::Clear()
 {
     qcc::KeyBlob key(0);  /* use version 0 to exchange with older clients that send keyblob instead of key data */
-    lock.Lock(MUTEX_CONTEXT);
-    peerMap.clear();
+    for (size_t i = 0; i < NUM_SHARDS; ++i) {
+        shards[i].lock.Lock(MUTEX_CONTEXT);
+    }
+    for (size_t i = 0; i < NUM_SHARDS; ++i) {
+        shards[i].peerMap.clear();
+    }
     PeerState nullPeer;
     QCC_DbgHLPrintf(("Allocating group key"));
     key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
     key.SetTag("GroupKey", KeyBlob::NO_ROLE);
     nullPeer->SetKey(key, PEER_SESSION_KEY);
-    peerMap[""] = nullPeer;
-    lock.Unlock(MUTEX_CONTEXT);
+    GetShard("").peerMap[""] = nullPeer;
+    for (size_t i = NUM_SHARDS; i > 0; --i) {
+        shards[i - 1].lock.Unlock(MUTEX_CONTEXT);
+    }
 }
 
 PeerStateTable::~PeerStateTable()
 {
-    lock.Lock(MUTEX_CONTEXT);
-    peerMap.clear();
-    lock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < NUM_SHARDS; ++i) {
+        shards[i].lock.Lock(MUTEX_CONTEXT);
+        shards[i].peerMap.clear();
+        shards[i].lock.Unlock(MUTEX_CONTEXT);
+    }
 }
 
 }
@@ -34,6 +34,9 @@
 #include <alljoyn/Message.h>
 
 #include <qcc/String.h>
+#include <qcc/STLContainer.h>
+#include <qcc/Util.h>
+#include <qcc/Crypto.h>
 #include <qcc/GUID.h>
 #include <qcc/KeyBlob.h>
 #include <qcc/ManagedObj.h>
@@ -62,6 +65,54 @@ typedef enum {
  */
 typedef qcc::ManagedObj<_PeerState> PeerState;
 
+/**
+ * A cipher initialized with a peer key. The AES key schedule is computed once when the key is
+ * set rather than for every message that is encrypted or decrypted with the key.
+ */
+class _PeerCipher {
+  public:
+
+    /**
+     * Create an empty cipher
+     */
+    _PeerCipher() : aes(NULL) { }
+
+    /**
+     * Create a cipher for an AES key
+     *
+     * @param key  The key to initialize the cipher with.
+     */
+    _PeerCipher(const qcc::KeyBlob& key) : aes((key.GetType() == qcc::KeyBlob::AES) ? new qcc::Crypto_AES(key, qcc::Crypto_AES::CCM) : NULL) { }
+
+    /**
+     * Destructor
+     */
+    ~_PeerCipher() { delete aes; }
+
+    /**
+     * Get the cipher
+     *
+     * @return  The AES-CCM cipher or NULL if the key was not an AES key.
+     */
+    qcc::Crypto_AES* Get() const { return aes; }
+
+  private:
+
+    /**
+     * Copy constructor not allowed
+     */
+    _PeerCipher(const _PeerCipher& other);
+
+    /**
+     * Assignment not allowed
+     */
+    _PeerCipher& operator=(const _PeerCipher& other);
+
+    qcc::Crypto_AES* aes;
+};
+
+typedef qcc::ManagedObj<_PeerCipher> PeerCipher;
+
 /**
  * This class maintains state information about peers connected to the bus and provides helper
  * functions that check and update various state information.
@@ -141,8 +192,12 @@ class _PeerState {
      * @param keyType    Indicate if this is the unicast or broadcast key.
      */
     void SetKey(const qcc::KeyBlob& key, PeerKeyType keyType) {
+        PeerCipher cipher(key);
+        keyLock.Lock(MUTEX_CONTEXT);
         keys[keyType] = key;
+        ciphers[keyType] = cipher;
         isSecure = key.IsValid();
+        keyLock.Unlock(MUTEX_CONTEXT);
     }
 
     /**
@@ -155,26 +210,44 @@ class _PeerState {
      *          - ER_BUS_KEY_EXPIRED if there was a session key but the key has expired.
      */
     QStatus GetKey(qcc::KeyBlob& key, PeerKeyType keyType) {
+        PeerCipher cipher;
+        return GetKey(key, keyType, cipher);
+    }
+
+    /**
+     * Gets the session key for this peer and a cipher initialized with the key.
+     *
+     * @param key     [out]Returns the session key.
+     * @param cipher  [out]Returns the cipher for the session key.
+     *
+     * @return  - ER_OK if there is a session key set for this peer.
+     *          - ER_BUS_KEY_UNAVAILABLE if no session key has been set for this peer.
+     *          - ER_BUS_KEY_EXPIRED if there was a session key but the key has expired.
+     */
+    QStatus GetKey(qcc::KeyBlob& key, PeerKeyType keyType, PeerCipher& cipher) {
+        QStatus status = ER_BUS_KEY_UNAVAILABLE;
+        keyLock.Lock(MUTEX_CONTEXT);
         if (isSecure) {
-            key = keys[keyType];
-            if (key.HasExpired()) {
-                ClearKeys();
-                return ER_BUS_KEY_EXPIRED;
+            if (keys[keyType].HasExpired()) {
+                EraseKeys();
+                status = ER_BUS_KEY_EXPIRED;
             } else {
-                return ER_OK;
+                key = keys[keyType];
+                cipher = ciphers[keyType];
+                status = ER_OK;
             }
-        } else {
-            return ER_BUS_KEY_UNAVAILABLE;
         }
+        keyLock.Unlock(MUTEX_CONTEXT);
+        return status;
     }
 
     /**
      * Clear the keys for this peer.
      */
     void ClearKeys() {
-        keys[PEER_SESSION_KEY].Erase();
-        keys[PEER_GROUP_KEY].Erase();
-        isSecure = false;
+        keyLock.Lock(MUTEX_CONTEXT);
+        EraseKeys();
+        keyLock.Unlock(MUTEX_CONTEXT);
     }
 
     /**
@@ -254,6 +327,17 @@ class _PeerState {
 
   private:
 
+    /**
+     * Erase the keys and ciphers, must be called with keyLock held.
+     */
+    void EraseKeys() {
+        keys[PEER_SESSION_KEY].Erase();
+        keys[PEER_GROUP_KEY].Erase();
+        ciphers[PEER_SESSION_KEY] = PeerCipher();
+        ciphers[PEER_GROUP_KEY] = PeerCipher();
+        isSecure = false;
+    }
+
     /**
      * True if this peer state is for the local peer.
      */
@@ -315,6 +399,16 @@ class _PeerState {
      */
     qcc::KeyBlob keys[2];
 
+    /**
+     * Ciphers initialized with the session keys.
+     */
+    PeerCipher ciphers[2];
+
+    /**
+     * Mutex to protect the keys and ciphers
+     */
+    qcc::Mutex keyLock;
+
     /**
      * Serial number window. Used by IsValidSerial() to detect replay attacks. The size of the
      * window defines that largest tolerable gap between consecutive serial numbers.
@@ -354,9 +448,10 @@ class PeerStateTable {
      * @return  Returns true if the peer is known.
      */
     bool IsKnownPeer(const qcc::String& busName) {
-        lock.Lock(MUTEX_CONTEXT);
-        bool known = peerMap.count(busName) > 0;
-        lock.Unlock(MUTEX_CONTEXT);
+        Shard& shard = GetShard(busName);
+        shard.lock.Lock(MUTEX_CONTEXT);
+        bool known = shard.peerMap.count(busName) > 0;
+        shard.lock.Unlock(MUTEX_CONTEXT);
         return known;
     }
 
@@ -410,14 +505,60 @@ class PeerStateTable {
   private:
 
     /**
-     * Mapping table from bus names to peer state.
+     * Hash functor for bus names
      */
-    std::map<const qcc::String, PeerState> peerMap;
+    struct Hash {
+        inline size_t operator()(const qcc::String& s) const {
+            return qcc::hash_string(s.c_str());
+        }
+    };
+
+    /**
+     * Functor for testing 2 bus names for equality
+     */
+    struct Equal {
+        inline bool operator()(const qcc::String& s1, const qcc::String& s2) const {
+            return s1 == s2;
+        }
+    };
+
+    /**
+     * Type for the mapping table from bus names to peer state.
+     */
+    typedef std::unordered_map<qcc::String, PeerState, Hash, Equal> PeerMap;
+
+    /**
+     * The peer table is split into shards by bus name hash so that looking up the peer state of
+     * different peers (which happens for every secure message) doesn't contend on a single lock.
+     */
+    static const size_t NUM_SHARDS = 16;
+
+    /**
+     * One shard of the peer table
+     */
+    struct Shard {
+        /**
+         * Mapping table from bus names to peer state.
+         */
+        PeerMap peerMap;
+
+        /**
+         * Mutex to protect this shard of the peer table
+         */
+        qcc::Mutex lock;
+    };
+
+    /**
+     * Get the shard that holds the peer state for a bus name
+     */
+    Shard& GetShard(const qcc::String& busName) {
+        return shards[Hash()(busName) % NUM_SHARDS];
+    }
 
     /**
-     * Mutex to protect the peer table
+     * The peer table shards
      */
-    qcc::Mutex lock;
+    Shard shards[NUM_SHARDS];
 
 };
 
@@ -23,10 +23,12 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <new>
 #include <vector>
 #include <map>
 #include <set>
 
+#include <qcc/atomic.h>
 #include <qcc/Debug.h>
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
@@ -951,15 +953,92 @@ QStatus ProxyBusObject::MethodCallAsync(const char* ifaceName,
 }
 
 /**
- * Internal context structure used between synchronous method_call and method_return
+ * Internal context structure used between synchronous method_call and method_return.
+ *
+ * Waiters are recycled through a free list so a blocking method call does not
+ * have to allocate a context or create a new event for every call.  A waiter is
+ * referenced by the calling thread and by the registered reply handler and is
+ * only recycled once both have released it.  The reply is constructed in place
+ * so the waiter holds no reference to a bus while it is on the free list.
  */
-class SyncReplyContext {
+class SyncReplyWaiter {
   public:
-    SyncReplyContext(BusAttachment& bus) : replyMsg(bus) { }
-    Message replyMsg;
+
+    /** Get a waiter from the free list or create a new one */
+    static SyncReplyWaiter* Acquire()
+    {
+        SyncReplyWaiter* waiter = NULL;
+        freeLock.Lock(MUTEX_CONTEXT);
+        if (!freeList.empty()) {
+            waiter = freeList.back();
+            freeList.pop_back();
+        }
+        freeLock.Unlock(MUTEX_CONTEXT);
+        if (!waiter) {
+            waiter = new SyncReplyWaiter();
+        }
+        waiter->refs = 2;
+        waiter->event.ResetEvent();
+        return waiter;
+    }
+
+    /** Release a reference, the last reference returns the waiter to the free list */
+    void Release()
+    {
+        if (DecrementAndFetch(&refs) != 0) {
+            return;
+        }
+        if (hasReply) {
+            GetReply().~Message();
+            hasReply = false;
+        }
+        freeLock.Lock(MUTEX_CONTEXT);
+        if (freeList.size() < MAX_FREE_WAITERS) {
+            freeList.push_back(this);
+            freeLock.Unlock(MUTEX_CONTEXT);
+        } else {
+            freeLock.Unlock(MUTEX_CONTEXT);
+            delete this;
+        }
+    }
+
+    /** Called by the reply handler to store the reply and wake the calling thread */
+    void SetReply(Message& msg)
+    {
+        new (replyStorage) Message(msg);
+        hasReply = true;
+        QStatus status = event.SetEvent();
+        if (ER_OK != status) {
+            QCC_LogError(status, ("SetEvent failed"));
+        }
+    }
+
+    /** Get the reply, only valid once the event has been set */
+    Message& GetReply() { return *reinterpret_cast<Message*>(replyStorage); }
+
     Event event;
+
+  private:
+
+    SyncReplyWaiter() : refs(0), hasReply(false) { }
+
+    /* Maximum number of waiters kept for reuse */
+    static const size_t MAX_FREE_WAITERS = 64;
+
+    static Mutex freeLock;
+    static std::vector<SyncReplyWaiter*> freeList;
+
+    volatile int32_t refs;
+    bool hasReply;
+    union {
+        uint8_t replyStorage[sizeof(Message)];
+        void* align;
+    };
 };
 
+Mutex SyncReplyWaiter::freeLock;
+std::vector<SyncReplyWaiter*> SyncReplyWaiter::freeList;
+
 
 QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                                    const MsgArg* args,
@@ -1016,17 +1095,16 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
             status = bus->GetInternal().GetRouter().PushMessage(msg, busEndpoint);
         }
     } else {
-        ManagedObj<SyncReplyContext> ctxt(*bus);
         /*
          * Synchronous calls are really asynchronous calls that block waiting for a builtin
          * reply handler to be called.
          */
-        ManagedObj<SyncReplyContext>* heapCtx = new ManagedObj<SyncReplyContext>(ctxt);
+        SyncReplyWaiter* waiter = SyncReplyWaiter::Acquire();
         status = localEndpoint->RegisterReplyHandler(const_cast<MessageReceiver*>(static_cast<const MessageReceiver* const>(this)),
                                                      static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::SyncReplyHandler),
                                                      method,
                                                      msg,
-                                                     heapCtx,
+                                                     waiter,
                                                      timeout);
         if (status == ER_OK) {
             if (b2bEp->IsValid()) {
@@ -1036,8 +1114,9 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                 status = bus->GetInternal().GetRouter().PushMessage(msg, busEndpoint);
             }
         } else {
-            delete heapCtx;
-            heapCtx = NULL;
+            /* The handler was never registered so release its reference as well */
+            waiter->Release();
+            waiter->Release();
             goto MethodCallExit;
         }
 
@@ -1052,7 +1131,7 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                  * SyncReplyHandler or ProxyBusObject::DestructComponents(in case the
                  * ProxyBusObject is being destroyed) or this thread is stopped.
                  */
-                status = Event::Wait(ctxt->event);
+                status = Event::Wait(waiter->event);
                 lock->Lock(MUTEX_CONTEXT);
 
                 std::vector<Thread*>::iterator it = std::find(components->waitingThreads.begin(), components->waitingThreads.end(), thisThread);
@@ -1066,7 +1145,7 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
         }
 
         if (status == ER_OK) {
-            replyMsg = ctxt->replyMsg;
+            replyMsg = waiter->GetReply();
         } else if ((status == ER_ALERTED_THREAD) && (SYNC_METHOD_ALERTCODE_ABORT == thisThread->GetAlertCode())) {
             /*
              * We can't touch anything in this case since the external thread that was waiting
@@ -1075,10 +1154,11 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
             status = ER_BUS_METHOD_CALL_ABORTED;
         } else if (localEndpoint->UnregisterReplyHandler(msg)) {
             /*
-             * The handler was deregistered so we need to delete the context here.
+             * The handler was deregistered so we need to release its reference here.
              */
-            delete heapCtx;
+            waiter->Release();
         }
+        waiter->Release();
     }
 
 MethodCallExit:
@@ -1126,17 +1206,11 @@ QStatus ProxyBusObject::MethodCall(const char* ifaceName,
 void ProxyBusObject::SyncReplyHandler(Message& msg, void* context)
 {
     if (context != NULL) {
-        ManagedObj<SyncReplyContext>* ctx = reinterpret_cast<ManagedObj<SyncReplyContext>*> (context);
-
-        /* Set the reply message */
-        (*ctx)->replyMsg = msg;
+        SyncReplyWaiter* waiter = reinterpret_cast<SyncReplyWaiter*>(context);
 
-        /* Wake up sync method_call thread */
-        QStatus status = (*ctx)->event.SetEvent();
-        if (ER_OK != status) {
-            QCC_LogError(status, ("SetEvent failed"));
-        }
-        delete ctx;
+        /* Set the reply message and wake up sync method_call thread */
+        waiter->SetReply(msg);
+        waiter->Release();
     }
 }
 
@@ -88,13 +88,26 @@ class _RemoteEndpoint::Internal {
         sendTimeout(0),
         maxControlMessages(30),
         numControlMessages(0),
-        numDataMessages(0)
+        numDataMessages(0),
+        maxQueued(0),
+        txMessages(0),
+        rxMessages(0),
+        dropped(0),
+        waits(0)
     {
     }
 
     ~Internal() {
     }
 
+    /* Add a message to the transmit queue.  The caller must hold the lock. */
+    void Enqueue(Message& msg) {
+        txQueue.push_front(msg);
+        if (txQueue.size() > maxQueued) {
+            maxQueued = txQueue.size();
+        }
+    }
+
     BusAttachment& bus;                      /**< Message bus associated with this endpoint */
     qcc::Stream* stream;                     /**< Stream for this endpoint or NULL if uninitialized */
 
@@ -142,6 +155,11 @@ class _RemoteEndpoint::Internal {
                                                   - used on Routing nodes only */
     size_t numControlMessages;               /**< Number of control messages in txQueue - used on Routing nodes only */
     size_t numDataMessages;                  /**< Number of data messages in txQueue - used on Routing nodes only */
+    size_t maxQueued;                        /**< Largest number of messages that have been in txQueue at once */
+    uint64_t txMessages;                     /**< Number of messages written to the stream */
+    uint64_t rxMessages;                     /**< Number of messages read from the stream */
+    uint64_t dropped;                        /**< Number of messages dropped from or refused by txQueue */
+    uint64_t waits;                          /**< Number of times a sender had to wait for room in txQueue */
 };
 
 
@@ -707,6 +725,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
                 switch (status) {
                 case ER_OK:
                     internal->idleTimeoutCount = 0;
+                    ++internal->rxMessages;
                     bool isAck;
                     if ((internal->pingCallSerial != 0) && (msg->GetType() == MESSAGE_METHOD_RET) && (internal->pingCallSerial == msg->GetReplySerial())) {
                         /* This is a response to the DBus ping sent from RN to LN. Consume the reply quietly. */
@@ -949,6 +968,7 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut)
             internal->lock.Lock(MUTEX_CONTEXT);
             internal->txQueue.pop_back();
             internal->getNextMsg = true;
+            ++internal->txMessages;
             if (internal->bus.GetInternal().GetRouter().IsDaemon()) {
                 if (IsControlMessage(internal->currentWriteMsg)) {
                     internal->numControlMessages--;
@@ -1002,13 +1022,14 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
     if (IsControlMessage(msg)) {
 
         if (internal->numControlMessages < internal->maxControlMessages) {
-            internal->txQueue.push_front(msg);
+            internal->Enqueue(msg);
             internal->numControlMessages++;
             if (wasEmpty) {
                 internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
             }
             internal->lock.Unlock(MUTEX_CONTEXT);
         } else {
+            ++internal->dropped;
             internal->lock.Unlock(MUTEX_CONTEXT);
             Invalidate();
             internal->stopping = true;
@@ -1023,7 +1044,7 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
          * this RemoteEndpoint
          */
         if ((internal->numDataMessages < MAX_DATA_MESSAGES) && (internal->txWaitQueue.empty())) {
-            internal->txQueue.push_front(msg);
+            internal->Enqueue(msg);
             internal->numDataMessages++;
         } else {
             /* This thread will have to wait for room in the queue */
@@ -1032,6 +1053,7 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
 
             thread->AddAuxListener(this);
             internal->txWaitQueue.push_front(thread);
+            ++internal->waits;
 
             while (true) {
                 /* Remove a queue entry whose TTLs is expired.
@@ -1053,6 +1075,7 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
                             }
 
                             internal->txQueue.erase(it);
+                            ++internal->dropped;
                             break;
                         } else {
                             ++it;
@@ -1070,7 +1093,7 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
                         if (internal->txQueue.size() == 0) {
                             wasEmpty = true;
                         }
-                        internal->txQueue.push_front(msg);
+                        internal->Enqueue(msg);
                         internal->numDataMessages++;
 
                         status = ER_OK;
@@ -1096,6 +1119,10 @@ QStatus _RemoteEndpoint::PushMessageRouter(Message& msg, size_t& count)
                 }
 
             }
+            if (status != ER_OK) {
+                ++internal->dropped;
+            }
+
             /* Remove thread from wait queue. */
             thread->RemoveAuxListener(this);
             deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
@@ -1137,7 +1164,7 @@ QStatus _RemoteEndpoint::PushMessageLeaf(Message& msg, size_t& count)
      * this RemoteEndpoint
      */
     if ((count < MAX_TX_QUEUE_SIZE) && (internal->txWaitQueue.empty())) {
-        internal->txQueue.push_front(msg);
+        internal->Enqueue(msg);
     } else {
         /* This thread will have to wait for room in the queue */
         Thread* thread = Thread::GetThread();
@@ -1145,6 +1172,7 @@ QStatus _RemoteEndpoint::PushMessageLeaf(Message& msg, size_t& count)
 
         thread->AddAuxListener(this);
         internal->txWaitQueue.push_front(thread);
+        ++internal->waits;
 
         while (true) {
             /* Remove a queue entry whose TTLs is expired.
@@ -1160,6 +1188,7 @@ QStatus _RemoteEndpoint::PushMessageLeaf(Message& msg, size_t& count)
                     uint32_t expMs;
                     if ((*it)->IsExpired(&expMs)) {
                         internal->txQueue.erase(it);
+                        ++internal->dropped;
                         break;
                     } else {
                         ++it;
@@ -1177,7 +1206,7 @@ QStatus _RemoteEndpoint::PushMessageLeaf(Message& msg, size_t& count)
                     if (internal->txQueue.size() == 0) {
                         wasEmpty = true;
                     }
-                    internal->txQueue.push_front(msg);
+                    internal->Enqueue(msg);
                     status = ER_OK;
                     break;
                 }
@@ -1201,6 +1230,10 @@ QStatus _RemoteEndpoint::PushMessageLeaf(Message& msg, size_t& count)
             }
 
         }
+        if (status != ER_OK) {
+            ++internal->dropped;
+        }
+
         /* Remove thread from wait queue. */
         thread->RemoveAuxListener(this);
         deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
@@ -1338,4 +1371,20 @@ bool _RemoteEndpoint::IsSessionRouteSetUp()
     }
 }
 
+void _RemoteEndpoint::GetTrafficStats(TrafficStats& stats)
+{
+    if (internal) {
+        internal->lock.Lock(MUTEX_CONTEXT);
+        stats.queued = static_cast<uint32_t>(internal->txQueue.size());
+        stats.maxQueued = static_cast<uint32_t>(internal->maxQueued);
+        stats.txMessages = internal->txMessages;
+        stats.rxMessages = internal->rxMessages;
+        stats.dropped = internal->dropped;
+        stats.waits = internal->waits;
+        internal->lock.Unlock(MUTEX_CONTEXT);
+    } else {
+        stats = TrafficStats();
+    }
+}
+
 }
@@ -473,6 +473,27 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     virtual QStatus GetLocalIp(qcc::String& ipAddr) { return ER_NOT_IMPLEMENTED; };
 
+    /**
+     * Message counters and transmit queue depth of a remote endpoint.
+     */
+    struct TrafficStats {
+        uint32_t queued;       /**< Number of messages in the transmit queue */
+        uint32_t maxQueued;    /**< Largest number of messages that have been in the transmit queue at once */
+        uint64_t txMessages;   /**< Number of messages written to the stream */
+        uint64_t rxMessages;   /**< Number of messages read from the stream */
+        uint64_t dropped;      /**< Number of messages that expired in, or could not be added to, the transmit queue */
+        uint64_t waits;        /**< Number of times a sender had to wait for room in the transmit queue */
+
+        TrafficStats() : queued(0), maxQueued(0), txMessages(0), rxMessages(0), dropped(0), waits(0) { }
+    };
+
+    /**
+     * Get the message counters and transmit queue depth of this endpoint.
+     *
+     * @param[out] stats   The traffic statistics.
+     */
+    void GetTrafficStats(TrafficStats& stats);
+
   protected:
 
     /**
@@ -0,0 +1,208 @@
+/**
+ * @file
+ *
+ * Stream that moves AllJoyn message bytes through shared memory rings.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#ifndef _ALLJOYN_SHMSTREAM_H
+#define _ALLJOYN_SHMSTREAM_H
+
+#ifndef __cplusplus
+#error Only include ShmStream.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/Event.h>
+#include <qcc/SocketStream.h>
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * A SocketStream that can be upgraded to exchange bytes through a pair of
+ * single-producer/single-consumer rings in a shared memory region.
+ *
+ * The connection starts out as an ordinary unix domain socket stream so that
+ * the credentials exchange and authentication run exactly as they do for the
+ * unix transport.  Once the connection is established the routing node calls
+ * Offer() and the leaf node calls Accept().  The routing node creates and seals
+ * the memory region and sends it, along with an eventfd per ring, over the
+ * socket.  From then on message bytes go through the rings and the socket is
+ * only used as a doorbell: a single byte is sent when the consumer of a ring
+ * has run out of data and is waiting.  Keeping the doorbell on the socket means
+ * that the death of the peer is still reported as end of file on the source
+ * event.  The eventfds signal the producer that space has been freed in a full
+ * ring and serve as the sink event.
+ *
+ * Unix file descriptors cannot be passed through the rings so handle passing
+ * must be disabled on endpoints that use this stream.
+ */
+class ShmStream : public qcc::SocketStream {
+  public:
+
+    /**
+     * Default size in bytes of each of the two rings.
+     */
+    static const uint32_t DEFAULT_RING_SIZE = 256 * 1024;
+
+    /**
+     * Create a stream from a connected unix domain socket.
+     *
+     * @param sock  Socket file descriptor.
+     */
+    ShmStream(qcc::SocketFd sock);
+
+    /**
+     * Destructor
+     */
+    virtual ~ShmStream();
+
+    /**
+     * Called by the routing node once the connection is established to move
+     * the connection onto shared memory.  If the shared memory region cannot be
+     * created the leaf node is told to carry on using the socket.
+     *
+     * @param ringSize  Requested size in bytes of each ring, rounded up to a power of two.
+     *
+     * @return ER_OK if the offer was sent to the leaf node.
+     */
+    QStatus Offer(uint32_t ringSize);
+
+    /**
+     * Called by the leaf node once the connection is established to receive
+     * the shared memory region offered by the routing node.
+     *
+     * @param timeout  Time to wait for the offer in milliseconds.
+     *
+     * @return ER_OK if the offer was received, even if the routing node chose to carry on using the socket.
+     */
+    QStatus Accept(uint32_t timeout);
+
+    /**
+     * Indicates if the stream has been moved onto shared memory.
+     *
+     * @return true if message bytes go through the shared memory rings.
+     */
+    bool IsShared() const { return region != NULL; }
+
+    /**
+     * Close the stream.
+     */
+    void Close();
+
+    /**
+     * Pull bytes from the stream.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  Actual number of bytes retrieved from source.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful. ER_SOCK_OTHER_END_CLOSED if the peer has closed the connection.
+     */
+    QStatus PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Pull bytes and any files descriptors from the stream.  Once the stream
+     * is shared no file descriptors are ever returned.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  Actual number of bytes retrieved from source.
+     * @param fdList       Array to receive file descriptors.
+     * @param numFds       [IN,OUT] On IN the size of fdList on OUT number of files descriptors pulled.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful.
+     */
+    QStatus PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, qcc::SocketFd* fdList, size_t& numFds, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Push bytes into the stream.
+     *
+     * @param buf      Buffer containing data bytes to be sent
+     * @param numBytes Number of bytes from buf to send to sink.
+     * @param numSent  Number of bytes actually consumed by sink.
+     * @return   ER_OK if successful.
+     */
+    QStatus PushBytes(const void* buf, size_t numBytes, size_t& numSent);
+
+    /**
+     * Push bytes and file descriptors into the stream.
+     *
+     * @param buf      Buffer containing data bytes to be sent
+     * @param numBytes Number of bytes from buf to send to sink.
+     * @param numSent  Number of bytes actually consumed by sink.
+     * @param fdList   Array of file descriptors to send.
+     * @param numFds   Number of files descriptors to send.
+     * @param pid      Process id required on some platforms.
+     *
+     * @return  ER_OK if successful, ER_NOT_IMPLEMENTED if the stream is shared.
+     */
+    QStatus PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, qcc::SocketFd* fdList, size_t numFds, uint32_t pid = -1);
+
+    /**
+     * Get the event indicating that the stream can accept more bytes.
+     *
+     * @return Event that is set when there is space in the outgoing ring.
+     */
+    qcc::Event& GetSinkEvent() { return spaceEvent ? *spaceEvent : SocketStream::GetSinkEvent(); }
+
+  private:
+
+    struct Ring;
+
+    /**
+     * Private copy constructor and assignment operator, the mapping and
+     * eventfds cannot be shared between stream instances.
+     */
+    ShmStream(const ShmStream& other);
+    ShmStream& operator=(const ShmStream& other);
+
+    /**
+     * Map the shared memory region and set up the rings.
+     */
+    QStatus Attach(int memFd, int spaceFds[2], uint32_t ringSize, bool isRouter);
+
+    /**
+     * Unmap the shared memory region and close the eventfds.
+     */
+    void Detach();
+
+    /**
+     * Consume doorbell bytes from the socket.
+     */
+    QStatus DrainDoorbell();
+
+    uint8_t* region;            /**< The mapped shared memory region */
+    size_t regionSize;          /**< Size of the mapped region */
+    uint32_t ringSize;          /**< Size of each ring, a power of two */
+    Ring* txRing;               /**< The ring this side produces */
+    Ring* rxRing;               /**< The ring this side consumes */
+    uint8_t* txData;            /**< Data area of txRing */
+    uint8_t* rxData;            /**< Data area of rxRing */
+    uint32_t txTail;            /**< Private copy of the txRing producer index */
+    uint32_t rxHead;            /**< Private copy of the rxRing consumer index */
+    int txSpaceFd;              /**< eventfd signaled by the peer when txRing space is freed */
+    int rxSpaceFd;              /**< eventfd signaled by this side when rxRing space is freed */
+    qcc::Event* spaceEvent;     /**< Event wrapping txSpaceFd */
+    bool closed;                /**< True once Close() has been called */
+};
+
+}
+
+#endif
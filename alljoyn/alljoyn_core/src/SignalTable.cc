@@ -25,7 +25,7 @@
 #include <qcc/Debug.h>
 #include <qcc/String.h>
 
-#include <list>
+#include <vector>
 
 #include "SignalTable.h"
 
@@ -36,6 +36,24 @@ using namespace std;
 
 namespace ajn {
 
+SignalTable::~SignalTable()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    const MapType& table = hashTable.Get();
+    for (MapType::const_iterator iter = table.begin(); iter != table.end(); ++iter) {
+        delete iter->second;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void SignalTable::Publish(MapType* next, vector<Entry*>& retired)
+{
+    hashTable.Publish(next);
+    for (size_t i = 0; i < retired.size(); ++i) {
+        delete retired[i];
+    }
+}
+
 void SignalTable::Add(MessageReceiver* receiver,
                       MessageReceiver::SignalHandler handler,
                       const InterfaceDescription::Member* member,
@@ -45,10 +63,13 @@ void SignalTable::Add(MessageReceiver* receiver,
                   member->iface->GetName(),
                   member->name.c_str(),
                   rule.c_str()));
-    Entry entry(handler, receiver, member, rule);
+    Entry* entry = new Entry(handler, receiver, member, rule);
     Key key(member->iface->GetName(), member->name);
+    vector<Entry*> retired;
     lock.Lock(MUTEX_CONTEXT);
-    hashTable.insert(pair<const Key, Entry>(key, entry));
+    MapType* next = new MapType(hashTable.Get());
+    next->insert(pair<const Key, Entry*>(key, entry));
+    Publish(next, retired);
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -59,22 +80,26 @@ QStatus SignalTable::Remove(MessageReceiver* receiver,
 {
     QStatus status = ER_FAIL;
     Key key(member->iface->GetName(), member->name.c_str());
-    iterator iter;
-    pair<iterator, iterator> range;
     Rule matchRule(rule);
 
     lock.Lock(MUTEX_CONTEXT);
-    range = hashTable.equal_range(key);
-    iter = range.first;
-    while (iter != range.second) {
-        if ((iter->second.object == receiver) &&
-            (iter->second.handler == handler) &&
-            (iter->second.rule == matchRule)) {
-            hashTable.erase(iter);
+    const MapType& table = hashTable.Get();
+    pair<MapType::const_iterator, MapType::const_iterator> range = table.equal_range(key);
+    for (MapType::const_iterator iter = range.first; iter != range.second; ++iter) {
+        if ((iter->second->object == receiver) &&
+            (iter->second->handler == handler) &&
+            (iter->second->rule == matchRule)) {
+            vector<Entry*> retired(1, iter->second);
+            MapType* next = new MapType();
+            next->reserve(table.size());
+            for (MapType::const_iterator it = table.begin(); it != table.end(); ++it) {
+                if (it->second != iter->second) {
+                    next->insert(*it);
+                }
+            }
+            Publish(next, retired);
             status = ER_OK;
             break;
-        } else {
-            ++iter;
         }
     }
     lock.Unlock(MUTEX_CONTEXT);
@@ -83,26 +108,43 @@ QStatus SignalTable::Remove(MessageReceiver* receiver,
 
 void SignalTable::RemoveAll(MessageReceiver* receiver)
 {
-    bool removed;
+    vector<Entry*> retired;
     lock.Lock(MUTEX_CONTEXT);
-    do {
-        removed = false;
-        for (iterator iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
-            if (iter->second.object == receiver) {
-                hashTable.erase(iter);
-                removed = true;
-                break;
+    const MapType& table = hashTable.Get();
+    for (MapType::const_iterator iter = table.begin(); iter != table.end(); ++iter) {
+        if (iter->second->object == receiver) {
+            retired.push_back(iter->second);
+        }
+    }
+    if (!retired.empty()) {
+        MapType* next = new MapType();
+        next->reserve(table.size());
+        for (MapType::const_iterator iter = table.begin(); iter != table.end(); ++iter) {
+            if (iter->second->object != receiver) {
+                next->insert(*iter);
             }
         }
-    } while (removed);
+        Publish(next, retired);
+    }
     lock.Unlock(MUTEX_CONTEXT);
 }
 
-pair<SignalTable::const_iterator, SignalTable::const_iterator> SignalTable::Find(const char* iface,
-                                                                                 const char* signalName)
+const InterfaceDescription::Member* SignalTable::Find(Message& msg, vector<Handler>& handlers, SignatureInfo& args)
 {
-    Key key(iface, signalName);
-    return hashTable.equal_range(key);
+    Key key(msg->GetInterface(), msg->GetMemberName());
+    SnapshotPtr<MapType>::Reader table(hashTable);
+    pair<MapType::const_iterator, MapType::const_iterator> range = table->equal_range(key);
+    if (range.first == range.second) {
+        return NULL;
+    }
+    const InterfaceDescription::Member* signal = range.first->second->member;
+    args = range.first->second->args;
+    for (MapType::const_iterator iter = range.first; iter != range.second; ++iter) {
+        if (iter->second->rule.IsMatch(msg)) {
+            handlers.push_back(Handler(*iter->second));
+        }
+    }
+    return signal;
 }
 
 }
@@ -35,6 +35,7 @@
 #include <qcc/Mutex.h>
 
 #include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/Message.h>
 #include <alljoyn/MessageReceiver.h>
 
 #include <alljoyn/Status.h>
@@ -43,10 +44,17 @@
 
 #include <qcc/STLContainer.h>
 
+#include "SignatureUtils.h"
+#include "SnapshotPtr.h"
+
 namespace ajn {
 
 /**
  * %SignalTable is a multimap that maps interface/signalname to SignalHandler instances.
+ *
+ * The table is published as an immutable snapshot so that signals can be
+ * dispatched from any number of threads without taking a lock.  Adding or
+ * removing handlers builds a new snapshot under a lock and swaps it in.
  */
 class SignalTable {
 
@@ -80,6 +88,7 @@ class SignalTable {
         MessageReceiver* object;                     /**< Object that received the signal */
         const InterfaceDescription::Member* member;  /**< Signal member */
         Rule rule;                                   /**< Match rule */
+        SignatureInfo args;                          /**< Layout of the signal's arguments */
 
         /**
          * Construct an Entry
@@ -88,7 +97,13 @@ class SignalTable {
             : handler(handler),
             object(object),
             member(member),
-            rule(matchRule.c_str()) { }
+            rule(matchRule.c_str())
+        {
+            SignatureInfo returnArgs;
+            if (!member->iface->GetMemberSignatureInfo(member->name.c_str(), args, returnArgs)) {
+                SignatureUtils::GetSignatureInfo(member->signature.c_str(), args);
+            }
+        }
 
         /**
          * Construct an empty Entry.
@@ -96,6 +111,20 @@ class SignalTable {
         Entry(void) : handler(), object(NULL), member(NULL), rule() { }
     };
 
+    /**
+     * A signal handler found for a signal message
+     */
+    struct Handler {
+        MessageReceiver::SignalHandler handler;      /**< SignalHandler instance */
+        MessageReceiver* object;                     /**< Object that received the signal */
+        const InterfaceDescription::Member* member;  /**< Signal member */
+
+        /**
+         * Construct a Handler from a table entry
+         */
+        Handler(const Entry& entry) : handler(entry.handler), object(entry.object), member(entry.member) { }
+    };
+
     /** %Hash functor */
     struct Hash {
         /** Calculate hash for Key k */
@@ -121,14 +150,14 @@ class SignalTable {
     };
 
     /**
-     * Table iterator
+     * Constructor
      */
-    typedef std::unordered_multimap<Key, Entry, Hash, Equal>::iterator iterator;
+    SignalTable() : hashTable(new MapType()) { }
 
     /**
-     * Const table iterator
+     * Destructor
      */
-    typedef std::unordered_multimap<Key, Entry, Hash, Equal>::const_iterator const_iterator;
+    ~SignalTable();
 
     /**
      * Add an entry to the signal hash table.
@@ -166,32 +195,33 @@ class SignalTable {
     void RemoveAll(MessageReceiver* receiver);
 
     /**
-     * Find Entries for a certain signal
-     * Signal table lock should be held until iterators are no longer in use.
+     * Find the handlers for a signal whose match rules match the signal message.
      *
-     * @param iface    The interface.
-     * @param signalName   The signal name.
+     * @param msg            The signal message.
+     * @param[out] handlers  Receives the matching handlers.
+     * @param[out] args      Receives the layout of the signal's arguments.
      *
-     * @return   Iterator range of entries with matching criteria.
+     * @return  The signal member or NULL if no handlers are registered for the signal.
      */
-    std::pair<const_iterator, const_iterator> Find(const char* iface, const char* signalName);
+    const InterfaceDescription::Member* Find(Message& msg, std::vector<Handler>& handlers, SignatureInfo& args);
 
-    /**
-     * Get the lock that protects the signal table.
-     */
-    void Lock(void) { lock.Lock(MUTEX_CONTEXT); }
+  private:
 
-    /**
-     * Release the lock that protects the signal table.
-     */
-    void Unlock(void) { lock.Unlock(MUTEX_CONTEXT); }
+    qcc::Mutex lock; /**< Lock serializing changes to the signal table */
 
-  private:
+    /** The hash table, entries are never modified once published */
+    typedef std::unordered_multimap<Key, Entry*, Hash, Equal> MapType;
 
-    qcc::Mutex lock; /**< Lock protecting the signal table */
+    /**
+     * Publish a new version of the table and delete the entries it no longer uses.
+     * Must be called with the lock held.
+     *
+     * @param next     The new version of the table.
+     * @param retired  Entries that are no longer in the table.
+     */
+    void Publish(MapType* next, std::vector<Entry*>& retired);
 
-    /**  The hash table */
-    std::unordered_multimap<Key, Entry, Hash, Equal> hashTable;
+    SnapshotPtr<MapType> hashTable;  /**< The published table */
 };
 
 }
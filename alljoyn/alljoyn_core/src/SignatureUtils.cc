@@ -321,6 +321,66 @@ uint8_t SignatureUtils::CountCompleteTypes(const char* signature)
     return count;
 }
 
+/*
+ * Adds the layout of a valid complete type to offset and alignment. Returns false if the marshaled
+ * size of the type depends on its value, in which case the offset is no longer meaningful.
+ */
+static bool AddLayout(const char*& sigPtr, size_t& offset, size_t& alignment)
+{
+    AllJoynTypeId typeId = (AllJoynTypeId)(*sigPtr++);
+    size_t align = SignatureUtils::AlignmentForType(typeId);
+    alignment = max(alignment, align);
+    offset = PadUp(offset, align);
+
+    switch (typeId) {
+    case ALLJOYN_STRUCT_OPEN:
+        {
+            bool fixed = true;
+            while (*sigPtr != ALLJOYN_STRUCT_CLOSE) {
+                fixed = AddLayout(sigPtr, offset, alignment) && fixed;
+            }
+            ++sigPtr;
+            return fixed;
+        }
+
+    case ALLJOYN_ARRAY:
+        SignatureUtils::ParseCompleteType(sigPtr);
+        return false;
+
+    case ALLJOYN_OBJECT_PATH:
+    case ALLJOYN_STRING:
+    case ALLJOYN_SIGNATURE:
+    case ALLJOYN_VARIANT:
+        return false;
+
+    default:
+        /* The remaining basic types are the same size as their alignment */
+        offset += align;
+        return true;
+    }
+}
+
+void SignatureUtils::GetSignatureInfo(const char* signature, SignatureInfo& info)
+{
+    size_t offset = 0;
+    size_t alignment = 1;
+    bool fixed = true;
+
+    info.numArgs = 0;
+    if (signature != NULL) {
+        while (*signature) {
+            const char* sigPtr = signature;
+            if (ParseCompleteType(signature) != ER_OK) {
+                break;
+            }
+            fixed = AddLayout(sigPtr, offset, alignment) && fixed;
+            info.numArgs++;
+        }
+    }
+    info.alignment = static_cast<uint8_t>(alignment);
+    info.fixedSize = fixed ? static_cast<uint32_t>(offset) : 0;
+}
+
 bool SignatureUtils::IsValidSignature(const char* signature)
 {
     if (!signature) {
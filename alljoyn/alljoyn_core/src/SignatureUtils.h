@@ -32,6 +32,19 @@
 
 namespace ajn {
 
+/**
+ * Layout of the arguments described by a signature.  This is computed once for
+ * the members and properties of an activated interface so that it does not have
+ * to be worked out again for every message.
+ */
+struct SignatureInfo {
+    uint8_t numArgs;        /**< Number of complete types in the signature */
+    uint8_t alignment;      /**< Largest alignment required by an argument or struct field */
+    uint32_t fixedSize;     /**< Marshaled size of the arguments or 0 if the size depends on the values */
+
+    SignatureInfo() : numArgs(0), alignment(1), fixedSize(0) { }
+};
+
 class SignatureUtils {
 
   public:
@@ -113,6 +126,16 @@ class SignatureUtils {
      */
     static uint8_t CountCompleteTypes(const char* signature);
 
+    /**
+     * Computes the layout of the arguments described by a signature. As with
+     * CountCompleteTypes() the signature is only parsed up to the first
+     * character that does not start a complete type.
+     *
+     * @param signature  The signature
+     * @param[out] info  Returns the argument count, alignment and fixed size
+     */
+    static void GetSignatureInfo(const char* signature, SignatureInfo& info);
+
     /**
      * Check if a signature is a single complete type.
      *
@@ -0,0 +1,157 @@
+#ifndef _ALLJOYN_SNAPSHOTPTR_H
+#define _ALLJOYN_SNAPSHOTPTR_H
+/**
+ * @file
+ * This file defines a pointer to an immutable snapshot that readers can use without locking
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include SnapshotPtr.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+#include <qcc/Thread.h>
+
+namespace ajn {
+
+/**
+ * %SnapshotPtr holds the current version of a read-mostly data structure.
+ *
+ * Readers never block: a Reader announces itself on one of two counters and
+ * then uses whatever snapshot is current.  Writers, which must be serialized by
+ * the owner, build a complete new snapshot and Publish() it.  Publish() swaps
+ * the pointer and then waits for the readers that might still be using the
+ * previous snapshot before deleting it.  The reader counters are flipped twice
+ * so that a writer only ever waits for readers that started before the swap.
+ *
+ * A thread must not call Publish() while it has a Reader on the same pointer.
+ */
+template <typename T>
+class SnapshotPtr {
+  public:
+
+    /**
+     * Scoped read access to the current snapshot.
+     */
+    class Reader {
+      public:
+        /**
+         * Start using the current snapshot.
+         *
+         * @param ptr  The snapshot pointer to read.
+         */
+        Reader(const SnapshotPtr& ptr) : ptr(ptr)
+        {
+            slot = ptr.epoch & 1;
+            qcc::IncrementAndFetch(&ptr.readers[slot]);
+            snapshot = ptr.current;
+        }
+
+        /**
+         * Stop using the snapshot.
+         */
+        ~Reader()
+        {
+            qcc::DecrementAndFetch(&ptr.readers[slot]);
+        }
+
+        /**
+         * Access the snapshot.
+         */
+        const T& operator*() const { return *snapshot; }
+
+        /**
+         * Access the snapshot.
+         */
+        const T* operator->() const { return snapshot; }
+
+      private:
+        Reader(const Reader& other);
+        Reader& operator=(const Reader& other);
+
+        const SnapshotPtr& ptr;
+        const T* snapshot;
+        int32_t slot;
+    };
+
+    /**
+     * Constructor
+     *
+     * @param initial  The initial snapshot, ownership is transferred.
+     */
+    SnapshotPtr(T* initial) : current(initial), epoch(0)
+    {
+        readers[0] = readers[1] = 0;
+    }
+
+    /**
+     * Destructor
+     */
+    ~SnapshotPtr()
+    {
+        delete current;
+    }
+
+    /**
+     * Get the current snapshot.  Only writers may call this.
+     *
+     * @return  The current snapshot.
+     */
+    const T& Get() const { return *current; }
+
+    /**
+     * Replace the current snapshot and delete the previous one once no reader
+     * can still be using it.  Only writers may call this.
+     *
+     * @param next  The new snapshot, ownership is transferred.
+     */
+    void Publish(T* next)
+    {
+        T* prev = current;
+        qcc::CompareAndExchangePointer(reinterpret_cast<void* volatile*>(&current), prev, next);
+        for (uint32_t flip = 0; flip < 2; ++flip) {
+            int32_t slot = (qcc::IncrementAndFetch(&epoch) - 1) & 1;
+            for (uint32_t spin = 0; readers[slot] != 0; ++spin) {
+                if (spin < SPIN_COUNT) {
+                    qcc::Sleep(0);
+                } else {
+                    qcc::Sleep(1);
+                }
+            }
+        }
+        delete prev;
+    }
+
+  private:
+
+    /** Number of times a writer yields before it starts sleeping while waiting for readers */
+    static const uint32_t SPIN_COUNT = 100;
+
+    SnapshotPtr(const SnapshotPtr& other);
+    SnapshotPtr& operator=(const SnapshotPtr& other);
+
+    T* volatile current;                    /**< The current snapshot */
+    volatile int32_t epoch;                 /**< Low bit selects the counter new readers use */
+    mutable volatile int32_t readers[2];    /**< Readers that announced themselves on each counter */
+};
+
+}
+
+#endif
@@ -41,6 +41,9 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "ClientTransport.h"
+#if defined(QCC_OS_LINUX)
+#include "ShmStream.h"
+#endif
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -54,12 +57,29 @@ typedef qcc::ManagedObj<_ClientEndpoint> ClientEndpoint;
  * The name of this transport
  */
 const char* ClientTransport::TransportName = "unix";
+#if defined(QCC_OS_LINUX)
+const char* ShmClientTransport::TransportName = "shm";
+
+/*
+ * On Linux the endpoint stream can be moved onto shared memory, it behaves as
+ * a plain SocketStream until it is.
+ */
+typedef ShmStream ClientStream;
+#else
+typedef SocketStream ClientStream;
+#endif
+
+/*
+ * Time to wait for the daemon to offer shared memory once the connection has
+ * been established.
+ */
+static const uint32_t SHM_OFFER_TIMEOUT = 5000;
 
 class _ClientEndpoint : public _RemoteEndpoint {
   public:
     /* Unix endpoint constructor */
-    _ClientEndpoint(BusAttachment& bus, bool incoming, const qcc::String connectSpec, SocketFd sock) :
-        _RemoteEndpoint(bus, incoming, connectSpec, &stream, ClientTransport::TransportName),
+    _ClientEndpoint(BusAttachment& bus, bool incoming, const qcc::String connectSpec, SocketFd sock, const char* transportName) :
+        _RemoteEndpoint(bus, incoming, connectSpec, &stream, transportName),
         processId(-1),
         stream(sock)
     {
@@ -89,20 +109,26 @@ class _ClientEndpoint : public _RemoteEndpoint {
      */
     bool SupportsUnixIDs() const { return true; }
 
+#if defined(QCC_OS_LINUX)
+    /**
+     * Receive the shared memory offered by the daemon once the connection is established.
+     */
+    QStatus AcceptSharedMemory() { return stream.Accept(SHM_OFFER_TIMEOUT); }
+#endif
 
   private:
     uint32_t processId;
-    SocketStream stream;
+    ClientStream stream;
 };
 
 QStatus ClientTransport::NormalizeTransportSpec(const char* inSpec, qcc::String& outSpec, map<qcc::String, qcc::String>& argMap) const
 {
     /*
-     * Take the string in inSpec, which must start with "unix:" and parse it,
+     * Take the string in inSpec, which must start with the transport name and parse it,
      * looking for comma-separated "key=value" pairs and initialize the
      * argMap with those pairs.
      */
-    QStatus status = ParseArguments("unix", inSpec, argMap);
+    QStatus status = ParseArguments(GetTransportName(), inSpec, argMap);
     if (status != ER_OK) {
         return status;
     }
@@ -111,7 +137,7 @@ QStatus ClientTransport::NormalizeTransportSpec(const char* inSpec, qcc::String&
     qcc::String abstract = Trim(argMap["abstract"]);
     if (ER_OK == status) {
         // @@ TODO: Path normalization?
-        outSpec = "unix:";
+        outSpec = qcc::String(GetTransportName()) + ":";
         if (!path.empty()) {
             outSpec.append("path=");
             outSpec.append(path);
@@ -230,16 +256,23 @@ QStatus ClientTransport::Connect(const char* connectArgs, const SessionOpts& opt
 
     status = SendSocketCreds(sockFd, GetUid(), GetGid(), GetPid());
     static const bool falsiness = false;
-    ClientEndpoint ep = ClientEndpoint(m_bus, falsiness, normSpec, sockFd);
+    const char* transportName = GetTransportName();
+    ClientEndpoint ep = ClientEndpoint(m_bus, falsiness, normSpec, sockFd, transportName);
 
     /* Initialized the features for this endpoint */
     ep->GetFeatures().isBusToBus = false;
     ep->GetFeatures().allowRemote = m_bus.GetInternal().AllowRemoteMessages();
-    ep->GetFeatures().handlePassing = true;
+    /* Unix file descriptors cannot be passed through shared memory */
+    ep->GetFeatures().handlePassing = !m_sharedMemory;
 
     qcc::String authName;
     qcc::String redirection;
     status = ep->Establish("EXTERNAL", authName, redirection);
+#if defined(QCC_OS_LINUX)
+    if ((status == ER_OK) && m_sharedMemory) {
+        status = ep->AcceptSharedMemory();
+    }
+#endif
     if (status == ER_OK) {
         ep->SetListener(this);
         status = ep->Start();
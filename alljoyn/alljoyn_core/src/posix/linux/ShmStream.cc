@@ -0,0 +1,491 @@
+/**
+ * @file
+ *
+ * Shared memory stream used by the shm transport on Linux.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+
+#include <qcc/Debug.h>
+#include <qcc/Socket.h>
+#include <qcc/Util.h>
+
+#include "ShmStream.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+using namespace qcc;
+
+namespace ajn {
+
+/*
+ * Indices are free running and are only ever written by one side, the
+ * producer owns tail and the consumer owns head.  Each is kept in its own cache
+ * line so the two sides do not contend for it.
+ */
+struct ShmStream::Ring {
+    volatile uint32_t tail;             /**< Producer index */
+    uint8_t pad0[60];
+    volatile uint32_t head;             /**< Consumer index */
+    uint8_t pad1[60];
+    volatile uint32_t consumerWaiting;  /**< Set by the consumer when it has found the ring empty */
+    volatile uint32_t producerWaiting;  /**< Set by the producer when it has found the ring full */
+    uint8_t pad2[56];
+};
+
+/* The ring headers take up the first page of the region, ring data follows */
+static const size_t HEADER_SIZE = 4096;
+
+static const uint32_t MIN_RING_SIZE = 4096;
+static const uint32_t MAX_RING_SIZE = 16 * 1024 * 1024;
+
+/* Identifies the offer message sent by the routing node */
+static const uint32_t OFFER_MAGIC = 0x4d534a41;
+
+/* Times out the offer if the socket is backed up */
+static const uint32_t OFFER_TIMEOUT = 5000;
+
+/* Ring 0 carries bytes from the leaf node to the routing node, ring 1 the other way */
+static const size_t LEAF_TO_ROUTER = 0;
+static const size_t ROUTER_TO_LEAF = 1;
+
+struct ShmOffer {
+    uint32_t magic;
+    uint32_t ringSize;  /**< Zero if the connection stays on the socket */
+};
+
+static void SignalSpace(int fd)
+{
+    uint64_t one = 1;
+    if (::write(fd, &one, sizeof(one)) < 0 && (errno != EAGAIN)) {
+        QCC_LogError(ER_OS_ERROR, ("ShmStream: eventfd write failed: %s", strerror(errno)));
+    }
+}
+
+static void ClearSpace(int fd)
+{
+    uint64_t count;
+    while (::read(fd, &count, sizeof(count)) > 0) {
+    }
+}
+
+ShmStream::ShmStream(SocketFd sock) :
+    SocketStream(sock),
+    region(NULL),
+    regionSize(0),
+    ringSize(0),
+    txRing(NULL),
+    rxRing(NULL),
+    txData(NULL),
+    rxData(NULL),
+    txTail(0),
+    rxHead(0),
+    txSpaceFd(-1),
+    rxSpaceFd(-1),
+    spaceEvent(NULL),
+    closed(false)
+{
+}
+
+ShmStream::~ShmStream()
+{
+    Detach();
+}
+
+QStatus ShmStream::Attach(int memFd, int spaceFds[2], uint32_t ringSize, bool isRouter)
+{
+    size_t size = HEADER_SIZE + 2 * static_cast<size_t>(ringSize);
+    void* addr = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (addr == MAP_FAILED) {
+        QStatus status = ER_OS_ERROR;
+        QCC_LogError(status, ("ShmStream::Attach(): mmap failed: %s", strerror(errno)));
+        return status;
+    }
+    region = static_cast<uint8_t*>(addr);
+    regionSize = size;
+    this->ringSize = ringSize;
+
+    Ring* rings = reinterpret_cast<Ring*>(region);
+    uint8_t* data = region + HEADER_SIZE;
+    size_t tx = isRouter ? ROUTER_TO_LEAF : LEAF_TO_ROUTER;
+    size_t rx = isRouter ? LEAF_TO_ROUTER : ROUTER_TO_LEAF;
+    if (isRouter) {
+        /*
+         * Both consumers start out waiting so the first bytes written to each
+         * ring ring the doorbell.
+         */
+        ::memset(region, 0, HEADER_SIZE);
+        rings[LEAF_TO_ROUTER].consumerWaiting = 1;
+        rings[ROUTER_TO_LEAF].consumerWaiting = 1;
+        __sync_synchronize();
+    }
+    txRing = &rings[tx];
+    rxRing = &rings[rx];
+    txData = data + tx * ringSize;
+    rxData = data + rx * ringSize;
+    txTail = txRing->tail;
+    rxHead = rxRing->head;
+    txSpaceFd = spaceFds[tx];
+    rxSpaceFd = spaceFds[rx];
+    spaceEvent = new Event(txSpaceFd, Event::IO_READ);
+    return ER_OK;
+}
+
+void ShmStream::Detach()
+{
+    delete spaceEvent;
+    spaceEvent = NULL;
+    /* The Event destructor does not close the underlying fd */
+    if (txSpaceFd >= 0) {
+        ::close(txSpaceFd);
+        txSpaceFd = -1;
+    }
+    if (rxSpaceFd >= 0) {
+        ::close(rxSpaceFd);
+        rxSpaceFd = -1;
+    }
+    if (region) {
+        ::munmap(region, regionSize);
+        region = NULL;
+    }
+    txRing = rxRing = NULL;
+}
+
+QStatus ShmStream::Offer(uint32_t requestedSize)
+{
+    uint32_t size = MIN_RING_SIZE;
+    while ((size < requestedSize) && (size < MAX_RING_SIZE)) {
+        size <<= 1;
+    }
+
+    QStatus status = ER_OK;
+    int memFd = -1;
+    int spaceFds[2] = { -1, -1 };
+
+#if defined(SYS_memfd_create) && defined(F_ADD_SEALS)
+    memFd = static_cast<int>(::syscall(SYS_memfd_create, "alljoyn-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#else
+    errno = ENOSYS;
+#endif
+    if (memFd < 0) {
+        status = ER_OS_ERROR;
+        QCC_LogError(status, ("ShmStream::Offer(): memfd_create failed: %s", strerror(errno)));
+    }
+    if (status == ER_OK) {
+        if (::ftruncate(memFd, HEADER_SIZE + 2 * static_cast<off_t>(size)) != 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("ShmStream::Offer(): ftruncate failed: %s", strerror(errno)));
+        }
+    }
+#if defined(F_ADD_SEALS)
+    /*
+     * Seal the size so the leaf node cannot truncate the region out from
+     * under the routing node and have it killed by SIGBUS.
+     */
+    if (status == ER_OK) {
+        if (::fcntl(memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("ShmStream::Offer(): sealing failed: %s", strerror(errno)));
+        }
+    }
+#endif
+    /*
+     * The eventfds are the sink events so they start out readable, they are
+     * only cleared by a producer that finds its ring full.
+     */
+    for (size_t i = 0; (status == ER_OK) && (i < ArraySize(spaceFds)); ++i) {
+        spaceFds[i] = ::eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (spaceFds[i] < 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("ShmStream::Offer(): eventfd failed: %s", strerror(errno)));
+        }
+    }
+    if (status == ER_OK) {
+        status = Attach(memFd, spaceFds, size, true);
+    }
+    if (status != ER_OK) {
+        for (size_t i = 0; i < ArraySize(spaceFds); ++i) {
+            if (spaceFds[i] >= 0) {
+                ::close(spaceFds[i]);
+            }
+        }
+        size = 0;
+    }
+
+    ShmOffer offer = { OFFER_MAGIC, size };
+    SocketFd fdList[] = { memFd, spaceFds[0], spaceFds[1] };
+    size_t sent = 0;
+    while (true) {
+        if (size) {
+            status = SendWithFds(sock, &offer, sizeof(offer), sent, fdList, ArraySize(fdList), -1);
+        } else {
+            status = Send(sock, &offer, sizeof(offer), sent);
+        }
+        if (status != ER_WOULDBLOCK) {
+            break;
+        }
+        status = Event::Wait(*sinkEvent, OFFER_TIMEOUT);
+        if (status != ER_OK) {
+            break;
+        }
+    }
+    if ((status == ER_OK) && (sent != sizeof(offer))) {
+        status = ER_WRITE_ERROR;
+    }
+    if (memFd >= 0) {
+        ::close(memFd);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ShmStream::Offer(): Failed to send offer"));
+        Detach();
+    } else {
+        QCC_DbgPrintf(("ShmStream::Offer(): %s", size ? "using shared memory" : "staying on socket"));
+    }
+    return status;
+}
+
+QStatus ShmStream::Accept(uint32_t timeout)
+{
+    ShmOffer offer;
+    SocketFd fdList[SOCKET_MAX_FILE_DESCRIPTORS];
+    size_t recvdFds = 0;
+    size_t received = 0;
+    QStatus status;
+    while (true) {
+        status = RecvWithFds(sock, &offer, sizeof(offer), received, fdList, ArraySize(fdList), recvdFds);
+        if (status != ER_WOULDBLOCK) {
+            break;
+        }
+        status = Event::Wait(*sourceEvent, timeout);
+        if (status != ER_OK) {
+            break;
+        }
+    }
+    if (status == ER_OK) {
+        if (received == 0) {
+            status = ER_SOCK_OTHER_END_CLOSED;
+        } else if ((received != sizeof(offer)) || (offer.magic != OFFER_MAGIC)) {
+            status = ER_READ_ERROR;
+        } else if (offer.ringSize != 0) {
+            struct stat st;
+            if ((recvdFds != 3) ||
+                (offer.ringSize < MIN_RING_SIZE) || (offer.ringSize > MAX_RING_SIZE) || (offer.ringSize & (offer.ringSize - 1)) ||
+                (::fstat(fdList[0], &st) != 0) || (static_cast<size_t>(st.st_size) < HEADER_SIZE + 2 * static_cast<size_t>(offer.ringSize))) {
+                status = ER_READ_ERROR;
+            } else {
+                int spaceFds[2] = { fdList[1], fdList[2] };
+                status = Attach(fdList[0], spaceFds, offer.ringSize, false);
+                if (status == ER_OK) {
+                    /* The eventfds now belong to the stream */
+                    recvdFds = 1;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < recvdFds; ++i) {
+        ::close(fdList[i]);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ShmStream::Accept(): Failed to receive offer"));
+    } else {
+        QCC_DbgPrintf(("ShmStream::Accept(): %s", region ? "using shared memory" : "staying on socket"));
+    }
+    return status;
+}
+
+void ShmStream::Close()
+{
+    closed = true;
+    SocketStream::Close();
+}
+
+QStatus ShmStream::DrainDoorbell()
+{
+    uint8_t buf[64];
+    size_t recvd;
+    while (true) {
+        QStatus status = Recv(sock, buf, sizeof(buf), recvd);
+        if (status == ER_WOULDBLOCK) {
+            return ER_OK;
+        }
+        if (status != ER_OK) {
+            return status;
+        }
+        if (recvd == 0) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        }
+    }
+}
+
+QStatus ShmStream::PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout)
+{
+    if (!region) {
+        return SocketStream::PullBytes(buf, reqBytes, actualBytes, timeout);
+    }
+    actualBytes = 0;
+    if (reqBytes == 0) {
+        return closed ? ER_READ_ERROR : ER_OK;
+    }
+    while (true) {
+        if (closed) {
+            return ER_READ_ERROR;
+        }
+        uint32_t avail = rxRing->tail - rxHead;
+        if (avail > ringSize) {
+            QCC_LogError(ER_READ_ERROR, ("ShmStream::PullBytes(): Ring indices are corrupt"));
+            return ER_READ_ERROR;
+        }
+        if (avail) {
+            /* Read the data only after the producer index that covers it */
+            __sync_synchronize();
+            size_t n = std::min(static_cast<size_t>(avail), reqBytes);
+            size_t offset = rxHead & (ringSize - 1);
+            size_t first = std::min(n, ringSize - offset);
+            ::memcpy(buf, rxData + offset, first);
+            ::memcpy(static_cast<uint8_t*>(buf) + first, rxData, n - first);
+            __sync_synchronize();
+            rxHead += static_cast<uint32_t>(n);
+            rxRing->head = rxHead;
+            __sync_synchronize();
+            if (__sync_bool_compare_and_swap(&rxRing->producerWaiting, 1, 0)) {
+                SignalSpace(rxSpaceFd);
+            }
+            actualBytes = n;
+            return ER_OK;
+        }
+        /*
+         * The ring is empty.  Doorbell bytes are consumed first so that the
+         * source event reflects new doorbells and end of file.  The waiting
+         * flag must be visible to the producer before the ring is checked
+         * again otherwise a doorbell could be missed.
+         */
+        QStatus status = DrainDoorbell();
+        if (status != ER_OK) {
+            return status;
+        }
+        rxRing->consumerWaiting = 1;
+        __sync_synchronize();
+        if (rxRing->tail != rxHead) {
+            continue;
+        }
+        if (timeout == 0) {
+            return ER_TIMEOUT;
+        }
+        status = Event::Wait(*sourceEvent, timeout);
+        if (status != ER_OK) {
+            return status;
+        }
+    }
+}
+
+QStatus ShmStream::PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, SocketFd* fdList, size_t& numFds, uint32_t timeout)
+{
+    if (!region) {
+        return SocketStream::PullBytesAndFds(buf, reqBytes, actualBytes, fdList, numFds, timeout);
+    }
+    numFds = 0;
+    return PullBytes(buf, reqBytes, actualBytes, timeout);
+}
+
+QStatus ShmStream::PushBytes(const void* buf, size_t numBytes, size_t& numSent)
+{
+    if (!region) {
+        return SocketStream::PushBytes(buf, numBytes, numSent);
+    }
+    numSent = 0;
+    if (numBytes == 0) {
+        return ER_OK;
+    }
+    while (true) {
+        if (closed) {
+            return ER_WRITE_ERROR;
+        }
+        uint32_t used = txTail - txRing->head;
+        if (used > ringSize) {
+            QCC_LogError(ER_WRITE_ERROR, ("ShmStream::PushBytes(): Ring indices are corrupt"));
+            return ER_WRITE_ERROR;
+        }
+        if (used < ringSize) {
+            size_t n = std::min(static_cast<size_t>(ringSize - used), numBytes);
+            size_t offset = txTail & (ringSize - 1);
+            size_t first = std::min(n, ringSize - offset);
+            ::memcpy(txData + offset, buf, first);
+            ::memcpy(txData, static_cast<const uint8_t*>(buf) + first, n - first);
+            /* Publish the data before the producer index that covers it */
+            __sync_synchronize();
+            txTail += static_cast<uint32_t>(n);
+            txRing->tail = txTail;
+            __sync_synchronize();
+            if (__sync_bool_compare_and_swap(&txRing->consumerWaiting, 1, 0)) {
+                static const uint8_t doorbell = 0;
+                size_t sent;
+                /* A full socket buffer already holds doorbells so a failed send can be ignored */
+                Send(sock, &doorbell, sizeof(doorbell), sent);
+            }
+            numSent = n;
+            return ER_OK;
+        }
+        /* The ring is full, wait for the consumer to free some space */
+        ClearSpace(txSpaceFd);
+        txRing->producerWaiting = 1;
+        __sync_synchronize();
+        if ((txTail - txRing->head) < ringSize) {
+            continue;
+        }
+        QStatus status;
+        if (sendTimeout == 0) {
+            return ER_TIMEOUT;
+        } else if (sendTimeout == Event::WAIT_FOREVER) {
+            status = Event::Wait(*spaceEvent);
+        } else {
+            status = Event::Wait(*spaceEvent, sendTimeout);
+        }
+        if (status != ER_OK) {
+            return status;
+        }
+    }
+}
+
+QStatus ShmStream::PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, SocketFd* fdList, size_t numFds, uint32_t pid)
+{
+    if (!region) {
+        return SocketStream::PushBytesAndFds(buf, numBytes, numSent, fdList, numFds, pid);
+    }
+    return ER_NOT_IMPLEMENTED;
+}
+
+}
@@ -0,0 +1,142 @@
+/**
+ * @file
+ * ECDHE_ECDSA key exchange benchmark
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/Crypto.h>
+#include <qcc/CryptoECC.h>
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "CRYPTO"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static const uint8_t hello[] = "ECDHE_ECDSA handshake transcript";
+
+/*
+ * Mirrors the public key operations both peers perform in an ECDHE_ECDSA
+ * authentication: each side generates an ephemeral DH key pair, derives the
+ * shared secret from the other's public key, signs its verifier and checks
+ * the peer's signature.
+ */
+static QStatus Handshake(Crypto_ECC& client, Crypto_ECC& server)
+{
+    ECCSecret clientSecret;
+    ECCSecret serverSecret;
+    ECCSignature clientSig;
+    ECCSignature serverSig;
+
+    QStatus status = client.GenerateDHKeyPair();
+    if (status == ER_OK) {
+        status = server.GenerateDHKeyPair();
+    }
+    if (status == ER_OK) {
+        status = client.GenerateSharedSecret(server.GetDHPublicKey(), &clientSecret);
+    }
+    if (status == ER_OK) {
+        status = server.GenerateSharedSecret(client.GetDHPublicKey(), &serverSecret);
+    }
+    if ((status == ER_OK) && (memcmp(&clientSecret, &serverSecret, sizeof(ECCSecret)) != 0)) {
+        status = ER_FAIL;
+        QCC_LogError(status, ("Shared secrets don't match"));
+    }
+    if (status == ER_OK) {
+        status = client.DSASign(hello, sizeof(hello), &clientSig);
+    }
+    if (status == ER_OK) {
+        status = server.DSASign(hello, sizeof(hello), &serverSig);
+    }
+    if (status == ER_OK) {
+        Crypto_ECC verifier;
+        verifier.SetDSAPublicKey(client.GetDSAPublicKey());
+        status = verifier.DSAVerify(hello, sizeof(hello), &clientSig);
+        if (status == ER_OK) {
+            verifier.SetDSAPublicKey(server.GetDSAPublicKey());
+            status = verifier.DSAVerify(hello, sizeof(hello), &serverSig);
+        }
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: ecc [-h] [-n <count>]\n\n");
+    printf("Options:\n");
+    printf("   -h            - Print this help message\n");
+    printf("   -n <count>    - Number of handshakes to run (default 200)\n");
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t count = 200;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            count = StringToU32(argv[++i], 10, count);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Crypto_ECC client;
+    Crypto_ECC server;
+    status = client.GenerateDSAKeyPair();
+    if (status == ER_OK) {
+        status = server.GenerateDSAKeyPair();
+    }
+
+    uint64_t start = GetTimestamp64();
+    uint32_t done = 0;
+    while ((status == ER_OK) && (done < count)) {
+        status = Handshake(client, server);
+        if (status == ER_OK) {
+            ++done;
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Handshake %u failed", done));
+        return 1;
+    }
+    printf("handshakes:      %u in %u ms\n", done, static_cast<uint32_t>(elapsed));
+    printf("handshakes/sec:  %.1f\n", elapsed ? (done * 1000.0) / elapsed : 0.0);
+    return 0;
+}
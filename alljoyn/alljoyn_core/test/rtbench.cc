@@ -0,0 +1,230 @@
+/**
+ * @file
+ * Synchronous method call round-trip benchmark
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static const char* INTERFACE_NAME = "org.alljoyn.rtbench";
+static const char* OBJECT_PATH = "/org/alljoyn/rtbench";
+
+/* Microsecond monotonic timestamp */
+static uint64_t NowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Number of open file descriptors, -1 if it cannot be determined */
+static int CountOpenFds()
+{
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir) {
+        return -1;
+    }
+    int count = 0;
+    while (readdir(dir)) {
+        ++count;
+    }
+    closedir(dir);
+    /* Don't count ".", ".." or the directory itself */
+    return count - 3;
+}
+
+/**
+ * Object that echoes its argument back to the caller.
+ */
+class EchoObject : public BusObject {
+  public:
+    EchoObject(BusAttachment& bus) : BusObject(OBJECT_PATH)
+    {
+        const InterfaceDescription* iface = bus.GetInterface(INTERFACE_NAME);
+        AddInterface(*iface);
+        const MethodEntry methodEntries[] = {
+            { iface->GetMember("Echo"), static_cast<MessageReceiver::MethodHandler>(&EchoObject::Echo) }
+        };
+        AddMethodHandlers(methodEntries, ArraySize(methodEntries));
+    }
+
+    void Echo(const InterfaceDescription::Member* member, Message& msg)
+    {
+        size_t numArgs;
+        const MsgArg* args;
+        msg->GetArgs(numArgs, args);
+        QStatus status = MethodReply(msg, args, numArgs);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Echo: Error sending reply"));
+        }
+    }
+};
+
+static QStatus CreateInterface(BusAttachment& bus)
+{
+    InterfaceDescription* iface = NULL;
+    QStatus status = bus.CreateInterface(INTERFACE_NAME, iface);
+    if (status == ER_OK) {
+        iface->AddMethod("Echo", "ay", "ay", "in,out", 0);
+        iface->Activate();
+    }
+    return status;
+}
+
+static uint32_t Percentile(const vector<uint32_t>& sorted, double pct)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(pct * (sorted.size() - 1) / 100.0);
+    return sorted[idx];
+}
+
+static void usage(void)
+{
+    printf("Usage: rtbench [-h] [-n <count>] [-s <size>] [-c <connect spec>]\n\n");
+    printf("Options:\n");
+    printf("   -h                 - Print this help message\n");
+    printf("   -n <count>         - Number of method calls to make (default 10000)\n");
+    printf("   -s <size>          - Size of the echoed byte array (default 16)\n");
+    printf("   -c <connect spec>  - Connect spec to use for both attachments\n");
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t count = 10000;
+    size_t size = 16;
+    const char* connectSpec = NULL;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    /* Parse command line args */
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            count = StringToU32(argv[++i], 10, count);
+        } else if ((::strcmp("-s", argv[i]) == 0) && (i + 1 < argc)) {
+            size = StringToU32(argv[++i], 10, static_cast<uint32_t>(size));
+        } else if ((::strcmp("-c", argv[i]) == 0) && (i + 1 < argc)) {
+            connectSpec = argv[++i];
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    BusAttachment serviceBus("rtbench-service", true);
+    BusAttachment clientBus("rtbench-client", true);
+
+    status = CreateInterface(serviceBus);
+    if (status == ER_OK) {
+        status = CreateInterface(clientBus);
+    }
+    EchoObject echoObj(serviceBus);
+    if (status == ER_OK) {
+        status = serviceBus.RegisterBusObject(echoObj);
+    }
+    if (status == ER_OK) {
+        status = serviceBus.Start();
+    }
+    if (status == ER_OK) {
+        status = connectSpec ? serviceBus.Connect(connectSpec) : serviceBus.Connect();
+    }
+    if (status == ER_OK) {
+        status = clientBus.Start();
+    }
+    if (status == ER_OK) {
+        status = connectSpec ? clientBus.Connect(connectSpec) : clientBus.Connect();
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up bus attachments"));
+        return 1;
+    }
+
+    ProxyBusObject proxy(clientBus, serviceBus.GetUniqueName().c_str(), OBJECT_PATH, 0);
+    proxy.AddInterface(*clientBus.GetInterface(INTERFACE_NAME));
+    const InterfaceDescription::Member* echo = clientBus.GetInterface(INTERFACE_NAME)->GetMember("Echo");
+
+    vector<uint8_t> payload(size, 0x5a);
+    MsgArg arg("ay", payload.size(), payload.empty() ? NULL : &payload[0]);
+    Message reply(clientBus);
+
+    /* Warm up the connection before measuring */
+    for (uint32_t i = 0; (i < 100) && (status == ER_OK); ++i) {
+        status = proxy.MethodCall(*echo, &arg, 1, reply);
+    }
+
+    vector<uint32_t> latencies;
+    latencies.reserve(count);
+    int fdsBefore = CountOpenFds();
+    uint64_t startUs = NowUs();
+    for (uint32_t i = 0; (i < count) && (status == ER_OK); ++i) {
+        uint64_t callUs = NowUs();
+        status = proxy.MethodCall(*echo, &arg, 1, reply);
+        latencies.push_back(static_cast<uint32_t>(NowUs() - callUs));
+    }
+    uint64_t elapsedUs = ::max(NowUs() - startUs, static_cast<uint64_t>(1));
+    int fdsAfter = CountOpenFds();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("MethodCall failed"));
+    }
+    sort(latencies.begin(), latencies.end());
+
+    printf("calls:         %u of %u (%u bytes each way)\n", static_cast<uint32_t>(latencies.size()), count, static_cast<uint32_t>(size));
+    printf("elapsed:       %.3f s\n", elapsedUs / 1000000.0);
+    printf("calls/sec:     %.0f\n", latencies.size() * 1000000.0 / elapsedUs);
+    printf("latency (us):  p50=%u p90=%u p99=%u p99.9=%u max=%u\n",
+           Percentile(latencies, 50), Percentile(latencies, 90), Percentile(latencies, 99),
+           Percentile(latencies, 99.9), latencies.empty() ? 0 : latencies.back());
+    printf("open fds:      %d before, %d after\n", fdsBefore, fdsAfter);
+
+    clientBus.Disconnect();
+    serviceBus.Disconnect();
+    return (status == ER_OK) ? 0 : 1;
+}
@@ -28,6 +28,7 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Util.h>
+#include <qcc/time.h>
 #include <qcc/Debug.h>
 #include <qcc/BigNum.h>
 
@@ -56,6 +57,47 @@ class MyAuthListener : public AuthListener {
     }
 };
 
+/*
+ * One complete SRP exchange with the server deriving the verifier from the password.
+ */
+static QStatus Handshake(const String& user, const String& pwd)
+{
+    Crypto_SRP client;
+    Crypto_SRP server;
+    String toClient;
+    String toServer;
+    KeyBlob serverPMS;
+    KeyBlob clientPMS;
+
+    QStatus status = server.ServerInit(user, pwd, toClient);
+    if (status == ER_OK) {
+        status = client.ClientInit(toClient, toServer);
+    }
+    if (status == ER_OK) {
+        status = server.ServerFinish(toServer);
+    }
+    if (status == ER_OK) {
+        status = client.ClientFinish(user, pwd);
+    }
+    if (status == ER_OK) {
+        server.GetPremasterSecret(serverPMS);
+        client.GetPremasterSecret(clientPMS);
+        if ((clientPMS.GetSize() != serverPMS.GetSize()) || (memcmp(serverPMS.GetData(), clientPMS.GetData(), serverPMS.GetSize()) != 0)) {
+            status = ER_AUTH_FAIL;
+        }
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: srp [-h] [-n <count>]\n\n");
+    printf("Options:\n");
+    printf("   -h            - Print this help message\n");
+    printf("   -n <count>    - Number of timed handshakes to run (default 50)\n");
+    printf("\n");
+}
+
 int main(int argc, char** argv)
 {
     String toClient;
@@ -66,10 +108,24 @@ int main(int argc, char** argv)
     KeyBlob clientPMS;
     String user = "someuser";
     String pwd = "a-secret-password";
+    uint32_t count = 50;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
 
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            count = StringToU32(argv[++i], 10, count);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
     /* Test vector as defined in RFC 5246 built in to Crypto_SRP class */
     {
         Crypto_SRP srp;
@@ -226,6 +282,27 @@ int main(int argc, char** argv)
         }
     }
 
+    /*
+     * Time complete handshakes
+     */
+    {
+        uint64_t start = GetTimestamp64();
+        uint32_t done = 0;
+        while ((status == ER_OK) && (done < count)) {
+            status = Handshake(user, pwd);
+            if (status == ER_OK) {
+                ++done;
+            }
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Handshake %u failed", done));
+            goto TestFail;
+        }
+        printf("handshakes:      %u in %u ms\n", done, static_cast<uint32_t>(elapsed));
+        printf("handshakes/sec:  %.1f\n", elapsed ? (done * 1000.0) / elapsed : 0.0);
+    }
+
     printf("Passed\n");
     return 0;
 
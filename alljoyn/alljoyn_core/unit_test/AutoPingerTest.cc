@@ -16,7 +16,9 @@
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/AutoPinger.h>
 #include <gtest/gtest.h>
+#include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
+#include <qcc/time.h>
 
 #include "ajTestCommon.h"
 
@@ -78,6 +80,13 @@ class TestPingListener : public PingListener {
   public:
     TestPingListener() { }
 
+    size_t NumLost() {
+        lostmutex.Lock();
+        size_t num = lost.size();
+        lostmutex.Unlock();
+        return num;
+    }
+
     void WaitUntilFound(const qcc::String& destination) {
 
         int retries = 0;
@@ -199,3 +208,26 @@ TEST_F(AutoPingerTest, Multibus) {
 
 }
 
+TEST_F(AutoPingerTest, RateLimited) {
+
+    TestPingListener tpl;
+    autoPinger.SetRateLimit(100, 8);
+    autoPinger.AddPingGroup("limitedgroup", tpl, 1);
+
+    /* None of these exist so every destination is reported lost once it has been pinged */
+    const size_t N = 300;
+    uint64_t start = qcc::GetTimestamp64();
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ(ER_OK, autoPinger.AddDestination("limitedgroup", qcc::String(":absent.") + qcc::U32ToString(i)));
+    }
+    for (int retries = 0; retries < 2000 && tpl.NumLost() < N; ++retries) {
+        qcc::Sleep(10);
+    }
+    uint64_t elapsed = qcc::GetTimestamp64() - start;
+    EXPECT_EQ(N, tpl.NumLost());
+
+    /* At 100 pings per second the first round cannot complete in much less than three seconds */
+    EXPECT_LE(static_cast<uint64_t>(2500), elapsed);
+
+    autoPinger.RemovePingGroup("limitedgroup");
+}
@@ -535,6 +535,16 @@ TEST_F(BusAttachmentTest, GetDBusProxyObj) {
     EXPECT_EQ(DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER, requestNameResponce);
 }
 
+TEST_F(BusAttachmentTest, GetUniqueName_stable_c_str) {
+    /* Callers, including the C binding, keep the c_str() of the returned names */
+    const char* uniqueName = bus.GetUniqueName().c_str();
+    const char* connectSpec = bus.GetConnectSpec().c_str();
+    MsgArg arg("s", bus.GetUniqueName().c_str());
+    EXPECT_EQ(bus.GetUniqueName(), uniqueName);
+    EXPECT_EQ(bus.GetConnectSpec(), connectSpec);
+    EXPECT_STREQ(uniqueName, arg.v_string.str);
+}
+
 TEST_F(BusAttachmentTest, Ping_self) {
     ASSERT_EQ(ER_OK, bus.Ping(bus.GetUniqueName().c_str(), 1000));
 }
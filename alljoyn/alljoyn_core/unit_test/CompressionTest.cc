@@ -21,6 +21,8 @@
  ******************************************************************************/
 
 #include <qcc/platform.h>
+
+#include <limits>
 //
 //#include <qcc/Debug.h>
 #include <qcc/Pipe.h>
@@ -35,6 +37,8 @@
 
 /* Private files included for unit testing */
 #include <RemoteEndpoint.h>
+#include <CompressionRules.h>
+#include <BusInternal.h>
 
 #include <gtest/gtest.h>
 
@@ -70,6 +74,14 @@ class MyMessage : public _Message {
         return SignalMsg("", destination, sessionId, objPath, iface, signalName, NULL, 0, ALLJOYN_FLAG_COMPRESSED, ttl);
     }
 
+    QStatus SessionlessSignal(const char* objPath,
+                              const char* iface,
+                              const char* signalName,
+                              uint16_t ttl)
+    {
+        return SignalMsg("", "", 0, objPath, iface, signalName, NULL, 0, ALLJOYN_FLAG_COMPRESSED | ALLJOYN_FLAG_SESSIONLESS, ttl);
+    }
+
     QStatus Read(RemoteEndpoint& ep, const qcc::String& endpointName, bool pedantic = true)
     {
         return _Message::Read(ep, pedantic);
@@ -196,3 +208,157 @@ TEST(CompressionTest, Compression) {
         ASSERT_EQ(sig, msg2.GetMemberName()) << "FAILD 6." << 1;
     }
 }
+
+static void SetHeader(HeaderFields& hdrFields, const char* path, const char* member)
+{
+    hdrFields.field[ALLJOYN_HDR_FIELD_PATH].Set("o", path);
+    hdrFields.field[ALLJOYN_HDR_FIELD_INTERFACE].Set("s", "foo.bar");
+    hdrFields.field[ALLJOYN_HDR_FIELD_MEMBER].Set("s", member);
+    hdrFields.field[ALLJOYN_HDR_FIELD_DESTINATION].Set("s", ":1.99");
+}
+
+TEST(CompressionTest, RulesLRU) {
+    _CompressionRules rules(2);
+    HeaderFields hdr1;
+    HeaderFields hdr2;
+    HeaderFields hdr3;
+    SetHeader(hdr1, "/foo/bar", "one");
+    SetHeader(hdr2, "/foo/bar", "two");
+    SetHeader(hdr3, "/foo/gorn", "one");
+
+    uint32_t tok1 = rules.GetToken(hdr1);
+    uint32_t tok2 = rules.GetToken(hdr2);
+    ASSERT_NE(0U, tok1);
+    ASSERT_NE(tok1, tok2);
+    /* Same header fields must map to the same token */
+    ASSERT_EQ(tok1, rules.GetToken(hdr1));
+
+    /* Adding a third rule evicts the least recently used rule (hdr2) */
+    uint32_t tok3 = rules.GetToken(hdr3);
+    ASSERT_NE(tok1, tok3);
+    ASSERT_EQ(2U, rules.GetNumRules());
+    ASSERT_TRUE(rules.HasExpansion(tok1));
+    ASSERT_FALSE(rules.HasExpansion(tok2));
+    ASSERT_TRUE(rules.HasExpansion(tok3));
+
+    /* Expansion fills in the compressible fields */
+    HeaderFields expanded;
+    ASSERT_TRUE(rules.Expand(tok3, expanded));
+    ASSERT_STREQ("/foo/gorn", expanded.field[ALLJOYN_HDR_FIELD_PATH].v_objPath.str);
+    ASSERT_STREQ("one", expanded.field[ALLJOYN_HDR_FIELD_MEMBER].v_string.str);
+
+    /* Expansion of an evicted token fails */
+    HeaderFields missing;
+    ASSERT_FALSE(rules.Expand(tok2, missing));
+    ASSERT_EQ(ALLJOYN_INVALID, missing.field[ALLJOYN_HDR_FIELD_PATH].typeId);
+
+    /* Expansions received from a remote peer are bounded too */
+    rules.AddExpansion(hdr2, 0x1234);
+    ASSERT_TRUE(rules.HasExpansion(0x1234));
+    ASSERT_FALSE(rules.HasExpansion(tok1));
+    ASSERT_EQ(2U, rules.GetNumRules());
+
+    _CompressionRules::Statistics stats;
+    rules.GetStatistics(stats);
+    ASSERT_EQ(4U, stats.compressed);
+    ASSERT_EQ(1U, stats.hits);
+    ASSERT_EQ(1U, stats.expanded);
+    ASSERT_EQ(1U, stats.misses);
+    ASSERT_EQ(2U, stats.evictions);
+    ASSERT_LT(0U, stats.bytesSaved);
+}
+
+TEST(CompressionTest, RulesPinned) {
+    _CompressionRules rules(2);
+    HeaderFields hdr1;
+    HeaderFields hdr2;
+    HeaderFields hdr3;
+    HeaderFields hdr4;
+    SetHeader(hdr1, "/foo/bar", "one");
+    SetHeader(hdr2, "/foo/bar", "two");
+    SetHeader(hdr3, "/foo/gorn", "one");
+    SetHeader(hdr4, "/foo/gorn", "two");
+    const uint32_t never = (numeric_limits<uint32_t>::max)();
+
+    /* A queued sessionless message keeps its rule however many other rules are added */
+    uint32_t tok1 = rules.GetToken(hdr1);
+    rules.Pin(":1.99:foo.bar:one:/foo/bar", tok1, never);
+    uint32_t tok2 = rules.GetToken(hdr2);
+    uint32_t tok3 = rules.GetToken(hdr3);
+    uint32_t tok4 = rules.GetToken(hdr4);
+    ASSERT_TRUE(rules.HasExpansion(tok1));
+    ASSERT_FALSE(rules.HasExpansion(tok2));
+    ASSERT_FALSE(rules.HasExpansion(tok3));
+    ASSERT_TRUE(rules.HasExpansion(tok4));
+    ASSERT_EQ(2U, rules.GetNumRules());
+
+    /* Only the pinned rules can take the table past its bound */
+    rules.Pin(":1.99:foo.bar:two:/foo/gorn", tok4, never);
+    tok2 = rules.GetToken(hdr2);
+    ASSERT_EQ(3U, rules.GetNumRules());
+    ASSERT_TRUE(rules.HasExpansion(tok1));
+    ASSERT_TRUE(rules.HasExpansion(tok4));
+    ASSERT_EQ(2U, rules.GetNumPinned());
+
+    /* A newer message with the same key releases the rule of the one it replaces */
+    rules.Pin(":1.99:foo.bar:one:/foo/bar", tok2, never);
+    ASSERT_EQ(2U, rules.GetNumPinned());
+    tok3 = rules.GetToken(hdr3);
+    ASSERT_FALSE(rules.HasExpansion(tok1));
+    ASSERT_TRUE(rules.HasExpansion(tok2));
+    ASSERT_TRUE(rules.HasExpansion(tok3));
+    ASSERT_TRUE(rules.HasExpansion(tok4));
+
+    /* Cancelled messages release their rule */
+    rules.Unpin(":1.99:foo.bar:two:/foo/gorn");
+    rules.Unpin(":1.99:foo.bar:one:/foo/bar");
+    ASSERT_EQ(0U, rules.GetNumPinned());
+    tok1 = rules.GetToken(hdr1);
+    ASSERT_EQ(2U, rules.GetNumRules());
+    ASSERT_TRUE(rules.HasExpansion(tok1));
+    ASSERT_TRUE(rules.HasExpansion(tok3));
+
+    /* Expired messages release their rule when room is needed */
+    rules.Pin(":1.99:foo.bar:one:/foo/bar", tok1, 0);
+    rules.Pin(":1.99:foo.bar:one:/foo/gorn", tok3, 0);
+    qcc::Sleep(2);
+    tok2 = rules.GetToken(hdr2);
+    ASSERT_EQ(0U, rules.GetNumPinned());
+    ASSERT_EQ(2U, rules.GetNumRules());
+    ASSERT_TRUE(rules.HasExpansion(tok2));
+}
+
+TEST(CompressionTest, SessionlessRulePinned) {
+    BusAttachment bus("compression-sessionless");
+    size_t maxRules = 1;
+    CompressionRules rules(maxRules);
+    bus.GetInternal().OverrideCompressionRules(rules);
+    MyMessage msg(bus);
+
+    bus.Start();
+
+    QStatus status = msg.SessionlessSignal("/foo/bar", "foo.bar", "one", 0);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t tok1 = msg.GetCompressionToken();
+
+    /* Other compressed traffic does not evict the rule of the sessionless message */
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "two", 0);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t tok2 = msg.GetCompressionToken();
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "three", 0);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_TRUE(rules->HasExpansion(tok1));
+    ASSERT_FALSE(rules->HasExpansion(tok2));
+    ASSERT_EQ(1U, rules->GetNumPinned());
+
+    /* Until a newer sessionless message replaces it */
+    status = msg.SessionlessSignal("/foo/bar", "foo.bar", "one", 60);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t tok3 = msg.GetCompressionToken();
+    ASSERT_NE(tok1, tok3);
+    ASSERT_EQ(1U, rules->GetNumPinned());
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "two", 0);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_FALSE(rules->HasExpansion(tok1));
+    ASSERT_TRUE(rules->HasExpansion(tok3));
+}
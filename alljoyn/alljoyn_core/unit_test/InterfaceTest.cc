@@ -19,6 +19,9 @@
 #include <gtest/gtest.h>
 
 #include <qcc/Thread.h>
+#include <qcc/StringUtil.h>
+
+#include "SignatureUtils.h"
 
 const char* SERVICE_OBJECT_PATH = "/org/alljoyn/test_services";
 
@@ -535,3 +538,59 @@ TEST_F(InterfaceTest, ArgNamesTest) {
     ASSERT_TRUE(member != NULL);
     EXPECT_STREQ(",arg1", member->argNames.c_str());
 }
+
+TEST_F(InterfaceTest, LookupAfterActivation) {
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = g_msgBus->CreateInterface("org.alljoyn.lookupTest", testIntf);
+    ASSERT_EQ(ER_OK, status);
+    ASSERT_TRUE(testIntf != NULL);
+
+    const size_t count = 100;
+    for (size_t i = 0; i < count; ++i) {
+        qcc::String name = "Member" + qcc::U32ToString(static_cast<uint32_t>(i));
+        EXPECT_EQ(ER_OK, testIntf->AddMethod(name.c_str(), "s", "s", "in,out"));
+        name = "Prop" + qcc::U32ToString(static_cast<uint32_t>(i));
+        EXPECT_EQ(ER_OK, testIntf->AddProperty(name.c_str(), "u", PROP_ACCESS_RW));
+    }
+    EXPECT_EQ(ER_OK, testIntf->AddSignal("Fixed", "y(ut)b", NULL));
+    EXPECT_EQ(ER_OK, testIntf->AddProperty("Dict", "a{sv}", PROP_ACCESS_READ));
+
+    SignatureInfo args;
+    SignatureInfo returnArgs;
+    EXPECT_FALSE(testIntf->GetMemberSignatureInfo("Fixed", args, returnArgs));
+    testIntf->Activate();
+
+    for (size_t i = 0; i < count; ++i) {
+        qcc::String name = "Member" + qcc::U32ToString(static_cast<uint32_t>(i));
+        const InterfaceDescription::Member* member = testIntf->GetMember(name.c_str());
+        ASSERT_TRUE(member != NULL);
+        EXPECT_STREQ(name.c_str(), member->name.c_str());
+        name = "Prop" + qcc::U32ToString(static_cast<uint32_t>(i));
+        const InterfaceDescription::Property* prop = testIntf->GetProperty(name.c_str());
+        ASSERT_TRUE(prop != NULL);
+        EXPECT_STREQ(name.c_str(), prop->name.c_str());
+    }
+    EXPECT_TRUE(testIntf->GetMember("Member100") == NULL);
+    EXPECT_TRUE(testIntf->GetMember("") == NULL);
+    EXPECT_TRUE(testIntf->GetProperty("Prop100") == NULL);
+
+    /* y, padding to 8 for the struct, u, padding to 8, t, b */
+    ASSERT_TRUE(testIntf->GetMemberSignatureInfo("Fixed", args, returnArgs));
+    EXPECT_EQ(3U, args.numArgs);
+    EXPECT_EQ(8U, args.alignment);
+    EXPECT_EQ(28U, args.fixedSize);
+    EXPECT_EQ(0U, returnArgs.numArgs);
+
+    ASSERT_TRUE(testIntf->GetMemberSignatureInfo("Member0", args, returnArgs));
+    EXPECT_EQ(1U, args.numArgs);
+    EXPECT_EQ(0U, args.fixedSize);
+
+    SignatureInfo info;
+    ASSERT_TRUE(testIntf->GetPropertySignatureInfo("Prop0", info));
+    EXPECT_EQ(4U, info.fixedSize);
+    ASSERT_TRUE(testIntf->GetPropertySignatureInfo("Dict", info));
+    EXPECT_EQ(1U, info.numArgs);
+    EXPECT_EQ(4U, info.alignment);
+    EXPECT_EQ(0U, info.fixedSize);
+    EXPECT_FALSE(testIntf->GetPropertySignatureInfo("Member0", info));
+}
@@ -25,12 +25,18 @@
 
 #include <qcc/platform.h>
 
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/FileStream.h>
 #include <qcc/KeyBlob.h>
 #include <qcc/Pipe.h>
 #include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
 #include <qcc/Util.h>
 #include <qcc/GUID.h>
 #include <qcc/time.h>
@@ -48,6 +54,35 @@ using namespace ajn;
 
 static const char testData[] = "This is the message that we are going to encrypt and then decrypt and verify";
 
+/* Size of a key record header in the key store and journal files */
+static const size_t RecordHeaderSize = 43;
+
+static qcc::String ReadKeyStoreFile(const qcc::String& fileName)
+{
+    qcc::String contents;
+    FileSource source(fileName);
+    uint8_t buf[1024];
+    size_t pulled;
+    while (source.PullBytes(buf, sizeof(buf), pulled) == ER_OK) {
+        contents.append((const char*)buf, pulled);
+    }
+    return contents;
+}
+
+static void WriteKeyStoreFile(const qcc::String& fileName, const qcc::String& contents)
+{
+    FileSink sink(fileName, FileSink::PRIVATE);
+    size_t pushed;
+    sink.PushBytes(contents.data(), contents.size(), pushed);
+}
+
+static void DeleteKeyStoreFiles(const qcc::String& fileName)
+{
+    DeleteFile(fileName);
+    DeleteFile(fileName + ".journal");
+    DeleteFile(fileName + ".lock");
+}
+
 
 
 TEST(KeyStoreTest, basic_encryption_decryption) {
@@ -233,3 +268,258 @@ TEST(KeyStoreTest, keystore_store_load_merge) {
     DeleteFile("keystore_test");
 }
 
+
+TEST(KeyStoreTest, keystore_journal) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+    qcc::String fileName = GetHomeDir() + "/keystore_journal_test";
+    qcc::String journalFileName = fileName + ".journal";
+
+    /*
+     * The first store writes the whole key store, later stores only append the changes
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init("keystore_journal_test", false);
+        keyStore.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid1, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid2, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        status = keyStore.DelKey(guid1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid1";
+        ASSERT_TRUE(keyStore.IsJournalValid());
+        ASSERT_FALSE(keyStore.IsCompactionDue());
+    }
+
+    /*
+     * Loading replays the journal
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init("keystore_journal_test", false);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid1 was not deleted";
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+    }
+
+    /*
+     * A damaged journal is applied up to the damage and the next store rewrites the key store
+     */
+    {
+        FileSink journal(journalFileName, FileSink::PRIVATE, true);
+        size_t pushed;
+        journal.PushBytes(testData, 40, pushed);
+    }
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init("keystore_journal_test", false);
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+        ASSERT_FALSE(keyStore.IsJournalValid());
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid3, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+        ASSERT_TRUE(keyStore.IsJournalValid());
+    }
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init("keystore_journal_test", false);
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+
+        status = keyStore.GetKey(guid3, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+    }
+    DeleteKeyStoreFiles(fileName);
+}
+
+TEST(KeyStoreTest, keystore_lazy_load) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+    qcc::String fileName = GetHomeDir() + "/keystore_lazy_test";
+
+    {
+        KeyStore keyStore("keystore_lazy_test");
+        keyStore.Init("keystore_lazy_test", false);
+        keyStore.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid1, key);
+        keyStore.AddKey(guid2, key);
+        keyStore.AddKey(guid3, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+    }
+
+    /*
+     * The records are appended in GUID order, damage the encrypted key of the last one
+     */
+    qcc::GUID128 damaged = max(guid1, max(guid2, guid3));
+    qcc::String journal = ReadKeyStoreFile(fileName + ".journal");
+    ASSERT_LT(RecordHeaderSize, journal.size());
+    qcc::String corrupted(journal.data(), journal.size() - 1);
+    corrupted.append((char)(journal[journal.size() - 1] ^ 0x01));
+    WriteKeyStoreFile(fileName + ".journal", corrupted);
+
+    /*
+     * Loading the key store does not decrypt the keys, only the damaged key is lost
+     */
+    {
+        KeyStore keyStore("keystore_lazy_test");
+        status = keyStore.Init("keystore_lazy_test", false);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load keystore";
+        ASSERT_TRUE(keyStore.HasKey(damaged));
+
+        status = keyStore.GetKey(damaged, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " Damaged key was loaded";
+        ASSERT_FALSE(keyStore.HasKey(damaged));
+
+        if (damaged != guid1) {
+            status = keyStore.GetKey(guid1, key);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid1";
+        }
+        if (damaged != guid2) {
+            status = keyStore.GetKey(guid2, key);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+        }
+        if (damaged != guid3) {
+            status = keyStore.GetKey(guid3, key);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+        }
+    }
+    DeleteKeyStoreFiles(fileName);
+}
+
+TEST(KeyStoreTest, keystore_shared_journal) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+    qcc::String fileName = GetHomeDir() + "/keystore_shared_test";
+
+    {
+        KeyStore keyStoreA("keystore_shared_test");
+        keyStoreA.Init("keystore_shared_test", true);
+        keyStoreA.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStoreA.AddKey(guid1, key);
+        keyStoreA.AddKey(guid2, key);
+        keyStoreA.AddKey(guid3, key);
+        status = keyStoreA.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        KeyStore keyStoreB("keystore_shared_test");
+        keyStoreB.Init("keystore_shared_test", true);
+        ASSERT_TRUE(keyStoreB.HasKey(guid1));
+
+        /*
+         * Both key stores append to the journal without reloading first, the second one picks up
+         * the record appended by the first one.
+         */
+        status = keyStoreA.DelKey(guid1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid1";
+        status = keyStoreB.DelKey(guid2);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid2";
+        ASSERT_FALSE(keyStoreB.HasKey(guid1));
+    }
+
+    /*
+     * Every record in the journal must have been encrypted with a different nonce
+     */
+    qcc::String journal = ReadKeyStoreFile(fileName + ".journal");
+    std::set<std::pair<uint32_t, uint32_t> > nonces;
+    size_t records = 0;
+    size_t offset = sizeof(uint16_t) + sizeof(uint32_t);
+    while (offset + RecordHeaderSize <= journal.size()) {
+        uint32_t len;
+        uint32_t rev;
+        uint32_t seq;
+        memcpy(&len, journal.data() + offset, sizeof(len));
+        memcpy(&rev, journal.data() + offset + sizeof(len), sizeof(rev));
+        memcpy(&seq, journal.data() + offset + sizeof(len) + sizeof(rev), sizeof(seq));
+        nonces.insert(std::make_pair(rev, seq));
+        ++records;
+        offset += RecordHeaderSize + len;
+    }
+    ASSERT_EQ(journal.size(), offset);
+    /* The three keys added and the two deletions */
+    ASSERT_EQ((size_t)5, records);
+    ASSERT_EQ(records, nonces.size());
+
+    {
+        KeyStore keyStore("keystore_shared_test");
+        keyStore.Init("keystore_shared_test", true);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid1 was not deleted";
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid2 was not deleted";
+
+        status = keyStore.GetKey(guid3, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+    }
+    DeleteKeyStoreFiles(fileName);
+}
+
+TEST(KeyStoreTest, keystore_background_compaction) {
+    QStatus status = ER_OK;
+    KeyBlob key;
+    qcc::String fileName = GetHomeDir() + "/keystore_compaction_test";
+    std::vector<qcc::GUID128> guids(200);
+
+    {
+        KeyStore keyStore("keystore_compaction_test");
+        keyStore.Init("keystore_compaction_test", false);
+        keyStore.Clear();
+
+        for (size_t i = 0; i < guids.size(); ++i) {
+            key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+            keyStore.AddKey(guids[i], key);
+            status = keyStore.Store();
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+        }
+
+        /*
+         * The journal has outgrown the key store, it is compacted without another store
+         */
+        for (int i = 0; (i < 500) && keyStore.IsCompactionDue(); ++i) {
+            qcc::Sleep(10);
+        }
+        ASSERT_FALSE(keyStore.IsCompactionDue());
+    }
+    ASSERT_GT((size_t)16 * 1024, ReadKeyStoreFile(fileName + ".journal").size());
+
+    {
+        KeyStore keyStore("keystore_compaction_test");
+        keyStore.Init("keystore_compaction_test", false);
+        for (size_t i = 0; i < guids.size(); ++i) {
+            status = keyStore.GetKey(guids[i], key);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load key " << i;
+        }
+    }
+    DeleteKeyStoreFiles(fileName);
+}
@@ -1139,6 +1139,55 @@ TEST_F(PropChangedTest, MultiSession)
     pb1.UnregisterPropertiesChangedListener(tp.intfParams[0].name.c_str(), l);
 }
 
+/*
+ * Set a coalescing window on the service object and emit each of three
+ * properties twice.  Verify that a single signal with the latest values is
+ * received once the window has passed, that FlushPropChanged sends queued
+ * changes straight away and that changes are sent directly again once the
+ * window is cleared.
+ */
+TEST_F(PropChangedTest, Coalesced)
+{
+    TestParameters tp(false, P1to3);
+    tp.AddInterfaceParameters(InterfaceParameters(P1to3));
+    tp.AddListener(P1to3);
+    SetupPropChanged(tp, tp);
+
+    BusObject::PropChangedCounters counters;
+    EXPECT_EQ(ER_BUS_UNKNOWN_INTERFACE, obj->SetPropChangedWindow(INTERFACE_NAME "X", 0, 100));
+    ASSERT_EQ(ER_OK, obj->SetPropChangedWindow(INTERFACE_NAME, 0, 200));
+
+    obj->EmitSignals(tp);
+    obj->EmitSignals(tp);
+    EXPECT_EQ(ER_OK, proxy->TimedWait(TIMEOUT));
+    EXPECT_EQ(ER_TIMEOUT, proxy->TimedWait(TIMEOUT_EXPECTED));
+    proxy->ValidateSignals(tp);
+    ASSERT_EQ(ER_OK, obj->GetPropChangedCounters(INTERFACE_NAME, 0, counters));
+    EXPECT_EQ(6U, counters.updates);
+    EXPECT_EQ(1U, counters.signals);
+    EXPECT_EQ(3U, counters.superseded);
+
+    /* Queued changes go out on demand rather than at the end of a long window */
+    proxy->Clear();
+    ASSERT_EQ(ER_OK, obj->SetPropChangedWindow(INTERFACE_NAME, 0, 60000));
+    obj->EmitSignals(tp);
+    EXPECT_EQ(ER_TIMEOUT, proxy->TimedWait(TIMEOUT_EXPECTED));
+    EXPECT_EQ(ER_OK, obj->FlushPropChanged(INTERFACE_NAME, 0));
+    EXPECT_EQ(ER_OK, proxy->TimedWait(TIMEOUT));
+    proxy->ValidateSignals(tp);
+
+    /* Without a window each change is sent as it is made */
+    proxy->Clear();
+    ASSERT_EQ(ER_OK, obj->SetPropChangedWindow(INTERFACE_NAME, 0, 0));
+    obj->EmitSignals(tp);
+    for (int i = 0; i < P1to3.Size(); i++) {
+        EXPECT_EQ(ER_OK, proxy->TimedWait(TIMEOUT));
+    }
+    ASSERT_EQ(ER_OK, obj->GetPropChangedCounters(INTERFACE_NAME, 0, counters));
+    EXPECT_EQ(9U, counters.updates);
+    EXPECT_EQ(2U, counters.signals);
+}
+
 /*
  * The following are the tests that check the return codes of EmitPropChanged.
  */
@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_LINUX)
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+
+#include "ShmStream.h"
+
+using namespace ajn;
+using namespace qcc;
+
+class ShmStreamTest : public testing::Test {
+  public:
+    ShmStream* router;
+    ShmStream* leaf;
+
+    ShmStreamTest() : router(NULL), leaf(NULL) { }
+
+    virtual void SetUp() {
+        SocketFd fds[2];
+        ASSERT_EQ(ER_OK, SocketPair(fds));
+        /* Transports hand the stream non-blocking sockets */
+        ASSERT_EQ(ER_OK, SetBlocking(fds[0], false));
+        ASSERT_EQ(ER_OK, SetBlocking(fds[1], false));
+        router = new ShmStream(fds[0]);
+        leaf = new ShmStream(fds[1]);
+        ASSERT_EQ(ER_OK, router->Offer(4096));
+        ASSERT_EQ(ER_OK, leaf->Accept(1000));
+        ASSERT_TRUE(router->IsShared());
+        ASSERT_TRUE(leaf->IsShared());
+    }
+
+    virtual void TearDown() {
+        SocketFd routerFd = router->GetSocketFd();
+        SocketFd leafFd = leaf->GetSocketFd();
+        delete router;
+        delete leaf;
+        qcc::Close(routerFd);
+        qcc::Close(leafFd);
+    }
+};
+
+TEST_F(ShmStreamTest, round_trip_with_wrap)
+{
+    std::vector<uint8_t> out(3000);
+    std::vector<uint8_t> in(3000);
+    for (uint32_t pass = 0; pass < 20; ++pass) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<uint8_t>(i + pass);
+        }
+        size_t sent = 0;
+        ASSERT_EQ(ER_OK, leaf->PushBytes(&out[0], out.size(), sent));
+        ASSERT_EQ(out.size(), sent);
+        size_t recvd = 0;
+        ASSERT_EQ(ER_OK, router->PullBytes(&in[0], in.size(), recvd, 0));
+        ASSERT_EQ(in.size(), recvd);
+        ASSERT_TRUE(in == out);
+
+        ASSERT_EQ(ER_OK, router->PushBytes(&out[0], out.size(), sent));
+        ASSERT_EQ(out.size(), sent);
+        ASSERT_EQ(ER_OK, leaf->PullBytes(&in[0], in.size(), recvd, 0));
+        ASSERT_EQ(in.size(), recvd);
+        ASSERT_TRUE(in == out);
+    }
+}
+
+TEST_F(ShmStreamTest, doorbell_signals_source_event)
+{
+    uint8_t buf[16] = { 0 };
+    size_t actual;
+    /* An empty ring times out and leaves the consumer waiting for the doorbell */
+    EXPECT_EQ(ER_TIMEOUT, leaf->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(ER_TIMEOUT, Event::Wait(leaf->GetSourceEvent(), 0));
+
+    EXPECT_EQ(ER_OK, router->PushBytes(buf, sizeof(buf), actual));
+    EXPECT_EQ(ER_OK, Event::Wait(leaf->GetSourceEvent(), 1000));
+    EXPECT_EQ(ER_OK, leaf->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(sizeof(buf), actual);
+}
+
+TEST_F(ShmStreamTest, full_ring_signals_sink_event)
+{
+    std::vector<uint8_t> buf(4096);
+    size_t actual;
+    router->SetSendTimeout(0);
+    EXPECT_EQ(ER_OK, Event::Wait(router->GetSinkEvent(), 0));
+    EXPECT_EQ(ER_OK, router->PushBytes(&buf[0], buf.size(), actual));
+    EXPECT_EQ(buf.size(), actual);
+    EXPECT_EQ(ER_TIMEOUT, router->PushBytes(&buf[0], 1, actual));
+    EXPECT_EQ(ER_TIMEOUT, Event::Wait(router->GetSinkEvent(), 0));
+
+    EXPECT_EQ(ER_OK, leaf->PullBytes(&buf[0], 100, actual, 0));
+    EXPECT_EQ(ER_OK, Event::Wait(router->GetSinkEvent(), 1000));
+    EXPECT_EQ(ER_OK, router->PushBytes(&buf[0], buf.size(), actual));
+    EXPECT_EQ(100U, actual);
+}
+
+TEST_F(ShmStreamTest, peer_close_is_end_of_file)
+{
+    uint8_t buf[16];
+    size_t actual;
+    leaf->Close();
+    EXPECT_EQ(ER_OK, Event::Wait(router->GetSourceEvent(), 1000));
+    EXPECT_EQ(ER_SOCK_OTHER_END_CLOSED, router->PullBytes(buf, sizeof(buf), actual, 0));
+}
+
+TEST_F(ShmStreamTest, no_handle_passing)
+{
+    uint8_t buf[4] = { 0 };
+    size_t sent;
+    SocketFd fd = router->GetSocketFd();
+    EXPECT_EQ(ER_NOT_IMPLEMENTED, leaf->PushBytesAndFds(buf, sizeof(buf), sent, &fd, 1));
+}
+
+#endif
@@ -0,0 +1,104 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <gtest/gtest.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+#include <qcc/atomic.h>
+
+#include "SnapshotPtr.h"
+
+using namespace ajn;
+using namespace qcc;
+
+/* A snapshot that records if it is used after it has been deleted */
+struct Version {
+    static volatile int32_t live;
+    uint32_t value;
+    uint32_t check;
+    Version(uint32_t value) : value(value), check(~value) { IncrementAndFetch(&live); }
+    ~Version() { check = value; DecrementAndFetch(&live); }
+};
+
+volatile int32_t Version::live = 0;
+
+class SnapshotReader : public Thread {
+  public:
+    SnapshotReader(SnapshotPtr<Version>& ptr) : Thread("SnapshotReader"), ptr(ptr), errors(0), reads(0) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint32_t last = 0;
+        while (!IsStopping()) {
+            SnapshotPtr<Version>::Reader version(ptr);
+            /* Versions are published in order and stay intact while they are being read */
+            if ((version->check != ~version->value) || (version->value < last)) {
+                IncrementAndFetch(&errors);
+            }
+            last = version->value;
+            IncrementAndFetch(&reads);
+        }
+        return 0;
+    }
+
+    SnapshotPtr<Version>& ptr;
+    volatile int32_t errors;
+    volatile int32_t reads;
+};
+
+static bool AllReading(SnapshotReader** readers, size_t numReaders)
+{
+    for (size_t i = 0; i < numReaders; ++i) {
+        if (readers[i]->reads == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(SnapshotPtrTest, publish_while_reading)
+{
+    {
+        SnapshotPtr<Version> ptr(new Version(0));
+        SnapshotReader* readers[4];
+        for (size_t i = 0; i < ArraySize(readers); ++i) {
+            readers[i] = new SnapshotReader(ptr);
+            ASSERT_EQ(ER_OK, readers[i]->Start());
+        }
+        uint32_t v = 0;
+        while (v < 2000) {
+            ptr.Publish(new Version(++v));
+            /* The previous version has been deleted */
+            EXPECT_EQ(1, Version::live);
+        }
+        /* Keep publishing until every reader has been scheduled and has read a version */
+        while (!AllReading(readers, ArraySize(readers))) {
+            qcc::Sleep(1);
+            ptr.Publish(new Version(++v));
+            EXPECT_EQ(1, Version::live);
+        }
+        for (size_t i = 0; i < ArraySize(readers); ++i) {
+            readers[i]->Stop();
+            readers[i]->Join();
+            EXPECT_EQ(0, readers[i]->errors);
+            EXPECT_LT(0, readers[i]->reads);
+            delete readers[i];
+        }
+        EXPECT_EQ(v, ptr.Get().value);
+    }
+    EXPECT_EQ(0, Version::live);
+}
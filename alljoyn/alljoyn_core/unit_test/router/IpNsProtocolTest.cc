@@ -0,0 +1,220 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include "ns/IpNameServiceImpl.h"
+#include "ns/IpNsProtocol.h"
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace ajn;
+
+/* Decode the name at offset in packet, which is size octets long */
+static size_t DecodeName(const uint8_t* packet, size_t size, uint32_t offset, String& name)
+{
+    MDNSDomainName domainName;
+    size_t ret = domainName.Deserialize(packet + offset, size - offset, offset);
+    name = domainName.GetName();
+    return ret;
+}
+
+TEST(IpNsProtocolTest, name_without_pointers)
+{
+    static const uint8_t packet[] = { 3, 'f', 'o', 'o', 3, 'b', 'a', 'r', 0 };
+    String name;
+    EXPECT_EQ(sizeof(packet), DecodeName(packet, sizeof(packet), 0, name));
+    EXPECT_STREQ("foo.bar.", name.c_str());
+
+    static const uint8_t root[] = { 0 };
+    EXPECT_EQ(1U, DecodeName(root, sizeof(root), 0, name));
+    EXPECT_STREQ("", name.c_str());
+}
+
+TEST(IpNsProtocolTest, valid_pointers)
+{
+    static const uint8_t packet[] = {
+        3, 'f', 'o', 'o', 3, 'b', 'a', 'r', 0,     /*  0: foo.bar. */
+        3, 'b', 'a', 'z', 0xc0, 4,                 /*  9: baz + pointer to bar. */
+        3, 'q', 'u', 'x', 0xc0, 9,                 /* 15: qux + pointer to a name that ends in a pointer */
+        0xc0, 0                                    /* 21: nothing but a pointer */
+    };
+    String name;
+    /* The size is that of the name at offset, up to and including its first pointer */
+    EXPECT_EQ(6U, DecodeName(packet, sizeof(packet), 9, name));
+    EXPECT_STREQ("baz.bar.", name.c_str());
+    EXPECT_EQ(6U, DecodeName(packet, sizeof(packet), 15, name));
+    EXPECT_STREQ("qux.baz.bar.", name.c_str());
+    EXPECT_EQ(2U, DecodeName(packet, sizeof(packet), 21, name));
+    EXPECT_STREQ("foo.bar.", name.c_str());
+}
+
+TEST(IpNsProtocolTest, forward_and_self_pointers)
+{
+    static const uint8_t forward[] = { 0xc0, 2, 3, 'f', 'o', 'o', 0 };
+    String name;
+    EXPECT_EQ(0U, DecodeName(forward, sizeof(forward), 0, name));
+    EXPECT_TRUE(name.empty());
+
+    static const uint8_t self[] = { 3, 'f', 'o', 'o', 0, 0xc0, 5 };
+    EXPECT_EQ(0U, DecodeName(self, sizeof(self), 5, name));
+    EXPECT_TRUE(name.empty());
+
+    /* A pointer past the end of the packet */
+    static const uint8_t outside[] = { 3, 'f', 'o', 'o', 0xff, 0xff };
+    EXPECT_EQ(0U, DecodeName(outside, sizeof(outside), 0, name));
+    EXPECT_TRUE(name.empty());
+}
+
+TEST(IpNsProtocolTest, pointer_loops)
+{
+    /* a -> b -> a: the second pointer points forwards */
+    static const uint8_t twoNames[] = { 1, 'a', 0xc0, 4, 1, 'b', 0xc0, 0 };
+    String name;
+    EXPECT_EQ(0U, DecodeName(twoNames, sizeof(twoNames), 4, name));
+    EXPECT_TRUE(name.empty());
+    EXPECT_EQ(0U, DecodeName(twoNames, sizeof(twoNames), 0, name));
+
+    /* A name that points back to its own start would repeat forever */
+    static const uint8_t selfLoop[] = { 3, 'f', 'o', 'o', 0xc0, 0 };
+    EXPECT_EQ(0U, DecodeName(selfLoop, sizeof(selfLoop), 0, name));
+    EXPECT_TRUE(name.empty());
+}
+
+TEST(IpNsProtocolTest, truncated_labels)
+{
+    String name;
+    static const uint8_t shortLabel[] = { 5, 'a', 'b' };
+    EXPECT_EQ(0U, DecodeName(shortLabel, sizeof(shortLabel), 0, name));
+
+    static const uint8_t noTerminator[] = { 3, 'f', 'o', 'o' };
+    EXPECT_EQ(0U, DecodeName(noTerminator, sizeof(noTerminator), 0, name));
+
+    static const uint8_t halfPointer[] = { 3, 'f', 'o', 'o', 0xc0 };
+    EXPECT_EQ(0U, DecodeName(halfPointer, sizeof(halfPointer), 0, name));
+
+    static const uint8_t empty[] = { 0 };
+    EXPECT_EQ(0U, DecodeName(empty, 0, 0, name));
+
+    /* A label reached through a pointer may not run into the pointer */
+    static const uint8_t intoPointer[] = { 2, 'a', 'b', 0xc0, 0 };
+    EXPECT_EQ(0U, DecodeName(intoPointer, sizeof(intoPointer), 3, name));
+    EXPECT_TRUE(name.empty());
+
+    /* The name fits in the packet but not in the size it was given */
+    static const uint8_t packet[] = { 3, 'f', 'o', 'o', 0 };
+    EXPECT_EQ(0U, DecodeName(packet, sizeof(packet) - 1, 0, name));
+}
+
+TEST(IpNsProtocolTest, pointer_chain_filling_message_max)
+{
+    /*
+     * A datagram of NS_MESSAGE_MAX octets made of a root name followed by
+     * names of one label and a pointer to the name before, the last of which
+     * ends at the very end of the datagram.
+     */
+    const size_t max = IpNameServiceImpl::NS_MESSAGE_MAX;
+    uint8_t packet[IpNameServiceImpl::NS_MESSAGE_MAX];
+    const size_t links = (max - 6) / 4;
+    ASSERT_EQ(max, 6 + 4 * links);
+    static const uint8_t root[] = { 4, 'r', 'o', 'o', 't', 0 };
+    memcpy(packet, root, sizeof(root));
+    size_t prev = 0;
+    size_t pos = sizeof(root);
+    String expected("root.");
+    for (size_t i = 0; i < links; ++i) {
+        packet[pos] = 1;
+        packet[pos + 1] = 'a';
+        packet[pos + 2] = 0xc0 | static_cast<uint8_t>(prev >> 8);
+        packet[pos + 3] = static_cast<uint8_t>(prev);
+        prev = pos;
+        pos += 4;
+        expected = "a." + expected;
+    }
+    ASSERT_EQ(max, pos);
+
+    String name;
+    EXPECT_EQ(4U, DecodeName(packet, max, static_cast<uint32_t>(prev), name));
+    EXPECT_EQ(expected, name);
+
+    /* Cut the datagram short by one octet and the last pointer is incomplete */
+    EXPECT_EQ(0U, DecodeName(packet, max - 1, static_cast<uint32_t>(prev), name));
+}
+
+TEST(IpNsProtocolTest, packet_round_trip)
+{
+    const String guid("0123456789abcdef0123456789abcdef");
+    MDNSPacket packet;
+    packet->SetHeader(MDNSHeader(42, MDNSHeader::MDNS_RESPONSE));
+
+    MDNSPtrRData ptrRData;
+    ptrRData.SetPtrDName(guid + "._alljoyn._tcp.local.");
+    packet->AddAnswer(MDNSResourceRecord("_alljoyn._tcp.local.", MDNSResourceRecord::PTR, MDNSResourceRecord::INTERNET, 120, &ptrRData));
+    MDNSSrvRData srvRData(1, 1, 9955, guid + ".local.");
+    packet->AddAnswer(MDNSResourceRecord(guid + "._alljoyn._tcp.local.", MDNSResourceRecord::SRV, MDNSResourceRecord::INTERNET, 120, &srvRData));
+
+    /* Add advertised names until the datagram is as full as the name service lets it get */
+    MDNSAdvertiseRData advRData;
+    advRData.SetTransport(TRANSPORT_TCP);
+    MDNSResourceRecord advRecord("advertise." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &advRData);
+    uint32_t numNames = 0;
+    while (true) {
+        MDNSAdvertiseRData more(advRData);
+        more.SetValue("name", "org.alljoyn.IpNsProtocolTest.n" + U32ToString(numNames));
+        MDNSPacket trial;
+        trial->SetHeader(packet->GetHeader());
+        trial->AddAnswer(MDNSResourceRecord("_alljoyn._tcp.local.", MDNSResourceRecord::PTR, MDNSResourceRecord::INTERNET, 120, &ptrRData));
+        trial->AddAnswer(MDNSResourceRecord(guid + "._alljoyn._tcp.local.", MDNSResourceRecord::SRV, MDNSResourceRecord::INTERNET, 120, &srvRData));
+        trial->AddAdditionalRecord(MDNSResourceRecord("advertise." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &more));
+        if (trial->GetSerializedSize() > IpNameServiceImpl::NS_MESSAGE_MAX) {
+            break;
+        }
+        advRData = more;
+        ++numNames;
+    }
+    ASSERT_LT(0U, numNames);
+    packet->AddAdditionalRecord(MDNSResourceRecord("advertise." + guid + ".local.", MDNSResourceRecord::TXT, MDNSResourceRecord::INTERNET, 120, &advRData));
+
+    uint8_t buffer[IpNameServiceImpl::NS_MESSAGE_MAX];
+    size_t size = packet->GetSerializedSize();
+    ASSERT_GE(sizeof(buffer), size);
+    ASSERT_EQ(size, packet->Serialize(buffer));
+
+    MDNSPacket received;
+    ASSERT_EQ(size, received->Deserialize(buffer, static_cast<uint32_t>(size)));
+    MDNSResourceRecord* record;
+    ASSERT_TRUE(received->GetAnswer("_alljoyn._tcp.local.", MDNSResourceRecord::PTR, &record));
+    EXPECT_EQ(guid + "._alljoyn._tcp.local.", static_cast<MDNSPtrRData*>(record->GetRData())->GetPtrDName());
+    ASSERT_TRUE(received->GetAnswer(guid + "._alljoyn._tcp.local.", MDNSResourceRecord::SRV, &record));
+    EXPECT_EQ(guid + ".local.", static_cast<MDNSSrvRData*>(record->GetRData())->GetTarget());
+    ASSERT_TRUE(received->GetAdditionalRecord("advertise." + guid + ".local.", MDNSResourceRecord::TXT, &record));
+    MDNSAdvertiseRData* received_adv = static_cast<MDNSAdvertiseRData*>(record->GetRData());
+    ASSERT_EQ(numNames, received_adv->GetNumNames());
+    for (uint32_t i = 0; i < numNames; ++i) {
+        EXPECT_EQ("org.alljoyn.IpNsProtocolTest.n" + U32ToString(i), received_adv->GetNameAt(i));
+    }
+
+    /* Every truncation of the datagram is rejected */
+    for (size_t len = 0; len < size; ++len) {
+        EXPECT_EQ(0U, received->Deserialize(buffer, static_cast<uint32_t>(len))) << "length " << len;
+    }
+}
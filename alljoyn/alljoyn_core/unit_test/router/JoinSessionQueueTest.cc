@@ -0,0 +1,195 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+
+#include "JoinSessionQueue.h"
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace ajn;
+
+typedef JoinSessionQueue::Request Request;
+typedef JoinSessionQueue::Stats Stats;
+
+TEST(JoinSessionQueueTest, run_and_finish)
+{
+    JoinSessionQueue queue(16, 4);
+    Request a(":a.1", true);
+    Request b(":b.1", true);
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a));
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&b));
+
+    Stats stats;
+    queue.GetStats(stats);
+    EXPECT_EQ(2U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(0U, stats.counters[Stats::IN_PROGRESS]);
+    EXPECT_EQ(2U, stats.counters[Stats::ADMITTED]);
+
+    qcc::Sleep(20);
+    queue.Started(&a);
+    queue.GetStats(stats);
+    EXPECT_EQ(1U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(1U, stats.counters[Stats::IN_PROGRESS]);
+    EXPECT_LE(10U, stats.counters[Stats::MAX_QUEUE_TIME]);
+
+    /* A request may finish without ever starting, e.g. when the workers exit */
+    EXPECT_TRUE(queue.Finished(&a) == NULL);
+    EXPECT_TRUE(queue.Finished(&b) == NULL);
+    queue.GetStats(stats);
+    EXPECT_EQ(0U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(0U, stats.counters[Stats::IN_PROGRESS]);
+    EXPECT_EQ(0U, stats.counters[Stats::REJECTED]);
+    EXPECT_EQ(0U, stats.counters[Stats::DEFERRED]);
+
+    /* Finishing a request twice does nothing */
+    EXPECT_TRUE(queue.Finished(&a) == NULL);
+    queue.GetStats(stats);
+    EXPECT_EQ(0U, stats.counters[Stats::QUEUED]);
+}
+
+TEST(JoinSessionQueueTest, per_joiner_limit)
+{
+    JoinSessionQueue queue(16, 2);
+    Request a1(":a.1", true);
+    Request a2(":a.1", true);
+    Request a3(":a.1", true);
+    Request a4(":a.1", true);
+    Request b1(":b.1", true);
+
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a1));
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a2));
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&a3));
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&a4));
+    /* Another joiner is not held up */
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&b1));
+
+    Stats stats;
+    queue.GetStats(stats);
+    EXPECT_EQ(5U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(2U, stats.counters[Stats::DEFERRED]);
+
+    /* Parked requests are handed back oldest first as running ones finish */
+    queue.Started(&a1);
+    queue.Started(&a2);
+    EXPECT_EQ(&a3, queue.Finished(&a2));
+    queue.Started(&a3);
+    EXPECT_TRUE(queue.Finished(&b1) == NULL);
+    EXPECT_EQ(&a4, queue.Finished(&a1));
+    queue.Started(&a4);
+
+    /* The joiner is back at its limit */
+    Request a5(":a.1", true);
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&a5));
+    EXPECT_EQ(&a5, queue.Finished(&a3));
+    EXPECT_TRUE(queue.Finished(&a4) == NULL);
+    EXPECT_TRUE(queue.Finished(&a5) == NULL);
+
+    queue.GetStats(stats);
+    EXPECT_EQ(0U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(0U, stats.counters[Stats::IN_PROGRESS]);
+    EXPECT_EQ(6U, stats.counters[Stats::ADMITTED]);
+    EXPECT_EQ(3U, stats.counters[Stats::DEFERRED]);
+}
+
+TEST(JoinSessionQueueTest, joins_and_attaches_counted_separately)
+{
+    /* The attaches caused by a joiner's joins must not be parked behind those joins */
+    JoinSessionQueue queue(16, 1);
+    Request join(":a.1", true);
+    Request attach(":a.1", false);
+    Request attach2(":a.1", false);
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&join));
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&attach));
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&attach2));
+    EXPECT_TRUE(queue.Finished(&join) == NULL);
+    EXPECT_EQ(&attach2, queue.Finished(&attach));
+    EXPECT_TRUE(queue.Finished(&attach2) == NULL);
+}
+
+TEST(JoinSessionQueueTest, rejection)
+{
+    JoinSessionQueue queue(3, 1);
+    Request a1(":a.1", true);
+    Request a2(":a.1", true);
+    Request b1(":b.1", false);
+    Request c1(":c.1", true);
+
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a1));
+    /* Parked requests count against the limit on outstanding requests */
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&a2));
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&b1));
+    EXPECT_EQ(JoinSessionQueue::REJECTED, queue.Add(&c1));
+
+    Stats stats;
+    queue.GetStats(stats);
+    EXPECT_EQ(3U, stats.counters[Stats::ADMITTED]);
+    EXPECT_EQ(1U, stats.counters[Stats::REJECTED]);
+    EXPECT_EQ(3U, stats.counters[Stats::QUEUED]);
+
+    /* A rejected request is forgotten */
+    EXPECT_TRUE(queue.Finished(&c1) == NULL);
+
+    /* Room is made as soon as a request finishes */
+    EXPECT_TRUE(queue.Finished(&b1) == NULL);
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&c1));
+    EXPECT_EQ(&a2, queue.Finished(&a1));
+    EXPECT_TRUE(queue.Finished(&a2) == NULL);
+    EXPECT_TRUE(queue.Finished(&c1) == NULL);
+}
+
+TEST(JoinSessionQueueTest, clear)
+{
+    JoinSessionQueue queue(16, 1);
+    Request a1(":a.1", true);
+    Request a2(":a.1", true);
+    Request b1(":b.1", false);
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a1));
+    EXPECT_EQ(JoinSessionQueue::PARKED, queue.Add(&a2));
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&b1));
+    queue.Started(&b1);
+
+    std::vector<Request*> cleared;
+    queue.Clear(cleared);
+    EXPECT_EQ(3U, cleared.size());
+    Stats stats;
+    queue.GetStats(stats);
+    EXPECT_EQ(0U, stats.counters[Stats::QUEUED]);
+    EXPECT_EQ(0U, stats.counters[Stats::IN_PROGRESS]);
+
+    /* Requests finishing after a clear are ignored */
+    EXPECT_TRUE(queue.Finished(&a1) == NULL);
+    EXPECT_TRUE(queue.Finished(&b1) == NULL);
+    EXPECT_EQ(JoinSessionQueue::RUN, queue.Add(&a2));
+    EXPECT_TRUE(queue.Finished(&a2) == NULL);
+}
+
+TEST(JoinSessionQueueTest, stats_names)
+{
+    Stats stats;
+    stats.counters[Stats::REJECTED] = 7;
+    EXPECT_STREQ("join_sessions_rejected", Stats::GetName(Stats::REJECTED));
+    EXPECT_STREQ("", Stats::GetName(Stats::NUM_COUNTERS));
+    qcc::String str = stats.ToString();
+    EXPECT_NE(+qcc::String::npos, str.find("join_sessions_rejected 7\n"));
+    EXPECT_NE(+qcc::String::npos, str.find("join_session_max_queue_ms 0\n"));
+}
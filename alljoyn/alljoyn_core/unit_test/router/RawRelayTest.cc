@@ -0,0 +1,195 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_LINUX)
+
+#include <stdio.h>
+#include <sys/socket.h>
+#include <vector>
+
+#include <qcc/Socket.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+
+#include "RawRelay.h"
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+#include "../ajTestCommon.h"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+/* Writes a pattern of bytes to a socket from its own thread */
+class PatternWriter : public Thread {
+  public:
+    PatternWriter(SocketFd fd, size_t total) : Thread("PatternWriter"), fd(fd), total(total) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        vector<uint8_t> buf(32 * 1024);
+        size_t sent = 0;
+        while (sent < total) {
+            size_t len = min(buf.size(), total - sent);
+            for (size_t i = 0; i < len; ++i) {
+                buf[i] = static_cast<uint8_t>(sent + i);
+            }
+            ssize_t n = ::send(fd, &buf[0], len, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            sent += n;
+        }
+        return 0;
+    }
+
+  private:
+    SocketFd fd;
+    size_t total;
+};
+
+/* Reads the pattern from a socket, returns false if it does not match or the stream ends early */
+static bool ReadPattern(SocketFd fd, size_t total)
+{
+    vector<uint8_t> buf(32 * 1024);
+    size_t received = 0;
+    while (received < total) {
+        ssize_t n = ::recv(fd, &buf[0], min(buf.size(), total - received), 0);
+        if (n <= 0) {
+            return false;
+        }
+        for (ssize_t i = 0; i < n; ++i) {
+            if (buf[i] != static_cast<uint8_t>(received + i)) {
+                return false;
+            }
+        }
+        received += n;
+    }
+    return true;
+}
+
+class RawRelayTest : public testing::Test {
+  public:
+    RawRelayService relays;
+    SocketFd appA;
+    SocketFd appB;
+
+    RawRelayTest() : relays(1), appA(-1), appB(-1) { }
+
+    virtual void SetUp() {
+        SocketFd left[2];
+        SocketFd right[2];
+        ASSERT_EQ(ER_OK, SocketPair(left));
+        ASSERT_EQ(ER_OK, SocketPair(right));
+        appA = left[0];
+        appB = right[1];
+        ASSERT_EQ(ER_OK, relays.AddRelay(left[1], right[0], "test"));
+        EXPECT_EQ(1U, relays.GetNumRelays());
+    }
+
+    virtual void TearDown() {
+        if (appA >= 0) {
+            qcc::Close(appA);
+        }
+        if (appB >= 0) {
+            qcc::Close(appB);
+        }
+    }
+
+    /* Wait for the relay to be closed by the service */
+    bool WaitForClose() {
+        for (uint32_t i = 0; i < 200; ++i) {
+            if (relays.GetNumRelays() == 0) {
+                return true;
+            }
+            qcc::Sleep(10);
+        }
+        return false;
+    }
+};
+
+TEST_F(RawRelayTest, relays_both_directions)
+{
+    const size_t size = 1024 * 1024;
+    PatternWriter aToB(appA, size);
+    PatternWriter bToA(appB, size);
+    ASSERT_EQ(ER_OK, aToB.Start());
+    ASSERT_EQ(ER_OK, bToA.Start());
+
+    EXPECT_TRUE(ReadPattern(appB, size));
+    EXPECT_TRUE(ReadPattern(appA, size));
+    aToB.Join();
+    bToA.Join();
+
+    vector<RawRelayStats> stats;
+    relays.GetStats(stats);
+    ASSERT_EQ(1U, stats.size());
+    EXPECT_STREQ("test", stats[0].name.c_str());
+    EXPECT_EQ(size, stats[0].bytes[0]);
+    EXPECT_EQ(size, stats[0].bytes[1]);
+    EXPECT_LT(0U, stats[0].bursts[0]);
+    EXPECT_LE(stats[0].maxLatencyUs[0], stats[0].totalLatencyUs[0]);
+
+    /* End of stream is passed on in each direction and then the relay is closed */
+    uint8_t buf[16];
+    ::shutdown(appA, SHUT_WR);
+    EXPECT_EQ(0, ::recv(appB, buf, sizeof(buf), 0));
+    EXPECT_EQ(1U, relays.GetNumRelays());
+    ::shutdown(appB, SHUT_WR);
+    EXPECT_EQ(0, ::recv(appA, buf, sizeof(buf), 0));
+    EXPECT_TRUE(WaitForClose());
+}
+
+TEST_F(RawRelayTest, peer_close_closes_relay)
+{
+    uint8_t buf[16] = { 0 };
+    qcc::Close(appB);
+    appB = -1;
+    EXPECT_EQ(0, ::recv(appA, buf, sizeof(buf), 0));
+
+    /* Bytes that cannot be delivered close the relay */
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(buf)), ::send(appA, buf, sizeof(buf), MSG_NOSIGNAL));
+    EXPECT_TRUE(WaitForClose());
+}
+
+TEST_F(RawRelayTest, socketpair_throughput)
+{
+    const size_t size = 256 * 1024 * 1024;
+    PatternWriter aToB(appA, size);
+    uint64_t start = GetTimestamp64();
+    ASSERT_EQ(ER_OK, aToB.Start());
+    size_t received = 0;
+    vector<uint8_t> buf(64 * 1024);
+    while (received < size) {
+        ssize_t n = ::recv(appB, &buf[0], buf.size(), 0);
+        ASSERT_LT(0, n);
+        received += n;
+    }
+    uint64_t elapsed = max(GetTimestamp64() - start, static_cast<uint64_t>(1));
+    aToB.Join();
+    printf("Relayed %u MB in %u ms (%u MB/s)\n", static_cast<uint32_t>(size >> 20), static_cast<uint32_t>(elapsed),
+           static_cast<uint32_t>(((size >> 20) * 1000) / elapsed));
+
+    vector<RawRelayStats> stats;
+    relays.GetStats(stats);
+    ASSERT_EQ(1U, stats.size());
+    EXPECT_EQ(size, stats[0].bytes[0]);
+    EXPECT_EQ(0U, stats[0].bytes[1]);
+}
+
+#endif
@@ -0,0 +1,205 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/ProxyBusObject.h>
+
+#include "JoinSessionQueue.h"
+#include "RouterStats.h"
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+#include "../ajTestCommon.h"
+
+using namespace qcc;
+using namespace ajn;
+
+/* Records a fixed number of events from its own thread and then exits */
+class StatsRecorder : public Thread {
+  public:
+    StatsRecorder(RouterStats& stats, uint32_t events) : Thread("StatsRecorder"), stats(stats), events(events) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t i = 0; i < events; ++i) {
+            stats.Increment(RouterStats::MESSAGES_ROUTED);
+            stats.Record(RouterStats::ROUTE_LATENCY, i % 100);
+        }
+        return 0;
+    }
+
+  private:
+    RouterStats& stats;
+    uint32_t events;
+};
+
+TEST(RouterStatsTest, histogram_buckets)
+{
+    RouterStats stats;
+    stats.Record(RouterStats::ROUTE_LATENCY, 0);
+    stats.Record(RouterStats::ROUTE_LATENCY, 1);
+    stats.Record(RouterStats::ROUTE_LATENCY, 3);
+    stats.Record(RouterStats::ROUTE_LATENCY, 1000);
+    stats.Record(RouterStats::ROUTE_LATENCY, static_cast<uint64_t>(1) << 40);
+
+    RouterStats::Snapshot snapshot;
+    stats.GetSnapshot(snapshot);
+    EXPECT_EQ(5U, snapshot.GetCount(RouterStats::ROUTE_LATENCY));
+    EXPECT_EQ(1U, snapshot.buckets[RouterStats::ROUTE_LATENCY][0]);
+    EXPECT_EQ(1U, snapshot.buckets[RouterStats::ROUTE_LATENCY][1]);
+    EXPECT_EQ(1U, snapshot.buckets[RouterStats::ROUTE_LATENCY][2]);
+    EXPECT_EQ(1U, snapshot.buckets[RouterStats::ROUTE_LATENCY][10]);
+    EXPECT_EQ(1U, snapshot.buckets[RouterStats::ROUTE_LATENCY][RouterStats::NUM_BUCKETS - 1]);
+
+    /* Percentiles are reported as the upper bound of their bucket */
+    EXPECT_EQ(4U, snapshot.GetPercentile(RouterStats::ROUTE_LATENCY, 50));
+    EXPECT_EQ(1024U, snapshot.GetPercentile(RouterStats::ROUTE_LATENCY, 80));
+    EXPECT_EQ(0U, snapshot.GetPercentile(RouterStats::NAME_TABLE_LOCK_WAIT, 50));
+}
+
+TEST(RouterStatsTest, sampling)
+{
+    /*
+     * Time two histograms for every event the way PushMessage() does.  Each
+     * histogram has to get its own one in SAMPLE_INTERVAL samples.
+     */
+    RouterStats stats;
+    uint32_t sampled = 0;
+    for (uint32_t i = 0; i < 10 * RouterStats::SAMPLE_INTERVAL; ++i) {
+        RouterStats::ScopedSample sample(stats, RouterStats::ROUTE_LATENCY);
+        uint64_t start = stats.StartSample(RouterStats::RULE_TABLE_LOCK_WAIT);
+        if (start) {
+            ++sampled;
+        }
+        stats.RecordSince(RouterStats::RULE_TABLE_LOCK_WAIT, start);
+    }
+    EXPECT_EQ(10U, sampled);
+
+    RouterStats::Snapshot snapshot;
+    stats.GetSnapshot(snapshot);
+    EXPECT_EQ(10U, snapshot.GetCount(RouterStats::RULE_TABLE_LOCK_WAIT));
+    EXPECT_EQ(10U, snapshot.GetCount(RouterStats::ROUTE_LATENCY));
+}
+
+TEST(RouterStatsTest, counts_survive_thread_exit)
+{
+    RouterStats stats;
+    StatsRecorder* recorders[4];
+    for (size_t i = 0; i < ArraySize(recorders); ++i) {
+        recorders[i] = new StatsRecorder(stats, 10000);
+        ASSERT_EQ(ER_OK, recorders[i]->Start());
+    }
+    for (size_t i = 0; i < ArraySize(recorders); ++i) {
+        recorders[i]->Join();
+        delete recorders[i];
+    }
+    stats.Increment(RouterStats::MESSAGES_ROUTED, 5);
+
+    RouterStats::Snapshot snapshot;
+    stats.GetSnapshot(snapshot);
+    EXPECT_EQ(40005U, snapshot.counters[RouterStats::MESSAGES_ROUTED]);
+    EXPECT_EQ(40000U, snapshot.GetCount(RouterStats::ROUTE_LATENCY));
+    EXPECT_EQ(4U * 100U * (99U * 100U / 2U), snapshot.sums[RouterStats::ROUTE_LATENCY]);
+}
+
+TEST(RouterStatsTest, debug_stats_interface)
+{
+    BusAttachment bus("RouterStatsTest", false);
+    ASSERT_EQ(ER_OK, bus.Start());
+    ASSERT_EQ(ER_OK, bus.Connect(ajn::getConnectArg().c_str()));
+
+    /* A JoinSession that fails goes through the join session queue all the same */
+    SessionId sessionId;
+    SessionOpts opts;
+    EXPECT_NE(ER_OK, bus.JoinSession("org.alljoyn.RouterStatsTest.NoSuchHost", 42, NULL, sessionId, opts));
+
+    ProxyBusObject proxy(bus, org::alljoyn::Bus::WellKnownName, org::alljoyn::Bus::Debug::Stats::ObjectPath, 0);
+    const InterfaceDescription* intf = bus.GetInterface(org::alljoyn::Bus::Debug::Stats::InterfaceName);
+    ASSERT_TRUE(intf != NULL);
+    ASSERT_EQ(ER_OK, proxy.AddInterface(*intf));
+
+    /* Route enough unicast messages from this thread for every histogram on the unicast path to be sampled */
+    Message reply(bus);
+    for (uint32_t i = 0; i < 4 * RouterStats::SAMPLE_INTERVAL; ++i) {
+        ASSERT_EQ(ER_OK, proxy.MethodCall(org::alljoyn::Bus::Debug::Stats::InterfaceName, "GetReport", NULL, 0, reply));
+    }
+
+    ASSERT_EQ(ER_OK, proxy.MethodCall(org::alljoyn::Bus::Debug::Stats::InterfaceName, "GetCounters", NULL, 0, reply));
+    MsgArg* counters;
+    size_t numCounters;
+    ASSERT_EQ(ER_OK, reply->GetArg(0)->Get("a{st}", &numCounters, &counters));
+    EXPECT_EQ(static_cast<size_t>(RouterStats::NUM_COUNTERS + RouterStats::NUM_GAUGES + JoinSessionQueue::Stats::NUM_COUNTERS), numCounters);
+    uint64_t routed = 0;
+    uint64_t uniqueNames = 0;
+    uint64_t joinsAdmitted = 0;
+    for (size_t i = 0; i < numCounters; ++i) {
+        const char* name;
+        uint64_t value;
+        ASSERT_EQ(ER_OK, counters[i].Get("{st}", &name, &value));
+        if (strcmp(name, "messages_routed") == 0) {
+            routed = value;
+        } else if (strcmp(name, "unique_names") == 0) {
+            uniqueNames = value;
+        } else if (strcmp(name, "join_sessions_admitted") == 0) {
+            joinsAdmitted = value;
+        }
+    }
+    /* At least our own method call went through the router */
+    EXPECT_LT(0U, routed);
+    EXPECT_LT(0U, uniqueNames);
+    EXPECT_LT(0U, joinsAdmitted);
+
+    ASSERT_EQ(ER_OK, proxy.MethodCall(org::alljoyn::Bus::Debug::Stats::InterfaceName, "GetHistograms", NULL, 0, reply));
+    MsgArg* histograms;
+    size_t numHistograms;
+    ASSERT_EQ(ER_OK, reply->GetArg(0)->Get("a(sttat)", &numHistograms, &histograms));
+    ASSERT_EQ(static_cast<size_t>(RouterStats::NUM_HISTOGRAMS), numHistograms);
+    const char* name;
+    uint64_t count;
+    uint64_t sum;
+    size_t numBuckets;
+    uint64_t* buckets;
+    ASSERT_EQ(ER_OK, histograms[0].Get("(sttat)", &name, &count, &sum, &numBuckets, &buckets));
+    EXPECT_STREQ("route_latency_us", name);
+    EXPECT_EQ(static_cast<size_t>(RouterStats::NUM_BUCKETS), numBuckets);
+    EXPECT_LT(0U, count);
+    ASSERT_EQ(ER_OK, histograms[1].Get("(sttat)", &name, &count, &sum, &numBuckets, &buckets));
+    EXPECT_STREQ("name_table_lock_wait_us", name);
+    EXPECT_LT(0U, count);
+
+    ASSERT_EQ(ER_OK, proxy.MethodCall(org::alljoyn::Bus::Debug::Stats::InterfaceName, "GetEndpointStats", NULL, 0, reply));
+    MsgArg* endpoints;
+    size_t numEndpoints;
+    EXPECT_EQ(ER_OK, reply->GetArg(0)->Get("a(suutttt)", &numEndpoints, &endpoints));
+
+    ASSERT_EQ(ER_OK, proxy.MethodCall(org::alljoyn::Bus::Debug::Stats::InterfaceName, "GetReport", NULL, 0, reply));
+    const char* report;
+    ASSERT_EQ(ER_OK, reply->GetArg(0)->Get("s", &report));
+    EXPECT_TRUE(strstr(report, "messages_routed") != NULL);
+    EXPECT_TRUE(strstr(report, "route_latency_us count") != NULL);
+    EXPECT_TRUE(strstr(report, "join_sessions_admitted") != NULL);
+
+    bus.Disconnect();
+    bus.Stop();
+    bus.Join();
+}
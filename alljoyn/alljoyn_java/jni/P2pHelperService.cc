@@ -832,9 +832,9 @@ JNIEXPORT jboolean JNICALL Java_org_alljoyn_bus_p2p_service_P2pHelperService_jni
                         env->ReleaseStringUTFChars(connectSpec, cSpec);
                         return false;
                     } else {
-                        const char*cConnectSpec = s_bus->GetConnectSpec().c_str();
-                        isStandalone = (strcmp(cConnectSpec, "null:") == 0) ? true  : false;
-                        LOGE("BusAttachment::Connect(\"%s\") SUCCEEDED (%s)", cConnectSpec, QCC_StatusText(status));
+                        qcc::String connectedSpec = s_bus->GetConnectSpec();
+                        isStandalone = (connectedSpec == "null:") ? true  : false;
+                        LOGE("BusAttachment::Connect(\"%s\") SUCCEEDED (%s)", connectedSpec.c_str(), QCC_StatusText(status));
                     }
                     env->ReleaseStringUTFChars(connectSpec, cSpec);
                 }
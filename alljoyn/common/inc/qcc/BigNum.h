@@ -211,6 +211,9 @@ class BigNum {
     // @param mod The modulus
     BigNum mod_exp(const BigNum& e, const BigNum& mod) const;
 
+    // Precomputed powers of a fixed base for repeated modular exponentiation
+    class FixedBase;
+
     // Modular inverse
     //
     // @param mod The modulus
@@ -233,12 +236,22 @@ class BigNum {
 
   private:
 
-    // Montgomery multiplication
+    // Montgomery multiplication on zero padded digit arrays of length len. Computes
+    // x * y / R % m where R = 2^(32 * len). The result r may alias x or y.
     // @param r    Returns the Montgomery product
-    // @param n    The multiplicand
-    // @param m    The modulus
+    // @param x    The multiplier
+    // @param y    The multiplicand
+    // @param m    The modulus digits
+    // @param len  The number of digits in all operands
     // @param rho  The inverse modulus
-    BigNum& monty_mul(BigNum& r, const BigNum& n, const BigNum& m, uint32_t rho) const;
+    // @param t    Scratch space for len + 1 digits
+    static void monty_mul(uint32_t* r, const uint32_t* x, const uint32_t* y, const uint32_t* m, size_t len, uint32_t rho, uint32_t* t);
+
+    // Convert into the Montgomery domain as a zero padded array of mod.length digits
+    void monty_enter(uint32_t* d, const BigNum& mod) const;
+
+    // Convert out of the Montgomery domain
+    static BigNum monty_leave(const uint32_t* d, const BigNum& mod, uint32_t rho, uint32_t* t);
 
     // Mongtomery modular exponentiation
     BigNum monty_mod_exp(const BigNum& n, const BigNum& mod) const;
@@ -323,5 +336,54 @@ class BigNum {
     static uint32_t zero_digit;
 };
 
+// Modular exponentiation with a base and modulus that are used many times, for example the
+// generator of a Diffie-Hellman group. The powers base^(2^(k * window)) are computed once so
+// each exponentiation needs about maxExpBits / window multiplications and no squarings. The
+// object is not modified after construction so it can be shared between threads.
+class BigNum::FixedBase {
+  public:
+
+    // Constructor
+    //
+    // @param base        The fixed base
+    // @param mod         The modulus, must be odd
+    // @param maxExpBits  The largest exponent (in bits) the precomputed powers will cover
+    FixedBase(const BigNum& base, const BigNum& mod, size_t maxExpBits);
+
+    // Modular exponentiation. Exponents longer than maxExpBits fall back to BigNum::mod_exp.
+    //
+    // @param e   The exponent
+    BigNum mod_exp(const BigNum& e) const;
+
+    // Returns the base
+    const BigNum& get_base() const { return base; }
+
+    // Returns the modulus
+    const BigNum& get_mod() const { return mod; }
+
+  private:
+
+    // The fixed base
+    BigNum base;
+
+    // The modulus
+    BigNum mod;
+
+    // The inverse modulus
+    uint32_t rho;
+
+    // Number of exponent bits per precomputed power
+    size_t window;
+
+    // Number of precomputed powers
+    size_t count;
+
+    // The precomputed powers in the Montgomery domain, each mod.length digits long
+    BigNum powers;
+
+    // The value one in the Montgomery domain
+    BigNum one;
+};
+
 }
 #endif
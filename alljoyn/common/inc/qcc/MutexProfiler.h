@@ -0,0 +1,160 @@
+#ifndef _QCC_MUTEXPROFILER_H
+#define _QCC_MUTEXPROFILER_H
+/**
+ * @file
+ *
+ * This file defines a profiler that measures lock contention per lock site.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+
+namespace qcc {
+
+class Mutex;
+struct MutexSite;
+
+/**
+ * %MutexProfiler measures how often and for how long the callers of
+ * Mutex::Lock(MUTEX_CONTEXT) wait for and hold each lock, keyed by the file
+ * and line the lock was taken from.
+ *
+ * The profiler is off until Enable() is called.  While it is off Lock() pays
+ * for one extra test.  While it is on every contended acquisition is counted
+ * and its wait timed, but only one in sampleInterval acquisitions of each
+ * mutex is counted and has its hold time measured, so an uncontended Lock()
+ * does not normally read the clock.  Locks taken with Lock() or TryLock()
+ * rather than Lock(MUTEX_CONTEXT) are not profiled.
+ */
+class MutexProfiler {
+  public:
+
+    /**
+     * Number of histogram buckets.  Bucket 0 counts times of 0, bucket n
+     * counts times from 2^(n-1) to 2^n - 1 microseconds and the last bucket
+     * counts everything from 2^(NUM_BUCKETS-2) microseconds up.
+     */
+    static const uint32_t NUM_BUCKETS = 24;
+
+    /**
+     * The statistics of one lock site.
+     */
+    struct SiteStats {
+        qcc::String file;                   /**< File the lock was taken from */
+        uint32_t line;                      /**< Line the lock was taken from */
+        uint64_t acquisitions;              /**< Estimated acquisitions, each sampled acquisition counts sampleInterval times */
+        uint64_t contended;                 /**< Acquisitions that had to wait for another thread */
+        uint64_t waitTime;                  /**< Total time spent waiting in microseconds */
+        uint64_t waitBuckets[NUM_BUCKETS];  /**< Histogram of the wait times */
+        uint64_t holdSamples;               /**< Number of hold times measured */
+        uint64_t holdTime;                  /**< Total of the hold times measured in microseconds */
+        uint64_t holdBuckets[NUM_BUCKETS];  /**< Histogram of the hold times */
+
+        SiteStats();
+
+        /**
+         * Get an upper bound for a percentile of a histogram.
+         *
+         * @param buckets   waitBuckets or holdBuckets.
+         * @param percent   The percentile, 0 to 100.
+         *
+         * @return  The upper bound in microseconds of the bucket that holds the
+         *          percentile, or 0 if the histogram is empty.
+         */
+        static uint64_t GetPercentile(const uint64_t* buckets, uint32_t percent);
+    };
+
+    /**
+     * Start profiling.  May be called again to change the sample interval.
+     *
+     * @param sampleInterval   One in this many acquisitions of each mutex is counted and timed.
+     */
+    static void Enable(uint32_t sampleInterval = 16);
+
+    /**
+     * Stop profiling.  The statistics collected so far are kept.
+     */
+    static void Disable();
+
+    /**
+     * Check whether profiling is on.
+     *
+     * @return  true if profiling is on.
+     */
+    static bool IsEnabled() { return enabled; }
+
+    /**
+     * Clear the statistics of all lock sites.
+     */
+    static void Reset();
+
+    /**
+     * Get the statistics of every lock site that has recorded an event, most
+     * total wait time first.
+     *
+     * @param[out] sites   The lock sites.
+     */
+    static void GetSites(std::vector<SiteStats>& sites);
+
+    /**
+     * Format the statistics of the most contended lock sites as text with one
+     * lock site per line.
+     *
+     * @param maxSites   Maximum number of lock sites to include.
+     *
+     * @return  The formatted statistics.
+     */
+    static qcc::String Dump(size_t maxSites = 20);
+
+  private:
+
+    friend class Mutex;
+
+    /**
+     * Called by Mutex after an outermost Lock(MUTEX_CONTEXT).
+     *
+     * @param file               The file the lock was taken from.
+     * @param line               The line the lock was taken from.
+     * @param waitStart          Time the wait began if the lock was contended, 0 otherwise.
+     * @param[in,out] sampleCount  The mutex's count of acquisitions since its last sample.
+     * @param[out] holdStart     Time the lock was acquired if the hold time is to be measured, 0 otherwise.
+     *
+     * @return  The lock site to pass to Released().
+     */
+    static MutexSite* Acquired(const char* file, uint32_t line, uint64_t waitStart, uint32_t& sampleCount, uint64_t& holdStart);
+
+    /**
+     * Called by Mutex before the outermost unlock of a lock whose hold time is
+     * being measured.
+     *
+     * @param site        The lock site returned by Acquired().
+     * @param holdStart   The time the lock was acquired.
+     */
+    static void Released(MutexSite* site, uint64_t holdStart);
+
+    static volatile bool enabled;               /**< true while profiling */
+    static volatile uint32_t sampleInterval;    /**< One in this many acquisitions is sampled */
+};
+
+}
+
+#endif
@@ -31,7 +31,7 @@
 #include <qcc/UARTStream.h>
 #include <qcc/Timer.h>
 #include <qcc/SLAPPacket.h>
-#include <list>
+#include <vector>
 
 namespace qcc {
 class SLAPStream : public Stream, public UARTReadListener, public AlarmListener {
@@ -201,15 +201,80 @@ class SLAPStream : public Stream, public UARTReadListener, public AlarmListener
     uint8_t m_currentTxAck;   /**< sequence number of the packet we expect to ACK next */
     uint8_t m_pendingAcks;    /**< number of received packets waiting to be ACKed */
 
+    /**
+     * Contiguous FIFO of packet pointers. The queues below hold at most a window's worth of
+     * packets and are cycled for every packet sent or received, so a ring over a single
+     * array avoids the node allocation and pointer chasing of a linked list. The ring grows
+     * (doubling) if it ever fills.
+     */
+    template <typename T>
+    class PacketRing {
+      public:
+        PacketRing() : m_ring(8), m_head(0), m_count(0) { }
+
+        bool empty() const { return m_count == 0; }
+
+        size_t size() const { return m_count; }
+
+        T front() const { return m_ring[m_head]; }
+
+        T back() const { return m_ring[(m_head + m_count - 1) & (m_ring.size() - 1)]; }
+
+        T operator[](size_t i) const { return m_ring[(m_head + i) & (m_ring.size() - 1)]; }
+
+        void push_back(T t)
+        {
+            if (m_count == m_ring.size()) {
+                Grow();
+            }
+            m_ring[(m_head + m_count++) & (m_ring.size() - 1)] = t;
+        }
+
+        void push_front(T t)
+        {
+            if (m_count == m_ring.size()) {
+                Grow();
+            }
+            m_head = (m_head - 1) & (m_ring.size() - 1);
+            m_ring[m_head] = t;
+            ++m_count;
+        }
+
+        void pop_front()
+        {
+            m_head = (m_head + 1) & (m_ring.size() - 1);
+            --m_count;
+        }
+
+        void pop_back() { --m_count; }
+
+        void clear() { m_head = m_count = 0; }
+
+      private:
+        void Grow()
+        {
+            std::vector<T> ring(m_ring.size() * 2);
+            for (size_t i = 0; i < m_count; ++i) {
+                ring[i] = (*this)[i];
+            }
+            m_ring.swap(ring);
+            m_head = 0;
+        }
+
+        std::vector<T> m_ring;  /* Capacity is always a power of two */
+        size_t m_head;
+        size_t m_count;
+    };
+
     Mutex m_streamLock;                   /**< Lock used to protect the private data structures */
     SLAPReadPacket* m_rxCurrent;            /**< Packet currently being received */
     SLAPWritePacket* m_txCtrl;              /**< Link control packet */
     SLAPWritePacket* m_txCurrent;           /**< Packet currently being transmitted */
-    std::list<SLAPReadPacket*> m_rxFreeList; /**< List of receive packets that are available to be filled and put into m_rxQueue */
-    std::list<SLAPReadPacket*> m_rxQueue;   /**< List of data packets that have been received */
-    std::list<SLAPWritePacket*> m_txFreeList; /**< List of transmit packets that are available to be filled and put into the m_txQueue */
-    std::list<SLAPWritePacket*> m_txQueue;  /**< List of packets to be transmitted */
-    std::list<SLAPWritePacket*> m_txSent;   /**< List of transmitted packets that havent been acked */
+    PacketRing<SLAPReadPacket*> m_rxFreeList; /**< Queue of receive packets that are available to be filled and put into m_rxQueue */
+    PacketRing<SLAPReadPacket*> m_rxQueue;   /**< Queue of data packets that have been received */
+    PacketRing<SLAPWritePacket*> m_txFreeList; /**< Queue of transmit packets that are available to be filled and put into the m_txQueue */
+    PacketRing<SLAPWritePacket*> m_txQueue;  /**< Queue of packets to be transmitted */
+    PacketRing<SLAPWritePacket*> m_txSent;   /**< Queue of transmitted packets that havent been acked */
 
 };
 
@@ -30,10 +30,11 @@
 namespace qcc {
 
 /**
- * String is a heap-allocated array of bytes whose life-cycle is managed
- * through reference counting. When all references to a qcc::String instance
- * go out of scope or are deleted, then the underlying heap-allocated storage
- * is freed.
+ * String is an array of bytes. Strings of up to InlineCapacity characters are
+ * stored in the String object itself and are copied rather than shared.
+ * Longer strings are heap-allocated and their life-cycle is managed through
+ * reference counting. When all references to a qcc::String instance go out of
+ * scope or are deleted, then the underlying heap-allocated storage is freed.
  */
 class String {
   public:
@@ -86,6 +87,18 @@ class String {
      */
     String(const String& str);
 
+#if (__cplusplus >= 201100L)
+    /**
+     * Move Constructor
+     *
+     * @param str        String to move from, a heap-allocated string is left empty
+     */
+    String(String&& str);
+
+    /** Move assignment operator */
+    String& operator=(String&& assignFromMe);
+#endif
+
     /** Destructor */
     virtual ~String();
 
@@ -339,6 +352,11 @@ class String {
     /**
      * Get the null termination char* representation for this String.
      *
+     * The pointer belongs to this String object, not to the value it shares
+     * with its copies.  A short string is stored inside the object, so the
+     * pointer must not be used after this String is destroyed or modified
+     * even if a copy of it is still alive.
+     *
      * @return Null terminated string.
      */
     const char* c_str() const { return context->c_str; }
@@ -513,10 +531,26 @@ class String {
         char c_str[MinCapacity]; /**< The buffer holding the actual character string */
     } ManagedCtx;
 
+    /** Longest string that is stored in the String object itself */
+    static const size_t InlineCapacity = 31;
+
+    /**
+     * Context of a string stored in the String object itself.  The buffer of
+     * the ManagedCtx continues into the extra bytes that follow it.
+     */
+    struct InlineCtx {
+        ManagedCtx ctx;
+        char extra[InlineCapacity + 1 - MinCapacity];
+    };
+
     ManagedCtx* context;
 
+    InlineCtx inlineCtx;
+
     static ManagedCtx nullContext;
 
+    void CopyContext(const String& other);
+
     void IncRef();
 
     void DecRef(ManagedCtx* context);
@@ -1,7 +1,7 @@
 /**
  * @file
  *
- * Simple ThreadPool using Timers and Alarms
+ * Simple work-stealing ThreadPool
  */
 
 /******************************************************************************
@@ -23,10 +23,12 @@
 #ifndef _QCC_THREADPOOL_H
 #define _QCC_THREADPOOL_H
 
-#include <map>
+#include <vector>
 
 #include <qcc/Timer.h>
+#include <qcc/Condition.h>
 #include <qcc/Event.h>
+#include <qcc/Mutex.h>
 #include <qcc/Ptr.h>
 
 namespace qcc {
@@ -83,9 +85,9 @@ class Runnable : public qcc::RefCountBase, public qcc::AlarmListener {
     friend class ThreadPool;
 
     /**
-     * AlarmTriggered is the method that is called to dispatch an alarm.
-     * Our Run() methods are driven by alarm expirations that happen to
-     * always occur immediately.
+     * AlarmTriggered is the method that is called to dispatch an alarm.  The
+     * ThreadPool worker threads call Run() directly; this remains so that a
+     * Runnable can still be driven by an alarm that expires immediately.
      *
      * Note that the enclosing runnable object is automatically deleted
      * afte the Run method is executed.
@@ -116,6 +118,11 @@ class Runnable : public qcc::RefCountBase, public qcc::AlarmListener {
  * to provide a simple way to execute tasks in the context of a separate
  * thread.
  *
+ * Each worker thread has its own queue.  Execute() places a Runnable on the
+ * queues in round-robin order without taking a lock, and a worker that finds
+ * its own queue empty steals from the queues of the other workers before it
+ * goes to sleep.
+ *
  * In order to ask a ThreadPool to execute a task, one must inherit from the
  * Runnable class and provide a Run() method.
  */
@@ -237,16 +244,41 @@ class ThreadPool {
      */
     ThreadPool(const ThreadPool& other);
 
+    class Worker;
+    class TaskQueue;
+
     /**
      * A flag to remind if the thread pool is stopping or stopped.
      */
-    bool m_stopping;
+    volatile bool m_stopping;
 
     /**
-     * A mutex to protect the underlying data structures.
+     * A mutex that protects the sleeping workers and the wakeups posted to them.
      */
     qcc::Mutex m_lock;
 
+    /**
+     * A condition that sleeping workers wait on for a wakeup.
+     */
+    qcc::Condition m_wakeup;
+
+    /**
+     * The number of wakeups posted to sleeping workers that have not been
+     * consumed yet.
+     */
+    uint32_t m_wakeups;
+
+    /**
+     * The number of workers that are sleeping or about to sleep.  A worker
+     * announces itself here before it looks at the queues one last time.
+     */
+    volatile int32_t m_sleeping;
+
+    /**
+     * The number of threads waiting in WaitForAvailableThread().
+     */
+    volatile int32_t m_waiters;
+
     /**
      * An event to allow callers to wait until a thread becomes available
      * in the pool.
@@ -259,31 +291,55 @@ class ThreadPool {
     uint32_t m_poolsize;
 
     /**
-     * We need to hold a reference to an underlying Runnable object while we
-     * wait for its Run() method to be executed.  The Runnable object acts as a
-     * closure that a user will use to keep required variables.  When the Run()
-     * method is done executing, we release the reference to the runnable managed
-     * object by deleting the corresponding entry in the closure map.
+     * The number of Runnable closures that are queued or executing.  We hold
+     * a reference to each of them until its Run() method has returned, and
+     * never allow more than m_poolsize of them.
+     */
+    volatile int32_t m_pending;
+
+    /**
+     * Counter used to pick the queue for the next Runnable.
+     */
+    volatile int32_t m_next;
+
+    /**
+     * One queue per worker thread.
      */
-    typedef std::map<Runnable*, Ptr<Runnable> > RunnableEntry;
-    RunnableEntry m_closures;
+    std::vector<TaskQueue*> m_queues;
 
     /**
-     * When the AlarmTriggered callback of the AlarmListener base class of the
-     * Runnable is called by the Timer, it will call the user's Run() function
-     * and then call back here to let us know that it has finished executing.
-     * That tells us that we can clean up any resources we may be holding.  That
-     * just means releasing our reference to the Ptr that holds the ulitmate
-     * reference to the runnable.  If we can't find a closure, we have screwed
-     * up massively and we should just die.
+     * The worker threads.
+     */
+    std::vector<Worker*> m_workers;
+
+    /**
+     * After a Runnable's Run() method has returned the worker calls back here
+     * to release our reference to it and to let a thread that is waiting for
+     * an available thread know that one has become free.
      */
     void Release(Runnable* runnable);
 
     /**
-     * The timer that actually does all of the work of dispatching threads and
-     * essentially doing all of the work of the thread pool.
+     * Take the next Runnable from the queue of a worker, or steal one from
+     * the queues of the other workers if that queue is empty.
+     *
+     * @param index  The index of the worker.
+     *
+     * @return The Runnable or NULL if all queues are empty.
+     */
+    Runnable* Take(uint32_t index);
+
+    /**
+     * The main loop of a worker thread.
+     *
+     * @param index  The index of the worker.
+     */
+    void RunWorker(uint32_t index);
+
+    /**
+     * Wake up a sleeping worker unless a wakeup is already on its way.
      */
-    qcc::Timer m_dispatcher;
+    void WakeWorker();
 };
 
 } // namespace qcc
@@ -150,8 +150,10 @@ class FileSink : public Sink {
      * Create an FileSink.
      *
      * @param fileName     Name of file to use as sink.
+     * @param mode         File creation mode.
+     * @param append       If true bytes are appended to an existing file rather than replacing it.
      */
-    FileSink(qcc::String fileName, Mode mode = WORLD_READABLE);
+    FileSink(qcc::String fileName, Mode mode = WORLD_READABLE, bool append = false);
 
     /**
      * Create an FileSink for stdout
@@ -32,18 +32,17 @@
 
 namespace qcc {
 
+struct MutexSite;
+
 /**
  * a macro that can be passed into the Mutex::Lock/Unlock member functions to
  * help when debugging Mutex related issues. When running in debug mode, this
  * will cause the code to log the name of the file and the line number of that
  * file each time a Mutex lock is obtained and released. Logging must be turned
- * on to see this information.
+ * on to see this information.  The file and line are also the lock site that
+ * qcc::MutexProfiler reports contention for, in release builds as well.
  */
-#ifndef NDEBUG
 #define MUTEX_CONTEXT __FILE__, __LINE__
-#else
-#define MUTEX_CONTEXT
-#endif
 
 /**
  * The Linux implementation of a Mutex abstraction class.
@@ -142,6 +141,16 @@ class Mutex {
     void Init();            ///< Initialize underlying OS mutex
     const char* file;
     uint32_t line;
+    uint32_t depth;         ///< Number of times the owning thread has locked the mutex.
+    uint32_t profileCount;  ///< Acquisitions since the profiler last sampled this mutex.
+    uint64_t holdStart;     ///< Time the sampled acquisition began, 0 if the hold time is not being measured.
+    MutexSite* profileSite; ///< Lock site of the sampled acquisition.
+
+    QStatus ProfiledLock(const char* file, uint32_t line);  ///< Lock(file, line) while the profiler is on
+    void Unlocking();       ///< Bookkeeping before the mutex is released
+    void EndHoldSample();   ///< Record the hold time of a sampled acquisition
+    uint32_t BeginWait();   ///< Called by Condition before a wait releases the mutex
+    void EndWait(uint32_t depth);  ///< Called by Condition after a wait has reacquired the mutex
 
     /**
      * Give the condition variable class access to the underlying mutex so it
@@ -72,6 +72,32 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem)
     return __atomic_dec(mem) - 1;
 }
 
+/**
+ * Atomically replace an int32_t if it still holds an expected value.
+ *
+ * @param mem            Pointer to int32_t to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue)
+{
+    return __sync_bool_compare_and_swap(mem, expectedValue, newValue);
+}
+
+/**
+ * Atomically replace a pointer if it still holds an expected value.
+ *
+ * @param mem            Pointer to the pointer to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchangePointer(void* volatile* mem, void* expectedValue, void* newValue)
+{
+    return __sync_bool_compare_and_swap(mem, expectedValue, newValue);
+}
+
 #elif defined(QCC_OS_LINUX)
 
 /**
@@ -94,6 +120,30 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem) {
     return __sync_sub_and_fetch(mem, 1);
 }
 
+/**
+ * Atomically replace an int32_t if it still holds an expected value.
+ *
+ * @param mem            Pointer to int32_t to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue) {
+    return __sync_bool_compare_and_swap(mem, expectedValue, newValue);
+}
+
+/**
+ * Atomically replace a pointer if it still holds an expected value.
+ *
+ * @param mem            Pointer to the pointer to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchangePointer(void* volatile* mem, void* expectedValue, void* newValue) {
+    return __sync_bool_compare_and_swap(mem, expectedValue, newValue);
+}
+
 #elif defined(QCC_OS_DARWIN)
 
 /**
@@ -116,6 +166,30 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem) {
     return OSAtomicDecrement32(mem);
 }
 
+/**
+ * Atomically replace an int32_t if it still holds an expected value.
+ *
+ * @param mem            Pointer to int32_t to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue) {
+    return OSAtomicCompareAndSwap32Barrier(expectedValue, newValue, mem);
+}
+
+/**
+ * Atomically replace a pointer if it still holds an expected value.
+ *
+ * @param mem            Pointer to the pointer to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchangePointer(void* volatile* mem, void* expectedValue, void* newValue) {
+    return OSAtomicCompareAndSwapPtrBarrier(expectedValue, newValue, mem);
+}
+
 #else
 
 /**
@@ -134,6 +208,26 @@ int32_t IncrementAndFetch(volatile int32_t* mem);
  */
 int32_t DecrementAndFetch(volatile int32_t* mem);
 
+/**
+ * Atomically replace an int32_t if it still holds an expected value.
+ *
+ * @param mem            Pointer to int32_t to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue);
+
+/**
+ * Atomically replace a pointer if it still holds an expected value.
+ *
+ * @param mem            Pointer to the pointer to be replaced.
+ * @param expectedValue  Value *mem must hold for the exchange to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true if *mem held expectedValue and was replaced with newValue.
+ */
+bool CompareAndExchangePointer(void* volatile* mem, void* expectedValue, void* newValue);
+
 #endif
 
 }
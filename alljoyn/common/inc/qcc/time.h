@@ -122,6 +122,13 @@ uint32_t GetTimestamp(void);
  */
 uint64_t GetTimestamp64(void);
 
+/**
+ * Return (non-absolute) monotonic timestamp in microseconds.  This is meant
+ * for measuring short intervals.
+ * @return  timestamp in microseconds.
+ */
+uint64_t GetTimestampMicros(void);
+
 /**
  * Return (non-absolute) timestamp in milliseconds since Epoch.
  * @return  timestamp in milliseconds.
@@ -55,7 +55,9 @@ Condition::~Condition()
 
 QStatus Condition::Wait(qcc::Mutex& m)
 {
+    uint32_t depth = m.BeginWait();
     int ret = pthread_cond_wait(&c, &m.mutex);
+    m.EndWait(depth);
     if (ret != 0) {
         QCC_LogError(ER_OS_ERROR, ("Condition::Wait(): Cannot wait on pthread condition variable (%d)", ret));
         return ER_OS_ERROR;
@@ -84,7 +86,9 @@ QStatus Condition::TimedWait(qcc::Mutex& m, uint32_t ms)
     tsTimeout.tv_nsec %= 1000000000;
     tsTimeout.tv_sec += tsNow.tv_sec;
 
+    uint32_t depth = m.BeginWait();
     int ret = pthread_cond_timedwait(&c, &m.mutex, &tsTimeout);
+    m.EndWait(depth);
     if (ret == 0) {
         return ER_OK;
     }
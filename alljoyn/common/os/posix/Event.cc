@@ -53,6 +53,8 @@
 #include <sys/event.h>
 #include <sys/time.h>
 #else
+#include <limits.h>
+#include <poll.h>
 #include <sys/epoll.h>
 #endif
 
@@ -169,29 +171,21 @@ QStatus Event::Wait(Event& evt, uint32_t maxWaitMs)
     }
 }
 #else
+/*
+ * A single event plus the thread's stop event are waited on with poll() rather
+ * than epoll so that the wait does not have to create and destroy an epoll
+ * instance every time.
+ */
 QStatus Event::Wait(Event& evt, uint32_t maxWaitMs)
 {
-    struct timeval tval;
-    struct timeval* pTval = NULL;
+    int timeoutMs = (maxWaitMs == WAIT_FOREVER) ? -1 : static_cast<int>(min(maxWaitMs, static_cast<uint32_t>(INT_MAX)));
 
     Thread* thread = Thread::GetThread();
 
-#if defined(QCC_OS_LINUX)
-    int epollfd = epoll_create1(0);
-#elif defined (QCC_OS_ANDROID)
-    int epollfd = epoll_create(2);
-#endif
-
-    if (epollfd == -1) {
-        QCC_LogError(ER_OS_ERROR, ("epoll_create failed with %d (%s)", errno, strerror(errno)));
-        return ER_OS_ERROR;
-    }
-    struct epoll_event ev, events[2];
-    if (maxWaitMs != WAIT_FOREVER) {
-        tval.tv_sec = maxWaitMs / 1000;
-        tval.tv_usec = (maxWaitMs % 1000) * 1000;
-        pTval = &tval;
-    }
+    struct pollfd fds[2];
+    nfds_t numFds = 0;
+    int evtIndex = -1;
+    int stopIndex = -1;
 
     if (evt.eventType == TIMED) {
         uint32_t now = GetTimestamp();
@@ -199,101 +193,48 @@ QStatus Event::Wait(Event& evt, uint32_t maxWaitMs)
             if (0 < evt.period) {
                 evt.timestamp += (((now - evt.timestamp) / evt.period) + 1) * evt.period;
             }
-            close(epollfd);
             return ER_OK;
-        } else if (!pTval || ((evt.timestamp - now) < (uint32_t) (tval.tv_sec * 1000 + tval.tv_usec / 1000))) {
-            tval.tv_sec = (evt.timestamp - now) / 1000;
-            tval.tv_usec = 1000 * ((evt.timestamp - now) % 1000);
-            pTval = &tval;
-        }
-    } else {
-        if (0 <= evt.fd) {
-            ev.events = (evt.eventType == IO_WRITE) ? EPOLLOUT : EPOLLIN;
-            ev.data.fd = evt.fd;
-            if (epoll_ctl(epollfd, EPOLL_CTL_ADD, evt.fd, &ev) == -1) {
-                if (errno == EEXIST) {
-                    QCC_DbgPrintf(("Duplicate epoll_ctl add for fd %u", evt.fd));
-                } else {
-                    QCC_LogError(ER_OS_ERROR, ("epoll_ctl add failed for fd %u with %d (%s)", evt.fd, errno, strerror(errno)));
-                    close(epollfd);
-                    return ER_OS_ERROR;
-                }
-            }
-        } else if (0 <= evt.ioFd) {
-            ev.events = (evt.eventType == IO_WRITE) ? EPOLLOUT : EPOLLIN;
-            ev.data.fd = evt.ioFd;
-            if (epoll_ctl(epollfd, EPOLL_CTL_ADD, evt.ioFd, &ev) == -1) {
-                if (errno == EEXIST) {
-                    QCC_DbgPrintf(("Duplicate epoll_ctl add for fd %u", evt.ioFd));
-                } else {
-                    QCC_LogError(ER_OS_ERROR, ("epoll_ctl add failed for fd %u with %d (%s)", evt.ioFd, errno, strerror(errno)));
-                    close(epollfd);
-                    return ER_OS_ERROR;
-                }
-            }
+        } else if ((timeoutMs < 0) || ((evt.timestamp - now) < static_cast<uint32_t>(timeoutMs))) {
+            timeoutMs = evt.timestamp - now;
         }
+    } else if ((0 <= evt.fd) || (0 <= evt.ioFd)) {
+        evtIndex = numFds++;
+        fds[evtIndex].fd = (0 <= evt.fd) ? evt.fd : evt.ioFd;
+        fds[evtIndex].events = (evt.eventType == IO_WRITE) ? POLLOUT : POLLIN;
+        fds[evtIndex].revents = 0;
     }
 
-    int stopFd = -1;
     if (thread) {
-        stopFd = thread->GetStopEvent().fd;
-        ev.events = EPOLLIN;
-        ev.data.fd = stopFd;
-        if (epoll_ctl(epollfd, EPOLL_CTL_ADD, stopFd, &ev) == -1) {
-            if (errno == EEXIST) {
-                QCC_DbgPrintf(("Duplicate epoll_ctl add for fd %u", stopFd));
-            } else {
-                QCC_LogError(ER_OS_ERROR, ("epoll_ctl add failed for fd %u with %d (%s)", stopFd, errno, strerror(errno)));
-                close(epollfd);
-                return ER_OS_ERROR;
-            }
-        }
+        stopIndex = numFds++;
+        fds[stopIndex].fd = thread->GetStopEvent().fd;
+        fds[stopIndex].events = POLLIN;
+        fds[stopIndex].revents = 0;
     }
 
     evt.IncrementNumThreads();
 
-    int ret = epoll_wait(epollfd, events, 2, pTval ? ((pTval->tv_sec * 1000) + (pTval->tv_usec / 1000)) : -1);
+    int ret = poll(fds, numFds, timeoutMs);
 
     evt.DecrementNumThreads();
 
-    if (0 < ret && 0 <= stopFd) {
-        for (int n = 0; n < ret; ++n) {
-            if ((events[n].events & EPOLLIN) && events[n].data.fd == stopFd) {
-                close(epollfd);
-                return thread->IsStopping() ? ER_STOPPING_THREAD : ER_ALERTED_THREAD;
-            }
-        }
+    if ((0 < ret) && (0 <= stopIndex) && (fds[stopIndex].revents & POLLIN)) {
+        return thread->IsStopping() ? ER_STOPPING_THREAD : ER_ALERTED_THREAD;
     }
-    if (0 <= ret && evt.eventType == TIMED) {
+    if ((0 <= ret) && (evt.eventType == TIMED)) {
         uint32_t now = GetTimestamp();
         if (now >= evt.timestamp) {
             if (0 < evt.period) {
                 evt.timestamp += (((now - evt.timestamp) / evt.period) + 1) * evt.period;
             }
-            close(epollfd);
             return ER_OK;
         } else {
-            close(epollfd);
             return ER_TIMEOUT;
         }
-    } else if ((0 < ret) && ((0 <= evt.fd) || (0 <= evt.ioFd))) {
-        for (int n = 0; n < ret; ++n) {
-            if ((events[n].events & EPOLLOUT) && evt.eventType == IO_WRITE && (events[n].data.fd == evt.fd || events[n].data.fd == evt.ioFd)) {
-                close(epollfd);
-                return ER_OK;
-            }
-            if ((events[n].events & EPOLLIN) && (evt.eventType == IO_READ || evt.eventType == GEN_PURPOSE) && (events[n].data.fd == evt.fd || events[n].data.fd == evt.ioFd)) {
-                close(epollfd);
-                return ER_OK;
-            }
-        }
-        close(epollfd);
-        return ER_TIMEOUT;
+    } else if ((0 < ret) && (0 <= evtIndex)) {
+        return (fds[evtIndex].revents & fds[evtIndex].events) ? ER_OK : ER_TIMEOUT;
     } else if (0 <= ret) {
-        close(epollfd);
         return ER_TIMEOUT;
     } else {
-        close(epollfd);
         return ER_FAIL;
     }
 }
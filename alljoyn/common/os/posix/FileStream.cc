@@ -131,7 +131,7 @@ void FileSource::Unlock()
     }
 }
 
-FileSink::FileSink(qcc::String fileName, Mode mode)
+FileSink::FileSink(qcc::String fileName, Mode mode, bool append)
     : fd(-1), event(new Event(fd, Event::IO_WRITE)), ownsFd(true), locked(false)
 {
 #ifdef QCC_OS_ANDROID
@@ -185,7 +185,7 @@ FileSink::FileSink(qcc::String fileName, Mode mode)
     }
 
     /* Create and open the file */
-    fd = open(fileName.c_str(), O_CREAT | O_WRONLY | O_TRUNC, fileMode);
+    fd = open(fileName.c_str(), O_CREAT | O_WRONLY | (append ? O_APPEND : O_TRUNC), fileMode);
     if (0 > fd) {
         QCC_LogError(ER_OS_ERROR, ("open(%s) failed with '%s'", fileName.c_str(), strerror(errno)));
     }
@@ -28,7 +28,9 @@
 
 #include <qcc/Thread.h>
 #include <qcc/Mutex.h>
+#include <qcc/MutexProfiler.h>
 #include <qcc/Debug.h>
+#include <qcc/time.h>
 
 #include <Status.h>
 
@@ -40,6 +42,10 @@ using namespace qcc;
 void Mutex::Init()
 {
     isInitialized = false;
+    depth = 0;
+    profileCount = 0;
+    holdStart = 0;
+    profileSite = NULL;
     int ret;
     pthread_mutexattr_t attr;
     ret = pthread_mutexattr_init(&attr);
@@ -99,11 +105,15 @@ QStatus Mutex::Lock()
         assert(false);
         return ER_OS_ERROR;
     }
+    ++depth;
     return ER_OK;
 }
 
 QStatus Mutex::Lock(const char* file, uint32_t line)
 {
+    if (MutexProfiler::IsEnabled()) {
+        return ProfiledLock(file, line);
+    }
 #ifdef NDEBUG
     return Lock();
 #else
@@ -130,12 +140,68 @@ QStatus Mutex::Lock(const char* file, uint32_t line)
 #endif
 }
 
+QStatus Mutex::ProfiledLock(const char* file, uint32_t line)
+{
+    if (!isInitialized) {
+        return ER_INIT_FAILED;
+    }
+
+    /* Only read the clock for the wait if the lock is contended */
+    uint64_t waitStart = 0;
+    QStatus status = ER_OK;
+    if (!TryLock()) {
+        waitStart = GetTimestampMicros();
+        status = Lock();
+    }
+    if (status == ER_OK) {
+        if (depth == 1) {
+            profileSite = MutexProfiler::Acquired(file, line, waitStart, profileCount, holdStart);
+        }
+        this->file = file;
+        this->line = line;
+    }
+    return status;
+}
+
+void Mutex::Unlocking()
+{
+    if ((--depth == 0) && holdStart) {
+        EndHoldSample();
+    }
+}
+
+void Mutex::EndHoldSample()
+{
+    MutexProfiler::Released(profileSite, holdStart);
+    holdStart = 0;
+}
+
+uint32_t Mutex::BeginWait()
+{
+    /*
+     * Other threads may lock the mutex while this thread waits, so it has to
+     * look unlocked to them.
+     */
+    uint32_t waitDepth = depth;
+    depth = 0;
+    if (holdStart) {
+        EndHoldSample();
+    }
+    return waitDepth;
+}
+
+void Mutex::EndWait(uint32_t waitDepth)
+{
+    depth = waitDepth;
+}
+
 QStatus Mutex::Unlock()
 {
     if (!isInitialized) {
         return ER_INIT_FAILED;
     }
 
+    Unlocking();
     int ret = pthread_mutex_unlock(&mutex);
     if (ret != 0) {
         fflush(stdout);
@@ -155,6 +221,7 @@ QStatus Mutex::Unlock(const char* file, uint32_t line)
     if (!isInitialized) {
         return ER_INIT_FAILED;
     }
+    Unlocking();
     this->file = NULL;
     this->line = -1;
     int ret = pthread_mutex_unlock(&mutex);
@@ -173,5 +240,9 @@ bool Mutex::TryLock(void)
     if (!isInitialized) {
         return false;
     }
-    return pthread_mutex_trylock(&mutex) == 0;
+    if (pthread_mutex_trylock(&mutex) != 0) {
+        return false;
+    }
+    ++depth;
+    return true;
 }
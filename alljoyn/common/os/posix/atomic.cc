@@ -46,6 +46,32 @@ int32_t DecrementAndFetch(volatile int32_t* mem)
     return ret;
 }
 
+bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue)
+{
+    bool exchanged = false;
+
+    pthread_mutex_lock(&atomicLock);
+    if (*mem == expectedValue) {
+        *mem = newValue;
+        exchanged = true;
+    }
+    pthread_mutex_unlock(&atomicLock);
+    return exchanged;
+}
+
+bool CompareAndExchangePointer(void* volatile* mem, void* expectedValue, void* newValue)
+{
+    bool exchanged = false;
+
+    pthread_mutex_lock(&atomicLock);
+    if (*mem == expectedValue) {
+        *mem = newValue;
+        exchanged = true;
+    }
+    pthread_mutex_unlock(&atomicLock);
+    return exchanged;
+}
+
 }
 
 #endif
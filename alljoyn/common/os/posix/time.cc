@@ -92,6 +92,21 @@ uint64_t qcc::GetTimestamp64(void)
     return ret_val;
 }
 
+uint64_t qcc::GetTimestampMicros(void)
+{
+#if defined(QCC_OS_DARWIN)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (mach_absolute_time() * timebase.numer) / (timebase.denom * 1000);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000);
+#endif
+}
+
 uint64_t qcc::GetEpochTimestamp(void)
 {
     struct timespec ts;
@@ -46,7 +46,9 @@ QStatus Condition::Wait(qcc::Mutex& m)
 
 QStatus Condition::TimedWait(qcc::Mutex& m, uint32_t ms)
 {
+    uint32_t depth = m.BeginWait();
     bool ret = SleepConditionVariableCS(&c, &m.mutex, ms);
+    m.EndWait(depth);
     if (ret == true) {
         return ER_OK;
     }
@@ -171,7 +171,7 @@ void FileSource::Unlock()
     }
 }
 
-FileSink::FileSink(qcc::String fileName, Mode mode) : handle(INVALID_HANDLE_VALUE), event(&Event::alwaysSet), ownsHandle(true), locked(false)
+FileSink::FileSink(qcc::String fileName, Mode mode, bool append) : handle(INVALID_HANDLE_VALUE), event(&Event::alwaysSet), ownsHandle(true), locked(false)
 {
     ReSlash(fileName);
 
@@ -239,12 +239,14 @@ FileSink::FileSink(qcc::String fileName, Mode mode) : handle(INVALID_HANDLE_VALU
                          GENERIC_WRITE,
                          FILE_SHARE_READ,
                          NULL,
-                         CREATE_ALWAYS,
+                         append ? OPEN_ALWAYS : CREATE_ALWAYS,
                          attributes,
                          INVALID_HANDLE_VALUE);
 
     if (INVALID_HANDLE_VALUE == handle) {
         QCC_LogError(ER_OS_ERROR, ("CreateFile(GENERIC_WRITE) %s failed (%d)", fileName.c_str(), ::GetLastError()));
+    } else if (append && (INVALID_SET_FILE_POINTER == SetFilePointer(handle, 0, NULL, FILE_END))) {
+        QCC_LogError(ER_OS_ERROR, ("SetFilePointer(FILE_END) %s failed (%d)", fileName.c_str(), ::GetLastError()));
     }
 }
 
@@ -28,6 +28,8 @@
 
 #include <qcc/Thread.h>
 #include <qcc/Mutex.h>
+#include <qcc/MutexProfiler.h>
+#include <qcc/time.h>
 #include <qcc/windows/utility.h>
 
 /** @internal */
@@ -43,6 +45,10 @@ using namespace qcc;
 
 void Mutex::Init()
 {
+    depth = 0;
+    profileCount = 0;
+    holdStart = 0;
+    profileSite = NULL;
     if (!initialized) {
         // Starting with Vista this always returns non-zero so this test will be less and less important
         // in the future (http://msdn.microsoft.com/en-us/library/windows/desktop/ms683476.aspx)
@@ -72,11 +78,15 @@ QStatus Mutex::Lock(void)
         return ER_INIT_FAILED;
     }
     EnterCriticalSection(&mutex);
+    ++depth;
     return ER_OK;
 }
 
 QStatus Mutex::Lock(const char* file, uint32_t line)
 {
+    if (MutexProfiler::IsEnabled()) {
+        return ProfiledLock(file, line);
+    }
 #if NO_LOCK_TRACE
     return Lock();
 #else
@@ -96,11 +106,62 @@ QStatus Mutex::Lock(const char* file, uint32_t line)
 #endif
 }
 
+QStatus Mutex::ProfiledLock(const char* file, uint32_t line)
+{
+    if (!initialized) {
+        return ER_INIT_FAILED;
+    }
+
+    /* Only read the clock for the wait if the lock is contended */
+    uint64_t waitStart = 0;
+    if (!TryLock()) {
+        waitStart = GetTimestampMicros();
+        Lock();
+    }
+    if (depth == 1) {
+        profileSite = MutexProfiler::Acquired(file, line, waitStart, profileCount, holdStart);
+    }
+    return ER_OK;
+}
+
+void Mutex::Unlocking()
+{
+    if ((--depth == 0) && holdStart) {
+        EndHoldSample();
+    }
+}
+
+void Mutex::EndHoldSample()
+{
+    MutexProfiler::Released(profileSite, holdStart);
+    holdStart = 0;
+}
+
+uint32_t Mutex::BeginWait()
+{
+    /*
+     * Other threads may lock the mutex while this thread waits, so it has to
+     * look unlocked to them.
+     */
+    uint32_t waitDepth = depth;
+    depth = 0;
+    if (holdStart) {
+        EndHoldSample();
+    }
+    return waitDepth;
+}
+
+void Mutex::EndWait(uint32_t waitDepth)
+{
+    depth = waitDepth;
+}
+
 QStatus Mutex::Unlock(void)
 {
     if (!initialized) {
         return ER_INIT_FAILED;
     }
+    Unlocking();
     LeaveCriticalSection(&mutex);
     return ER_OK;
 }
@@ -123,5 +184,9 @@ bool Mutex::TryLock(void)
     if (!initialized) {
         return false;
     }
-    return TryEnterCriticalSection(&mutex);
+    if (!TryEnterCriticalSection(&mutex)) {
+        return false;
+    }
+    ++depth;
+    return true;
 }
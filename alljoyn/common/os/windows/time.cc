@@ -79,6 +79,17 @@ uint64_t qcc::GetTimestamp64(void)
     return ret_val + base;
 }
 
+uint64_t qcc::GetTimestampMicros(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((counter.QuadPart / frequency.QuadPart) * 1000000 + ((counter.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart);
+}
+
 uint64_t qcc::GetEpochTimestamp(void)
 {
     return GetTimestamp64();
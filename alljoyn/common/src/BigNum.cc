@@ -1141,77 +1141,231 @@ static uint32_t monty_rho(uint64_t b)
     return (uint32_t)-x;
 }
 
-BigNum& BigNum::monty_mul(BigNum& r, const BigNum& n, const BigNum& m, uint32_t rho) const
+// Montgomery multiplication on raw digit arrays. The scratch buffer means no allocation is done here.
+void BigNum::monty_mul(uint32_t* r, const uint32_t* x, const uint32_t* y, const uint32_t* m, size_t len, uint32_t rho, uint32_t* t)
 {
-    size_t len = m.length;
-    assert(length <= len);
-    assert(n.length <= len);
-
-    // Zero pad inputs if needed
-    BigNum x = (length < len) ? clone(len - length) : *this;
-    BigNum y = (n.length < len) ? n.clone(len - n.length) : n;
-
-    r.reset(len + 1);
-    // This avoids a final shift right
-    ++r.digits;
+    memset(t, 0, (len + 1) * sizeof(uint32_t));
     for (size_t i = 0; i < len; ++i) {
-        uint64_t X = x.digits[i];
-        uint32_t u = (r.digits[0] + X * y.digits[0]) * rho;
-        uint64_t carry = 0;
-        uint64_t R;
-        uint32_t* rd = r.digits;
-        for (size_t j = 0; j < len; ++j, ++rd) {
-            uint64_t Y = X * y.digits[j];
-            uint64_t M = (uint64_t)u * m.digits[j];
-            R = (uint64_t)*rd + carry + (uint32_t)Y + (uint32_t)M;
+        uint64_t X = x[i];
+        uint64_t Y = X * y[0];
+        uint32_t u = (t[0] + (uint32_t)Y) * rho;
+        uint64_t M = (uint64_t)u * m[0];
+        // The low digit is zero by the choice of u so only the carry is kept
+        uint64_t R = (uint64_t)t[0] + (uint32_t)Y + (uint32_t)M;
+        uint64_t carry = (R >> 32) + (Y >> 32) + (M >> 32);
+        for (size_t j = 1; j < len; ++j) {
+            Y = X * y[j];
+            M = (uint64_t)u * m[j];
+            R = (uint64_t)t[j] + carry + (uint32_t)Y + (uint32_t)M;
             carry = (R >> 32) + (Y >> 32) + (M >> 32);
-            *(rd - 1) = (uint32_t)R;
+            t[j - 1] = (uint32_t)R;
         }
-        R = (uint64_t)*rd + carry;
-        carry = (R >> 32);
-        *(rd - 1) = (uint32_t)R;
-        *rd = (uint32_t)carry;
+        R = (uint64_t)t[len] + carry;
+        t[len - 1] = (uint32_t)R;
+        t[len] = (uint32_t)(R >> 32);
+    }
+    // The result is less than 2m so a single conditional subtraction reduces it
+    bool ge = (t[len] != 0);
+    if (!ge) {
+        size_t j = len;
+        while (j && (t[j - 1] == m[j - 1])) {
+            --j;
+        }
+        ge = (j == 0) || (t[j - 1] > m[j - 1]);
+    }
+    if (ge) {
+        uint64_t borrow = 0;
+        for (size_t j = 0; j < len; ++j) {
+            uint64_t d = (uint64_t)t[j] - m[j] - borrow;
+            borrow = d >> 63;
+            r[j] = (uint32_t)d;
+        }
+    } else {
+        memcpy(r, t, len * sizeof(uint32_t));
     }
+}
 
-    if (r >= m) {
-        r.sub(m);
+// Convert to the Montgomery domain by computing (this * R) % m
+void BigNum::monty_enter(uint32_t* d, const BigNum& m) const
+{
+    BigNum x = (*this << (uint32_t)(m.length * 32)) % m;
+    if (x.neg) {
+        x += m;
     }
+    assert(x.length <= m.length);
+    memset(d, 0, m.length * sizeof(uint32_t));
+    memcpy(d, x.digits, x.length * sizeof(uint32_t));
+}
+
+// Convert out of the Montgomery domain by multiplying by 1
+BigNum BigNum::monty_leave(const uint32_t* d, const BigNum& m, uint32_t rho, uint32_t* t)
+{
+    size_t len = m.length;
+    BigNum r(len, false);
+    memset(r.digits, 0, len * sizeof(uint32_t));
+    r.digits[0] = 1;
+    monty_mul(r.digits, r.digits, d, m.digits, len, rho, t);
     return strip_lz(r);
 }
 
-// Modular exponentiation using Montgomery multiplication
+// Window size for sliding window exponentiation chosen to minimize the number of multiplications
+static size_t monty_window(size_t bits)
+{
+    if (bits > 671) {
+        return 6;
+    } else if (bits > 239) {
+        return 5;
+    } else if (bits > 79) {
+        return 4;
+    } else if (bits > 23) {
+        return 3;
+    } else {
+        return 1;
+    }
+}
+
+// Modular exponentiation using Montgomery multiplication and a sliding window over the exponent
 BigNum BigNum::monty_mod_exp(const BigNum& e, const BigNum& m) const
 {
     assert(m.is_odd());
     uint32_t rho = monty_rho(m.digits[0]);
+    size_t len = m.length;
+    size_t bits = e.bit_len();
+    size_t w = monty_window(bits);
+    size_t numPowers = (size_t)1 << (w - 1);
+
+    // Single allocation for the odd powers, the accumulator, x^2 and the multiplier scratch
+    BigNum work((numPowers + 2) * len + len + 1, false);
+    uint32_t* powers = work.digits;
+    uint32_t* acc = powers + numPowers * len;
+    uint32_t* sq = acc + len;
+    uint32_t* t = sq + len;
+
+    // powers[i] holds x^(2i + 1) in the Montgomery domain
+    monty_enter(powers, m);
+    if (numPowers > 1) {
+        monty_mul(sq, powers, powers, m.digits, len, rho, t);
+        for (size_t i = 1; i < numPowers; ++i) {
+            monty_mul(powers + i * len, powers + (i - 1) * len, sq, m.digits, len, rho, t);
+        }
+    }
 
-    BigNum R = 1;
-    BigNum RR = 1;
-
-    R.reset(m.length + 1);
-    R.msdigit() = 1;
-    RR.reset(m.length * 2 + 1);
-    RR.msdigit() = 1;
-
-    BigNum x;
-    BigNum a = R % m;
-
-    // Convert to Montgomery domain
-    this->monty_mul(x, RR % m, m, rho);
-
-    BigNum tmp1;
-    BigNum tmp2;
-
-    size_t i = e.bit_len();
+    // The accumulator starts as 1 in the Montgomery domain
+    BigNum(1).monty_enter(acc, m);
+    bool started = false;
+    size_t i = bits;
     while (i) {
-        a = a.monty_mul(tmp1, a, m, rho);
-        if (e.test_bit(--i)) {
-            a = a.monty_mul(tmp2, x, m, rho);
+        if (!e.test_bit(i - 1)) {
+            if (started) {
+                monty_mul(acc, acc, acc, m.digits, len, rho, t);
+            }
+            --i;
+            continue;
+        }
+        // Longest window ending in a set bit
+        size_t lo = (i > w) ? i - w : 0;
+        while (!e.test_bit(lo)) {
+            ++lo;
+        }
+        uint32_t val = 0;
+        for (size_t b = i; b > lo; --b) {
+            val = (val << 1) | (e.test_bit(b - 1) ? 1 : 0);
+            if (started) {
+                monty_mul(acc, acc, acc, m.digits, len, rho, t);
+            }
+        }
+        if (started) {
+            monty_mul(acc, acc, powers + (val >> 1) * len, m.digits, len, rho, t);
         } else {
-            tmp1 = tmp2;
-            tmp2 = a;
+            memcpy(acc, powers + (val >> 1) * len, len * sizeof(uint32_t));
+            started = true;
+        }
+        i = lo;
+    }
+    return monty_leave(acc, m, rho, t);
+}
+
+BigNum::FixedBase::FixedBase(const BigNum& base, const BigNum& mod, size_t maxExpBits) :
+    base(base), mod(mod), rho(0), window(0), count(0)
+{
+    if (!mod.is_odd()) {
+        return;
+    }
+    // Pick the window that minimizes the multiplications for an exponent of maxExpBits
+    size_t best = 0;
+    for (size_t w = 1; w <= 8; ++w) {
+        size_t n = (maxExpBits + w - 1) / w;
+        size_t cost = n + ((size_t)1 << w);
+        if (!window || (cost < best)) {
+            best = cost;
+            window = w;
+            count = n;
+        }
+    }
+    rho = monty_rho(mod.digits[0]);
+    size_t len = mod.length;
+    powers.reset(count * len + len + 1);
+    uint32_t* t = powers.digits + count * len;
+
+    // powers[i] holds base^(2^(window * i)) in the Montgomery domain
+    base.monty_enter(powers.digits, mod);
+    for (size_t i = 1; i < count; ++i) {
+        uint32_t* p = powers.digits + i * len;
+        memcpy(p, p - len, len * sizeof(uint32_t));
+        for (size_t j = 0; j < window; ++j) {
+            monty_mul(p, p, p, mod.digits, len, rho, t);
+        }
+    }
+    one.reset(len);
+    BigNum(1).monty_enter(one.digits, mod);
+}
+
+// Brickell, Gordon, McCurley and Wilson fixed base exponentiation. Writing the exponent as
+// digits e[i] in base 2^window the result is the product over d of (product of powers[i] with
+// e[i] >= d), which needs at most count + 2^window multiplications and no squarings.
+BigNum BigNum::FixedBase::mod_exp(const BigNum& e) const
+{
+    size_t bits = e.bit_len();
+    if (!count || (bits > window * count)) {
+        return base.mod_exp(e, mod);
+    }
+    size_t len = mod.length;
+    size_t numDigits = (bits + window - 1) / window;
+    BigNum work(3 * len + 1, false);
+    uint32_t* a = work.digits;
+    uint32_t* b = a + len;
+    uint32_t* t = b + len;
+
+    memcpy(a, one.digits, len * sizeof(uint32_t));
+    memcpy(b, one.digits, len * sizeof(uint32_t));
+    bool aIsOne = true;
+    bool bIsOne = true;
+    uint32_t mask = (1 << window) - 1;
+    for (uint32_t d = mask; d > 0; --d) {
+        for (size_t i = 0; i < numDigits; ++i) {
+            size_t bit = i * window;
+            uint32_t ei = e.digits[bit >> 5] >> (bit & 0x1F);
+            if (((bit & 0x1F) + window > 32) && ((bit >> 5) + 1 < e.length)) {
+                ei |= e.digits[(bit >> 5) + 1] << (32 - (bit & 0x1F));
+            }
+            if ((ei & mask) == d) {
+                const uint32_t* p = powers.digits + i * len;
+                if (bIsOne) {
+                    memcpy(b, p, len * sizeof(uint32_t));
+                    bIsOne = false;
+                } else {
+                    monty_mul(b, b, p, mod.digits, len, rho, t);
+                }
+            }
+        }
+        if (!bIsOne) {
+            if (aIsOne) {
+                memcpy(a, b, len * sizeof(uint32_t));
+                aIsOne = false;
+            } else {
+                monty_mul(a, a, b, mod.digits, len, rho, t);
+            }
         }
     }
-    BigNum r;
-    return a.monty_mul(r, 1, m, rho);
+    return monty_leave(a, mod, rho, t);
 }
@@ -21,6 +21,7 @@
  ******************************************************************************/
 
 #include <qcc/platform.h>
+#include <assert.h>
 #include <qcc/Util.h>
 
 #include <qcc/Debug.h>
@@ -164,8 +165,14 @@ static boolean_t big_is_zero(bigval_t const* a);
    but on Windows machines and if loops are unrolled (SMALL_CODE not
    defined) actually causes slight slowing. */
 #define SPECIAL_SQUARE
-/* define MPY2BITS to consume the multiplier two bits at a time. */
-#define MPY2BITS
+
+/*
+ * With a 128 bit integer type the schoolbook product in big_mpyP is done
+ * on 64 bit limbs, 25 multiplies in place of 81.
+ */
+#if defined(__SIZEOF_INT128__) && !defined(ARM7_ASM) && !defined(SMALL_CODE)
+#define MPY64
+#endif
 
 
 #ifdef ECC_TEST
@@ -310,7 +317,7 @@ static affine_point_t const baseP256 = {
 #define ACCUM(ap, bp) MULACC(*(ap), *(bp))
 #define ACCUMDBL(ap, bp) MULACC_DOUBLE(*(ap), *(bp))
 
-#else /* ARM7_ASM, below is platform independent */
+#elif !defined(MPY64) /* below is platform independent */
 
 /* (sum, carry) += a * b */
 static void
@@ -352,7 +359,7 @@ mpy_accum_dbl(int* cumcarry, uint64_t* sum, uint32_t a, uint32_t b)
 #define ACCUM(ap, bp) mpy_accum(&cum_carry, &u_accum, *(ap),  *(bp))
 #define ACCUMDBL(ap, bp) mpy_accum_dbl(&cum_carry, &u_accum, *(ap),  *(bp))
 
-#endif /* !ARM7_ASM, ie platform independent */
+#endif /* !ARM7_ASM && !MPY64, ie platform independent */
 
 
 /*
@@ -388,6 +395,41 @@ mpy_accum_dbl(int* cumcarry, uint64_t* sum, uint32_t a, uint32_t b)
  * is ignored, and the curve modulus is used.
  */
 
+#ifdef MPY64
+/*
+ * Computes the unsigned product of the 9 word values a and b on 64 bit
+ * limbs and stores it in w as 2 * BIGLEN 32 bit digits, exactly as the
+ * 32 bit multiply loop in big_mpyP leaves it before the sign correction.
+ */
+static void
+big_mpy64(int64_t* w, bigval_t const* a, bigval_t const* b)
+{
+    uint64_t a64[5], b64[5], r[10];
+    int i, j;
+
+    for (i = 0; i < 4; ++i) {
+        a64[i] = a->data[2 * i] | ((uint64_t)a->data[2 * i + 1] << 32);
+        b64[i] = b->data[2 * i] | ((uint64_t)b->data[2 * i + 1] << 32);
+    }
+    a64[4] = a->data[2 * 4];
+    b64[4] = b->data[2 * 4];
+
+    memset(r, 0, sizeof(r));
+    for (i = 0; i < 5; ++i) {
+        uint64_t carry = 0;
+        for (j = 0; j < 5; ++j) {
+            unsigned __int128 t = (unsigned __int128)a64[i] * b64[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[i + 5] = carry;
+    }
+    for (i = 0; i < 2 * BIGLEN; ++i) {
+        w[i] = (r[i / 2] >> (32 * (i & 1))) & 0xffffffffULL;
+    }
+}
+#endif /* MPY64 */
+
 /*
  * Computes a * b, approximately reduced mod modulusP or orderP,
  * depending on the modselect flag.
@@ -398,7 +440,9 @@ big_mpyP(bigval_t* tgt, bigval_t const* a, bigval_t const* b,
 {
     int64_t w[2 * BIGLEN];
     int64_t s_accum; /* signed */
-    int i, minj, maxj, a_words, b_words, cum_carry;
+    int i;
+#ifndef MPY64
+    int minj, maxj, a_words, b_words, cum_carry;
 #ifdef SMALL_CODE
     int j;
 #else
@@ -410,6 +454,7 @@ big_mpyP(bigval_t* tgt, bigval_t const* a, bigval_t const* b,
 #else
     uint64_t u_accum;
 #endif
+#endif /* MPY64 not defined */
 
 #ifdef ECDSA
 #define MODSELECT modselect
@@ -423,6 +468,9 @@ big_mpyP(bigval_t* tgt, bigval_t const* a, bigval_t const* b,
         return;
     }
 
+#ifdef MPY64
+    big_mpy64(w, a, b);
+#else /* MPY64 not defined */
     a_words = BIGLEN;
     while (a_words > 1 && a->data[a_words - 1] == 0) {
         --a_words;
@@ -637,6 +685,7 @@ big_mpyP(bigval_t* tgt, bigval_t const* a, bigval_t const* b,
     w[i] = u_accum;
     /* u_accum = 0; maintain invariant */
 #endif
+#endif /* MPY64 not defined */
 
     /*
      * Apply correction if a or b are negative.  It would be nice to
@@ -1152,7 +1201,8 @@ toAffine(affine_point_t* tgt, jacobian_point_t const* a)
  */
 
 /* tgt = 2 * P.  P->Z must be precisely reduced and
-   tgt->Z will be precisely reduced */
+   tgt->Z will be precisely reduced.  The infinite point needs no
+   special case, Z3 = 2 * Y1 * Z1 so it doubles to a point with Z = 0. */
 static void
 pointDouble(jacobian_point_t* tgt, jacobian_point_t const* P)
 {
@@ -1165,12 +1215,6 @@ pointDouble(jacobian_point_t* tgt, jacobian_point_t const* P)
 #define y3 (&y3loc)
 #define z3 (&z3loc)
 
-    /* This requires P->Z be precisely reduced */
-    if (jacobian_point_is_infinity(P)) {
-        *tgt = jacobian_infinity;
-        return;
-    }
-
     big_sqrP(&t1, z1);
     big_subP(&t2, x1, &t1);
     big_addP(&t1, x1, &t1);
@@ -1206,29 +1250,19 @@ pointDouble(jacobian_point_t* tgt, jacobian_point_t const* P)
 
 /* From [HMV] Algorithm 3.22 */
 
-/* tgt = P + Q.  P->Z must be precisely reduced.
-   tgt->Z will be precisely reduced.  tgt and P can be aliased.
+/* tgt = P + Q without the special cases.  The result is only correct if
+   neither point is infinite and P != Q.  h and r return the differences
+   Z1^2 * x2 - X1 and Z1^3 * y2 - Y1.  Both are zero if P == Q and only h is
+   zero if P == -Q, in which case tgt->Z is zero.  h is precisely reduced, r
+   is not.  P->Z must be precisely reduced.  tgt->Z will be precisely
+   reduced.  tgt and P can be aliased.
  */
 static void
-pointAdd(jacobian_point_t* tgt, jacobian_point_t const* P,
-         affine_point_t const* Q)
+pointAddFormula(jacobian_point_t* tgt, jacobian_point_t const* P,
+                affine_point_t const* Q, bigval_t* h, bigval_t* r)
 {
     bigval_t t1, t2, t3, t4, x3loc;
 
-    if (Q->infinity) {
-        if (tgt != P) {
-            *tgt = *P;
-        }
-        return;
-    }
-
-    /* This requires that P->Z be precisely reduced */
-    if (jacobian_point_is_infinity(P)) {
-        toJacobian(tgt, Q);
-        return;
-    }
-
-
 #define x1 (&P->X)
 #define y1 (&P->Y)
 #define z1 (&P->Z)
@@ -1246,16 +1280,8 @@ pointAdd(jacobian_point_t* tgt, jacobian_point_t const* P,
     big_subP(&t2, &t2, y1);
     /* big_is_zero requires precisely reduced arg */
     big_precise_reduce(&t1, &t1, &modulusP);
-    if (big_is_zero(&t1)) {
-        big_precise_reduce(&t2, &t2, &modulusP);
-        if (big_is_zero(&t2)) {
-            toJacobian(tgt, Q);
-            pointDouble(tgt, tgt);
-        } else {
-            *tgt = jacobian_infinity;
-        }
-        return;
-    }
+    *h = t1;
+    *r = t2;
     /* store into target.  okay, even if tgt is aliased with P,
        as z1 is not subsequently used */
     big_mpyP(z3, z1, &t1, MOD_MODULUS);
@@ -1289,96 +1315,490 @@ pointAdd(jacobian_point_t* tgt, jacobian_point_t const* P,
 
 }
 
-/* pointMpyP uses a left-to-right binary double-and-add method, which
- * is an exact analogy to the left-to-right binary meethod for
- * exponentiation described in [KnuthV2] Section 4.6.3.
+/* tgt = P + Q.  P->Z must be precisely reduced.
+   tgt->Z will be precisely reduced.  tgt and P can be aliased.
+   This branches on the special cases, use pointAddSecret when the
+   points depend on a secret.
  */
+static void
+pointAdd(jacobian_point_t* tgt, jacobian_point_t const* P,
+         affine_point_t const* Q)
+{
+    bigval_t h, r;
+
+    if (Q->infinity) {
+        if (tgt != P) {
+            *tgt = *P;
+        }
+        return;
+    }
+
+    /* This requires that P->Z be precisely reduced */
+    if (jacobian_point_is_infinity(P)) {
+        toJacobian(tgt, Q);
+        return;
+    }
+
+    pointAddFormula(tgt, P, Q, &h, &r);
+    if (big_is_zero(&h)) {
+        big_precise_reduce(&r, &r, &modulusP);
+        if (big_is_zero(&r)) {
+            toJacobian(tgt, Q);
+            pointDouble(tgt, tgt);
+        } else {
+            *tgt = jacobian_infinity;
+        }
+    }
+}
+
+/* Returns all ones if a is zero and zero otherwise, without branching on
+   the value of a.  a must be precisely reduced. */
+static uint32_t
+big_zero_mask(bigval_t const* a)
+{
+    uint32_t acc = 0;
+    int i;
+
+    for (i = 0; i < BIGLEN; ++i) {
+        acc |= a->data[i];
+    }
+    /* (acc | -acc) has its top bit set unless acc is zero */
+    return ((acc | ((uint32_t)0 - acc)) >> 31) - 1;
+}
+
+/* tgt = a where mask is all ones and b where mask is zero */
+static void
+jacobianSelect(jacobian_point_t* tgt, jacobian_point_t const* a,
+               jacobian_point_t const* b, uint32_t mask)
+{
+    uint32_t* dst = (uint32_t*)tgt;
+    uint32_t const* srcA = (uint32_t const*)a;
+    uint32_t const* srcB = (uint32_t const*)b;
+    size_t j;
+
+    for (j = 0; j < sizeof(jacobian_point_t) / sizeof(uint32_t); ++j) {
+        dst[j] = (srcA[j] & mask) | (srcB[j] & ~mask);
+    }
+}
+
+/* tgt = P + Q for points that depend on a secret.  Unlike pointAdd this
+   always computes the sum of the addition formula and the double of Q and
+   picks the result for the special cases with masks, so the point
+   operations do not depend on whether either point is infinite or the
+   points are equal.  P->Z must be precisely reduced.  tgt->Z will be
+   precisely reduced.  tgt and P can be aliased.
+ */
+static void
+pointAddSecret(jacobian_point_t* tgt, jacobian_point_t const* P,
+               affine_point_t const* Q)
+{
+    jacobian_point_t sum, dbl, J;
+    bigval_t h, r;
+    uint32_t pInfinite, qInfinite, equal;
+
+    pInfinite = big_zero_mask(&P->Z);
+    qInfinite = (uint32_t)0 - (uint32_t)(Q->infinity & 1);
+
+    toJacobian(&J, Q);
+    pointDouble(&dbl, &J);
+    pointAddFormula(&sum, P, Q, &h, &r);
+    big_precise_reduce(&r, &r, &modulusP);
+    equal = big_zero_mask(&h) & big_zero_mask(&r);
+
+    /* For P == -Q the formula already gives a point with Z = 0 */
+    jacobianSelect(&sum, &dbl, &sum, equal);
+    jacobianSelect(&sum, &J, &sum, pInfinite);
+    jacobianSelect(tgt, P, &sum, qInfinite);
+}
 
 /* returns bit i of bignum n.  LSB of n is bit 0. */
 #define big_get_bit(n, i) (((n)->data[(i) / 32] >> ((i) % 32)) & 1)
-/* returns bits i+1 and i of bignum n.  LSB of n is bit 0; i <= 30 */
-#define big_get_2bits(n, i) (((n)->data[(i) / 32] >> ((i) % 32)) & 3)
-
-/* k must be non-negative.  Negative values (incorrectly)
-   return the infinite point */
 
+/*
+ * Converts n Jacobian points to affine using a single inversion
+ * (Montgomery's trick, [HMV] Algorithm 2.26).  n must be at most 16.
+ */
 static void
-pointMpyP(affine_point_t* tgt, bigval_t const* k, affine_point_t const* P)
+toAffineBatch(affine_point_t* tgt, jacobian_point_t const* a, int n)
 {
+    bigval_t prod[16];
+    bigval_t inv, zinv, zinvpwr;
     int i;
-    jacobian_point_t Q;
 
-    if (big_is_negative(k)) {
-        /* This should never happen.*/
-        *tgt = affine_infinity;
+    assert(n > 0 && n <= 16);
+
+    prod[0] = a[0].Z;
+    for (i = 1; i < n; ++i) {
+        big_mpyP(&prod[i], &prod[i - 1], &a[i].Z, MOD_MODULUS);
+    }
+    big_precise_reduce(&inv, &prod[n - 1], &modulusP);
+    if (big_is_zero(&inv)) {
+        /* At least one point is infinite. big_divide must not see a zero. */
+        for (i = 0; i < n; ++i) {
+            toAffine(&tgt[i], &a[i]);
+        }
         return;
     }
+    big_divide(&inv, &big_one, &inv, &modulusP);
+
+    for (i = n - 1; i >= 0; --i) {
+        if (i > 0) {
+            big_mpyP(&zinv, &inv, &prod[i - 1], MOD_MODULUS);
+            big_mpyP(&inv, &inv, &a[i].Z, MOD_MODULUS);
+        } else {
+            zinv = inv;
+        }
+        big_sqrP(&zinvpwr, &zinv);  /* Zinv^2 */
+        big_mpyP(&tgt[i].x, &a[i].X, &zinvpwr, MOD_MODULUS);
+        big_mpyP(&zinvpwr, &zinvpwr, &zinv, MOD_MODULUS); /* Zinv^3 */
+        big_mpyP(&tgt[i].y, &a[i].Y, &zinvpwr, MOD_MODULUS);
+        big_precise_reduce(&tgt[i].x, &tgt[i].x, &modulusP);
+        big_precise_reduce(&tgt[i].y, &tgt[i].y, &modulusP);
+        tgt[i].infinity = B_FALSE;
+    }
+}
+
+/*
+ * Copies table[idx] to tgt.  Every entry is read so that the memory access
+ * pattern does not depend on idx.
+ */
+static void
+pointSelect(affine_point_t* tgt, affine_point_t const* table, uint32_t n, uint32_t idx)
+{
+    uint32_t* dst = (uint32_t*)tgt;
+    uint32_t i;
+    size_t j;
+
+    memset(tgt, 0, sizeof(affine_point_t));
+    for (i = 0; i < n; ++i) {
+        uint32_t const* src = (uint32_t const*)&table[i];
+        uint32_t mask = (uint32_t)0 - (uint32_t)(i == idx);
+        for (j = 0; j < U32_AFFINEPOINT_SZ; ++j) {
+            dst[j] |= src[j] & mask;
+        }
+    }
+}
+
+/*
+ * Fixed-base comb for multiples of the base point ([HMV] Algorithm 3.44,
+ * w = 4 with two tables).  The multiplier is cut into four 64 bit rows.
+ * combTable[0][u] is the sum of 2^(64 * j) * G over the set bits j of u, and
+ * combTable[1][u] is 2^32 times that, so a multiple of G costs 32 doublings
+ * and 64 additions.  The additions are done with pointAddSecret since the
+ * multiplier is secret.  The tables were computed offline from base_point.
+ */
+#define COMB_TEETH 4
+#define COMB_SPACING 32
+
+static affine_point_t const combTable[2][1 << COMB_TEETH] = {
+    {
+        { { { 0, 0, 0, 0, 0, 0, 0, 0 } },
+          { { 0, 0, 0, 0, 0, 0, 0, 0 } },
+          B_TRUE },
+        { { { 0xd898c296, 0xf4a13945, 0x2deb33a0, 0x77037d81,
+              0x63a440f2, 0xf8bce6e5, 0xe12c4247, 0x6b17d1f2 } },
+          { { 0x37bf51f5, 0xcbb64068, 0x6b315ece, 0x2bce3357,
+              0x7c0f9e16, 0x8ee7eb4a, 0xfe1a7f9b, 0x4fe342e2 } },
+          B_FALSE },
+        { { { 0x8e14db63, 0x90e75cb4, 0xad651f7e, 0x29493baa,
+              0x326e25de, 0x8492592e, 0x2811aaa5, 0x0fa822bc } },
+          { { 0x5f462ee7, 0xe4112454, 0x50fe82f5, 0x34b1a650,
+              0xb3df188b, 0x6f4ad4bc, 0xf5dba80d, 0xbff44ae8 } },
+          B_FALSE },
+        { { { 0x097992af, 0x93391ce2, 0x0d35f1fa, 0xe96c98fd,
+              0x95e02789, 0xb257c0de, 0x89d6726f, 0x300a4bbc } },
+          { { 0xc08127a0, 0xaa54a291, 0xa9d806a5, 0x5bb1eead,
+              0xff1e3c6f, 0x7f1ddb25, 0xd09b4644, 0x72aac7e0 } },
+          B_FALSE },
+        { { { 0xd789bd85, 0x57c84fc9, 0xc297eac3, 0xfc35ff7d,
+              0x88c6766e, 0xfb982fd5, 0xeedb5e67, 0x447d739b } },
+          { { 0x72e25b32, 0x0c7e33c9, 0xa7fae500, 0x3d349b95,
+              0x3a4aaff7, 0xe12e9d95, 0x834131ee, 0x2d4825ab } },
+          B_FALSE },
+        { { { 0x2a1d367f, 0x13949c93, 0x1a0a11b7, 0xef7fbd2b,
+              0xb91dfc60, 0xddc6068b, 0x8a9c72ff, 0xef951932 } },
+          { { 0x7376d8a8, 0x196035a7, 0x95ca1740, 0x23183b08,
+              0x022c219c, 0xc1ee9807, 0x7dbb2c9b, 0x611e9fc3 } },
+          B_FALSE },
+        { { { 0x0b57f4bc, 0xcae2b192, 0xc6c9bc36, 0x2936df5e,
+              0xe11238bf, 0x7dea6482, 0x7b51f5d8, 0x55066379 } },
+          { { 0x348a964c, 0x44ffe216, 0xdbdefbe1, 0x9fb3d576,
+              0x8d9d50e5, 0x0afa4001, 0x8aecb851, 0x15716484 } },
+          B_FALSE },
+        { { { 0xfc5cde01, 0xe48ecaff, 0x0d715f26, 0x7ccd84e7,
+              0xf43e4391, 0xa2e8f483, 0xb21141ea, 0xeb5d7745 } },
+          { { 0x731a3479, 0xcac917e2, 0x2844b645, 0x85f22cfe,
+              0x58006cee, 0x0990e6a1, 0xdbecc17b, 0xeafd72eb } },
+          B_FALSE },
+        { { { 0x313728be, 0x6cf20ffb, 0xa3c6b94a, 0x96439591,
+              0x44315fc5, 0x2736ff83, 0xa7849276, 0xa6d39677 } },
+          { { 0xc357f5f4, 0xf2bab833, 0x2284059b, 0x824a920c,
+              0x2d27ecdf, 0x66b8babd, 0x9b0b8816, 0x674f8474 } },
+          B_FALSE },
+        { { { 0x677c8a3e, 0x2df48c04, 0x0203a56b, 0x74e02f08,
+              0xb8c7fedb, 0x31855f7d, 0x72c9ddad, 0x4e769e76 } },
+          { { 0xb824bbb0, 0xa4c36165, 0x3b9122a5, 0xfb9ae16f,
+              0x06947281, 0x1ec00572, 0xde830663, 0x42b99082 } },
+          B_FALSE },
+        { { { 0xdda868b9, 0x6ef95150, 0x9c0ce131, 0xd1f89e79,
+              0x08a1c478, 0x7fdc1ca0, 0x1c6ce04d, 0x78878ef6 } },
+          { { 0x1fe0d976, 0x9c62b912, 0xbde08d4f, 0x6ace570e,
+              0x12309def, 0xde53142c, 0x7b72c321, 0xb6cb3f5d } },
+          B_FALSE },
+        { { { 0xc31a3573, 0x7f991ed2, 0xd54fb496, 0x5b82dd5b,
+              0x812ffcae, 0x595c5220, 0x716b1287, 0x0c88bc4d } },
+          { { 0x5f48aca8, 0x3a57bf63, 0xdf2564f3, 0x7c8181f4,
+              0x9c04e6aa, 0x18d1b5b3, 0xf3901dc6, 0xdd5ddea3 } },
+          B_FALSE },
+        { { { 0x3e72ad0c, 0xe96a79fb, 0x42ba792f, 0x43a0a28c,
+              0x083e49f3, 0xefe0a423, 0x6b317466, 0x68f344af } },
+          { { 0x3fb24d4a, 0xcdfe17db, 0x71f5c626, 0x668bfc22,
+              0x24d67ff3, 0x604ed93c, 0xf8540a20, 0x31b9c405 } },
+          B_FALSE },
+        { { { 0xa2582e7f, 0xd36b4789, 0x4ec39c28, 0x0d1a1014,
+              0xedbad7a0, 0x663c62c3, 0x6f461db9, 0x4052bf4b } },
+          { { 0x188d25eb, 0x235a27c3, 0x99bfcc5b, 0xe724f339,
+              0x71d70cc8, 0x862be6bd, 0x90b0fc61, 0xfecf4d51 } },
+          B_FALSE },
+        { { { 0xa1d4cfac, 0x74346c10, 0x8526a7a4, 0xafdf5cc0,
+              0xf62bff7a, 0x123202a8, 0xc802e41a, 0x1eddbae2 } },
+          { { 0xd603f844, 0x8fa0af2d, 0x4c701917, 0x36e06b7e,
+              0x73db33a0, 0x0c45f452, 0x560ebcfc, 0x43104d86 } },
+          B_FALSE },
+        { { { 0x0d1d78e5, 0x9615b511, 0x25c4744b, 0x66b0de32,
+              0x6aaf363a, 0x0a4a46fb, 0x84f7a21c, 0xb48e26b4 } },
+          { { 0x21a01b2d, 0x06ebb0f6, 0x8b7b0f98, 0xc004e404,
+              0xfed6f668, 0x64131bcd, 0x4d4d3dab, 0xfac01540 } },
+          B_FALSE },
+    },
+    {
+        { { { 0, 0, 0, 0, 0, 0, 0, 0 } },
+          { { 0, 0, 0, 0, 0, 0, 0, 0 } },
+          B_TRUE },
+        { { { 0x185a5943, 0x3a5a9e22, 0x5c65dfb6, 0x1ab91936,
+              0x262c71da, 0x21656b32, 0xaf22af89, 0x7fe36b40 } },
+          { { 0x699ca101, 0xd50d152c, 0x7b8af212, 0x74b3d586,
+              0x07dca6f1, 0x9f09f404, 0x25b63624, 0xe697d458 } },
+          B_FALSE },
+        { { { 0x7512218e, 0xa84aa939, 0x74ca0141, 0xe9a521b0,
+              0x18a2e902, 0x57880b3a, 0x12a677a6, 0x4a5b5066 } },
+          { { 0x4c4f3840, 0x0beada7a, 0x19e26d9d, 0x626db154,
+              0xe1627d40, 0xc42604fb, 0xeac089f1, 0xeb13461c } },
+          B_FALSE },
+        { { { 0x27a43281, 0xf9faed09, 0x4103ecbc, 0x5e52c414,
+              0xa815c857, 0xc342967a, 0x1c6a220a, 0x0781b829 } },
+          { { 0xeac55f80, 0x5a8343ce, 0xe54a05e3, 0x88f80eee,
+              0x12916434, 0x97b2a14f, 0xf0151593, 0x690cde8d } },
+          B_FALSE },
+        { { { 0xf7f82f2a, 0xaee9c75d, 0x4afdf43a, 0x9e4c3587,
+              0x37371326, 0xf5622df4, 0x6ec73617, 0x8a535f56 } },
+          { { 0x223094b7, 0xc5f9a0ac, 0x4c8c7669, 0xcde53386,
+              0x085a92bf, 0x37e02819, 0x68b08bd7, 0x0455c084 } },
+          B_FALSE },
+        { { { 0x9477b5d9, 0x0c0a6e2c, 0x876dc444, 0xf9a4bf62,
+              0xb6cdc279, 0x5050a949, 0xb77f8276, 0x06bada7a } },
+          { { 0xea48dac9, 0xc8b4aed1, 0x7ea1070f, 0xdebd8a4b,
+              0x1366eb70, 0x427d4910, 0x0e6cb18a, 0x5b476dfd } },
+          B_FALSE },
+        { { { 0x278c340a, 0x7c5c3e44, 0x12d66f3b, 0x4d546068,
+              0xae23c5d8, 0x29a751b1, 0x8a2ec908, 0x3e29864e } },
+          { { 0x26dbb850, 0x142d2a66, 0x765bd780, 0xad1744c4,
+              0xe322d1ed, 0x1f150e68, 0x3dc31e7e, 0x239b90ea } },
+          B_FALSE },
+        { { { 0x7a53322a, 0x78c41652, 0x09776f8e, 0x305dde67,
+              0xf8862ed4, 0xdbcab759, 0x49f72ff7, 0x820f4dd9 } },
+          { { 0x2b5debd4, 0x6cc544a6, 0x7b4e8cc4, 0x75be5d93,
+              0x215c14d3, 0x1b481b1b, 0x783a05ec, 0x140406ec } },
+          B_FALSE },
+        { { { 0xe895df07, 0x6a703f10, 0x01876bd8, 0xfd75f3fa,
+              0x0ce08ffe, 0xeb5b06e7, 0x2783dfee, 0x68f6b854 } },
+          { { 0x78712655, 0x90c76f8a, 0xf310bf7f, 0xcf5293d2,
+              0xfda45028, 0xfbc8044d, 0x92e40ce6, 0xcbe1feba } },
+          B_FALSE },
+        { { { 0x4396e4c1, 0xe998ceea, 0x6acea274, 0xfc82ef0b,
+              0x2250e927, 0x230f729f, 0x2f420109, 0xd0b2f94d } },
+          { { 0xb38d4966, 0x4305addd, 0x624c3b45, 0x10b838f8,
+              0x58954e7a, 0x7db26366, 0x8b0719e5, 0x97145982 } },
+          B_FALSE },
+        { { { 0x23369fc9, 0x4bd6b726, 0x53d0b876, 0x57f2929e,
+              0xf2340687, 0xc2d5cba4, 0x4a866aba, 0x96161000 } },
+          { { 0x2e407a5e, 0x49997bcd, 0x92ddcb24, 0x69ab197d,
+              0x8fe5131c, 0x2cf1f243, 0xcee75e44, 0x7acb9fad } },
+          B_FALSE },
+        { { { 0x23d2d4c0, 0x254e8394, 0x7aea685b, 0xf57f0c91,
+              0x6f75aaea, 0xa60d880f, 0xa333bf5b, 0x24eb9acc } },
+          { { 0x1cda5dea, 0xe3de4ccb, 0xc51a6b4f, 0xfeef9341,
+              0x8bac4c4d, 0x743125f8, 0xacd079cc, 0x69f891c5 } },
+          B_FALSE },
+        { { { 0x702476b5, 0xeee44b35, 0xe45c2258, 0x7ed031a0,
+              0xbd6f8514, 0xb422d1e7, 0x5972a107, 0xe51f547c } },
+          { { 0xc9cf343d, 0xa25bcd6f, 0x097c184e, 0x8ca922ee,
+              0xa9fe9a06, 0xa62f98b3, 0x25bb1387, 0x1c309a2b } },
+          B_FALSE },
+        { { { 0x1967c459, 0x9295dbeb, 0x3472c98e, 0xb0014883,
+              0x08011828, 0xc5049777, 0xa2c4e503, 0x20b87b8a } },
+          { { 0xe057c277, 0x3063175d, 0x8fe582dd, 0x1bd53933,
+              0x5f69a044, 0x0d11adef, 0x919776be, 0xf5c6fa49 } },
+          B_FALSE },
+        { { { 0x0fd59e11, 0x8c944e76, 0x102fad5f, 0x3876cba1,
+              0xd83faa56, 0xa454c3fa, 0x332010b9, 0x1ed7d1b9 } },
+          { { 0x0024b889, 0xa1011a27, 0xac0cd344, 0x05e4d0dc,
+              0xeb6a2a24, 0x52b520f0, 0x3217257a, 0x3a2b03f0 } },
+          B_FALSE },
+        { { { 0xdf1d043d, 0xf20fc2af, 0xb58d5a62, 0xf330240d,
+              0xa0058c3b, 0xfc7d229c, 0xc78dd9f6, 0x15fee545 } },
+          { { 0x5bc98cda, 0x501e8288, 0xd046ac04, 0x41ef80e5,
+              0x461210fb, 0x557d9f49, 0xb8753f81, 0x4ab5b6b2 } },
+          B_FALSE },
+    }
+};
+
+/* Gathers bit i of each 64 bit row of k into a comb table index. */
+#define comb_column(k, i) (big_get_bit(k, i) | (big_get_bit(k, (i) + 64) << 1) | \
+                           (big_get_bit(k, (i) + 128) << 2) | (big_get_bit(k, (i) + 192) << 3))
+
+/* tgt = k * base_point.  k must be precisely reduced and non-negative. */
+static void
+pointMpyBaseP(affine_point_t* tgt, bigval_t const* k)
+{
+    jacobian_point_t Q;
+    affine_point_t T;
+    int i;
 
     Q = jacobian_infinity;
+    for (i = COMB_SPACING - 1; i >= 0; --i) {
+        pointDouble(&Q, &Q);
+        pointSelect(&T, combTable[0], 1 << COMB_TEETH, comb_column(k, i));
+        pointAddSecret(&Q, &Q, &T);
+        pointSelect(&T, combTable[1], 1 << COMB_TEETH, comb_column(k, i + COMB_SPACING));
+        pointAddSecret(&Q, &Q, &T);
+    }
+    toAffine(tgt, &Q);
+}
 
-    /* faster */
-#ifdef MPY2BITS
-    affine_point_t const*mpyset[4];
-    affine_point_t twoP, threeP;
-#endif /* MPY2BITS */
+/*
+ * tgt = k * P for a secret multiplier k, using a fixed 4 bit window.  The
+ * window table 0P..15P is built with one inversion, and every window costs
+ * four doublings and one pointAddSecret of an entry fetched by pointSelect,
+ * so the sequence of point operations does not depend on k.  The field
+ * arithmetic underneath is not constant-time.  k must be precisely reduced
+ * and non-negative.
+ */
+static void
+pointMpyWindowP(affine_point_t* tgt, bigval_t const* k, affine_point_t const* P)
+{
+    jacobian_point_t J[16];
+    affine_point_t table[16];
+    affine_point_t T;
+    jacobian_point_t Q;
+    int i;
 
-    if (big_is_zero(k) || big_is_negative(k)) {
+    if (P->infinity) {
         *tgt = affine_infinity;
         return;
     }
 
-#ifndef MPY2BITS
-    /* Classical high-to-low method */
-    /* discard high order zeros */
-    for (i = BIGLEN * 32 - 1; i >= 0; --i) {
-        if (big_get_bit(k, i)) {
-            break;
-        }
+    table[0] = affine_infinity;
+    table[1] = *P;
+    toJacobian(&J[1], P);
+    pointDouble(&J[2], &J[1]);
+    for (i = 3; i < 16; ++i) {
+        pointAdd(&J[i], &J[i - 1], P);
     }
-    /* Can't fall through since k is non-zero.  We get here only via the break */
-    /* discard highest order 1 bit */
-    --i;
+    toAffineBatch(&table[2], &J[2], 14);
 
-    toJacobian(&Q, P);
-    for (; i >= 0; --i) {
+    Q = jacobian_infinity;
+    for (i = 32 * (BIGLEN - 1) - 4; i >= 0; i -= 4) {
+        pointDouble(&Q, &Q);
+        pointDouble(&Q, &Q);
         pointDouble(&Q, &Q);
-        if (big_get_bit(k, i)) {
-            pointAdd(&Q, &Q, P);
+        pointDouble(&Q, &Q);
+        pointSelect(&T, table, 16, (k->data[i / 32] >> (i % 32)) & 0xF);
+        pointAddSecret(&Q, &Q, &T);
+    }
+    toAffine(tgt, &Q);
+}
+
+/*
+ * Width-w non-adjacent form for public multipliers ([HMV] Algorithm 3.35).
+ * Nonzero digits are odd and at most 2^(w-1) in magnitude and on average
+ * only one digit in w+1 is nonzero.
+ */
+#define WNAF_WIDTH 5
+#define WNAF_TABLE (1 << (WNAF_WIDTH - 2))
+
+/* Returns the number of digits written to naf, least significant first. */
+static int
+big_to_wnaf(int8_t* naf, bigval_t const* k)
+{
+    bigval_t v = *k;
+    bigval_t d = big_zero;
+    int len = 0;
+
+    while (!big_is_zero(&v)) {
+        int digit = 0;
+        if (big_is_odd(&v)) {
+            digit = v.data[0] & ((1 << WNAF_WIDTH) - 1);
+            if (digit >= (1 << (WNAF_WIDTH - 1))) {
+                digit -= 1 << WNAF_WIDTH;
+                d.data[0] = -digit;
+                big_add(&v, &v, &d);
+            } else {
+                d.data[0] = digit;
+                big_sub(&v, &v, &d);
+            }
         }
+        naf[len++] = (int8_t)digit;
+        big_halve(&v, &v);
     }
-#else /* MPY2BITS defined */
-      /* multiply 2 bits at a time */
-      /* precompute 1P, 2P, and 3P */
-    mpyset[0] = (affine_point_t*)0;
-    mpyset[1] = P;
-    toJacobian(&Q, P);  /* Q = P */
-    pointDouble(&Q, &Q); /* now Q = 2P */
+    return len;
+}
+
+/*
+ * tgt = k * P for a public multiplier k, such as the ECDSA verification
+ * multipliers, using wNAF.  This is not constant-time and must not be used
+ * with secret multipliers.  k must be precisely reduced and non-negative.
+ */
+static void
+pointMpyWnafP(affine_point_t* tgt, bigval_t const* k, affine_point_t const* P)
+{
+    int8_t naf[32 * BIGLEN + 1];
+    jacobian_point_t J[WNAF_TABLE];
+    affine_point_t odd[WNAF_TABLE];
+    affine_point_t neg[WNAF_TABLE];
+    affine_point_t twoP;
+    jacobian_point_t Q;
+    int i, n;
+
+    if (P->infinity) {
+        *tgt = affine_infinity;
+        return;
+    }
+
+    /* odd[i] = (2i + 1)P and neg[i] = -odd[i] */
+    toJacobian(&J[0], P);
+    pointDouble(&Q, &J[0]);
     toAffine(&twoP, &Q);
-    mpyset[2] = &twoP;
-    pointAdd(&Q, &Q, P); /* now Q = 3P */
-    toAffine(&threeP, &Q);
-    mpyset[3] = &threeP;
-
-    /* discard high order zeros (in pairs) */
-    for (i = BIGLEN * 32 - 2; i >= 0; i -= 2) {
-        if (big_get_2bits(k, i)) {
-            break;
-        }
+    for (i = 1; i < WNAF_TABLE; ++i) {
+        pointAdd(&J[i], &J[i - 1], &twoP);
+    }
+    odd[0] = *P;
+    toAffineBatch(&odd[1], &J[1], WNAF_TABLE - 1);
+    for (i = 0; i < WNAF_TABLE; ++i) {
+        neg[i] = odd[i];
+        big_sub(&neg[i].y, &modulusP, &odd[i].y);
     }
 
+    n = big_to_wnaf(naf, k);
     Q = jacobian_infinity;
-
-    for (; i >= 0; i -= 2) {
-        int mbits = big_get_2bits(k, i);
+    for (i = n - 1; i >= 0; --i) {
         pointDouble(&Q, &Q);
-        pointDouble(&Q, &Q);
-        if (mpyset[mbits] != (affine_point_t*)0) {
-            pointAdd(&Q, &Q, mpyset[mbits]);
+        if (naf[i] > 0) {
+            pointAdd(&Q, &Q, &odd[naf[i] >> 1]);
+        } else if (naf[i] < 0) {
+            pointAdd(&Q, &Q, &neg[(-naf[i]) >> 1]);
         }
     }
-
-#endif /* MPY2BITS */
-
     toAffine(tgt, &Q);
 }
 
@@ -1436,7 +1856,7 @@ ECDH_generate(affine_point_t* P1, bigval_t* k)
     if (rv < 0) {
         return (-1);
     }
-    pointMpyP(P1, k, &base_point);
+    pointMpyBaseP(P1, k);
 
     return (0);
 }
@@ -1474,7 +1894,7 @@ ECDH_derive_pt(affine_point_t* tgt, bigval_t const* k, affine_point_t const* Q)
      * Infinity, which is required by ANSI X9.63.
      */
 
-    pointMpyP(tgt, k, Q);
+    pointMpyWindowP(tgt, k, Q);
     /* Q2 can't be infinity if 1 <= k < orderP, which is supposed to be
        the case, but the test is so cheap, we just do it. */
     if (tgt->infinity) {
@@ -1637,8 +2057,8 @@ ECDSA_verify_inner(bigval_t const* msgdgst,
     big_precise_reduce(&u1, &u1, &orderP);
     big_mpyP(&u2, &sig->r, &w, MOD_ORDER);
     big_precise_reduce(&u2, &u2, &orderP);
-    pointMpyP(&P1, &u1, &base_point);
-    pointMpyP(&P2, &u2, pubkey);
+    pointMpyBaseP(&P1, &u1);
+    pointMpyWnafP(&P2, &u2, pubkey);
     toJacobian(&P2Jacobian, &P2);
     pointAdd(&XJacobian, &P2Jacobian, &P1);
     toAffine(&X, &XJacobian);
@@ -1709,11 +2129,11 @@ ECC_feature_list(void)
 #ifdef SMALL_CODE
                " SMALL_CODE"
 #endif
-#ifdef MPY2BITS
-               " MPY2BITS"
-#endif
 #ifdef ARM7_ASM
                " ARM7_ASM"
+#endif
+#ifdef MPY64
+               " MPY64"
 #endif
                );
 }
@@ -35,6 +35,7 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Util.h>
+#include <qcc/atomic.h>
 
 #include <Status.h>
 
@@ -130,6 +131,53 @@ static bool IsValidPrimeGroup(BigNum& N, BigNum& g)
     return ok && (g == group) && (N == prime);
 }
 
+/*
+ * The random exponents a and b are 32 bytes and x is a SHA1 digest
+ */
+static const size_t MAX_GENERATOR_EXP_BITS = 256;
+
+/* Precomputed generator powers for the trusted prime groups, created on first use */
+static BigNum::FixedBase* volatile generator1024 = NULL;
+static BigNum::FixedBase* volatile generator1536 = NULL;
+
+/*
+ * Compute g^e % N. For the trusted groups this uses precomputed powers of the generator
+ * shared by all conversations, the tables are built once and never modified afterwards.
+ */
+static BigNum GeneratorExp(BigNum& g, const BigNum& e, BigNum& N)
+{
+    BigNum::FixedBase* volatile* cache;
+    switch (N.bit_len()) {
+    case 1024:
+        cache = &generator1024;
+        break;
+
+    case 1536:
+        cache = &generator1536;
+        break;
+
+    default:
+        return g.mod_exp(e, N);
+    }
+    BigNum::FixedBase* fb = *cache;
+    if (!fb) {
+        if (!IsValidPrimeGroup(N, g)) {
+            return g.mod_exp(e, N);
+        }
+        fb = new BigNum::FixedBase(g, N, MAX_GENERATOR_EXP_BITS);
+        /* Another thread may have got there first */
+        if (!CompareAndExchangePointer(reinterpret_cast<void* volatile*>(cache), NULL, fb)) {
+            delete fb;
+            fb = *cache;
+        }
+    }
+    if ((fb->get_base() == g) && (fb->get_mod() == N)) {
+        return fb->mod_exp(e);
+    } else {
+        return g.mod_exp(e, N);
+    }
+}
+
 
 namespace qcc {
 
@@ -241,7 +289,7 @@ QStatus Crypto_SRP::ClientInit(const qcc::String& fromServer, qcc::String& toSer
     }
 
     /* Compute A = g^a % N */
-    bn->A = bn->g.mod_exp(bn->a, bn->N);
+    bn->A = GeneratorExp(bn->g, bn->a, bn->N);
 
     /* Compose string A to send to server */
     toServer = bn->A.get_hex();
@@ -298,7 +346,7 @@ QStatus Crypto_SRP::ClientFinish(const qcc::String& id, const qcc::String& pwd)
     /* Calculate premaster secret for client = (B - (k * g^x)) ^ (a + (u * x)) % N  */
 
     /* (B - (k * g^x)) */
-    BigNum tmp1 = (bn->B - bn->k * bn->g.mod_exp(bn->x, bn->N)) % bn->N;
+    BigNum tmp1 = (bn->B - bn->k * GeneratorExp(bn->g, bn->x, bn->N)) % bn->N;
     if (tmp1 < 0) {
         tmp1 += bn->N;
     }
@@ -338,7 +386,7 @@ void Crypto_SRP::ServerCommon(qcc::String& toClient)
     bn->k.set_bytes(digest, Crypto_SHA1::DIGEST_SIZE);
 
     /* Compute B = (k*v + g^b % N) %N */
-    bn->B = (bn->k * bn->v + bn->g.mod_exp(bn->b, bn->N)) % bn->N;
+    bn->B = (bn->k * bn->v + GeneratorExp(bn->g, bn->b, bn->N)) % bn->N;
 
     /* Compose string s:B to send to client */
     toClient.erase();
@@ -394,7 +442,7 @@ QStatus Crypto_SRP::ServerInit(const qcc::String& id, const qcc::String& pwd, qc
     bn->x.set_bytes(digest, Crypto_SHA1::DIGEST_SIZE);
 
     /* Compute v = g^x % N */
-    bn->v = bn->g.mod_exp(bn->x, bn->N);
+    bn->v = GeneratorExp(bn->g, bn->x, bn->N);
 
     ServerCommon(toClient);
     return ER_OK;
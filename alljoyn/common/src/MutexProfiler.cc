@@ -0,0 +1,340 @@
+/**
+ * @file
+ *
+ * Profiler that measures lock contention per lock site.
+ */
+
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <qcc/MutexProfiler.h>
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+#include <qcc/atomic.h>
+#include <qcc/time.h>
+
+using namespace std;
+
+/*
+ * Nothing in here may lock a qcc::Mutex since it is called from inside
+ * Mutex::Lock() and Mutex::Unlock().  That includes the logging macros.
+ */
+
+namespace qcc {
+
+/*
+ * A slot in the lock site table.  A slot is claimed once, by the first thread
+ * to record an event for its file and line, and is never reused.  The
+ * statistics are guarded by a spin lock but all the events of one mutex are
+ * recorded while that mutex is held, so the spin lock is only contended when
+ * several mutexes are locked from the same line at the same time.
+ */
+struct MutexSite {
+    volatile int32_t state;
+    volatile int32_t busy;
+    const char* volatile file;
+    volatile uint32_t line;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t waitTime;
+    uint64_t waitBuckets[MutexProfiler::NUM_BUCKETS];
+    uint64_t holdSamples;
+    uint64_t holdTime;
+    uint64_t holdBuckets[MutexProfiler::NUM_BUCKETS];
+};
+
+enum {
+    SITE_FREE = 0,
+    SITE_CLAIMED = 1,
+    SITE_READY = 2
+};
+
+/* Number of lock sites that can be profiled, must be a power of two */
+static const uint32_t NUM_SITES = 2048;
+
+/* The lock site table, allocated the first time profiling is enabled and never freed */
+static void* volatile siteTable = NULL;
+
+volatile bool MutexProfiler::enabled = false;
+volatile uint32_t MutexProfiler::sampleInterval = 16;
+
+static void LockSite(MutexSite* site)
+{
+    for (uint32_t spins = 0; !CompareAndExchange(&site->busy, 0, 1); ++spins) {
+        if (spins > 1000) {
+            /* The holder has most likely been preempted */
+            Sleep(1);
+        }
+    }
+}
+
+static void UnlockSite(MutexSite* site)
+{
+    CompareAndExchange(&site->busy, 1, 0);
+}
+
+static uint32_t GetBucket(uint64_t micros)
+{
+    uint32_t bucket = 0;
+    for (uint64_t v = micros; v && (bucket < (MutexProfiler::NUM_BUCKETS - 1)); v >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+/*
+ * Find the slot for a lock site, claiming a free one if the site is new.  The
+ * file is compared by address: MUTEX_CONTEXT passes a string literal, so one
+ * translation unit always passes the same address.  A header that is compiled
+ * into several translation units, or a slot that is found while another thread
+ * is still filling it in, ends up with more than one slot for the same site;
+ * GetSites() merges those.
+ */
+static MutexSite* FindSite(const char* file, uint32_t line)
+{
+    MutexSite* table = reinterpret_cast<MutexSite*>(siteTable);
+    if (!table) {
+        return NULL;
+    }
+    uint32_t hash = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(file) >> 3) * 31 + line;
+    for (uint32_t i = 0; i < NUM_SITES; ++i) {
+        MutexSite* site = &table[(hash + i) & (NUM_SITES - 1)];
+        int32_t state = site->state;
+        if (state == SITE_READY) {
+            if ((site->file == file) && (site->line == line)) {
+                return site;
+            }
+        } else if ((state == SITE_FREE) && CompareAndExchange(&site->state, SITE_FREE, SITE_CLAIMED)) {
+            site->file = file;
+            site->line = line;
+            CompareAndExchange(&site->state, SITE_CLAIMED, SITE_READY);
+            return site;
+        }
+    }
+    /* The table is full */
+    return NULL;
+}
+
+MutexProfiler::SiteStats::SiteStats() :
+    line(0), acquisitions(0), contended(0), waitTime(0), holdSamples(0), holdTime(0)
+{
+    memset(waitBuckets, 0, sizeof(waitBuckets));
+    memset(holdBuckets, 0, sizeof(holdBuckets));
+}
+
+uint64_t MutexProfiler::SiteStats::GetPercentile(const uint64_t* buckets, uint32_t percent)
+{
+    uint64_t count = 0;
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+        count += buckets[b];
+    }
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+        seen += buckets[b];
+        if ((seen >= rank) && (seen > 0)) {
+            return static_cast<uint64_t>(1) << b;
+        }
+    }
+    return static_cast<uint64_t>(1) << (NUM_BUCKETS - 1);
+}
+
+void MutexProfiler::Enable(uint32_t interval)
+{
+    if (!siteTable) {
+        MutexSite* table = new MutexSite[NUM_SITES]();
+        if (!CompareAndExchangePointer(&siteTable, NULL, table)) {
+            delete [] table;
+        }
+    }
+    sampleInterval = interval ? interval : 1;
+    enabled = true;
+}
+
+void MutexProfiler::Disable()
+{
+    enabled = false;
+}
+
+void MutexProfiler::Reset()
+{
+    MutexSite* table = reinterpret_cast<MutexSite*>(siteTable);
+    if (!table) {
+        return;
+    }
+    for (uint32_t i = 0; i < NUM_SITES; ++i) {
+        MutexSite* site = &table[i];
+        if (site->state == SITE_READY) {
+            LockSite(site);
+            site->acquisitions = 0;
+            site->contended = 0;
+            site->waitTime = 0;
+            memset(site->waitBuckets, 0, sizeof(site->waitBuckets));
+            site->holdSamples = 0;
+            site->holdTime = 0;
+            memset(site->holdBuckets, 0, sizeof(site->holdBuckets));
+            UnlockSite(site);
+        }
+    }
+}
+
+static bool MoreContended(const MutexProfiler::SiteStats& a, const MutexProfiler::SiteStats& b)
+{
+    if (a.waitTime != b.waitTime) {
+        return a.waitTime > b.waitTime;
+    }
+    if (a.contended != b.contended) {
+        return a.contended > b.contended;
+    }
+    return a.acquisitions > b.acquisitions;
+}
+
+void MutexProfiler::GetSites(std::vector<SiteStats>& sites)
+{
+    sites.clear();
+    MutexSite* table = reinterpret_cast<MutexSite*>(siteTable);
+    if (!table) {
+        return;
+    }
+
+    map<pair<qcc::String, uint32_t>, size_t> index;
+    for (uint32_t i = 0; i < NUM_SITES; ++i) {
+        MutexSite* site = &table[i];
+        if (site->state != SITE_READY) {
+            continue;
+        }
+        SiteStats stats;
+        LockSite(site);
+        stats.acquisitions = site->acquisitions;
+        stats.contended = site->contended;
+        stats.waitTime = site->waitTime;
+        memcpy(stats.waitBuckets, site->waitBuckets, sizeof(stats.waitBuckets));
+        stats.holdSamples = site->holdSamples;
+        stats.holdTime = site->holdTime;
+        memcpy(stats.holdBuckets, site->holdBuckets, sizeof(stats.holdBuckets));
+        UnlockSite(site);
+        if (!stats.acquisitions && !stats.contended && !stats.holdSamples) {
+            continue;
+        }
+
+        pair<qcc::String, uint32_t> key(site->file, site->line);
+        map<pair<qcc::String, uint32_t>, size_t>::iterator it = index.find(key);
+        if (it == index.end()) {
+            stats.file = key.first;
+            stats.line = key.second;
+            index[key] = sites.size();
+            sites.push_back(stats);
+        } else {
+            SiteStats& merged = sites[it->second];
+            merged.acquisitions += stats.acquisitions;
+            merged.contended += stats.contended;
+            merged.waitTime += stats.waitTime;
+            merged.holdSamples += stats.holdSamples;
+            merged.holdTime += stats.holdTime;
+            for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+                merged.waitBuckets[b] += stats.waitBuckets[b];
+                merged.holdBuckets[b] += stats.holdBuckets[b];
+            }
+        }
+    }
+    sort(sites.begin(), sites.end(), MoreContended);
+}
+
+qcc::String MutexProfiler::Dump(size_t maxSites)
+{
+    vector<SiteStats> sites;
+    GetSites(sites);
+
+    char line[512];
+    snprintf(line, sizeof(line), "# Mutex contention by lock site, 1 in %u acquisitions sampled%s\n",
+             sampleInterval, enabled ? "" : " (profiling off)");
+    qcc::String str(line);
+    for (size_t i = 0; (i < sites.size()) && (i < maxSites); ++i) {
+        const SiteStats& s = sites[i];
+        snprintf(line, sizeof(line),
+                 "%s:%u acquisitions %llu contended %llu wait_us total %llu p50 %llu p99 %llu max %llu hold_us mean %llu p50 %llu p99 %llu\n",
+                 s.file.c_str(), s.line,
+                 static_cast<unsigned long long>(s.acquisitions),
+                 static_cast<unsigned long long>(s.contended),
+                 static_cast<unsigned long long>(s.waitTime),
+                 static_cast<unsigned long long>(SiteStats::GetPercentile(s.waitBuckets, 50)),
+                 static_cast<unsigned long long>(SiteStats::GetPercentile(s.waitBuckets, 99)),
+                 static_cast<unsigned long long>(SiteStats::GetPercentile(s.waitBuckets, 100)),
+                 static_cast<unsigned long long>(s.holdSamples ? s.holdTime / s.holdSamples : 0),
+                 static_cast<unsigned long long>(SiteStats::GetPercentile(s.holdBuckets, 50)),
+                 static_cast<unsigned long long>(SiteStats::GetPercentile(s.holdBuckets, 99)));
+        str += line;
+    }
+    return str;
+}
+
+MutexSite* MutexProfiler::Acquired(const char* file, uint32_t line, uint64_t waitStart, uint32_t& sampleCount, uint64_t& holdStart)
+{
+    holdStart = 0;
+    uint32_t interval = sampleInterval;
+    bool sampled = (++sampleCount >= interval);
+    if (sampled) {
+        sampleCount = 0;
+    } else if (!waitStart) {
+        return NULL;
+    }
+
+    MutexSite* site = FindSite(file, line);
+    if (!site) {
+        return NULL;
+    }
+    uint64_t now = GetTimestampMicros();
+    LockSite(site);
+    if (sampled) {
+        site->acquisitions += interval;
+    }
+    if (waitStart) {
+        uint64_t wait = now - waitStart;
+        ++site->contended;
+        site->waitTime += wait;
+        ++site->waitBuckets[GetBucket(wait)];
+    }
+    UnlockSite(site);
+    if (sampled) {
+        holdStart = now;
+    }
+    return site;
+}
+
+void MutexProfiler::Released(MutexSite* site, uint64_t holdStart)
+{
+    uint64_t hold = GetTimestampMicros() - holdStart;
+    LockSite(site);
+    ++site->holdSamples;
+    site->holdTime += hold;
+    ++site->holdBuckets[GetBucket(hold)];
+    UnlockSite(site);
+}
+
+}
@@ -52,6 +52,36 @@ static void CRC16_Complete(uint16_t crc,
     crcBlock[1] = (uint8_t) (rev[(crc >> 8) & 0xF] << 4) | rev[crc >> 12];
 }
 
+/*
+ * Returns the number of leading bytes in buf that are neither a boundary nor an escape byte
+ * and can therefore be copied through SLIP framing unchanged. The scan tests a machine word
+ * at a time for either special byte and only falls back to a byte-wise scan for the word
+ * that contains one.
+ */
+static size_t PlainRun(const uint8_t* buf, size_t len)
+{
+    const size_t ones = ~static_cast<size_t>(0) / 0xFF;
+    const size_t highs = ones * 0x80;
+    const size_t boundaries = ones * BOUNDARY_BYTE;
+    const size_t escapes = ones * ESCAPE_BYTE;
+
+    size_t n = 0;
+    while ((n + sizeof(size_t)) <= len) {
+        size_t word;
+        memcpy(&word, buf + n, sizeof(word));
+        size_t b = word ^ boundaries;
+        size_t e = word ^ escapes;
+        if ((((b - ones) & ~b) | ((e - ones) & ~e)) & highs) {
+            break;
+        }
+        n += sizeof(size_t);
+    }
+    while ((n < len) && (buf[n] != BOUNDARY_BYTE) && (buf[n] != ESCAPE_BYTE)) {
+        ++n;
+    }
+    return n;
+}
+
 SLAPReadPacket::SLAPReadPacket(size_t packetSize) :
     m_maxPacketSize(packetSize),
     m_buffer(new uint8_t[SLAP_DESLIPPED_LENGTH(packetSize)]),
@@ -87,8 +117,24 @@ QStatus SLAPReadPacket::DeSlip(uint8_t*& bufIn, size_t& lenIn)
     uint8_t rx;
 
     QStatus status = ER_TIMEOUT;
-    while (status == ER_TIMEOUT && lenIn-- > 0) {
+    const size_t maxLen = m_maxPacketSize + SLAP_HDR_LEN + SLAP_BOUNDARY_BYTES;
+    while (status == ER_TIMEOUT && lenIn > 0) {
+        if (m_readState == PACKET_OPEN) {
+            /*
+             * Copy any run of bytes that need no decoding straight into the packet. The byte
+             * that ends the run (if any) goes through the state machine below.
+             */
+            size_t run = PlainRun(bufIn, (lenIn < (maxLen - m_totalLen)) ? lenIn : (maxLen - m_totalLen));
+            memcpy(&m_buffer[m_totalLen], bufIn, run);
+            m_totalLen += run;
+            bufIn += run;
+            lenIn -= run;
+            if (lenIn == 0) {
+                break;
+            }
+        }
         rx = *bufIn++;
+        --lenIn;
         switch (m_readState) {
         case PACKET_FLUSH:
             /*
@@ -151,7 +197,7 @@ QStatus SLAPReadPacket::DeSlip(uint8_t*& bufIn, size_t& lenIn)
                 m_readState = PACKET_ESCAPE;
                 break;
             }
-            if (m_totalLen == (m_maxPacketSize + SLAP_HDR_LEN + SLAP_BOUNDARY_BYTES)) {
+            if (m_totalLen == maxLen) {
                 /*
                  * Packet overrun: discard the packet.
                  */
@@ -287,8 +333,7 @@ QStatus SLAPReadPacket::Validate()
 
 bool SLAPReadPacket::FillBuffer(void* buf, size_t reqBytes, size_t& actualBytes)
 {
-    uint16_t toRead = reqBytes;
-    actualBytes = (toRead < m_remainingLen) ? toRead : m_remainingLen;
+    actualBytes = (reqBytes < m_remainingLen) ? reqBytes : m_remainingLen;
     memcpy(buf, m_readPtr, actualBytes);
 
     if (actualBytes == m_remainingLen) {
@@ -345,23 +390,17 @@ void SLAPWritePacket::DataPacket(const void* buf, size_t num, size_t& numSent)
 void SLAPWritePacket::SlipPayload() {
 
     m_slippedLen = SLAP_PAYLOAD_START_POS;
-    for (int i = 0; i < m_payloadLen; i++) {
-        uint8_t b = m_payloadBuffer[i];
-        switch (b) {
-        case BOUNDARY_BYTE:
-            m_buffer[m_slippedLen++] = ESCAPE_BYTE;
-            m_buffer[m_slippedLen++] = BOUNDARY_SUBSTITUTE;
-            break;
-
-        case ESCAPE_BYTE:
-            m_buffer[m_slippedLen++] = ESCAPE_BYTE;
-            m_buffer[m_slippedLen++] = ESCAPE_SUBSTITUTE;
-            break;
-
-        default:
-            m_buffer[m_slippedLen++] = b;
+    size_t i = 0;
+    while (i < m_payloadLen) {
+        size_t run = PlainRun(&m_payloadBuffer[i], m_payloadLen - i);
+        memcpy(&m_buffer[m_slippedLen], &m_payloadBuffer[i], run);
+        m_slippedLen += run;
+        i += run;
+        if (i == m_payloadLen) {
             break;
         }
+        m_buffer[m_slippedLen++] = ESCAPE_BYTE;
+        m_buffer[m_slippedLen++] = (m_payloadBuffer[i++] == BOUNDARY_BYTE) ? BOUNDARY_SUBSTITUTE : ESCAPE_SUBSTITUTE;
     }
 }
 void SLAPWritePacket::AckPacket()
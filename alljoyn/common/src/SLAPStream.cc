@@ -96,35 +96,26 @@ SLAPStream::SLAPStream(Stream* rawStream, Timer& timer, uint16_t maxPacketSize,
 SLAPStream::~SLAPStream()
 {
     Close();
-    std::list<SLAPWritePacket*>::iterator it = m_txFreeList.begin();
-    while (it != m_txFreeList.end()) {
-        delete *it;
-        ++it;
+    for (size_t i = 0; i < m_txFreeList.size(); ++i) {
+        delete m_txFreeList[i];
     }
     m_txFreeList.clear();
-
-    it = m_txQueue.begin();
-    while (it != m_txQueue.end() && *it != m_txCtrl) {
-        delete *it;
-        ++it;
+    for (size_t i = 0; i < m_txQueue.size(); ++i) {
+        if (m_txQueue[i] != m_txCtrl) {
+            delete m_txQueue[i];
+        }
     }
     m_txQueue.clear();
-    it = m_txSent.begin();
-    while (it != m_txSent.end()) {
-        delete *it;
-        ++it;
+    for (size_t i = 0; i < m_txSent.size(); ++i) {
+        delete m_txSent[i];
     }
     m_txSent.clear();
-    std::list<SLAPReadPacket*>::iterator it1 = m_rxQueue.begin();
-    while (it1 != m_rxQueue.end()) {
-        delete *it1;
-        ++it1;
+    for (size_t i = 0; i < m_rxQueue.size(); ++i) {
+        delete m_rxQueue[i];
     }
     m_rxQueue.clear();
-    it1 = m_rxFreeList.begin();
-    while (it1 != m_rxFreeList.end()) {
-        delete *it1;
-        ++it1;
+    for (size_t i = 0; i < m_rxFreeList.size(); ++i) {
+        delete m_rxFreeList[i];
     }
     m_rxFreeList.clear();
 
@@ -854,7 +845,7 @@ void SLAPStream::EnqueueCtrl(ControlPacketType type, uint8_t* config)
      * for the new packet to overwrite the older packet. It would NOT be OK for
      * the unreliable packet to get queued twice.
      */
-    if (m_txQueue.front() == m_txCtrl) {
+    if (!m_txQueue.empty() && (m_txQueue.front() == m_txCtrl)) {
         QCC_DbgPrintf(("Unreliable packet already queued %d", type));
     } else {
 
@@ -914,13 +905,18 @@ void SLAPStream::AlarmTriggered(const Alarm& alarm, QStatus reason)
          * simply means moving packets on m_txSent to the head of m_txQueue.
          */
         if (!m_txSent.empty()) {
-            std::list<SLAPWritePacket*>::iterator it = m_txQueue.begin();
-            if ((it == m_txQueue.end()) || (m_txQueue.front() != m_txCtrl)) {
-                m_txQueue.insert(it, m_txSent.begin(), m_txSent.end());
-            } else {
-                m_txQueue.insert(++it, m_txSent.begin(), m_txSent.end());
+            /* A queued link control packet stays at the head of the queue */
+            bool ctrlQueued = !m_txQueue.empty() && (m_txQueue.front() == m_txCtrl);
+            if (ctrlQueued) {
+                m_txQueue.pop_front();
+            }
+            while (!m_txSent.empty()) {
+                m_txQueue.push_front(m_txSent.back());
+                m_txSent.pop_back();
+            }
+            if (ctrlQueued) {
+                m_txQueue.push_front(m_txCtrl);
             }
-            m_txSent.clear();
             /*
              * Start sending again.
              */
@@ -945,7 +941,7 @@ void SLAPStream::AlarmTriggered(const Alarm& alarm, QStatus reason)
              * for the new packet to overwrite the older packet. It would NOT be OK for
              * the unreliable packet to get queued twice.
              */
-            if (m_txQueue.front() == m_txCtrl) {
+            if (!m_txQueue.empty() && (m_txQueue.front() == m_txCtrl)) {
                 QCC_DbgPrintf(("Unreliable packet already queued"));
             } else {
                 m_txQueue.push_front(m_txCtrl);
@@ -118,10 +118,35 @@ String::String(size_t n, char c, size_t sizeHint)
 
 String::String(const String& copyMe)
 {
-    context = copyMe.context;
-    IncRef();
+    CopyContext(copyMe);
 }
 
+#if (__cplusplus >= 201100L)
+String::String(String&& moveMe)
+{
+    if (moveMe.context == &moveMe.inlineCtx.ctx) {
+        CopyContext(moveMe);
+    } else {
+        context = moveMe.context;
+        moveMe.context = &nullContext;
+    }
+}
+
+String& String::operator=(String&& assignFromMe)
+{
+    if (&assignFromMe != this) {
+        DecRef(context);
+        if (assignFromMe.context == &assignFromMe.inlineCtx.ctx) {
+            CopyContext(assignFromMe);
+        } else {
+            context = assignFromMe.context;
+            assignFromMe.context = &nullContext;
+        }
+    }
+    return *this;
+}
+#endif
+
 String::~String()
 {
     DecRef(context);
@@ -134,11 +159,8 @@ String& String::operator=(const String& assignFromMe)
         /* Decrement ref of current context */
         DecRef(context);
 
-        /* Reassign this Managed Obj */
-        context = assignFromMe.context;
-
-        /* Increment the ref */
-        IncRef();
+        /* Share or copy the other context */
+        CopyContext(assignFromMe);
     }
 
     return *this;
@@ -579,6 +601,18 @@ void String::NewContext(const char* str, size_t strLen, size_t sizeHint)
     sizeHint = MIN(sizeHint, maxSize);
 
     size_t capacity = MAX(MinCapacity, MAX(strLen, sizeHint));
+    if (capacity <= InlineCapacity) {
+        /* str may point into the inline buffer when a string is reallocated in place */
+        context = &inlineCtx.ctx;
+        context->refCount = 1;
+        context->capacity = static_cast<uint32_t>(InlineCapacity);
+        context->offset = static_cast<uint32_t>(strLen);
+        if (str) {
+            ::memmove(context->c_str, str, strLen);
+        }
+        context->c_str[strLen] = '\0';
+        return;
+    }
     size_t mallocSz = capacity + 1 + sizeof(ManagedCtx) - MinCapacity;
     void* newCtxMem = malloc(mallocSz);
     assert(newCtxMem);
@@ -593,6 +627,18 @@ void String::NewContext(const char* str, size_t strLen, size_t sizeHint)
     context->c_str[strLen] = '\0';
 }
 
+void String::CopyContext(const String& other)
+{
+    if (other.context == &other.inlineCtx.ctx) {
+        /* Short strings are cheaper to copy than to share */
+        inlineCtx = other.inlineCtx;
+        context = &inlineCtx.ctx;
+    } else {
+        context = other.context;
+        IncRef();
+    }
+}
+
 void String::IncRef()
 {
     /* Increment the ref count */
@@ -604,9 +650,13 @@ void String::IncRef()
 void String::DecRef(ManagedCtx* ctx)
 {
     /* Decrement the ref count */
-    if (ctx != &nullContext) {
-        uint32_t refs = DecrementAndFetch(&ctx->refCount);
-        if (0 == refs) {
+    if ((ctx != &nullContext) && (ctx != &inlineCtx.ctx)) {
+        /*
+         * Always go through the atomic: it orders this thread's free after the
+         * other threads' last uses of the context, which a plain load of a
+         * count of 1 would not.
+         */
+        if (0 == DecrementAndFetch(&ctx->refCount)) {
 #if defined(QCC_OS_DARWIN) || defined(__clang__)
             ctx->~ManagedCtx();
 #else
@@ -21,12 +21,129 @@
  ******************************************************************************/
 
 #include <assert.h>
+#include <qcc/atomic.h>
+#include <qcc/Thread.h>
 #include <qcc/ThreadPool.h>
 
 #define QCC_MODULE "THREADPOOL"
 
 namespace qcc {
 
+/*
+ * Queue positions and cell sequence numbers are free running 32-bit counters
+ * that are compared by their difference so that they can wrap around.
+ */
+static inline int32_t SeqAdd(int32_t seq, uint32_t n)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(seq) + n);
+}
+
+static inline int32_t SeqDiff(int32_t a, int32_t b)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+/**
+ * A bounded queue of Runnables that any thread can add to and take from
+ * without a lock.  Each cell carries a sequence number that tells producers
+ * and consumers whose turn it is to use the cell, so the only contention is a
+ * compare-and-exchange on the enqueue or dequeue position.
+ */
+class ThreadPool::TaskQueue {
+  public:
+    TaskQueue(uint32_t capacity) : m_cells(capacity), m_mask(capacity - 1), m_enqueuePos(0), m_dequeuePos(0)
+    {
+        assert(capacity && !(capacity & (capacity - 1)) && "ThreadPool::TaskQueue(): Capacity must be a power of two");
+        for (uint32_t i = 0; i < capacity; ++i) {
+            m_cells[i].sequence = static_cast<int32_t>(i);
+            m_cells[i].runnable = NULL;
+        }
+    }
+
+    bool Enqueue(Runnable* runnable)
+    {
+        int32_t pos = m_enqueuePos;
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            int32_t dif = SeqDiff(cell->sequence, pos);
+            if (dif == 0) {
+                if (CompareAndExchange(&m_enqueuePos, pos, SeqAdd(pos, 1))) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            }
+            pos = m_enqueuePos;
+        }
+        cell->runnable = runnable;
+        /* The exchange is a full barrier so consumers see the runnable before the new sequence */
+        CompareAndExchange(&cell->sequence, pos, SeqAdd(pos, 1));
+        return true;
+    }
+
+    Runnable* Dequeue()
+    {
+        int32_t pos = m_dequeuePos;
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            int32_t dif = SeqDiff(cell->sequence, SeqAdd(pos, 1));
+            if (dif == 0) {
+                if (CompareAndExchange(&m_dequeuePos, pos, SeqAdd(pos, 1))) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return NULL;
+            }
+            pos = m_dequeuePos;
+        }
+        Runnable* runnable = cell->runnable;
+        cell->runnable = NULL;
+        /* Hand the cell back to producers for their next lap around the queue */
+        CompareAndExchange(&cell->sequence, SeqAdd(pos, 1), SeqAdd(pos, m_mask + 1));
+        return runnable;
+    }
+
+  private:
+    struct Cell {
+        volatile int32_t sequence;
+        Runnable* volatile runnable;
+    };
+
+    std::vector<Cell> m_cells;
+    uint32_t m_mask;
+    volatile int32_t m_enqueuePos;
+    uint8_t m_pad[64];  /* keep producers and consumers off each other's cache line */
+    volatile int32_t m_dequeuePos;
+};
+
+/**
+ * A thread that runs the worker loop of the thread pool.
+ */
+class ThreadPool::Worker : public Thread {
+  public:
+    Worker(const char* name, ThreadPool& pool, uint32_t index) : Thread(name), m_pool(pool), m_index(index) { }
+
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        m_pool.RunWorker(m_index);
+        return 0;
+    }
+
+  private:
+    ThreadPool& m_pool;
+    uint32_t m_index;
+};
+
+/*
+ * Each queue only needs to hold the runnables that happen to be placed on it,
+ * and all queues together never hold more than the pool size, so there is
+ * no need for every queue to be able to hold the whole pool.
+ */
+static const uint32_t MAX_QUEUE_CAPACITY = 16;
+
 void Runnable::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
     QCC_DbgPrintf(("Runnable::AlarmTriggered()"));
@@ -49,63 +166,99 @@ void Runnable::AlarmTriggered(const Alarm& alarm, QStatus reason)
 }
 
 ThreadPool::ThreadPool(const char* name, uint32_t poolsize)
-    : m_stopping(false), m_poolsize(poolsize), m_dispatcher(name, false, poolsize)
+    : m_stopping(false), m_wakeups(0), m_sleeping(0), m_waiters(0), m_poolsize(poolsize), m_pending(0), m_next(0)
 {
     QCC_DbgPrintf(("ThreadPool::ThreadPool()"));
 
     assert(poolsize && "ThreadPool::ThreadPool(): Empty pools are no good for anyone");
 
+    uint32_t capacity = 1;
+    while ((capacity < poolsize) && (capacity < MAX_QUEUE_CAPACITY)) {
+        capacity <<= 1;
+    }
+
     /*
-     * Start the dispatcher Timer.  The Timer is the code that will cause alarms
-     * to be executed.  It is the alarms that provide the callbacks that the
-     * timer will fire.  Our timer will have a concurrency variable that
-     * corresponds to the poolsize provided.  This means that there will be
-     * <poolsize> theads waiting to dispatch expired alarms (either AllJoyn
-     * created in Posix systems or OS dispatched in Windows systems).  The
-     * concurrent threads in the Timer provide us with the thread pool we
-     * actually use.
+     * Start one worker thread with its own queue for each thread in the pool.
+     * The workers sleep until there is something on one of the queues.
      */
-    m_dispatcher.Start();
+    for (uint32_t i = 0; i < poolsize; ++i) {
+        m_queues.push_back(new TaskQueue(capacity));
+    }
+    for (uint32_t i = 0; i < poolsize; ++i) {
+        Worker* worker = new Worker(name, *this, i);
+        m_workers.push_back(worker);
+        QStatus status = worker->Start();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ThreadPool::ThreadPool(): Failed to start worker %u", i));
+        }
+    }
 
     /*
      * Set the event that callers will ultimately use to sleep on until a thread
-     * becomes available.  We just created a Timer dispatcher which has
-     * concurrency of at least one, so there is definitely a thread available.
+     * becomes available.  We just started at least one worker, so there is
+     * definitely a thread available.
      */
     m_event.SetEvent();
 }
 
 ThreadPool::~ThreadPool()
 {
-    QCC_DbgPrintf(("ThreadPool::~ThreadPool(): %d closures remain", m_closures.size()));
+    QCC_DbgPrintf(("ThreadPool::~ThreadPool(): %d closures remain", m_pending));
     Stop();
     Join();
 
     /*
-     * We have joined the underlying timer, so all of its threads must be
-     * stopped.  That doesn't necessarily mean that they have executed the
-     * AlarmTriggered() function that would take the closure off of the
-     * pending closures list.  In this case, we need to make sure we clear
-     * the closures map so we release the underlying Ptr and free the
-     * runnable.
+     * We have joined the workers, so none of them is running a closure.  That
+     * doesn't mean that every closure has been run, so release the references
+     * we still hold to the ones that are left on the queues.
      */
-    m_closures.clear();
+    Runnable* runnable;
+    while ((runnable = Take(0)) != NULL) {
+        runnable->DecRef();
+    }
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        delete m_workers[i];
+    }
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+        delete m_queues[i];
+    }
 }
 
 QStatus ThreadPool::Stop()
 {
     QCC_DbgPrintf(("ThreadPool::Stop()"));
     m_stopping = true;
-    QStatus status = m_dispatcher.Stop();
-    return status;
 
+    /*
+     * Wake up every sleeping worker so it can see that we are stopping, and
+     * any thread waiting for an available thread so it can return.
+     */
+    m_lock.Lock();
+    m_wakeup.Broadcast();
+    m_lock.Unlock();
+    m_event.SetEvent();
+
+    QStatus status = ER_OK;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        QStatus s = m_workers[i]->Stop();
+        if (s != ER_OK) {
+            status = s;
+        }
+    }
+    return status;
 }
 
 QStatus ThreadPool::Join()
 {
     QCC_DbgPrintf(("ThreadPool::Join()"));
     assert(m_stopping && "ThreadPool::Join(): must have previously Stop()ped");
-    QStatus status = m_dispatcher.Join();
+    QStatus status = ER_OK;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        QStatus s = m_workers[i]->Join();
+        if (s != ER_OK) {
+            status = s;
+        }
+    }
     return status;
 }
 
@@ -118,29 +271,17 @@ QStatus ThreadPool::Join()
 uint32_t ThreadPool::GetN(void)
 {
     QCC_DbgPrintf(("ThreadPool::GetN()"));
-
-    uint32_t n = 0;
-    QCC_DbgPrintf(("ThreadPool::GetN(): Taking lock"));
-    m_lock.Lock();
-    n = m_closures.size();
-    QCC_DbgPrintf(("ThreadPool::GetN(): Giving lock"));
-    m_lock.Unlock();
-    return n;
+    return static_cast<uint32_t>(m_pending);
 }
 
 QStatus ThreadPool::Execute(Ptr<Runnable> runnable)
 {
     QCC_DbgPrintf(("ThreadPool::Execute()"));
 
-    QCC_DbgPrintf(("ThreadPool::Execute(): Taking lock"));
-    m_lock.Lock();
-
     /*
      * Refuse to add any new closures if we're in the process of closing.
      */
     if (m_stopping) {
-        QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
-        m_lock.Unlock();
         QCC_DbgPrintf(("ThreadPool::Execute(): Stopping"));
         return ER_THREADPOOL_STOPPING;
     }
@@ -152,91 +293,139 @@ QStatus ThreadPool::Execute(Ptr<Runnable> runnable)
      * available resources.  This is enabled by returning an error when all of
      * the threads are in process.  This is a thread pool, not a work queue.
      */
-    if (m_closures.size() == m_poolsize) {
-        QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
-        m_lock.Unlock();
-        QCC_DbgPrintf(("ThreadPool::Execute(): Exhausted"));
-        return ER_THREADPOOL_EXHAUSTED;
+    for (;;) {
+        int32_t pending = m_pending;
+        if (pending >= static_cast<int32_t>(m_poolsize)) {
+            QCC_DbgPrintf(("ThreadPool::Execute(): Exhausted"));
+            return ER_THREADPOOL_EXHAUSTED;
+        }
+        if (CompareAndExchange(&m_pending, pending, pending + 1)) {
+            break;
+        }
     }
 
     /*
      * We need to make sure that the runnable object is kept alive while it is
-     * waiting to be run (and while it is running) so we keep a reference to it
-     * until we don't need it any more.  This also allows us to keep track of
-     * how many pending operations there are.  Note that the map is keyed on the
-     * underlying runnable object pointer, but the smart pointer is saved in the
-     * map in order to hold a reference to the object.
+     * waiting to be run (and while it is running) so we take a reference to it
+     * that the worker gives up in Release() once Run() has returned.
      */
-    QCC_DbgPrintf(("ThreadPool::Execute(): Schedule runnable"));
-    m_closures[runnable.Peek()] = runnable;
-    QCC_DbgPrintf(("ThreadPool::Execute(): %d closures remain", m_closures.size()));
+    runnable->SetThreadPool(this);
+    Runnable* closure = runnable.Peek();
+    closure->IncRef();
 
     /*
-     * Tell the runnable object where to contact us when it is done executing.
-     * Since we're not the one that is actually going to dispatch the thread
-     * we need to have whatever thread that goes in there call us us back so
-     * we can know when to release the object.
+     * Place the closure on the worker queues in round-robin order.  All of the
+     * queues together can hold at least m_poolsize closures, so if the queue we
+     * picked is full one of the others has room.
      */
-    runnable->SetThreadPool(this);
+    uint32_t n = static_cast<uint32_t>(m_queues.size());
+    uint32_t start = static_cast<uint32_t>(IncrementAndFetch(&m_next));
+    bool queued = false;
+    for (uint32_t i = 0; !queued && (i < n); ++i) {
+        queued = m_queues[(start + i) % n]->Enqueue(closure);
+    }
+    assert(queued && "ThreadPool::Execute(): No room on any queue");
 
     /*
-     * The trick here is to add an alarm that expires immediately and executes
-     * the AlarmTriggered method of the provided Runnable object.  This will
-     * call the Run() method of the Runnable.  So although we use Timers and
-     * Alarms, we schedule everthing to happen immediately, and the result looks
-     * like a thread pool that we all know and love.
-     *
-     * Since <runnable> is a smart pointer, we need to get the underlying object
-     * pointer using Peek().  This object pointer is automagically cast to an
-     * AlarmListener which defines which actual callback which the alarm will
-     * call.
+     * Enqueue() is a full barrier, so either a worker that is going to sleep
+     * sees the closure when it looks at the queues one last time, or we see
+     * that worker here and wake it up.
      */
-    uint32_t zero = 0;
-    void* voidptr = NULL;
-    AlarmListener* listener = runnable.Peek();
-    Alarm alarm = Alarm(zero, listener, voidptr, zero);
-    QCC_DbgPrintf(("ThreadPool::Execute(): AddAlarm()"));
-    QStatus status = m_dispatcher.AddAlarm(alarm);
-    QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
-    m_lock.Unlock();
-    return status;
+    WakeWorker();
+    return ER_OK;
 }
 
-void ThreadPool::Release(Runnable* runnable)
+void ThreadPool::WakeWorker()
 {
-    QCC_DbgPrintf(("ThreadPool::Release()"));
-
     /*
-     * After the closure corresponding to the Runnable pointer above has finished
-     * executing, it needs to call us back here and tell us that its heap object is
-     * no longer required; and that we can release our hold on that object.
-     *
-     * We save a smart pointer to the Runnable in our m_closures map, so we need to
-     * erase that entry.  Since the entry is a smart pointer, the act of erasing it
-     * will cause the reference count of the object to be decremented and the
-     * underlying object to be deleted if possible.
+     * Only one wakeup is outstanding at a time.  The worker that gets it wakes
+     * the next one as soon as it finds a closure, so a burst of closures brings
+     * in as many workers as it needs without a signal for every closure.
      */
-    QCC_DbgPrintf(("ThreadPool::Release(): Taking lock"));
-    m_lock.Lock();
-    QCC_DbgPrintf(("ThreadPool::Release(): Got lock"));
+    if (m_sleeping > 0) {
+        m_lock.Lock();
+        if ((m_wakeups == 0) && (m_sleeping > 0)) {
+            ++m_wakeups;
+            m_wakeup.Signal();
+        }
+        m_lock.Unlock();
+    }
+}
 
-    RunnableEntry::iterator i = m_closures.find(runnable);
-    assert(i != m_closures.end() && "ThreadPool::Release(): Cannot find closure to release");
-    m_closures.erase(i);
+Runnable* ThreadPool::Take(uint32_t index)
+{
+    uint32_t n = static_cast<uint32_t>(m_queues.size());
+    for (uint32_t i = 0; i < n; ++i) {
+        Runnable* runnable = m_queues[(index + i) % n]->Dequeue();
+        if (runnable) {
+            return runnable;
+        }
+    }
+    return NULL;
+}
+
+void ThreadPool::RunWorker(uint32_t index)
+{
+    QCC_DbgPrintf(("ThreadPool::RunWorker(%u)", index));
+
+    while (!m_stopping) {
+        Runnable* runnable = Take(index);
+        if (!runnable) {
+            /*
+             * Announce that we are about to sleep before looking at the queues
+             * one last time so that Execute() cannot miss us.
+             */
+            IncrementAndFetch(&m_sleeping);
+            runnable = Take(index);
+            if (!runnable) {
+                m_lock.Lock();
+                while ((m_wakeups == 0) && !m_stopping) {
+                    m_wakeup.Wait(m_lock);
+                }
+                if (m_wakeups > 0) {
+                    --m_wakeups;
+                }
+                m_lock.Unlock();
+                DecrementAndFetch(&m_sleeping);
+                runnable = Take(index);
+                if (runnable) {
+                    WakeWorker();
+                }
+            } else {
+                DecrementAndFetch(&m_sleeping);
+            }
+            if (!runnable) {
+                continue;
+            }
+        }
+
+        runnable->Run();
+
+        /*
+         * Release our reference to the runnable object.  This may result in an
+         * immediate delete of the object so we must never refer to it after this.
+         */
+        Release(runnable);
+    }
+}
+
+void ThreadPool::Release(Runnable* runnable)
+{
+    QCC_DbgPrintf(("ThreadPool::Release()"));
+
+    runnable->DecRef();
+    DecrementAndFetch(&m_pending);
 
     /*
      * Release needs to work in conjunction with Execute() and
      * WaitForAvailableThread() to ensure that no than m_poolSize threads are
-     * dispatched at any one time.  We set an event every time a thread
-     * completes its Run() method which can then wake up an external thread
-     * waiting for an available thread to do its work.
+     * dispatched at any one time.  We set an event when a thread completes
+     * its Run() method and some external thread is waiting for an available
+     * thread to do its work.
      */
-    m_event.SetEvent();
-
-    QCC_DbgPrintf(("ThreadPool::Release(): %d closures remain", m_closures.size()));
-
-    QCC_DbgPrintf(("ThreadPool::Release(): Giving lock"));
-    m_lock.Unlock();
+    if (m_waiters > 0) {
+        m_event.SetEvent();
+    }
 }
 
 QStatus ThreadPool::WaitForAvailableThread(void)
@@ -245,68 +434,35 @@ QStatus ThreadPool::WaitForAvailableThread(void)
 
     /*
      * Our job here is loop until a thread is available to execute a closure.
+     * We announce ourselves first so that Release() knows to set the event.
      */
-    QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Taking lock"));
-    m_lock.Lock();
+    IncrementAndFetch(&m_waiters);
 
+    QStatus status = ER_OK;
     for (;;) {
 
         /*
          * We can't have an available thread if we're stopping.
          */
         if (m_stopping) {
-            QCC_DbgPrintf(("ThreadPool::WaitforAvailableThread(): Giving lock"));
-            m_lock.Unlock();
             QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Stopping"));
-            return ER_THREADPOOL_STOPPING;
+            status = ER_THREADPOOL_STOPPING;
+            break;
         }
 
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): m_closures.size() == %d.", m_closures.size()));
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): m_poolsize == %d.", m_poolsize));
-
         /*
-         * There are no available threads for us to use doing our work, so we
-         * must block until one of them completes.  When one completes, in its
-         * Release() function, it will do a SetEvent() on our wait event to let
-         * us know that it is done.  We reset this event here, with the shared
-         * lock taken.  This ensures that there can be no Release() in progress
-         * and when the next one happens we will be notified.
-         *
-         * This may seem a peculiar place to put this reset, but there is a
-         * method to my madness.  It turns out that SetEvent() is implemented by
-         * a write to an FD.  ResetEvent reads the file and empties it.  If the
-         * Release() function always does a SetEvent(), it writes characters to
-         * the underlying file.  If that file is never read, it eventually
-         * blocks writes and SetEvent() blocks.  So there must be ResetEvent()
-         * calls made to read this file even though we may not need to block and
-         * wait for threads to finish.  Thus, even though the ResetEvent() should
-         * logically go right before the Event::Wait() we do it here to drain
-         * the event file (on Linux).
+         * Reset the event before looking at the number of pending closures.
+         * Release() decrements that number before it sets the event, so either
+         * we see a thread become available here or the event is set after the
+         * reset and the wait below returns.
          */
         m_event.ResetEvent();
 
-        /*
-         * We enter the loop with the mutex that interlocks us with the release
-         * method taken.  Since the lock is taken, the release function must
-         * not change its state so we can look around safely and see whether
-         * or not there is currently an available thread.
-         *
-         * There is a closure on the m_closures map for the duration of time
-         * when a Runnable closure is waiting to be executed and while it is in
-         * process.  So, if the size of the m_closures map is less than the pool
-         * size, it means that not all of our thread pool threads are occupied
-         * and at least one is available, so we return.
-         */
-        if (m_closures.size() < m_poolsize) {
-            QCC_DbgPrintf(("ThreadPool::WaitforAvailableThread(): Giving lock"));
-            m_lock.Unlock();
+        if (m_pending < static_cast<int32_t>(m_poolsize)) {
             QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Thread available"));
-            return ER_OK;
+            break;
         }
 
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Waiting on thread completion event.  Giving lock"));
-        m_lock.Unlock();
-
         /*
          * We are executing in the context of some unknown (to us) thread.  This
          * thread can be stopped and alerted using its own mechanisms so we have
@@ -315,18 +471,15 @@ QStatus ThreadPool::WaitForAvailableThread(void)
          * should be returned to the caller, who can figure out the right thing
          * to do.
          */
-        QStatus status = Event::Wait(m_event, Event::WAIT_FOREVER);
+        status = Event::Wait(m_event, Event::WAIT_FOREVER);
         if (status != ER_OK) {
             QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Event::Wait() error"));
-            return status;
+            break;
         }
-
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Taking lock"));
-        m_lock.Lock();
     }
 
-    assert(false && "ThreadPool::WaitForAvailableThread(): Can't happen");
-    return ER_FAIL;
+    DecrementAndFetch(&m_waiters);
+    return status;
 }
 
 } // namespace qcc
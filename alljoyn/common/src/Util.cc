@@ -131,10 +131,43 @@ static const uint16_t crcTable[256] = {
     0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78
 };
 
+/*
+ * Slicing-by-8 tables derived from crcTable. slice[k][i] is the CRC contribution of byte i
+ * followed by k zero bytes, which lets eight input bytes be folded into the CRC with eight
+ * independent table lookups instead of eight dependent ones.
+ */
+class CRC16SliceTable {
+  public:
+    CRC16SliceTable()
+    {
+        for (size_t i = 0; i < 256; ++i) {
+            slice[0][i] = crcTable[i];
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t i = 0; i < 256; ++i) {
+                uint16_t prev = slice[k - 1][i];
+                slice[k][i] = crcTable[prev & 0xFF] ^ (prev >> 8);
+            }
+        }
+    }
+
+    uint16_t slice[8][256];
+};
+
+static const CRC16SliceTable crcSlices;
+
 void qcc::CRC16_Compute(const uint8_t* buffer, size_t bufLen, uint16_t*runningCrc)
 {
     uint16_t crc = *runningCrc;
-
+    const uint16_t (*t)[256] = crcSlices.slice;
+
+    while (bufLen >= 8) {
+        crc = t[7][buffer[0] ^ (crc & 0xFF)] ^ t[6][buffer[1] ^ (crc >> 8)] ^
+              t[5][buffer[2]] ^ t[4][buffer[3]] ^ t[3][buffer[4]] ^ t[2][buffer[5]] ^
+              t[1][buffer[6]] ^ t[0][buffer[7]];
+        buffer += 8;
+        bufLen -= 8;
+    }
     while (bufLen--) {
         crc = crcTable[(crc ^ *buffer++) & 0xFF] ^ (crc >> 8);
     }
@@ -0,0 +1,204 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <qcc/Crypto.h>
+#include <qcc/CryptoECC.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+
+using namespace qcc;
+
+/*
+ * The ECC keys are arrays of 32 bit words, least significant word first,
+ * each word stored big endian.  Converts a 256 bit big endian hex number
+ * to that layout.
+ */
+static void HexToECCWords(const char* hex, uint8_t* out)
+{
+    uint8_t be[32];
+    ASSERT_EQ(sizeof(be), HexStringToBytes(hex, be, sizeof(be)));
+    for (size_t i = 0; i < 8; ++i) {
+        memcpy(&out[4 * i], &be[28 - 4 * i], 4);
+    }
+    memset(&out[4 * 8], 0, 4);
+}
+
+static void HexToPoint(const char* x, const char* y, ECCPublicKey& pt)
+{
+    memset(&pt, 0, sizeof(pt));
+    HexToECCWords(x, &pt.data[0]);
+    HexToECCWords(y, &pt.data[4 * ECC_BIGVAL_SZ]);
+}
+
+/* Known answers computed independently for the NIST P-256 curve */
+static const char ecdhPrivate[] = "617ff7680a1884b6c41c164ba0f91489ac57883d0d40dbb8784bcc5651d630d5";
+static const char ecdhPeerX[] = "d87105e0952cd90bec5d112efef6480e3139640f87c4fc7fab643a107a274e68";
+static const char ecdhPeerY[] = "8a52b289fc58e5797e65f4e4a9b9656e056c67627c0cecbe491e432ef08ed4ab";
+static const char ecdhSecretX[] = "704a452a9ceeec617e5a417e5b582202e3112dc3e81b84499064e12fef856015";
+static const char ecdhSecretY[] = "6b8edbdd6807d52be2ca693bc2062c448a9a52a06b0f7d00402a0c7567c94e60";
+static const char baseX[] = "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296";
+static const char baseY[] = "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5";
+static const char ecdhPublicX[] = "1c85c0ad19280729733aa3169b83e26703bb4572b73b3f4f1ba9ae487a8b24f4";
+static const char ecdhPublicY[] = "89cc907634fc05b52e4c204dc199b33748025f39b99af0091970a9e2d3b8137d";
+
+static const char dsaPrivate[] = "e36e7dc3be7bac550d362532a8b3e1b7b218e749708e567a98f839535fb01ab4";
+static const char dsaPublicX[] = "c9fddc6416dc84b5ac3ef4860840540d40668d2c4d1bcab361723c644b6e9090";
+static const char dsaPublicY[] = "c17dd3fe6d561c2622a9a429d2906b064fd42d80951a531e2080f4bd9df751e4";
+static const char dsaSigR[] = "03b163f70c355463a1e7befbe3cce8bfc49d4b8e45da209515ebe300472c59f9";
+static const char dsaSigS[] = "db875f750deaa04a4a4ff4467e72a4781d1e557d1bb7e9a74744acbaaf94f7ca";
+static const char dsaMessage[] = "AllJoyn ECDSA known answer";
+
+TEST(CryptoECCTest, SharedSecretKnownAnswer)
+{
+    Crypto_ECC ecc;
+    ECCPrivateKey privateKey;
+    ECCPublicKey peer;
+    ECCSecret expected;
+    ECCSecret secret;
+
+    HexToECCWords(ecdhPrivate, privateKey.data);
+    ecc.SetDHPrivateKey(&privateKey);
+
+    HexToPoint(ecdhPeerX, ecdhPeerY, peer);
+    HexToPoint(ecdhSecretX, ecdhSecretY, expected);
+    ASSERT_EQ(ER_OK, ecc.GenerateSharedSecret(&peer, &secret));
+    EXPECT_EQ(0, memcmp(&expected, &secret, sizeof(secret)));
+
+    /* With the base point as the peer key the secret is the public key */
+    HexToPoint(baseX, baseY, peer);
+    HexToPoint(ecdhPublicX, ecdhPublicY, expected);
+    ASSERT_EQ(ER_OK, ecc.GenerateSharedSecret(&peer, &secret));
+    EXPECT_EQ(0, memcmp(&expected, &secret, sizeof(secret)));
+}
+
+/*
+ * Multiples of the base point whose window additions hit the special cases:
+ * adding to the point at infinity, adding a point to itself and a sum that
+ * is the point at infinity.
+ */
+static const struct {
+    const char* k;
+    const char* x;
+    const char* y;
+} smallMultiples[] = {
+    { "0000000000000000000000000000000000000000000000000000000000000002",
+      "7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978",
+      "07775510db8ed040293d9ac69f7430dbba7dade63ce982299e04b79d227873d1" },
+    { "0000000000000000000000000000000000000000000000000000000000000003",
+      "5ecbe4d1a6330a44c8f7ef951d4bf165e6c6b721efada985fb41661bc6e7fd6c",
+      "8734640c4998ff7e374b06ce1a64a2ecd82ab036384fb83d9a79b127a27d5032" },
+    { "0000000000000000000000000000000000000000000000000000000000000011",
+      "47776904c0f1cc3a9c0984b66f75301a5fa68678f0d64af8ba1abce34738a73e",
+      "aa005ee6b5b957286231856577648e8381b2804428d5733f32f787ff71f1fcdc" },
+    { "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632550",
+      "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+      "b01cbd1c01e58065711814b583f061e9d431cca994cea1313449bf97c840ae0a" },
+    { "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc63254f",
+      "7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978",
+      "f888aaee24712fc0d6c26539608bcf244582521ac3167dd661fb4862dd878c2e" }
+};
+
+TEST(CryptoECCTest, SharedSecretSmallMultiples)
+{
+    Crypto_ECC ecc;
+    ECCPrivateKey privateKey;
+    ECCPublicKey peer;
+    ECCSecret expected;
+    ECCSecret secret;
+
+    HexToPoint(baseX, baseY, peer);
+    for (size_t i = 0; i < ArraySize(smallMultiples); ++i) {
+        HexToECCWords(smallMultiples[i].k, privateKey.data);
+        ecc.SetDHPrivateKey(&privateKey);
+        HexToPoint(smallMultiples[i].x, smallMultiples[i].y, expected);
+        ASSERT_EQ(ER_OK, ecc.GenerateSharedSecret(&peer, &secret));
+        EXPECT_EQ(0, memcmp(&expected, &secret, sizeof(secret))) << "k = " << smallMultiples[i].k;
+    }
+}
+
+TEST(CryptoECCTest, SharedSecretRejectsInvalidPoint)
+{
+    Crypto_ECC ecc;
+    ECCPublicKey peer;
+    ECCSecret secret;
+
+    ASSERT_EQ(ER_OK, ecc.GenerateDHKeyPair());
+    HexToPoint(ecdhPeerX, ecdhPeerX, peer);
+    EXPECT_NE(ER_OK, ecc.GenerateSharedSecret(&peer, &secret));
+}
+
+TEST(CryptoECCTest, VerifyKnownAnswer)
+{
+    Crypto_ECC ecc;
+    ECCPublicKey publicKey;
+    ECCSignature sig;
+
+    HexToPoint(dsaPublicX, dsaPublicY, publicKey);
+    ecc.SetDSAPublicKey(&publicKey);
+    HexToECCWords(dsaSigR, &sig.data[0]);
+    HexToECCWords(dsaSigS, &sig.data[4 * ECC_BIGVAL_SZ]);
+
+    const uint8_t* msg = reinterpret_cast<const uint8_t*>(dsaMessage);
+    EXPECT_EQ(ER_OK, ecc.DSAVerify(msg, sizeof(dsaMessage) - 1, &sig));
+
+    sig.data[7] ^= 0x01;
+    EXPECT_NE(ER_OK, ecc.DSAVerify(msg, sizeof(dsaMessage) - 1, &sig));
+}
+
+TEST(CryptoECCTest, SignWithKnownKey)
+{
+    Crypto_ECC ecc;
+    ECCPrivateKey privateKey;
+    ECCPublicKey publicKey;
+    ECCSignature sig;
+
+    HexToECCWords(dsaPrivate, privateKey.data);
+    HexToPoint(dsaPublicX, dsaPublicY, publicKey);
+    ecc.SetDSAPrivateKey(&privateKey);
+    ecc.SetDSAPublicKey(&publicKey);
+
+    const uint8_t* msg = reinterpret_cast<const uint8_t*>(dsaMessage);
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_EQ(ER_OK, ecc.DSASign(msg, sizeof(dsaMessage) - 1, &sig));
+        EXPECT_EQ(ER_OK, ecc.DSAVerify(msg, sizeof(dsaMessage) - 1, &sig));
+    }
+}
+
+TEST(CryptoECCTest, KeyAgreementAndSignature)
+{
+    static const uint8_t msg[] = "ECDHE_ECDSA transcript";
+
+    for (int i = 0; i < 16; ++i) {
+        Crypto_ECC a;
+        Crypto_ECC b;
+        ECCSecret secretA;
+        ECCSecret secretB;
+        ECCSignature sig;
+
+        ASSERT_EQ(ER_OK, a.GenerateDHKeyPair());
+        ASSERT_EQ(ER_OK, b.GenerateDHKeyPair());
+        ASSERT_EQ(ER_OK, a.GenerateSharedSecret(b.GetDHPublicKey(), &secretA));
+        ASSERT_EQ(ER_OK, b.GenerateSharedSecret(a.GetDHPublicKey(), &secretB));
+        EXPECT_EQ(0, memcmp(&secretA, &secretB, sizeof(secretA)));
+
+        ASSERT_EQ(ER_OK, a.GenerateDSAKeyPair());
+        ASSERT_EQ(ER_OK, a.DSASign(msg, sizeof(msg), &sig));
+        b.SetDSAPublicKey(a.GetDSAPublicKey());
+        EXPECT_EQ(ER_OK, b.DSAVerify(msg, sizeof(msg), &sig));
+        EXPECT_NE(ER_OK, b.DSAVerify(msg, sizeof(msg) - 1, &sig));
+    }
+}
@@ -0,0 +1,203 @@
+/******************************************************************************
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <qcc/Condition.h>
+#include <qcc/Mutex.h>
+#include <qcc/MutexProfiler.h>
+#include <qcc/Thread.h>
+
+#include <Status.h>
+
+using namespace qcc;
+
+/*
+ * The tests name their lock sites with their own strings rather than
+ * MUTEX_CONTEXT so that they can find them among the sites of whatever else
+ * is running.
+ */
+static const char* SITE_A = "MutexProfilerTest.site_a";
+static const char* SITE_B = "MutexProfilerTest.site_b";
+static const char* SITE_HOLDER = "MutexProfilerTest.site_holder";
+static const char* SITE_WAITER = "MutexProfilerTest.site_waiter";
+
+static bool FindSite(const char* file, MutexProfiler::SiteStats& stats)
+{
+    std::vector<MutexProfiler::SiteStats> sites;
+    MutexProfiler::GetSites(sites);
+    for (size_t i = 0; i < sites.size(); ++i) {
+        if (sites[i].file == file) {
+            stats = sites[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+class MutexProfilerTest : public testing::Test {
+  public:
+    virtual void SetUp()
+    {
+        MutexProfiler::Enable(1);
+        MutexProfiler::Reset();
+    }
+
+    virtual void TearDown()
+    {
+        MutexProfiler::Disable();
+        MutexProfiler::Reset();
+    }
+};
+
+TEST_F(MutexProfilerTest, disabled)
+{
+    MutexProfiler::Disable();
+    Mutex m;
+    for (int i = 0; i < 100; ++i) {
+        m.Lock(SITE_A, 1);
+        m.Unlock(SITE_A, 1);
+    }
+    MutexProfiler::SiteStats stats;
+    EXPECT_FALSE(FindSite(SITE_A, stats));
+}
+
+TEST_F(MutexProfilerTest, uncontended)
+{
+    Mutex m;
+    for (int i = 0; i < 100; ++i) {
+        m.Lock(SITE_A, 1);
+        m.Unlock(SITE_A, 1);
+    }
+    MutexProfiler::SiteStats stats;
+    ASSERT_TRUE(FindSite(SITE_A, stats));
+    EXPECT_EQ(1U, stats.line);
+    EXPECT_EQ(100U, stats.acquisitions);
+    EXPECT_EQ(0U, stats.contended);
+    EXPECT_EQ(0U, stats.waitTime);
+    EXPECT_EQ(100U, stats.holdSamples);
+
+    MutexProfiler::Reset();
+    EXPECT_FALSE(FindSite(SITE_A, stats));
+}
+
+TEST_F(MutexProfilerTest, sampling)
+{
+    MutexProfiler::Enable(10);
+    Mutex m;
+    for (int i = 0; i < 100; ++i) {
+        m.Lock(SITE_A, 2);
+        m.Unlock(SITE_A, 2);
+    }
+    MutexProfiler::SiteStats stats;
+    ASSERT_TRUE(FindSite(SITE_A, stats));
+    /* Ten samples, each standing for ten acquisitions */
+    EXPECT_EQ(100U, stats.acquisitions);
+    EXPECT_EQ(10U, stats.holdSamples);
+}
+
+TEST_F(MutexProfilerTest, recursive)
+{
+    /* Only the outermost lock of a recursive mutex is a lock site */
+    Mutex m;
+    m.Lock(SITE_A, 3);
+    m.Lock(SITE_B, 3);
+    m.Unlock(SITE_B, 3);
+    m.Unlock(SITE_A, 3);
+
+    MutexProfiler::SiteStats stats;
+    ASSERT_TRUE(FindSite(SITE_A, stats));
+    EXPECT_EQ(1U, stats.acquisitions);
+    EXPECT_EQ(1U, stats.holdSamples);
+    EXPECT_FALSE(FindSite(SITE_B, stats));
+}
+
+static Mutex contendedLock;
+static volatile bool holderLocked;
+
+static ThreadReturn STDCALL HoldLock(void* arg)
+{
+    contendedLock.Lock(SITE_HOLDER, 4);
+    holderLocked = true;
+    qcc::Sleep(100);
+    contendedLock.Unlock(SITE_HOLDER, 4);
+    return 0;
+}
+
+TEST_F(MutexProfilerTest, contended)
+{
+    holderLocked = false;
+    Thread holder("HoldLock", HoldLock);
+    ASSERT_EQ(ER_OK, holder.Start());
+    while (!holderLocked) {
+        qcc::Sleep(1);
+    }
+    contendedLock.Lock(SITE_WAITER, 5);
+    contendedLock.Unlock(SITE_WAITER, 5);
+    holder.Join();
+
+    MutexProfiler::SiteStats stats;
+    ASSERT_TRUE(FindSite(SITE_WAITER, stats));
+    EXPECT_EQ(1U, stats.contended);
+    EXPECT_LE(50000U, stats.waitTime);
+    EXPECT_LE(65536U, MutexProfiler::SiteStats::GetPercentile(stats.waitBuckets, 50));
+
+    ASSERT_TRUE(FindSite(SITE_HOLDER, stats));
+    EXPECT_EQ(0U, stats.contended);
+    EXPECT_EQ(1U, stats.holdSamples);
+    EXPECT_LE(50000U, stats.holdTime);
+
+    /* The contended site comes first */
+    std::vector<MutexProfiler::SiteStats> sites;
+    MutexProfiler::GetSites(sites);
+    ASSERT_FALSE(sites.empty());
+    EXPECT_STREQ(SITE_WAITER, sites[0].file.c_str());
+    String dump = MutexProfiler::Dump(1);
+    EXPECT_NE(+String::npos, dump.find(SITE_WAITER));
+    EXPECT_EQ(+String::npos, dump.find(SITE_HOLDER));
+}
+
+static Mutex waitLock;
+
+static ThreadReturn STDCALL LockWhileWaiting(void* arg)
+{
+    waitLock.Lock(SITE_B, 6);
+    waitLock.Unlock(SITE_B, 6);
+    return 0;
+}
+
+TEST_F(MutexProfilerTest, condition_wait)
+{
+    /* A mutex released by a condition wait is not held by the waiter */
+    Condition c;
+    Thread locker("LockWhileWaiting", LockWhileWaiting);
+    waitLock.Lock(SITE_A, 7);
+    ASSERT_EQ(ER_OK, locker.Start());
+    EXPECT_EQ(ER_TIMEOUT, c.TimedWait(waitLock, 200));
+    waitLock.Unlock(SITE_A, 7);
+    locker.Join();
+
+    MutexProfiler::SiteStats stats;
+    ASSERT_TRUE(FindSite(SITE_A, stats));
+    EXPECT_EQ(1U, stats.acquisitions);
+    EXPECT_EQ(1U, stats.holdSamples);
+    EXPECT_GT(100000U, stats.holdTime);
+
+    ASSERT_TRUE(FindSite(SITE_B, stats));
+    EXPECT_EQ(1U, stats.acquisitions);
+    EXPECT_EQ(1U, stats.holdSamples);
+}
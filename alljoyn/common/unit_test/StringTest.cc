@@ -16,6 +16,12 @@
  ******************************************************************************/
 #include <gtest/gtest.h>
 #include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <map>
+#include <stdio.h>
+#include <vector>
 
 TEST(StringTest, constructor) {
     const char* testStr = "abcdefgdijk";
@@ -79,11 +85,20 @@ TEST(StringTest, operator_equals) {
 }
 
 TEST(StringTest, copyConstructor) {
-    /* test copy constructor */
-    qcc::String s2 = "abcdefg";
+    /* test copy constructor, long strings share their storage */
+    qcc::String s2 = "abcdefghijklmnopqrstuvwxyz0123456789";
     qcc::String t2 = s2;
     ASSERT_EQ(s2.c_str(), t2.c_str());
-    ASSERT_TRUE(t2 == "abcdefg");
+    ASSERT_TRUE(t2 == "abcdefghijklmnopqrstuvwxyz0123456789");
+
+    /* short strings are copied */
+    qcc::String s3 = "abcdefg";
+    qcc::String t3 = s3;
+    ASSERT_NE(s3.c_str(), t3.c_str());
+    ASSERT_TRUE(t3 == "abcdefg");
+    t3[0] = 'x';
+    ASSERT_STREQ("abcdefg", s3.c_str());
+    ASSERT_STREQ("xbcdefg", t3.c_str());
 }
 
 TEST(StringTest, append) {
@@ -260,3 +275,94 @@ TEST(StringTest, assignDoesNotAppend) {
     t.assign(after);
     ASSERT_STREQ(after, t.c_str());
 }
+
+TEST(StringTest, inlineToHeap) {
+    /* Grow a string past the inline capacity one character at a time and back */
+    const char* alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    qcc::String s;
+    for (size_t i = 0; i < ::strlen(alphabet); ++i) {
+        qcc::String before = s;
+        s.push_back(alphabet[i]);
+        ASSERT_EQ(i + 1, s.size());
+        ASSERT_EQ(0, ::strncmp(alphabet, s.c_str(), i + 1));
+        ASSERT_EQ(i, before.size());
+    }
+    s.resize(5);
+    ASSERT_STREQ("abcde", s.c_str());
+    s.reserve(8);
+    ASSERT_STREQ("abcde", s.c_str());
+
+    /* Embedded nuls survive copies of inline strings */
+    qcc::String n("a\0b", 3);
+    qcc::String m = n;
+    ASSERT_EQ(static_cast<size_t>(3), m.size());
+    ASSERT_TRUE(m == n);
+
+    /* Assigning over an inline string with a shared one and back */
+    qcc::String longStr(alphabet);
+    qcc::String t("short");
+    t = longStr;
+    ASSERT_EQ(longStr.c_str(), t.c_str());
+    t = "short";
+    ASSERT_STREQ("short", t.c_str());
+    ASSERT_STREQ(alphabet, longStr.c_str());
+    ASSERT_EQ(static_cast<size_t>(0), t.secure_clear());
+    ASSERT_TRUE(t.empty());
+}
+
+#if (__cplusplus >= 201100L)
+TEST(StringTest, move) {
+    const char* longStr = "abcdefghijklmnopqrstuvwxyz0123456789";
+    qcc::String a(longStr);
+    const char* storage = a.c_str();
+    qcc::String b(std::move(a));
+    /* Heap storage is handed over */
+    ASSERT_EQ(storage, b.c_str());
+    ASSERT_TRUE(a.empty());
+
+    qcc::String c("short");
+    c = std::move(b);
+    ASSERT_EQ(storage, c.c_str());
+    ASSERT_TRUE(b.empty());
+
+    qcc::String d("tiny");
+    c = std::move(d);
+    ASSERT_STREQ("tiny", c.c_str());
+}
+#endif
+
+/*
+ * Copies, compares and looks up names the way the routing and dispatch paths
+ * do: bus names, interface names and member names are copied into messages
+ * and match rules and used as map keys.
+ */
+TEST(StringTest, routingNamesBenchmark) {
+    const size_t numNames = 1000;
+    const size_t rounds = 200;
+    std::vector<qcc::String> senders;
+    std::map<qcc::String, uint32_t> nameTable;
+    for (size_t i = 0; i < numNames; ++i) {
+        senders.push_back(qcc::String(":ZyRsK2aX.") + qcc::U32ToString(i));
+        nameTable[senders[i]] = static_cast<uint32_t>(i);
+    }
+    const qcc::String iface("org.alljoyn.Bus.Peer.Session");
+    const qcc::String member("AcceptSession");
+
+    uint64_t start = qcc::GetTimestamp64();
+    uint32_t hits = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < numNames; ++i) {
+            /* Header fields arrive as char arrays and are turned into strings for lookups */
+            qcc::String sender(senders[i].c_str(), senders[i].size());
+            qcc::String ifaceCopy = iface;
+            qcc::String memberCopy = member;
+            std::map<qcc::String, uint32_t>::const_iterator it = nameTable.find(sender);
+            if ((it != nameTable.end()) && (ifaceCopy == iface) && (memberCopy == member)) {
+                ++hits;
+            }
+        }
+    }
+    uint64_t elapsed = qcc::GetTimestamp64() - start;
+    ASSERT_EQ(numNames * rounds, hits);
+    printf("Routed %u names in %u ms\n", static_cast<uint32_t>(numNames * rounds), static_cast<uint32_t>(elapsed));
+}
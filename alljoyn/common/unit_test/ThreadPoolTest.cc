@@ -0,0 +1,132 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2014, AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdio.h>
+
+#include <qcc/atomic.h>
+#include <qcc/Event.h>
+#include <qcc/Thread.h>
+#include <qcc/ThreadPool.h>
+#include <qcc/time.h>
+
+#include <Status.h>
+
+using namespace qcc;
+
+/* Counts how many times it has been run and optionally waits for an event first */
+class CountingRunnable : public Runnable {
+  public:
+    CountingRunnable(volatile int32_t& count, Event* gate = NULL) : count(count), gate(gate) { }
+
+    void Run(void)
+    {
+        if (gate) {
+            Event::Wait(*gate, Event::WAIT_FOREVER);
+        }
+        IncrementAndFetch(&count);
+    }
+
+  private:
+    volatile int32_t& count;
+    Event* gate;
+};
+
+static bool WaitForCount(volatile int32_t& count, int32_t expected)
+{
+    for (uint32_t i = 0; (i < 500) && (count != expected); ++i) {
+        qcc::Sleep(10);
+    }
+    return count == expected;
+}
+
+TEST(ThreadPoolTest, exhausted_until_released)
+{
+    volatile int32_t count = 0;
+    Event gate;
+    ThreadPool pool("exhausted", 2);
+    EXPECT_EQ(2U, pool.GetConcurrency());
+
+    EXPECT_EQ(ER_OK, pool.Execute(Ptr<Runnable>(new CountingRunnable(count, &gate))));
+    EXPECT_EQ(ER_OK, pool.Execute(Ptr<Runnable>(new CountingRunnable(count, &gate))));
+    EXPECT_EQ(2U, pool.GetN());
+
+    /* Both threads are busy so the pool refuses more work */
+    EXPECT_EQ(ER_THREADPOOL_EXHAUSTED, pool.Execute(Ptr<Runnable>(new CountingRunnable(count))));
+
+    gate.SetEvent();
+    EXPECT_EQ(ER_OK, pool.WaitForAvailableThread());
+    EXPECT_TRUE(WaitForCount(count, 2));
+    EXPECT_EQ(ER_OK, pool.Execute(Ptr<Runnable>(new CountingRunnable(count))));
+    EXPECT_TRUE(WaitForCount(count, 3));
+
+    pool.Stop();
+    EXPECT_EQ(ER_THREADPOOL_STOPPING, pool.Execute(Ptr<Runnable>(new CountingRunnable(count))));
+    EXPECT_EQ(ER_THREADPOOL_STOPPING, pool.WaitForAvailableThread());
+    pool.Join();
+}
+
+TEST(ThreadPoolTest, runs_every_runnable)
+{
+    volatile int32_t count = 0;
+    const int32_t total = 10000;
+    {
+        ThreadPool pool("every", 4);
+        for (int32_t i = 0; i < total;) {
+            QStatus status = pool.Execute(Ptr<Runnable>(new CountingRunnable(count)));
+            if (status == ER_THREADPOOL_EXHAUSTED) {
+                ASSERT_EQ(ER_OK, pool.WaitForAvailableThread());
+            } else {
+                ASSERT_EQ(ER_OK, status);
+                ++i;
+            }
+        }
+        EXPECT_TRUE(WaitForCount(count, total));
+    }
+    EXPECT_EQ(total, count);
+}
+
+/*
+ * Pushes short runnables through pools of 1 to 32 threads from a single
+ * submitting thread, backing off with WaitForAvailableThread() whenever the
+ * pool is exhausted, and prints the throughput for each pool size.
+ */
+TEST(ThreadPoolTest, throughput)
+{
+    const int32_t total = 50000;
+    for (uint32_t threads = 1; threads <= 32; threads *= 2) {
+        volatile int32_t count = 0;
+        ThreadPool pool("throughput", threads);
+        uint64_t start = GetTimestamp64();
+        for (int32_t i = 0; i < total;) {
+            QStatus status = pool.Execute(Ptr<Runnable>(new CountingRunnable(count)));
+            if (status == ER_THREADPOOL_EXHAUSTED) {
+                ASSERT_EQ(ER_OK, pool.WaitForAvailableThread());
+            } else {
+                ASSERT_EQ(ER_OK, status);
+                ++i;
+            }
+        }
+        ASSERT_TRUE(WaitForCount(count, total));
+        uint64_t elapsed = std::max(GetTimestamp64() - start, static_cast<uint64_t>(1));
+        printf("%2u threads: %u runnables in %u ms (%u per second)\n", threads, static_cast<uint32_t>(total),
+               static_cast<uint32_t>(elapsed), static_cast<uint32_t>((total * 1000ULL) / elapsed));
+        pool.Stop();
+        pool.Join();
+    }
+}
@@ -20,6 +20,12 @@
 #include <qcc/Util.h>
 #include <qcc/UARTStream.h>
 #include <qcc/SLAPStream.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#if defined(QCC_OS_LINUX)
+#include <fcntl.h>
+#include <stdlib.h>
+#endif
 #define PACKET_SIZE             100
 #define WINDOW_SIZE             4
 #define BAUDRATE                115200
@@ -640,3 +646,129 @@ TEST(UARTTest, DISABLED_valid_parameters)
         }
     }
 }
+
+#if defined(QCC_OS_LINUX)
+
+class SLAPPushThread : public Thread {
+  public:
+    SLAPPushThread(SLAPStream& stream, const uint8_t* buf, size_t len) :
+        Thread("SLAPPush"), status(ER_OK), stream(stream), buf(buf), len(len) { }
+
+    QStatus status;
+
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        size_t offset = 0;
+        while ((status == ER_OK) && (offset < len)) {
+            size_t sent = 0;
+            status = stream.PushBytes(buf + offset, len - offset, sent);
+            offset += sent;
+        }
+        return (ThreadReturn) 0;
+    }
+
+  private:
+    SLAPStream& stream;
+    const uint8_t* buf;
+    size_t len;
+};
+
+/*
+ * Runs SLAP over a pseudo terminal pair so the whole framing path (SLIP escaping,
+ * CRC, windowing) is exercised without serial hardware. Every fourth byte of the
+ * payload is a SLIP boundary or escape byte.
+ */
+TEST(UARTTest, pty_throughput_test)
+{
+    const size_t len = 64 * 1024;
+    const uint32_t baudrate = 2000000;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_NE(-1, master);
+    ASSERT_EQ(0, grantpt(master));
+    ASSERT_EQ(0, unlockpt(master));
+    ASSERT_EQ(0, fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK));
+    UARTFd slave;
+    QStatus status = UART(ptsname(master), baudrate, slave);
+    ASSERT_EQ(ER_OK, status);
+
+    Timer timer0("SLAPtimer0", true, 1, false, 10);
+    timer0.Start();
+    Timer timer1("SLAPtimer1", true, 1, false, 10);
+    timer1.Start();
+
+    UARTStream* s = new UARTStream(master);
+    UARTStream* s1 = new UARTStream(slave);
+    SLAPStream h(s, timer0, 1000, WINDOW_SIZE, baudrate);
+    SLAPStream h1(s1, timer1, 1000, WINDOW_SIZE, baudrate);
+    h.ScheduleLinkControlPacket();
+    h1.ScheduleLinkControlPacket();
+    IODispatch iodisp("iodisp", 4);
+    iodisp.Start();
+
+    UARTController uc(s, iodisp, &h);
+    UARTController uc1(s1, iodisp, &h1);
+    uc.Start();
+    uc1.Start();
+
+    uint8_t* txBuffer = new uint8_t[len];
+    uint8_t* rxBuffer = new uint8_t[len];
+    for (size_t i = 0; i < len; i++) {
+        switch (i & 7) {
+        case 3:
+            txBuffer[i] = 0xC0;
+            break;
+
+        case 7:
+            txBuffer[i] = 0xDB;
+            break;
+
+        default:
+            txBuffer[i] = static_cast<uint8_t>(i * 13);
+            break;
+        }
+    }
+    memset(rxBuffer, 0, len);
+
+    uint64_t start = GetTimestamp64();
+    SLAPPushThread pusher(h, txBuffer, len);
+    pusher.Start();
+
+    size_t received = 0;
+    while ((status == ER_OK) && (received < len)) {
+        size_t actual = 0;
+        status = h1.PullBytes(rxBuffer + received, len - received, actual, 10000);
+        received += actual;
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    pusher.Join();
+
+    EXPECT_EQ(ER_OK, status);
+    EXPECT_EQ(ER_OK, pusher.status);
+    EXPECT_EQ(len, received);
+    EXPECT_EQ(0, memcmp(txBuffer, rxBuffer, len));
+    printf("SLAP over pty: %u bytes in %u ms (%.1f KB/s)\n", static_cast<uint32_t>(received),
+           static_cast<uint32_t>(elapsed), elapsed ? (received / 1024.0) * 1000.0 / elapsed : 0.0);
+
+    timer0.Stop();
+    timer1.Stop();
+    uc.Stop();
+    uc1.Stop();
+    iodisp.Stop();
+
+    timer0.Join();
+    timer1.Join();
+    uc.Join();
+    uc1.Join();
+    iodisp.Join();
+
+    h.Close();
+    h1.Close();
+    delete s;
+    delete s1;
+    delete [] txBuffer;
+    delete [] rxBuffer;
+}
+
+#endif
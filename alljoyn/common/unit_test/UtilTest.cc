@@ -115,3 +115,30 @@ TEST(UtilTest, crc16_computation_stress) {
         expected_crc_value << ".";
     }
 }
+
+TEST(UtilTest, crc16_slice_matches_bytewise) {
+    /*
+     * CRC16_Compute folds in eight bytes at a time. Check it against a plain
+     * bit-at-a-time CRC-16/KERMIT over every length and alignment that
+     * exercises the block and tail paths.
+     */
+    uint8_t buffer[96];
+    for (size_t i = 0; i < ArraySize(buffer); i++) {
+        buffer[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len + offset <= ArraySize(buffer); len++) {
+            uint16_t expected = 0x1D0F;
+            for (size_t i = 0; i < len; i++) {
+                expected ^= buffer[offset + i];
+                for (int bit = 0; bit < 8; bit++) {
+                    expected = (expected & 1) ? ((expected >> 1) ^ 0x8408) : (expected >> 1);
+                }
+            }
+            uint16_t actual = 0x1D0F;
+            CRC16_Compute(buffer + offset, len, &actual);
+            EXPECT_EQ(expected, actual) << "offset " << offset << " len " << len;
+        }
+    }
+}
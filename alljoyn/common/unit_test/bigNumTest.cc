@@ -525,3 +525,34 @@ TEST(BigNumTest, ParseError) {
     ASSERT_FALSE(bn.set_dec("123"));
     ASSERT_FALSE(bn.set_dec("abc"));
 }
+
+TEST(BigNumTest, FixedBaseExponentiation) {
+    BigNum g = 2;
+    BigNum N;
+    N.set_bytes(Prime1536, sizeof(Prime1536));
+    BigNum::FixedBase fb(g, N, 256);
+
+    // Exponents shorter than, equal to and longer than the precomputed range
+    for (size_t len = 1; len <= 40; ++len) {
+        BigNum e;
+        e.gen_rand(len);
+        BigNum exp = fb.mod_exp(e);
+        BigNum check = g.mod_exp(e, N);
+        EXPECT_FALSE(exp != check) <<
+        "val e: " << e.get_hex().c_str();
+    }
+    EXPECT_TRUE(fb.mod_exp(0) == 1);
+    EXPECT_TRUE(fb.mod_exp(1) == g);
+
+    // Arbitrary base with an odd modulus
+    BigNum a;
+    BigNum m;
+    a.gen_rand(64);
+    m.set_bytes(Prime1024, sizeof(Prime1024));
+    BigNum::FixedBase fa(a, m, 160);
+    for (int i = 0; i < 20; ++i) {
+        BigNum e;
+        e.gen_rand(20);
+        EXPECT_TRUE(fa.mod_exp(e) == a.mod_exp(e, m));
+    }
+}
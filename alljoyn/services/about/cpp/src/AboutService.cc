@@ -134,7 +134,7 @@ QStatus AboutService::Announce() {
     for (std::map<qcc::String, std::vector<qcc::String> >::const_iterator it = m_AnnounceObjectsMap.begin();
          it != m_AnnounceObjectsMap.end(); ++it) {
 
-        qcc::String objectPath = it->first;
+        const qcc::String& objectPath = it->first;
         std::vector<const char*> interfacesVector(it->second.size());
         std::vector<qcc::String>::const_iterator interfaceIt;
         int interfaceIndex = 0;
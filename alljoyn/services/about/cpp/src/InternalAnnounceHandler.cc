@@ -29,7 +29,7 @@ using namespace services;
 #define QCC_MODULE "ALLJOYN_ABOUT_ANNOUNCE_HANDLER"
 
 InternalAnnounceHandler::InternalAnnounceHandler(BusAttachment& bus) :
-    bus(bus), announceSignalMember(NULL), emptyMatchRule("type='signal',interface='org.alljoyn.About',member='Announce',sessionless='t'") {
+    bus(bus), announceSignalMember(NULL), nextHandlerId(0), emptyMatchRule("type='signal',interface='org.alljoyn.About',member='Announce',sessionless='t'") {
     QCC_DbgTrace(("InternalAnnounceHandler::%s", __FUNCTION__));
 }
 
@@ -38,6 +38,8 @@ InternalAnnounceHandler::~InternalAnnounceHandler() {
     // don't delete the announceMap if another thread holds the lock
     announceMapLock.Lock(MUTEX_CONTEXT);
     announceMap.clear();
+    announcements.clear();
+    announcementOrder.clear();
     announceMapLock.Unlock(MUTEX_CONTEXT);
 
     announceHandlerLock.Lock(MUTEX_CONTEXT);
@@ -69,6 +71,7 @@ QStatus InternalAnnounceHandler::AddHandler(AnnounceHandler& handler, const char
     }
 
     announceMapLock.Lock(MUTEX_CONTEXT);
+    rhs.id = nextHandlerId++;
     AnnounceMap::value_type hi_pair = std::make_pair(&handler, rhs);
     announceMap.insert(hi_pair);
     announceMapLock.Unlock(MUTEX_CONTEXT);
@@ -176,18 +179,174 @@ void InternalAnnounceHandler::RemoveAllHandlers() {
     }
 }
 
-bool InternalAnnounceHandler::ContainsInterface(const ObjectDescriptions& objectDescriptions, const qcc::String interface) const {
+bool InternalAnnounceHandler::ContainsInterface(const std::set<qcc::String>& announcedInterfaces, const qcc::String& interface) const {
     size_t n = interface.find_first_of('*');
-    for (ObjectDescriptions::const_iterator oit = objectDescriptions.begin(); oit != objectDescriptions.end(); ++oit) {
-        for (size_t j = 0; j < oit->second.size(); ++j) {
-            if (n == qcc::String::npos && interface == oit->second[j]) {
-                return true;
-            } else if (n != qcc::String::npos && interface.compare(0, n, oit->second[j].substr(0, n)) == 0) {
-                return true;
+    if (n == qcc::String::npos) {
+        return announcedInterfaces.find(interface) != announcedInterfaces.end();
+    }
+    // A trailing wildcard matches any announced interface that shares the
+    // prefix before it.  The set is sorted so the first candidate is enough.
+    qcc::String prefix = interface.substr(0, n);
+    std::set<qcc::String>::const_iterator it = announcedInterfaces.lower_bound(prefix);
+    return (it != announcedInterfaces.end()) && (it->compare(0, n, prefix) == 0);
+}
+
+/*
+ * FNV-1a over the values held in a MsgArg tree.  Used to recognize an
+ * announcement whose contents have not changed without unmarshalling it.
+ */
+static void DigestMsgArg(const MsgArg& arg, uint64_t& digest)
+{
+    struct Local {
+        static void Add(uint64_t& digest, const void* data, size_t len) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < len; ++i) {
+                digest ^= p[i];
+                digest *= 1099511628211ULL;
             }
         }
+    };
+
+    Local::Add(digest, &arg.typeId, sizeof(arg.typeId));
+    switch (arg.typeId) {
+    case ALLJOYN_BOOLEAN:
+        Local::Add(digest, &arg.v_bool, sizeof(arg.v_bool));
+        break;
+
+    case ALLJOYN_BYTE:
+        Local::Add(digest, &arg.v_byte, sizeof(arg.v_byte));
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        Local::Add(digest, &arg.v_uint16, sizeof(arg.v_uint16));
+        break;
+
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+        Local::Add(digest, &arg.v_uint32, sizeof(arg.v_uint32));
+        break;
+
+    case ALLJOYN_INT64:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_DOUBLE:
+        Local::Add(digest, &arg.v_uint64, sizeof(arg.v_uint64));
+        break;
+
+    case ALLJOYN_STRING:
+    case ALLJOYN_OBJECT_PATH:
+        Local::Add(digest, arg.v_string.str, arg.v_string.len + 1);
+        break;
+
+    case ALLJOYN_SIGNATURE:
+        Local::Add(digest, arg.v_signature.sig, arg.v_signature.len + 1);
+        break;
+
+    case ALLJOYN_ARRAY:
+        Local::Add(digest, arg.v_array.GetElemSig(), strlen(arg.v_array.GetElemSig()) + 1);
+        for (size_t i = 0; i < arg.v_array.GetNumElements(); ++i) {
+            DigestMsgArg(arg.v_array.GetElements()[i], digest);
+        }
+        break;
+
+    case ALLJOYN_STRUCT:
+        for (size_t i = 0; i < arg.v_struct.numMembers; ++i) {
+            DigestMsgArg(arg.v_struct.members[i], digest);
+        }
+        break;
+
+    case ALLJOYN_DICT_ENTRY:
+        DigestMsgArg(*arg.v_dictEntry.key, digest);
+        DigestMsgArg(*arg.v_dictEntry.val, digest);
+        break;
+
+    case ALLJOYN_VARIANT:
+        DigestMsgArg(*arg.v_variant.val, digest);
+        break;
+
+    case ALLJOYN_BYTE_ARRAY:
+        Local::Add(digest, arg.v_scalarArray.v_byte, arg.v_scalarArray.numElements);
+        break;
+
+    case ALLJOYN_BOOLEAN_ARRAY:
+        Local::Add(digest, arg.v_scalarArray.v_bool, arg.v_scalarArray.numElements * sizeof(bool));
+        break;
+
+    case ALLJOYN_INT16_ARRAY:
+    case ALLJOYN_UINT16_ARRAY:
+        Local::Add(digest, arg.v_scalarArray.v_uint16, arg.v_scalarArray.numElements * sizeof(uint16_t));
+        break;
+
+    case ALLJOYN_INT32_ARRAY:
+    case ALLJOYN_UINT32_ARRAY:
+        Local::Add(digest, arg.v_scalarArray.v_uint32, arg.v_scalarArray.numElements * sizeof(uint32_t));
+        break;
+
+    case ALLJOYN_INT64_ARRAY:
+    case ALLJOYN_UINT64_ARRAY:
+    case ALLJOYN_DOUBLE_ARRAY:
+        Local::Add(digest, arg.v_scalarArray.v_uint64, arg.v_scalarArray.numElements * sizeof(uint64_t));
+        break;
+
+    default:
+        break;
     }
-    return false;
+}
+
+QStatus InternalAnnounceHandler::ParseAnnouncement(const ajn::MsgArg* args, Announcement& announcement) {
+    QStatus status = args[0].Get("q", &announcement.version);
+    if (status != ER_OK) {
+        return status;
+    }
+    status = args[1].Get("q", &announcement.port);
+    if (status != ER_OK) {
+        return status;
+    }
+
+    MsgArg* objectDescriptionsArgs;
+    size_t objectNum;
+    status = args[2].Get("a(oas)", &objectNum, &objectDescriptionsArgs);
+    if (status != ER_OK) {
+        return status;
+    }
+
+    for (size_t i = 0; i < objectNum; i++) {
+        char* objectDescriptionPath;
+        MsgArg* interfaceEntries;
+        size_t interfaceNum;
+        status = objectDescriptionsArgs[i].Get("(oas)", &objectDescriptionPath, &interfaceNum, &interfaceEntries);
+        if (status != ER_OK) {
+            return status;
+        }
+
+        std::vector<qcc::String> localVector;
+        for (size_t i = 0; i < interfaceNum; i++) {
+            char* interfaceName;
+            status = interfaceEntries[i].Get("s", &interfaceName);
+            if (status != ER_OK) {
+                return status;
+            }
+            localVector.push_back(interfaceName);
+            announcement.interfaces.insert(interfaceName);
+        }
+        announcement.objectDescriptions.insert(std::pair<qcc::String, std::vector<qcc::String> >(objectDescriptionPath, localVector));
+    }
+    MsgArg* tempControlArg2;
+    size_t languageTagNumElements;
+    status = args[3].Get("a{sv}", &languageTagNumElements, &tempControlArg2);
+    if (status != ER_OK) {
+        return status;
+    }
+    for (size_t i = 0; i < languageTagNumElements; i++) {
+        char* tempKey;
+        MsgArg* tempValue;
+        status = tempControlArg2[i].Get("{sv}", &tempKey, &tempValue);
+        if (status != ER_OK) {
+            return status;
+        }
+        announcement.aboutData.insert(std::pair<qcc::String, ajn::MsgArg>(tempKey, *tempValue));
+    }
+    return ER_OK;
 }
 
 void InternalAnnounceHandler::AnnounceSignalHandler(const ajn::InterfaceDescription::Member* member, const char* srcPath,
@@ -203,7 +362,6 @@ void InternalAnnounceHandler::AnnounceSignalHandler(const ajn::InterfaceDescript
     }
     const ajn::MsgArg* args = 0;
     size_t numArgs = 0;
-    QStatus status;
     message->GetArgs(numArgs, args);
     if (numArgs == 4) {
 #if !defined(NDEBUG)
@@ -211,72 +369,67 @@ void InternalAnnounceHandler::AnnounceSignalHandler(const ajn::InterfaceDescript
             QCC_DbgPrintf(("args[%d]=%s", i, args[i].ToString().c_str()));
         }
 #endif
-        uint16_t version = 0;
-        uint16_t receivedPort = 0;
-        AboutData aboutData;
-        ObjectDescriptions objectDescriptions;
-
-        status = args[0].Get("q", &version);
-        if (status != ER_OK) {
-            return;
-        }
-        status = args[1].Get("q", &receivedPort);
-        if (status != ER_OK) {
-            return;
+        qcc::String sender = message->GetSender();
+        uint32_t serial = message->GetCallSerial();
+        uint64_t digest = 14695981039346656037ULL;
+        for (size_t i = 0; i < numArgs; i++) {
+            DigestMsgArg(args[i], digest);
         }
 
-        MsgArg* objectDescriptionsArgs;
-        size_t objectNum;
-        status = args[2].Get("a(oas)", &objectNum, &objectDescriptionsArgs);
-        if (status != ER_OK) {
-            return;
+        /*
+         * The same Announce signal can reach us more than once (sessionless
+         * signals are redelivered whenever a new match rule is added), and
+         * peers periodically re-announce unchanged data.  A redelivered signal
+         * is only passed to handlers that have not seen it yet, and unchanged
+         * data is never unmarshalled twice.
+         */
+        announceMapLock.Lock(MUTEX_CONTEXT);
+        std::map<qcc::String, CacheEntry>::iterator ait = announcements.find(sender);
+        if (ait != announcements.end()) {
+            announcementOrder.splice(announcementOrder.begin(), announcementOrder, ait->second.order);
+        }
+        bool parse = (ait == announcements.end()) || (ait->second.announcement->digest != digest);
+        CachedAnnouncement announcement = parse ? CachedAnnouncement() : ait->second.announcement;
+        if (!parse && (announcement->serial != serial)) {
+            announcement->serial = serial;
+            announcement->deliveredTo.clear();
         }
+        announceMapLock.Unlock(MUTEX_CONTEXT);
 
-        for (size_t i = 0; i < objectNum; i++) {
-            char* objectDescriptionPath;
-            MsgArg* interfaceEntries;
-            size_t interfaceNum;
-            status = objectDescriptionsArgs[i].Get("(oas)", &objectDescriptionPath, &interfaceNum, &interfaceEntries);
-            if (status != ER_OK) {
+        if (parse) {
+            if (ParseAnnouncement(args, *announcement) != ER_OK) {
                 return;
             }
+            announcement->serial = serial;
+            announcement->digest = digest;
+        }
 
-            std::vector<qcc::String> localVector;
-            for (size_t i = 0; i < interfaceNum; i++) {
-                char* interfaceName;
-                status = interfaceEntries[i].Get("s", &interfaceName);
-                if (status != ER_OK) {
-                    return;
+        announceMapLock.Lock(MUTEX_CONTEXT);
+        if (parse) {
+            ait = announcements.find(sender);
+            if (ait == announcements.end()) {
+                if (announcements.size() >= MAX_CACHED_ANNOUNCEMENTS) {
+                    /* Forget the peer that has been quiet the longest */
+                    announcements.erase(announcementOrder.back());
+                    announcementOrder.pop_back();
                 }
-                localVector.push_back(interfaceName);
+                announcementOrder.push_front(sender);
+                ait = announcements.insert(std::make_pair(sender, CacheEntry())).first;
+                ait->second.order = announcementOrder.begin();
             }
-            objectDescriptions.insert(std::pair<qcc::String, std::vector<qcc::String> >(objectDescriptionPath, localVector));
-        }
-        MsgArg* tempControlArg2;
-        size_t languageTagNumElements;
-        status = args[3].Get("a{sv}", &languageTagNumElements, &tempControlArg2);
-        if (status != ER_OK) {
-            return;
+            ait->second.announcement = announcement;
         }
-        for (size_t i = 0; i < languageTagNumElements; i++) {
-            char* tempKey;
-            MsgArg* tempValue;
-            status = tempControlArg2[i].Get("{sv}", &tempKey, &tempValue);
-            if (status != ER_OK) {
-                return;
-            }
-            aboutData.insert(std::pair<qcc::String, ajn::MsgArg>(tempKey, *tempValue));
-        }
-
-        announceMapLock.Lock(MUTEX_CONTEXT);
-        qcc::String sender = message->GetSender();
         //look through map and send out the Announce if able to match the interfaces
         for (AnnounceMap::iterator it = announceMap.begin();
              it != announceMap.end(); ++it) {
+            if (!announcement->deliveredTo.insert(it->second.id).second) {
+                // this handler has already been given this signal
+                continue;
+            }
             bool matchFound = true;
             //if second.size is zero then the user is trying to match an any interface
             for (std::set<qcc::String>::iterator it2 = it->second.interfaces.begin(); it2 != it->second.interfaces.end(); ++it2) {
-                matchFound = ContainsInterface(objectDescriptions, (*it2));
+                matchFound = ContainsInterface(announcement->interfaces, (*it2));
                 // if the interface is not in the objectDescription we can exit
                 // the loop instantly with out checking the other interfaces
                 if (!matchFound) {
@@ -307,7 +460,7 @@ void InternalAnnounceHandler::AnnounceSignalHandler(const ajn::InterfaceDescript
         for (size_t i = 0; i < announceHandlerList.size(); ++i) {
             ProtectedAnnounceHandler l = announceHandlerList[i];
             announceHandlerLock.Unlock(MUTEX_CONTEXT);
-            (*l)->Announce(version, receivedPort, message->GetSender(), objectDescriptions, aboutData);
+            (*l)->Announce(announcement->version, announcement->port, message->GetSender(), announcement->objectDescriptions, announcement->aboutData);
             announceHandlerLock.Lock(MUTEX_CONTEXT);
         }
 
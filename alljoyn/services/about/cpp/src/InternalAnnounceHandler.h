@@ -17,11 +17,13 @@
 #ifndef INTERNALANNOUNCEHANDLER_H_
 #define INTERNALANNOUNCEHANDLER_H_
 
+#include <list>
 #include <map>
 #include <set>
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/about/AnnounceHandler.h>
 
+#include <qcc/ManagedObj.h>
 #include <qcc/Mutex.h>
 
 namespace ajn {
@@ -80,7 +82,7 @@ class InternalAnnounceHandler : public ajn::MessageReceiver {
      */
     void AnnounceSignalHandler(const ajn::InterfaceDescription::Member* member, const char* srcPath, ajn::Message& message);
 
-    bool ContainsInterface(const ObjectDescriptions& objectDescriptions, const qcc::String interface) const;
+    bool ContainsInterface(const std::set<qcc::String>& announcedInterfaces, const qcc::String& interface) const;
 
     qcc::String GetMatchRule(const std::set<qcc::String>& interfaces) const;
 
@@ -97,10 +99,66 @@ class InternalAnnounceHandler : public ajn::MessageReceiver {
      * the state of a single AnnounceHandler registration
      */
     struct RegisteredHandlerState {
+        uint32_t id;
         std::set<qcc::String> interfaces;
         std::set<qcc::String> matchingPeers;
     };
 
+    /**
+     * The unmarshalled contents of the last Announce signal received from a peer.
+     * Peers re-announce unchanged data far more often than they change it, so the
+     * parsed form is kept and reused for as long as the digest of the signal
+     * arguments stays the same.
+     */
+    struct Announcement {
+        uint32_t serial;                        /**< serial number of the last Announce signal */
+        uint64_t digest;                        /**< digest of the Announce signal arguments */
+        uint16_t version;
+        uint16_t port;
+        ObjectDescriptions objectDescriptions;
+        AboutData aboutData;
+        std::set<qcc::String> interfaces;       /**< every interface named in objectDescriptions */
+        std::set<uint32_t> deliveredTo;         /**< ids of the handlers that have seen serial */
+    };
+
+    typedef qcc::ManagedObj<Announcement> CachedAnnouncement;
+
+    /**
+     * Unmarshal the arguments of an Announce signal.
+     */
+    static QStatus ParseAnnouncement(const ajn::MsgArg* args, Announcement& announcement);
+
+    /**
+     * Maximum number of peers whose last announcement is cached.
+     */
+    static const size_t MAX_CACHED_ANNOUNCEMENTS = 4096;
+
+    /**
+     * A cached announcement and its place in announcementOrder.
+     */
+    struct CacheEntry {
+        CachedAnnouncement announcement;
+        std::list<qcc::String>::iterator order;
+    };
+
+    /**
+     * Last announcement received from each peer, keyed by unique name.
+     * Protected by announceMapLock.
+     */
+    std::map<qcc::String, CacheEntry> announcements;
+
+    /**
+     * Unique names of the peers in announcements, the peer heard from most
+     * recently first.  When the cache is full the last peer is evicted.
+     * Protected by announceMapLock.
+     */
+    std::list<qcc::String> announcementOrder;
+
+    /**
+     * id given to the next RegisteredHandlerState
+     */
+    uint32_t nextHandlerId;
+
     /**
      * Map of the AnnounceHandler with the interfaces it is listening for.
      */
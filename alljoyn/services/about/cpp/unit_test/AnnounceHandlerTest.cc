@@ -457,6 +457,78 @@ TEST_F(AnnounceHandlerTest, MultipleAnnounceHandlers)
     EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
 }
 
+TEST_F(AnnounceHandlerTest, LateAnnounceHandlerDoesNotRepeatAnnouncement)
+{
+    QStatus status;
+    announceHandler1Flag = false;
+    announceHandler2Flag = false;
+
+    qcc::GUID128 guid;
+    qcc::String ifaceName = "o" + guid.ToShortString() + ".test.AnnounceHandlerTest";
+
+    std::vector<qcc::String> object_interfaces;
+    object_interfaces.push_back(ifaceName);
+    status = AboutServiceApi::getInstance()->AddObjectDescription("/org/alljoyn/test", object_interfaces);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    // receive
+    BusAttachment clientBus("Receive Announcement client Test", true);
+    status = clientBus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = clientBus.Connect();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    AnnounceHandlerTestAnnounceHandler1 announceHandler1;
+
+    const char* interfaces[1];
+    interfaces[0] = ifaceName.c_str();
+
+    AnnouncementRegistrar::RegisterAnnounceHandler(clientBus, announceHandler1,
+                                                   interfaces, sizeof(interfaces) / sizeof(interfaces[0]));
+
+    status = AboutServiceApi::getInstance()->Announce();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    //Wait for a maximum of 10 sec for the Announce Signal.
+    for (int msec = 0; msec < 10000; msec += WAIT_TIME) {
+        if (announceHandler1Flag) {
+            break;
+        }
+        qcc::Sleep(WAIT_TIME);
+    }
+    ASSERT_TRUE(announceHandler1Flag);
+    announceHandler1Flag = false;
+
+    // Registering a second handler with a new match rule redelivers the same
+    // sessionless Announce signal; only the new handler should see it.
+    AnnounceHandlerTestAnnounceHandler2 announceHandler2;
+
+    AnnouncementRegistrar::RegisterAnnounceHandler(clientBus, announceHandler2, NULL, 0);
+
+    //Wait for a maximum of 10 sec for the redelivered Announce Signal.
+    for (int msec = 0; msec < 10000; msec += WAIT_TIME) {
+        if (announceHandler2Flag) {
+            break;
+        }
+        qcc::Sleep(WAIT_TIME);
+    }
+    ASSERT_TRUE(announceHandler2Flag);
+    qcc::Sleep(200);
+    EXPECT_FALSE(announceHandler1Flag);
+
+    AnnouncementRegistrar::UnRegisterAnnounceHandler(clientBus, announceHandler1,
+                                                     interfaces, sizeof(interfaces) / sizeof(interfaces[0]));
+
+    AnnouncementRegistrar::UnRegisterAnnounceHandler(clientBus, announceHandler2, NULL, 0);
+
+    status = clientBus.Stop();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = clientBus.Join();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+}
+
 TEST_F(AnnounceHandlerTest, MultipleAnnounceHandlersUnregister)
 {
     QStatus status;
@@ -97,6 +97,26 @@ class NotificationService {
      */
     QStatus disableSuperAgent();
 
+    /**
+     * Set the number of threads used to deliver received notifications.
+     * Notifications from one producer are always delivered by the same
+     * thread, in order. Needs to be called before starting receiver
+     * @param threadCount - number of threads, 1 to 16. Defaults to 1
+     * @return status
+     */
+    QStatus setReceiverThreadCount(uint16_t threadCount);
+
+    /**
+     * Get the receive counters of a producer whose notifications
+     * were recently received
+     * @param appId - app id of the producer
+     * @param received - number of notifications delivered
+     * @param duplicates - number of copies dropped because the notification was already delivered or dismissed
+     * @param perMinute - number of notifications delivered during the last full minute
+     * @return ER_OK, or ER_FAIL if no recent notification from this producer
+     */
+    QStatus getProducerStatistics(qcc::String const& appId, uint32_t& received, uint32_t& duplicates, uint32_t& perMinute);
+
     /**
      * Virtual method to get the busAttachment used in the service.
      */
@@ -40,6 +40,11 @@ static const int16_t ANNOUNCMENT_PORT_NUMBER = 900;
 static const uint16_t NOTIFICATION_DISMISSER_VERSION = 1;
 static const uint16_t NOTIFICATION_PRODUCER_VERSION = 1;
 
+static const uint16_t RECEIVER_THREAD_COUNT_DEFAULT = 1;
+static const uint16_t RECEIVER_THREAD_COUNT_MAX = 16;
+static const size_t RECEIVER_QUEUE_MAX = 256;
+static const size_t RECEIVER_CACHE_SIZE = 1024;
+
 static const qcc::String AJPARAM_BOOL = "b";
 static const qcc::String AJPARAM_UINT16 = "q";
 static const qcc::String AJPARAM_STR = "s";
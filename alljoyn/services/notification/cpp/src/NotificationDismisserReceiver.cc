@@ -157,6 +157,7 @@ void NotificationDismisserReceiver::ReceiverThread()
             qcc::String appId;
             QStatus status = UnmarshalMessage(message, msgId, appId);
             if (status == ER_OK) {
+                Transport::getInstance()->getNotificationReceiverCache()->dismiss(msgId, appId);
                 Transport::getInstance()->getNotificationReceiver()->Dismiss(msgId, appId);
             }
             EnterCriticalSection(&m_Lock);
@@ -182,6 +183,7 @@ void NotificationDismisserReceiver::ReceiverThread()
             qcc::String appId;
             QStatus status = UnmarshalMessage(message, msgId, appId);
             if (status == ER_OK) {
+                Transport::getInstance()->getNotificationReceiverCache()->dismiss(msgId, appId);
                 Transport::getInstance()->getNotificationReceiver()->Dismiss(msgId, appId);
             }
             pthread_mutex_lock(&m_Lock);
@@ -0,0 +1,138 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/time.h>
+#include "NotificationReceiverCache.h"
+#include <alljoyn/notification/LogModule.h>
+
+using namespace ajn;
+using namespace services;
+using namespace qcc;
+
+NotificationReceiverCache::NotificationReceiverCache(size_t capacity) :
+    m_Ring(capacity > 0 ? capacity : 1), m_Next(0)
+{
+    for (size_t i = 0; i < m_Ring.size(); i++) {
+        m_Ring[i].valid = false;
+    }
+}
+
+bool NotificationReceiverCache::admit(String const& appId, String const& deviceId, int32_t messageId)
+{
+    m_Lock.Lock(MUTEX_CONTEXT);
+
+    ProducerStatistics& producer = m_Producers[appId];
+    std::pair<MessageIndex::iterator, MessageIndex::iterator> range = m_Index.equal_range(std::make_pair(appId, messageId));
+    for (MessageIndex::iterator it = range.first; it != range.second; ++it) {
+        if (m_Ring[it->second].deviceId == deviceId) {
+            QCC_DbgPrintf(("Dropping %s copy of notification %d from %s", m_Ring[it->second].dismissed ? "dismissed" : "duplicate",
+                           messageId, appId.c_str()));
+            producer.duplicates++;
+            m_Lock.Unlock(MUTEX_CONTEXT);
+            return false;
+        }
+    }
+
+    uint64_t now = GetTimestamp64();
+    if ((now - producer.windowStart) >= 60000) {
+        producer.perMinute = ((now - producer.windowStart) < 120000) ? producer.windowCount : 0;
+        producer.windowStart = now;
+        producer.windowCount = 0;
+    }
+    producer.windowCount++;
+    producer.received++;
+
+    /*
+     * evict() may erase the counters of the producer that owns the slot being
+     * reused, so count the new entry first to keep our own counters alive.
+     */
+    producer.cached++;
+    evict(m_Next);
+
+    Entry& entry = m_Ring[m_Next];
+    entry.appId = appId;
+    entry.deviceId = deviceId;
+    entry.messageId = messageId;
+    entry.dismissed = false;
+    entry.valid = true;
+    m_Index.insert(std::make_pair(std::make_pair(appId, messageId), m_Next));
+    m_Next = (m_Next + 1) % m_Ring.size();
+
+    m_Lock.Unlock(MUTEX_CONTEXT);
+    return true;
+}
+
+bool NotificationReceiverCache::dismiss(int32_t messageId, String const& appId)
+{
+    m_Lock.Lock(MUTEX_CONTEXT);
+    std::pair<MessageIndex::iterator, MessageIndex::iterator> range = m_Index.equal_range(std::make_pair(appId, messageId));
+    bool found = (range.first != range.second);
+    for (MessageIndex::iterator it = range.first; it != range.second; ++it) {
+        m_Ring[it->second].dismissed = true;
+    }
+    m_Lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
+bool NotificationReceiverCache::getProducerStatistics(String const& appId, ProducerStatistics& statistics)
+{
+    m_Lock.Lock(MUTEX_CONTEXT);
+    std::map<String, ProducerStatistics>::const_iterator it = m_Producers.find(appId);
+    bool found = (it != m_Producers.end());
+    if (found) {
+        statistics = it->second;
+    }
+    m_Lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
+void NotificationReceiverCache::clear()
+{
+    m_Lock.Lock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < m_Ring.size(); i++) {
+        m_Ring[i].valid = false;
+    }
+    m_Next = 0;
+    m_Index.clear();
+    m_Producers.clear();
+    m_Lock.Unlock(MUTEX_CONTEXT);
+}
+
+void NotificationReceiverCache::evict(size_t slot)
+{
+    Entry& entry = m_Ring[slot];
+    if (!entry.valid) {
+        return;
+    }
+    entry.valid = false;
+
+    std::pair<MessageIndex::iterator, MessageIndex::iterator> range = m_Index.equal_range(std::make_pair(entry.appId, entry.messageId));
+    for (MessageIndex::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == slot) {
+            m_Index.erase(it);
+            break;
+        }
+    }
+
+    /*
+     * Counters are kept for as long as the producer has notifications in the
+     * ring, which bounds them by the ring capacity.
+     */
+    std::map<String, ProducerStatistics>::iterator pit = m_Producers.find(entry.appId);
+    if ((pit != m_Producers.end()) && (--pit->second.cached == 0)) {
+        m_Producers.erase(pit);
+    }
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#ifndef NOTIFICATIONRECEIVERCACHE_H_
+#define NOTIFICATIONRECEIVERCACHE_H_
+
+#include <map>
+#include <vector>
+#include <qcc/String.h>
+#include <qcc/Mutex.h>
+
+namespace ajn {
+namespace services {
+
+/**
+ * Notification Receiver Cache
+ *
+ * Remembers the most recently received notifications in a fixed size ring,
+ * indexed by app id and message id, so that copies of a notification that
+ * arrive more than once (for example directly from the producer and again
+ * through a super agent) or after it was dismissed are not passed to the
+ * NotificationReceiver again.  Also keeps per producer (app id) receive
+ * counters.
+ */
+class NotificationReceiverCache {
+  public:
+
+    /**
+     * Per producer receive counters
+     */
+    struct ProducerStatistics {
+        uint32_t received;          /**< notifications delivered */
+        uint32_t duplicates;        /**< copies dropped because they were already delivered or dismissed */
+        uint32_t perMinute;         /**< notifications delivered during the last full minute */
+        uint64_t windowStart;       /**< start of the current one minute window */
+        uint32_t windowCount;       /**< notifications delivered in the current window */
+        uint32_t cached;            /**< entries in the ring for this producer */
+    };
+
+    /**
+     * Constructor for NotificationReceiverCache
+     * @param capacity - number of notifications remembered
+     */
+    NotificationReceiverCache(size_t capacity);
+
+    /**
+     * Destructor of NotificationReceiverCache
+     */
+    ~NotificationReceiverCache() { };
+
+    /**
+     * Record a received notification
+     * @param appId     - app id of the producer
+     * @param deviceId  - device id of the producer
+     * @param messageId - message id of the notification
+     * @return true if the notification should be delivered, false if it is a
+     *         copy of one that was already delivered or dismissed
+     */
+    bool admit(qcc::String const& appId, qcc::String const& deviceId, int32_t messageId);
+
+    /**
+     * Record that a notification was dismissed
+     * @param messageId - message id of the notification
+     * @param appId     - app id of the producer
+     * @return true if the notification is in the cache
+     */
+    bool dismiss(int32_t messageId, qcc::String const& appId);
+
+    /**
+     * Get the receive counters of a producer
+     * @param appId - app id of the producer
+     * @param statistics - filled in with the counters
+     * @return true if the producer has notifications in the cache
+     */
+    bool getProducerStatistics(qcc::String const& appId, ProducerStatistics& statistics);
+
+    /**
+     * Forget all notifications and counters
+     */
+    void clear();
+
+  private:
+
+    /**
+     * A cached notification
+     */
+    struct Entry {
+        qcc::String appId;
+        qcc::String deviceId;
+        int32_t messageId;
+        bool dismissed;
+        bool valid;
+    };
+
+    typedef std::multimap<std::pair<qcc::String, int32_t>, size_t> MessageIndex;
+
+    /**
+     * Drop the entry in the given slot from the index and counters
+     * @param slot
+     */
+    void evict(size_t slot);
+
+    /**
+     * The ring of cached notifications
+     */
+    std::vector<Entry> m_Ring;
+
+    /**
+     * The next slot in the ring to be used
+     */
+    size_t m_Next;
+
+    /**
+     * (appId, messageId) to ring slot
+     */
+    MessageIndex m_Index;
+
+    /**
+     * Receive counters per appId
+     */
+    std::map<qcc::String, ProducerStatistics> m_Producers;
+
+    /**
+     * The mutex Lock
+     */
+    qcc::Mutex m_Lock;
+};
+} //namespace services
+} //namespace ajn
+
+#endif /* NOTIFICATIONRECEIVERCACHE_H_ */
@@ -244,6 +244,25 @@ QStatus NotificationService::disableSuperAgent()
     return transport->disableSuperAgent();
 }
 
+QStatus NotificationService::setReceiverThreadCount(uint16_t threadCount)
+{
+    QCC_DbgTrace(("Setting receiver thread count to %u", threadCount));
+    Transport* transport = Transport::getInstance();
+    return transport->setReceiverThreadCount(threadCount);
+}
+
+QStatus NotificationService::getProducerStatistics(String const& appId, uint32_t& received, uint32_t& duplicates, uint32_t& perMinute)
+{
+    NotificationReceiverCache::ProducerStatistics statistics;
+    if (!Transport::getInstance()->getNotificationReceiverCache()->getProducerStatistics(appId, statistics)) {
+        return ER_FAIL;
+    }
+    received = statistics.received;
+    duplicates = statistics.duplicates;
+    perMinute = statistics.perMinute;
+    return ER_OK;
+}
+
 
 BusAttachment* NotificationService::getBusAttachment()
 {
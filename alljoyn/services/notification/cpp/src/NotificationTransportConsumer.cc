@@ -30,32 +30,21 @@ using namespace nsConsts;
 using namespace qcc;
 
 NotificationTransportConsumer::NotificationTransportConsumer(
-    BusAttachment* bus, String const& servicePath, QStatus& status) :
+    BusAttachment* bus, String const& servicePath, QStatus& status, uint16_t threadCount) :
     NotificationTransport(bus, servicePath, status, AJ_NOTIFICATION_INTERFACE_NAME),
     m_IsStopping(false)
 {
     if (status != ER_OK) {
         return;
     }
+    if (threadCount == 0) {
+        threadCount = RECEIVER_THREAD_COUNT_DEFAULT;
+    }
 #ifdef _WIN32
     InitializeCriticalSection(&m_Lock);
-    InitializeConditionVariable(&m_QueueChanged);
-
-    status =  bus->RegisterSignalHandler(this,
-                                         static_cast<MessageReceiver::SignalHandler>(&NotificationTransportConsumer::handleSignal),
-                                         m_SignalMethod,
-                                         NULL);
-
-    if (status != ER_OK) {
-        QCC_LogError(status, ("Could not register the SignalHandler"));
-    } else {
-        QCC_DbgPrintf(("Registered the SignalHandler successfully"));
-    }
-
-    m_handle = reinterpret_cast<HANDLE>(_beginthreadex(NULL, 256 * 1024, (unsigned int (__stdcall*)(void*))ReceiverThreadWrapper, this, 0, NULL));
 #else
     pthread_mutex_init(&m_Lock, NULL);
-    pthread_cond_init(&m_QueueChanged, NULL);
+#endif
 
     status =  bus->RegisterSignalHandler(this,
                                          static_cast<MessageReceiver::SignalHandler>(&NotificationTransportConsumer::handleSignal),
@@ -68,22 +57,52 @@ NotificationTransportConsumer::NotificationTransportConsumer(
         QCC_DbgPrintf(("Registered the SignalHandler successfully"));
     }
 
-    pthread_create(&m_ReceiverThread, NULL, ReceiverThreadWrapper, this);
+    for (uint16_t i = 0; i < threadCount; i++) {
+        ReceiverWorker* worker = new ReceiverWorker();
+        worker->consumer = this;
+        m_Workers.push_back(worker);
+#ifdef _WIN32
+        InitializeConditionVariable(&worker->queueChanged);
+        worker->handle = reinterpret_cast<HANDLE>(_beginthreadex(NULL, 256 * 1024, (unsigned int (__stdcall*)(void*))ReceiverThreadWrapper, worker, 0, NULL));
+#else
+        pthread_cond_init(&worker->queueChanged, NULL);
+        pthread_create(&worker->receiverThread, NULL, ReceiverThreadWrapper, worker);
 #endif
+    }
+}
+
+NotificationTransportConsumer::ReceiverWorker* NotificationTransportConsumer::selectWorker(const char* sender)
+{
+    if (m_Workers.size() == 1 || sender == NULL) {
+        return m_Workers[0];
+    }
+    uint32_t hash = 2166136261U;
+    for (const char* c = sender; *c; ++c) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619U;
+    }
+    return m_Workers[hash % m_Workers.size()];
 }
 
 void NotificationTransportConsumer::handleSignal(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
 {
     QCC_DbgPrintf(("Received Message from producer."));
+    ReceiverWorker* worker = selectWorker(msg->GetSender());
 #ifdef _WIN32
     EnterCriticalSection(&m_Lock);
-    m_MessageQueue.push(msg);
-    WakeConditionVariable(&m_QueueChanged);
-    LeaveCriticalSection(&m_Lock);
 #else
     pthread_mutex_lock(&m_Lock);
-    m_MessageQueue.push(msg);
-    pthread_cond_signal(&m_QueueChanged);
+#endif
+    if (worker->messageQueue.size() >= RECEIVER_QUEUE_MAX) {
+        // keep the newest notifications when a slow receiver falls behind
+        QCC_LogError(ER_NONE, ("Receiver queue is full, dropping the oldest notification from %s", worker->messageQueue.front()->GetSender()));
+        worker->messageQueue.pop();
+    }
+    worker->messageQueue.push(msg);
+#ifdef _WIN32
+    WakeConditionVariable(&worker->queueChanged);
+    LeaveCriticalSection(&m_Lock);
+#else
+    pthread_cond_signal(&worker->queueChanged);
     pthread_mutex_unlock(&m_Lock);
 #endif
 }
@@ -92,14 +111,20 @@ void NotificationTransportConsumer::unregisterHandler(BusAttachment* bus)
 {
 #ifdef _WIN32
     EnterCriticalSection(&m_Lock);
-    while (!m_MessageQueue.empty()) {
-        m_MessageQueue.pop();
-    }
     m_IsStopping = true;
-    WakeConditionVariable(&m_QueueChanged);
+    for (size_t i = 0; i < m_Workers.size(); i++) {
+        while (!m_Workers[i]->messageQueue.empty()) {
+            m_Workers[i]->messageQueue.pop();
+        }
+        WakeConditionVariable(&m_Workers[i]->queueChanged);
+    }
     LeaveCriticalSection(&m_Lock);
-    WaitForSingleObject(m_handle, INFINITE);
-    CloseHandle(m_handle);
+    for (size_t i = 0; i < m_Workers.size(); i++) {
+        WaitForSingleObject(m_Workers[i]->handle, INFINITE);
+        CloseHandle(m_Workers[i]->handle);
+        delete m_Workers[i];
+    }
+    m_Workers.clear();
 
     bus->UnregisterSignalHandler(this,
                                  static_cast<MessageReceiver::SignalHandler>(&NotificationTransportConsumer::handleSignal),
@@ -109,43 +134,49 @@ void NotificationTransportConsumer::unregisterHandler(BusAttachment* bus)
     DeleteCriticalSection(&m_Lock);
 #else
     pthread_mutex_lock(&m_Lock);
-    while (!m_MessageQueue.empty()) {
-        m_MessageQueue.pop();
-    }
     m_IsStopping = true;
-    pthread_cond_signal(&m_QueueChanged);
+    for (size_t i = 0; i < m_Workers.size(); i++) {
+        while (!m_Workers[i]->messageQueue.empty()) {
+            m_Workers[i]->messageQueue.pop();
+        }
+        pthread_cond_signal(&m_Workers[i]->queueChanged);
+    }
     pthread_mutex_unlock(&m_Lock);
-    pthread_join(m_ReceiverThread, NULL);
+    for (size_t i = 0; i < m_Workers.size(); i++) {
+        pthread_join(m_Workers[i]->receiverThread, NULL);
+        pthread_cond_destroy(&m_Workers[i]->queueChanged);
+        delete m_Workers[i];
+    }
+    m_Workers.clear();
 
     bus->UnregisterSignalHandler(this,
                                  static_cast<MessageReceiver::SignalHandler>(&NotificationTransportConsumer::handleSignal),
                                  m_SignalMethod,
                                  NULL);
 
-    pthread_cond_destroy(&m_QueueChanged);
     pthread_mutex_destroy(&m_Lock);
 #endif
 }
 
 void* NotificationTransportConsumer::ReceiverThreadWrapper(void* context)
 {
-    NotificationTransportConsumer* consumer = reinterpret_cast<NotificationTransportConsumer*>(context);
-    if (consumer == NULL) { // should not happen
+    ReceiverWorker* worker = reinterpret_cast<ReceiverWorker*>(context);
+    if (worker == NULL) { // should not happen
         return NULL;
     }
-    consumer->ReceiverThread();
+    worker->consumer->ReceiverThread(worker);
     return NULL;
 }
 
 
-void NotificationTransportConsumer::ReceiverThread()
+void NotificationTransportConsumer::ReceiverThread(ReceiverWorker* worker)
 {
 #ifdef _WIN32
     EnterCriticalSection(&m_Lock);
     while (!m_IsStopping) {
-        while (!m_MessageQueue.empty()) {
-            Message message = m_MessageQueue.front();
-            m_MessageQueue.pop();
+        while (!worker->messageQueue.empty()) {
+            Message message = worker->messageQueue.front();
+            worker->messageQueue.pop();
             LeaveCriticalSection(&m_Lock);
             PayloadAdapter::receivePayload(message);
             EnterCriticalSection(&m_Lock);
@@ -154,16 +185,16 @@ void NotificationTransportConsumer::ReceiverThread()
         // it's possible m_IsStopping changed while executing OnTask() (which is done unlocked)
         //  therefore we have to check it again here, otherwise we potentially deadlock here
         if (!m_IsStopping) {
-            SleepConditionVariableCS(&m_QueueChanged, &m_Lock, INFINITE);
+            SleepConditionVariableCS(&worker->queueChanged, &m_Lock, INFINITE);
         }
     }
     LeaveCriticalSection(&m_Lock);
 #else
     pthread_mutex_lock(&m_Lock);
     while (!m_IsStopping) {
-        while (!m_MessageQueue.empty()) {
-            Message message = m_MessageQueue.front();
-            m_MessageQueue.pop();
+        while (!worker->messageQueue.empty()) {
+            Message message = worker->messageQueue.front();
+            worker->messageQueue.pop();
             pthread_mutex_unlock(&m_Lock);
             PayloadAdapter::receivePayload(message);
             pthread_mutex_lock(&m_Lock);
@@ -172,7 +203,7 @@ void NotificationTransportConsumer::ReceiverThread()
         // it's possible m_IsStopping changed while executing OnTask() (which is done unlocked)
         //  therefore we have to check it again here, otherwise we potentially deadlock here
         if (!m_IsStopping) {
-            pthread_cond_wait(&m_QueueChanged, &m_Lock);
+            pthread_cond_wait(&worker->queueChanged, &m_Lock);
         }
     }
     pthread_mutex_unlock(&m_Lock);
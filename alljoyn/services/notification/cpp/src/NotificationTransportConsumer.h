@@ -18,6 +18,7 @@
 #define NOTIFICATIONTRANSPORTCONSUMER_H_
 
 #include <queue>
+#include <vector>
 #ifdef _WIN32
 #include <Windows.h>
 #define pthread_mutex_t CRITICAL_SECTION
@@ -43,9 +44,11 @@ class NotificationTransportConsumer : public NotificationTransport {
      * @param bus         - BusAttachment that is used
      * @param servicePath - servicePath of BusObject
      * @param status      - success/failure
+     * @param threadCount - number of threads receiving the notifications
      */
     NotificationTransportConsumer(ajn::BusAttachment* bus,
-                                  qcc::String const& servicePath, QStatus& status);
+                                  qcc::String const& servicePath, QStatus& status,
+                                  uint16_t threadCount = 1);
 
     /**
      * Destructor of TransportConsumer
@@ -66,33 +69,57 @@ class NotificationTransportConsumer : public NotificationTransport {
   private:
 
     /**
-     * The thread responsible for receiving the notification
+     * A receiver thread and the messages queued for it.  Messages are
+     * assigned to a thread by sender so notifications from one producer
+     * are still delivered in the order they were sent.
      */
+    struct ReceiverWorker {
+        /**
+         * The consumer owning this thread
+         */
+        NotificationTransportConsumer* consumer;
+
+        /**
+         * The thread responsible for receiving the notification
+         */
 #ifdef _WIN32
-    HANDLE m_handle;
+        HANDLE handle;
 #else
-    pthread_t m_ReceiverThread;
+        pthread_t receiverThread;
 #endif
 
+        /**
+         * A Queue that holds the messages
+         */
+        std::queue<ajn::Message> messageQueue;
+
+        /**
+         * The Queue Changed thread condition
+         */
+        pthread_cond_t queueChanged;
+    };
+
     /**
-     * A Queue that holds the messages
+     * The receiver threads
      */
-    std::queue<ajn::Message> m_MessageQueue;
+    std::vector<ReceiverWorker*> m_Workers;
 
     /**
-     * The mutex Lock
+     * The mutex Lock, shared by all receiver threads
      */
     pthread_mutex_t m_Lock;
 
     /**
-     * The Queue Changed thread condition
+     * is the thread in the process of shutting down
      */
-    pthread_cond_t m_QueueChanged;
+    bool m_IsStopping;
 
     /**
-     * is the thread in the process of shutting down
+     * Pick the receiver thread for a sender
+     * @param sender - unique name of the sender
+     * @return the receiver thread
      */
-    bool m_IsStopping;
+    ReceiverWorker* selectWorker(const char* sender);
 
     /**
      * A wrapper for the receiver Thread
@@ -102,8 +129,9 @@ class NotificationTransportConsumer : public NotificationTransport {
 
     /**
      * The function run in the ReceiverThread
+     * @param worker - the receiver thread
      */
-    void ReceiverThread();
+    void ReceiverThread(ReceiverWorker* worker);
 };
 } //namespace services
 } //namespace ajn
@@ -523,6 +523,11 @@ void PayloadAdapter::receivePayload(Message& msg)
             appId.push_back(chars[c & 15]);
         }
 
+        // drop copies of notifications already delivered or dismissed before unmarshalling the rest
+        if (!Transport::getInstance()->getNotificationReceiverCache()->admit(appId, deviceId, messageId)) {
+            return;
+        }
+
         //Unmarshal appName
         if (appNameArg->typeId != ALLJOYN_STRING) {
             QCC_DbgHLPrintf(("Problem receiving message: Can not Unmarshal this app Name argument."));
@@ -45,7 +45,8 @@ Transport* Transport::s_Instance(NULL);
 Transport::Transport() : m_Bus(0), m_Receiver(0), m_Consumer(0), m_SuperAgent(0), m_AnnounceListener(0), m_SuperAgentBusListener(0),
     m_IsSendingDisabled(false), m_IsReceivingDisabled(false), m_IsSuperAgentDisabled(false),
     m_IsListeningToSuperAgent(false), m_NotificationProducerSender(0), m_NotificationProducerReceiver(0),
-    m_NotificationProducerListener(0), m_NotificationDismisserSender(0), m_NotificationDismisserReceiver(0)
+    m_NotificationProducerListener(0), m_NotificationDismisserSender(0), m_NotificationDismisserReceiver(0),
+    m_ReceiverThreadCount(RECEIVER_THREAD_COUNT_DEFAULT), m_ReceiverCache(RECEIVER_CACHE_SIZE)
 {
     Notification::m_AsyncTaskQueue.Start();
 
@@ -94,6 +95,18 @@ QStatus Transport::disableSuperAgent()
     return ER_OK;
 }
 
+QStatus Transport::setReceiverThreadCount(uint16_t threadCount)
+{
+    if (m_Consumer || m_SuperAgent) {
+        return ER_BUS_ALREADY_CONNECTED;         // Receiver already started
+    }
+    if (threadCount == 0 || threadCount > RECEIVER_THREAD_COUNT_MAX) {
+        return ER_BAD_ARG_1;
+    }
+    m_ReceiverThreadCount = threadCount;
+    return ER_OK;
+}
+
 void Transport::setNotificationReceiver(NotificationReceiver* notificationReceiver)
 {
     m_Receiver = notificationReceiver;
@@ -300,7 +313,7 @@ QStatus Transport::startReceiverTransport(BusAttachment* bus)
     }
 
     if (m_Consumer == NULL) {
-        m_Consumer = new NotificationTransportConsumer(m_Bus, AJ_CONSUMER_SERVICE_PATH, status);
+        m_Consumer = new NotificationTransportConsumer(m_Bus, AJ_CONSUMER_SERVICE_PATH, status, m_ReceiverThreadCount);
         if (status != ER_OK) {
             QCC_LogError(status, ("Could not create Consumer BusObject."));
             goto exit;
@@ -614,6 +627,7 @@ void Transport::cleanupReceiverTransport()
     cleanupTransportSuperAgent(true);
     cleanupSuperAgentBusListener(true);
     cleanupAnnouncementListener(true);
+    m_ReceiverCache.clear();
     QCC_DbgTrace(("Transport::cleanupReceiverTransport end"));
 }
 
@@ -736,3 +750,8 @@ NotificationReceiver* Transport::getNotificationReceiver()
 {
     return m_Receiver;
 }
+
+NotificationReceiverCache* Transport::getNotificationReceiverCache()
+{
+    return &m_ReceiverCache;
+}
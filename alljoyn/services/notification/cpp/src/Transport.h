@@ -21,6 +21,7 @@
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/notification/NotificationEnums.h>
 #include "NotificationConstants.h"
+#include "NotificationReceiverCache.h"
 
 namespace ajn {
 namespace services {
@@ -64,6 +65,14 @@ class Transport {
      */
     QStatus disableSuperAgent();
 
+    /**
+     * Set the number of threads receiving notifications. Needs to be
+     * called before starting receiver
+     * @param threadCount
+     * @return status
+     */
+    QStatus setReceiverThreadCount(uint16_t threadCount);
+
     /**
      * Sets the internal NotificationReceiver to the one
      * provided in the parameter
@@ -201,6 +210,11 @@ class Transport {
      */
     NotificationReceiver* getNotificationReceiver();
 
+    /**
+     * get function for the cache of received notifications
+     */
+    NotificationReceiverCache* getNotificationReceiverCache();
+
     /**
      * FindSuperAgent
      */
@@ -328,6 +342,14 @@ class Transport {
      * NotificationDismisserReceiver
      */
     NotificationDismisserReceiver* m_NotificationDismisserReceiver;
+    /**
+     * Number of threads receiving notifications
+     */
+    uint16_t m_ReceiverThreadCount;
+    /**
+     * Recently received notifications, used to drop duplicates
+     */
+    NotificationReceiverCache m_ReceiverCache;
 
 };
 } //namespace services
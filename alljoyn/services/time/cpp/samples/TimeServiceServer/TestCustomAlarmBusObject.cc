@@ -29,14 +29,14 @@ QStatus TestCustomAlarmBusObject::createCustomInterfaceHook(BusAttachment* bus)
 {
 
     QStatus status        = ER_OK;
-    const char* ifaceName = (tsConsts::ALARM_IFACE + ".CoolAlarm").c_str();
+    const qcc::String ifaceName = tsConsts::ALARM_IFACE + ".CoolAlarm";
 
-    InterfaceDescription* ifaceDesc = const_cast<InterfaceDescription*>(bus->GetInterface(ifaceName));
+    InterfaceDescription* ifaceDesc = const_cast<InterfaceDescription*>(bus->GetInterface(ifaceName.c_str()));
 
 
     if (!ifaceDesc) {
 
-        status = bus->CreateInterface(ifaceName, ifaceDesc);
+        status = bus->CreateInterface(ifaceName.c_str(), ifaceDesc);
         if (status != ER_OK) {
 
             return status;